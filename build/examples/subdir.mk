@@ -4,12 +4,33 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 CPP_SRCS += \
+../examples/bench_coverage.cpp \
+../examples/bench_decoder.cpp \
+../examples/bench_frontdoor.cpp \
+../examples/bench_pack.cpp \
+../examples/bench_publish.cpp \
 ../examples/test_usecase.cpp 
 
 OBJS += \
 ./examples/test_usecase.o 
 
+BENCH_OBJS += \
+./examples/bench_coverage.o \
+./examples/bench_decoder.o \
+./examples/bench_frontdoor.o \
+./examples/bench_pack.o \
+./examples/bench_publish.o 
+
+COVERAGE_BENCH_OBJS += \
+./examples/bench_coverage.cov.o 
+
 CPP_DEPS += \
+./examples/bench_coverage.cov.d \
+./examples/bench_coverage.d \
+./examples/bench_decoder.d \
+./examples/bench_frontdoor.d \
+./examples/bench_pack.d \
+./examples/bench_publish.d \
 ./examples/test_usecase.d 
 
 
@@ -20,5 +41,11 @@ examples/%.o: ../examples/%.cpp
 	g++ -I"../src" -O2 -g -Wall -c -fmessage-length=0 -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@:%.o=%.d)" -o "$@" "$<"
 	@echo 'Finished building: $<'
 	@echo ' '
+examples/%.cov.o: ../examples/%.cpp
+	@echo 'Building file: $<'
+	@echo 'Invoking: GCC C++ Compiler'
+	g++ -I"../src" -DAMIQ_RM_ENABLE_COVERAGE -O2 -g -Wall -c -fmessage-length=0 -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@:%.o=%.d)" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
 
 
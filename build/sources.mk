@@ -13,6 +13,12 @@ CXX_SRCS :=
 C++_SRCS := 
 CC_SRCS := 
 OBJS := 
+CLIENT_LIB_OBJS := 
+COVERAGE_OBJS := 
+TOOLS_OBJS := 
+TESTS_OBJS := 
+BENCH_OBJS := 
+COVERAGE_BENCH_OBJS := 
 C++_DEPS := 
 C_DEPS := 
 CC_DEPS := 
@@ -25,4 +31,6 @@ C_UPPER_DEPS :=
 SUBDIRS := \
 src \
 examples \
+tools \
+tests/unit_tests \
 
@@ -5,21 +5,147 @@
 # Add inputs and outputs from these tool invocations to the build variables 
 CPP_SRCS += \
 ../src/amiq_rm_address_map.cpp \
+../src/amiq_rm_counter.cpp \
+../src/amiq_rm_coverage.cpp \
+../src/amiq_rm_decoder.cpp \
+../src/amiq_rm_exporter.cpp \
 ../src/amiq_rm_field.cpp \
+../src/amiq_rm_frontdoor.cpp \
+../src/amiq_rm_hook_queue.cpp \
+../src/amiq_rm_importer.cpp \
+../src/amiq_rm_indirect_reg.cpp \
+../src/amiq_rm_log.cpp \
+../src/amiq_rm_map_array.cpp \
+../src/amiq_rm_map_worker.cpp \
+../src/amiq_rm_mem.cpp \
+../src/amiq_rm_provider.cpp \
+../src/amiq_rm_quantum_keeper.cpp \
+../src/amiq_rm_rcu.cpp \
 ../src/amiq_rm_reg.cpp \
-../src/amiq_rm_types.cpp 
+../src/amiq_rm_reg_array.cpp \
+../src/amiq_rm_reg_iterator.cpp \
+../src/amiq_rm_sequence.cpp \
+../src/amiq_rm_shm_server.cpp \
+../src/amiq_rm_signal.cpp \
+../src/amiq_rm_types.cpp \
+../src/amiq_rm_vcd_writer.cpp 
 
 OBJS += \
 ./src/amiq_rm_address_map.o \
+./src/amiq_rm_counter.o \
+./src/amiq_rm_coverage.o \
+./src/amiq_rm_decoder.o \
+./src/amiq_rm_exporter.o \
 ./src/amiq_rm_field.o \
+./src/amiq_rm_frontdoor.o \
+./src/amiq_rm_hook_queue.o \
+./src/amiq_rm_importer.o \
+./src/amiq_rm_indirect_reg.o \
+./src/amiq_rm_log.o \
+./src/amiq_rm_map_array.o \
+./src/amiq_rm_map_worker.o \
+./src/amiq_rm_mem.o \
+./src/amiq_rm_provider.o \
+./src/amiq_rm_quantum_keeper.o \
+./src/amiq_rm_rcu.o \
 ./src/amiq_rm_reg.o \
-./src/amiq_rm_types.o 
+./src/amiq_rm_reg_array.o \
+./src/amiq_rm_reg_iterator.o \
+./src/amiq_rm_sequence.o \
+./src/amiq_rm_shm_server.o \
+./src/amiq_rm_signal.o \
+./src/amiq_rm_types.o \
+./src/amiq_rm_vcd_writer.o 
 
 CPP_DEPS += \
 ./src/amiq_rm_address_map.d \
+./src/amiq_rm_counter.d \
+./src/amiq_rm_coverage.d \
+./src/amiq_rm_decoder.d \
+./src/amiq_rm_exporter.d \
 ./src/amiq_rm_field.d \
+./src/amiq_rm_frontdoor.d \
+./src/amiq_rm_hook_queue.d \
+./src/amiq_rm_importer.d \
+./src/amiq_rm_indirect_reg.d \
+./src/amiq_rm_log.d \
+./src/amiq_rm_map_array.d \
+./src/amiq_rm_map_worker.d \
+./src/amiq_rm_mem.d \
+./src/amiq_rm_provider.d \
+./src/amiq_rm_quantum_keeper.d \
+./src/amiq_rm_rcu.d \
 ./src/amiq_rm_reg.d \
-./src/amiq_rm_types.d 
+./src/amiq_rm_reg_array.d \
+./src/amiq_rm_reg_iterator.d \
+./src/amiq_rm_sequence.d \
+./src/amiq_rm_shm_server.d \
+./src/amiq_rm_signal.d \
+./src/amiq_rm_types.d \
+./src/amiq_rm_vcd_writer.d 
+
+COVERAGE_OBJS += \
+./src/amiq_rm_address_map.cov.o \
+./src/amiq_rm_counter.cov.o \
+./src/amiq_rm_coverage.cov.o \
+./src/amiq_rm_decoder.cov.o \
+./src/amiq_rm_exporter.cov.o \
+./src/amiq_rm_field.cov.o \
+./src/amiq_rm_frontdoor.cov.o \
+./src/amiq_rm_hook_queue.cov.o \
+./src/amiq_rm_importer.cov.o \
+./src/amiq_rm_indirect_reg.cov.o \
+./src/amiq_rm_log.cov.o \
+./src/amiq_rm_map_array.cov.o \
+./src/amiq_rm_map_worker.cov.o \
+./src/amiq_rm_mem.cov.o \
+./src/amiq_rm_provider.cov.o \
+./src/amiq_rm_quantum_keeper.cov.o \
+./src/amiq_rm_rcu.cov.o \
+./src/amiq_rm_reg.cov.o \
+./src/amiq_rm_reg_array.cov.o \
+./src/amiq_rm_reg_iterator.cov.o \
+./src/amiq_rm_sequence.cov.o \
+./src/amiq_rm_shm_server.cov.o \
+./src/amiq_rm_signal.cov.o \
+./src/amiq_rm_types.cov.o \
+./src/amiq_rm_vcd_writer.cov.o 
+
+CPP_DEPS += \
+./src/amiq_rm_address_map.cov.d \
+./src/amiq_rm_counter.cov.d \
+./src/amiq_rm_coverage.cov.d \
+./src/amiq_rm_decoder.cov.d \
+./src/amiq_rm_exporter.cov.d \
+./src/amiq_rm_field.cov.d \
+./src/amiq_rm_frontdoor.cov.d \
+./src/amiq_rm_hook_queue.cov.d \
+./src/amiq_rm_importer.cov.d \
+./src/amiq_rm_indirect_reg.cov.d \
+./src/amiq_rm_log.cov.d \
+./src/amiq_rm_map_array.cov.d \
+./src/amiq_rm_map_worker.cov.d \
+./src/amiq_rm_mem.cov.d \
+./src/amiq_rm_provider.cov.d \
+./src/amiq_rm_quantum_keeper.cov.d \
+./src/amiq_rm_rcu.cov.d \
+./src/amiq_rm_reg.cov.d \
+./src/amiq_rm_reg_array.cov.d \
+./src/amiq_rm_reg_iterator.cov.d \
+./src/amiq_rm_sequence.cov.d \
+./src/amiq_rm_shm_server.cov.d \
+./src/amiq_rm_signal.cov.d \
+./src/amiq_rm_types.cov.d \
+./src/amiq_rm_vcd_writer.cov.d 
+
+C_SRCS += \
+../src/amiq_rm_shm_client.c 
+
+CLIENT_LIB_OBJS += \
+./src/amiq_rm_shm_client.pic.o 
+
+C_DEPS += \
+./src/amiq_rm_shm_client.pic.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
@@ -30,4 +156,18 @@ src/%.o: ../src/%.cpp
 	@echo 'Finished building: $<'
 	@echo ' '
 
+src/%.cov.o: ../src/%.cpp
+	@echo 'Building file: $<'
+	@echo 'Invoking: GCC C++ Compiler'
+	g++ -I"../src" -DAMIQ_RM_ENABLE_COVERAGE -O2 -g -Wall -c -fmessage-length=0 -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@:%.o=%.d)" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+src/%.pic.o: ../src/%.c
+	@echo 'Building file: $<'
+	@echo 'Invoking: GCC C Compiler'
+	gcc -I"../src" -O2 -g -Wall -fPIC -c -fmessage-length=0 -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@:%.o=%.d)" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
 
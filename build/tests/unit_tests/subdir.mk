@@ -0,0 +1,84 @@
+################################################################################
+# Automatically-generated file. Do not edit!
+################################################################################
+
+# Add inputs and outputs from these tool invocations to the build variables 
+CPP_SRCS += \
+../tests/unit_tests/test_counter.cpp \
+../tests/unit_tests/test_coverage.cpp \
+../tests/unit_tests/test_decoder.cpp \
+../tests/unit_tests/test_exporter.cpp \
+../tests/unit_tests/test_frontdoor.cpp \
+../tests/unit_tests/test_hook_queue.cpp \
+../tests/unit_tests/test_importer.cpp \
+../tests/unit_tests/test_indirect_reg.cpp \
+../tests/unit_tests/test_latency.cpp \
+../tests/unit_tests/test_map_array.cpp \
+../tests/unit_tests/test_map_worker.cpp \
+../tests/unit_tests/test_mem.cpp \
+../tests/unit_tests/test_pack.cpp \
+../tests/unit_tests/test_provider.cpp \
+../tests/unit_tests/test_randomize.cpp \
+../tests/unit_tests/test_rcu.cpp \
+../tests/unit_tests/test_sequence.cpp \
+../tests/unit_tests/test_shm.cpp \
+../tests/unit_tests/test_signal.cpp \
+../tests/unit_tests/test_vcd_writer.cpp \
+../tests/unit_tests/test_wait_for.cpp 
+
+TESTS_OBJS += \
+./tests/unit_tests/test_counter.o \
+./tests/unit_tests/test_coverage.o \
+./tests/unit_tests/test_decoder.o \
+./tests/unit_tests/test_exporter.o \
+./tests/unit_tests/test_frontdoor.o \
+./tests/unit_tests/test_hook_queue.o \
+./tests/unit_tests/test_importer.o \
+./tests/unit_tests/test_indirect_reg.o \
+./tests/unit_tests/test_latency.o \
+./tests/unit_tests/test_map_array.o \
+./tests/unit_tests/test_map_worker.o \
+./tests/unit_tests/test_mem.o \
+./tests/unit_tests/test_pack.o \
+./tests/unit_tests/test_provider.o \
+./tests/unit_tests/test_randomize.o \
+./tests/unit_tests/test_rcu.o \
+./tests/unit_tests/test_sequence.o \
+./tests/unit_tests/test_shm.o \
+./tests/unit_tests/test_signal.o \
+./tests/unit_tests/test_vcd_writer.o \
+./tests/unit_tests/test_wait_for.o 
+
+CPP_DEPS += \
+./tests/unit_tests/test_counter.d \
+./tests/unit_tests/test_coverage.d \
+./tests/unit_tests/test_decoder.d \
+./tests/unit_tests/test_exporter.d \
+./tests/unit_tests/test_frontdoor.d \
+./tests/unit_tests/test_hook_queue.d \
+./tests/unit_tests/test_importer.d \
+./tests/unit_tests/test_indirect_reg.d \
+./tests/unit_tests/test_latency.d \
+./tests/unit_tests/test_map_array.d \
+./tests/unit_tests/test_map_worker.d \
+./tests/unit_tests/test_mem.d \
+./tests/unit_tests/test_pack.d \
+./tests/unit_tests/test_provider.d \
+./tests/unit_tests/test_randomize.d \
+./tests/unit_tests/test_rcu.d \
+./tests/unit_tests/test_sequence.d \
+./tests/unit_tests/test_shm.d \
+./tests/unit_tests/test_signal.d \
+./tests/unit_tests/test_vcd_writer.d \
+./tests/unit_tests/test_wait_for.d 
+
+
+# Each subdirectory must supply rules for building sources it contributes
+tests/unit_tests/%.o: ../tests/unit_tests/%.cpp
+	@echo 'Building file: $<'
+	@echo 'Invoking: GCC C++ Compiler'
+	g++ -I"../src" -O2 -g -Wall -c -fmessage-length=0 -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@:%.o=%.d)" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+
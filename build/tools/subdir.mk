@@ -0,0 +1,24 @@
+################################################################################
+# Automatically-generated file. Do not edit!
+################################################################################
+
+# Add inputs and outputs from these tool invocations to the build variables 
+CPP_SRCS += \
+../tools/amiq_rm_cov_merge.cpp 
+
+TOOLS_OBJS += \
+./tools/amiq_rm_cov_merge.o 
+
+CPP_DEPS += \
+./tools/amiq_rm_cov_merge.d 
+
+
+# Each subdirectory must supply rules for building sources it contributes
+tools/%.o: ../tools/%.cpp
+	@echo 'Building file: $<'
+	@echo 'Invoking: GCC C++ Compiler'
+	g++ -I"../src" -O2 -g -Wall -c -fmessage-length=0 -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@:%.o=%.d)" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+
@@ -0,0 +1,99 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        bench_coverage.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+
+#include "amiq_rm.h"
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+using namespace std;
+using namespace amiq_rm;
+
+/** The source is built twice: examples/bench_coverage against the library without coverage and examples/bench_coverage_enabled
+ * against the library compiled with AMIQ_RM_ENABLE_COVERAGE; the difference between the two reports is the cost of the sampling.
+ * The target is that the sampling adds at most 3 ns per field to an access (one counter and one bit of the bitmap of values),
+ * i.e. 25 ns for a register with eight 4-bit fields and 5 ns for a register with one 32-bit field. */
+
+/** Number of registers of the map. */
+static const int unsigned NOF_REGS = 256;
+
+/** Number of accesses measured for each kind of access. */
+static const int unsigned NOF_ACCESSES = 4000000;
+
+/** Receives the values read by the benchmark, so the reads are not optimized away. */
+static volatile amiq_rm_reg_data_t sink;
+
+/** The function measures the accesses to the registers of a map, in a scattered order.
+ * @param map is the map
+ * @param base is the address of the first register, the registers are placed at consecutive words
+ * @param direction selects reads or writes
+ * @returns the average time of an access in nanoseconds */
+static double measure(amiq_rm_physical_address_map &map, amiq_rm_reg_address_t base, amiq_rm_direction_t direction) {
+	amiq_rm_reg_data_t checksum = 0;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for (int unsigned i = 0; i < NOF_ACCESSES; i++) {
+		amiq_rm_reg_address_t address = base + 4 * ((i * 97) % NOF_REGS);
+		if (direction == READ)
+			checksum += map.read(address).first;
+		else
+			checksum += map.write(address, i * 0x9E3779B9);
+	}
+	chrono::steady_clock::time_point end = chrono::steady_clock::now();
+	sink = checksum;
+	return chrono::duration<double, nano>(end - start).count() / NOF_ACCESSES;
+}
+
+int main() {
+	amiq_rm_physical_address_map map("map");
+	vector<amiq_rm_reg*> regs;
+
+	//registers with eight 4-bit fields (all of them have a bitmap of values) at 0x0 and registers with one 32-bit field at 0x10000
+	for (int unsigned i = 0; i < NOF_REGS; i++) {
+		amiq_rm_reg *reg = new amiq_rm_reg("ctrl" + to_string(i));
+		for (int unsigned j = 0; j < 8; j++)
+			reg->add_field(new amiq_rm_field("f" + to_string(j), 0, 4, (j % 2 == 0) ? "RW" : "W1C"));
+		map.add_reg(*reg, 4 * i);
+		regs.push_back(reg);
+
+		reg = new amiq_rm_reg("data" + to_string(i));
+		reg->add_field(new amiq_rm_field("value", 0, 32, "RW"));
+		map.add_reg(*reg, 0x10000 + 4 * i);
+		regs.push_back(reg);
+	}
+	map.build();
+	map.reset();
+
+#ifdef AMIQ_RM_ENABLE_COVERAGE
+	cout << "Coverage compiled in: " << amiq_rm_coverage::get().fields.size() << " fields, " << amiq_rm_coverage::get().pool.size()
+			<< " words" << endl;
+#else
+	cout << "Coverage compiled out" << endl;
+#endif
+	cout << fixed << setprecision(1);
+	cout << "Read of 8 x 4-bit fields:  " << setw(6) << measure(map, 0x0, READ) << " ns" << endl;
+	cout << "Write of 8 x 4-bit fields: " << setw(6) << measure(map, 0x0, WRITE) << " ns" << endl;
+	cout << "Read of 1 x 32-bit field:  " << setw(6) << measure(map, 0x10000, READ) << " ns" << endl;
+	cout << "Write of 1 x 32-bit field: " << setw(6) << measure(map, 0x10000, WRITE) << " ns" << endl;
+
+	for (int unsigned i = 0; i < regs.size(); i++)
+		delete regs[i];
+	return 0;
+}
@@ -0,0 +1,104 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        bench_decoder.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#include "amiq_rm.h"
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+using namespace std;
+using namespace amiq_rm;
+
+/** Number of blocks of the SoC, each one is placed at its own address in a 48-bit address space. */
+static const int unsigned NOF_BLOCKS = 64;
+
+/** Number of registers of a block. */
+static const int unsigned NOF_REGS = 64;
+
+/** Number of reads measured for each decoding path. */
+static const int unsigned NOF_READS = 2000000;
+
+/** Receives the values read by the benchmark, so the reads are not optimized away. */
+static volatile amiq_rm_reg_data_t sink;
+
+/** The function measures the reads of the registers of the map, in a scattered order.
+ * @returns the average time of a read in nanoseconds */
+static double measure_reads(amiq_rm_physical_address_map &map, vector<amiq_rm_reg_address_t> &addresses, int unsigned nof_reads) {
+	amiq_rm_reg_data_t checksum = 0;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for (int unsigned i = 0; i < nof_reads; i++) {
+		checksum += map.read(addresses[(i * 7919) % addresses.size()]).first;
+	}
+	chrono::steady_clock::time_point end = chrono::steady_clock::now();
+	sink = checksum;
+	return chrono::duration<double, nano>(end - start).count() / nof_reads;
+}
+
+int main() {
+	amiq_rm_physical_address_map soc("soc");
+	vector<amiq_rm_address_map*> clusters;
+	vector<amiq_rm_address_map*> blocks;
+	vector<amiq_rm_reg*> regs;
+	vector<amiq_rm_reg_address_t> addresses;
+
+	//the blocks are grouped in clusters scattered over a 48-bit address space, which gives three levels of hierarchy
+	for (int unsigned i = 0; i < NOF_BLOCKS; i++) {
+		if (i % 8 == 0) {
+			clusters.push_back(new amiq_rm_address_map("cluster"));
+			soc.add_map(*clusters.back(), ((amiq_rm_reg_address_t) (i / 8 + 1)) << 40);
+		}
+		amiq_rm_address_map *block = new amiq_rm_address_map("block");
+		for (int unsigned j = 0; j < NOF_REGS; j++) {
+			amiq_rm_reg *reg = new amiq_rm_reg("reg");
+			reg->add_field(new amiq_rm_field("value", j, 32, "RW"));
+			block->add_reg(*reg, 4 * j);
+			regs.push_back(reg);
+		}
+		amiq_rm_reg_address_t block_offset = ((amiq_rm_reg_address_t) (i % 8)) << 28 | ((amiq_rm_reg_address_t) i << 16);
+		clusters.back()->add_map(*block, block_offset);
+		blocks.push_back(block);
+		for (int unsigned j = 0; j < NOF_REGS; j++)
+			addresses.push_back((((amiq_rm_reg_address_t) (i / 8 + 1)) << 40) + block_offset + 4 * j);
+	}
+	soc.build();
+	soc.reset();
+
+	amiq_rm_radix_decoder &decoder = soc.get_decoder();
+	cout << "Decoder: " << decoder.get_nof_targets() << " targets, " << decoder.get_nof_levels() << " levels, " << decoder.get_nof_nodes()
+			<< " nodes" << endl;
+
+	double radix_time = measure_reads(soc, addresses, NOF_READS);
+
+	//without the decoder, the accesses fall back to the recursive search through the maps
+	decoder.clear();
+	double search_time = measure_reads(soc, addresses, NOF_READS / 10);
+
+	cout << fixed << setprecision(1);
+	cout << "Read with the radix decoder:    " << setw(8) << radix_time << " ns" << endl;
+	cout << "Read with the recursive search: " << setw(8) << search_time << " ns" << endl;
+
+	for (int unsigned i = 0; i < regs.size(); i++)
+		delete regs[i];
+	for (int unsigned i = 0; i < blocks.size(); i++)
+		delete blocks[i];
+	for (int unsigned i = 0; i < clusters.size(); i++)
+		delete clusters[i];
+	return 0;
+}
@@ -0,0 +1,86 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        bench_frontdoor.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+
+#include "amiq_rm.h"
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+using namespace std;
+using namespace amiq_rm;
+
+/** Number of registers of the device. */
+static const int unsigned NOF_REGS = 64;
+
+/** Number of transactions measured for each number of outstanding transactions. */
+static const int unsigned NOF_TRANSACTIONS = 20000;
+
+/** The latency of a transaction of the local bus. */
+static const chrono::microseconds LATENCY(20);
+
+/** The function builds a map with NOF_REGS registers at consecutive addresses.
+ * @param map is the map
+ * @param regs is filled with the registers, which are deleted by the caller */
+static void build_map(amiq_rm_physical_address_map &map, vector<amiq_rm_reg*> &regs) {
+	for (int unsigned i = 0; i < NOF_REGS; i++) {
+		amiq_rm_reg *reg = new amiq_rm_reg("reg" + to_string(i));
+		reg->add_field(new amiq_rm_field("value", i, 32, "RW"));
+		map.add_reg(*reg, 4 * i);
+		regs.push_back(reg);
+	}
+	map.build();
+	map.reset();
+}
+
+int main() {
+	amiq_rm_physical_address_map device("device");
+	amiq_rm_physical_address_map model("model");
+	vector<amiq_rm_reg*> regs;
+	build_map(device, regs);
+	build_map(model, regs);
+	amiq_rm_local_bus_adapter adapter(device, LATENCY);
+
+	//with N outstanding transactions, the throughput is bounded by N transactions per latency
+	cout << "Transactions with a bus latency of " << LATENCY.count() << " us:" << endl;
+	cout << fixed << setprecision(1);
+	for (int unsigned max_outstanding = 1; max_outstanding <= 64; max_outstanding *= 2) {
+		amiq_rm_frontdoor frontdoor(model, adapter, max_outstanding);
+		int unsigned nof_transactions = (max_outstanding < 8) ? NOF_TRANSACTIONS / 8 : NOF_TRANSACTIONS;
+
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		for (int unsigned i = 0; i < nof_transactions; i++) {
+			amiq_rm_reg_address_t address = 4 * (i % NOF_REGS);
+			if (i % 2 == 0)
+				frontdoor.write(address, i);
+			else
+				frontdoor.read(address);
+		}
+		frontdoor.wait_all();
+		chrono::steady_clock::time_point end = chrono::steady_clock::now();
+
+		double seconds = chrono::duration<double>(end - start).count();
+		cout << "  " << setw(2) << max_outstanding << " outstanding: " << setw(10) << nof_transactions / seconds << " transactions/s" << endl;
+	}
+
+	for (int unsigned i = 0; i < regs.size(); i++)
+		delete regs[i];
+	return 0;
+}
@@ -0,0 +1,92 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        bench_pack.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#include "amiq_rm.h"
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+using namespace std;
+using namespace amiq_rm;
+
+/** Number of elements of the register array. */
+static const int unsigned NOF_ELEMENTS = 4096;
+
+/** Number of fields of the layout register (8 fields of 4 bits). */
+static const int unsigned NOF_FIELDS = 8;
+
+/** Number of times the array is unpacked. */
+static const int unsigned NOF_PASSES = 200;
+
+/** @returns the nanoseconds per unpacked field value of a pass over all elements, @b pass being called NOF_PASSES times. */
+template<typename T> static double measure(T pass) {
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for (int unsigned i = 0; i < NOF_PASSES; i++)
+		pass();
+	chrono::steady_clock::time_point end = chrono::steady_clock::now();
+	return chrono::duration<double, nano>(end - start).count() / ((double) NOF_PASSES * NOF_ELEMENTS * NOF_FIELDS);
+}
+
+int main() {
+	amiq_rm_reg *layout = new amiq_rm_reg("layout");
+	for (int unsigned f = 0; f < NOF_FIELDS; f++)
+		layout->add_field(new amiq_rm_field("field" + to_string(f), 0, 4, "RW"));
+	amiq_rm_reg_array array("array", layout, NOF_ELEMENTS, 4);
+	array.build();
+	for (int unsigned i = 0; i < NOF_ELEMENTS; i++)
+		array.set(i, 0x9E3779B9 * (i + 1));
+
+	vector<vector<amiq_rm_reg_data_t> > columns(NOF_FIELDS, vector<amiq_rm_reg_data_t>(NOF_ELEMENTS, 0));
+	vector<amiq_rm_reg_data_t*> column_pointers(NOF_FIELDS);
+	vector<string> names(NOF_FIELDS);
+	for (int unsigned f = 0; f < NOF_FIELDS; f++) {
+		column_pointers[f] = &columns[f][0];
+		names[f] = layout->fields[f]->name;
+	}
+
+	double by_name = measure([&]() {
+		for (int unsigned i = 0; i < NOF_ELEMENTS; i++)
+			for (int unsigned f = 0; f < NOF_FIELDS; f++)
+				columns[f][i] = array.get_field_value(i, names[f]);
+	});
+	double unpacked = measure([&]() {
+		amiq_rm_reg_data_t values[NOF_FIELDS];
+		for (int unsigned i = 0; i < NOF_ELEMENTS; i++) {
+			layout->unpack(array.values[i], values);
+			for (int unsigned f = 0; f < NOF_FIELDS; f++)
+				columns[f][i] = values[f];
+		}
+	});
+	double columnar = measure([&]() {
+		array.unpack_columns(&column_pointers[0]);
+	});
+
+	amiq_rm_reg_data_t checksum = 0;
+	for (int unsigned f = 0; f < NOF_FIELDS; f++)
+		for (int unsigned i = 0; i < NOF_ELEMENTS; i++)
+			checksum += columns[f][i];
+
+	cout << "Field values of " << NOF_ELEMENTS << " elements with " << NOF_FIELDS << " fields (checksum " << hex << checksum << dec << "):" << endl;
+	cout << fixed << setprecision(2);
+	cout << "  get_field_value(): " << setw(6) << by_name << " ns/field" << endl;
+	cout << "  unpack():          " << setw(6) << unpacked << " ns/field" << endl;
+	cout << "  unpack_columns():  " << setw(6) << columnar << " ns/field" << endl;
+	return 0;
+}
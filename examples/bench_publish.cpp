@@ -0,0 +1,128 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        bench_publish.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#include "amiq_rm.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace amiq_rm;
+
+/** Number of blocks of the SoC. */
+static const int unsigned NOF_BLOCKS = 64;
+
+/** Number of registers of a block. */
+static const int unsigned NOF_REGS = 64;
+
+/** Number of reads measured for each configuration. */
+static const int unsigned NOF_READS = 2000000;
+
+/** Number of publications and relocations measured. */
+static const int unsigned NOF_UPDATES = 200;
+
+/** Receives the values read by the benchmark, so the reads are not optimized away. */
+static volatile amiq_rm_reg_data_t sink;
+
+/** The function measures the reads of the registers of the map, in a scattered order.
+ * @returns the average time of a read in nanoseconds */
+static double measure_reads(amiq_rm_physical_address_map &map, vector<amiq_rm_reg_address_t> &addresses) {
+	amiq_rm_reg_data_t checksum = 0;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for (int unsigned i = 0; i < NOF_READS; i++)
+		checksum += map.read(addresses[(i * 7919) % addresses.size()]).first;
+	chrono::steady_clock::time_point end = chrono::steady_clock::now();
+	sink = checksum;
+	return chrono::duration<double, nano>(end - start).count() / NOF_READS;
+}
+
+/** The thread which publishes the topology of the map until it is stopped. */
+static void publish_loop(amiq_rm_physical_address_map *map, atomic<bool> *stopped, int unsigned *nof_publications) {
+	while (!*stopped) {
+		map->publish();
+		(*nof_publications)++;
+	}
+}
+
+int main() {
+	amiq_rm_physical_address_map soc("soc");
+	vector<amiq_rm_address_map*> blocks;
+	vector<amiq_rm_reg*> regs;
+	vector<amiq_rm_reg_address_t> addresses;
+
+	for (int unsigned i = 0; i < NOF_BLOCKS; i++) {
+		amiq_rm_address_map *block = new amiq_rm_address_map("block" + to_string(i));
+		for (int unsigned j = 0; j < NOF_REGS; j++) {
+			amiq_rm_reg *reg = new amiq_rm_reg("reg");
+			reg->add_field(new amiq_rm_field("value", j, 32, "RW"));
+			block->add_reg(*reg, 4 * j);
+			regs.push_back(reg);
+		}
+		soc.add_map(*block, ((amiq_rm_reg_address_t) i) << 16);
+		blocks.push_back(block);
+		for (int unsigned j = 0; j < NOF_REGS; j++)
+			addresses.push_back((((amiq_rm_reg_address_t) i) << 16) + 4 * j);
+	}
+	soc.build();
+	soc.reset();
+	cout << "Decoder: " << soc.get_decoder().get_nof_targets() << " targets" << endl;
+
+	//the cost of the read-side sections
+	double plain_time = measure_reads(soc, addresses);
+	soc.enable_rcu();
+	double rcu_time = measure_reads(soc, addresses);
+
+	//the cost of a publication: a new decoder is built, the old one is retired and reclaimed
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for (int unsigned i = 0; i < NOF_UPDATES; i++)
+		soc.publish();
+	double publish_time = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / NOF_UPDATES;
+
+	//the cost of moving a block to a free range and back (an even number of moves), only the two ranges are decoded again
+	start = chrono::steady_clock::now();
+	for (int unsigned i = 0; i < NOF_UPDATES; i++)
+		soc.relocate_map(*blocks[0], (i % 2 == 0) ? (((amiq_rm_reg_address_t) NOF_BLOCKS) << 16) : 0);
+	double relocate_time = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / NOF_UPDATES;
+
+	//the reads while another thread publishes continuously
+	atomic<bool> stopped(false);
+	int unsigned nof_publications = 0;
+	thread publisher(publish_loop, &soc, &stopped, &nof_publications);
+	double concurrent_time = measure_reads(soc, addresses);
+	stopped = true;
+	publisher.join();
+	amiq_rm_rcu::get().reclaim();
+
+	cout << fixed << setprecision(1);
+	cout << "Read without RCU:                 " << setw(8) << plain_time << " ns" << endl;
+	cout << "Read in a read-side section:      " << setw(8) << rcu_time << " ns" << endl;
+	cout << "Read during publications:         " << setw(8) << concurrent_time << " ns (" << nof_publications << " publications)" << endl;
+	cout << "Publication of the topology:      " << setw(8) << publish_time << " us" << endl;
+	cout << "Relocation of a block:            " << setw(8) << relocate_time << " us" << endl;
+	cout << "Decoders waiting for reclamation: " << setw(8) << amiq_rm_rcu::get().get_nof_retired() << endl;
+
+	for (int unsigned i = 0; i < regs.size(); i++)
+		delete regs[i];
+	for (int unsigned i = 0; i < blocks.size(); i++)
+		delete blocks[i];
+	return 0;
+}
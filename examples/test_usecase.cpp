@@ -150,7 +150,7 @@ public:
 	input_enable input_enable_h;
 	output_enable output_enable_h;
 	prio_destination prio_destination_h;
-	vector<dropped_ch*> dropped_ch_h;
+	amiq_rm_reg_array dropped_ch_h;
 	ld_baud ld_baud_h;
 	baud_0 baud_0_h;
 	baud_1 baud_1_h;
@@ -166,8 +166,7 @@ public:
 		map.add_reg(input_enable_h, 0x08);
 		map.add_reg(output_enable_h, 0x0C);
 		map.add_reg(prio_destination_h, 0x10);
-		for (int i = 0; i < 4; i++)
-			map.add_reg(*dropped_ch_h[i], 0x32 + dropped_ch_h[i]->get_size());
+		map.add_reg_array(dropped_ch_h, 0x32);
 		map.add_reg(ld_baud_h, 0xFB);
 		map.add_reg(baud_0_h, 0xFC);
 		map.add_reg(baud_1_h, 0xFD);
@@ -178,14 +177,8 @@ public:
 
 	amiq_rtr_reg_block() :
 			amiq_rm_reg_block("my_reg_block"), local_id_h("local_id"), software_reset_h("software_reset"), input_enable_h("input_enable"), output_enable_h(
-					"output_enable"), prio_destination_h("prio_destination"), ld_baud_h("ld_baud"), baud_0_h("baud_0"), baud_1_h("baud_1"), baud_2_h(
-					"baud_2"), baud_3_h("baud_3"), uart_map("uart_map"), ahb_map("ahb_map") {
-
-		for (int i = 0; i < 4; i++) {
-			ostringstream name;
-			name << "dropped_ch_" << i;
-			dropped_ch_h.push_back(new dropped_ch(name.str()));
-		}
+					"output_enable"), prio_destination_h("prio_destination"), dropped_ch_h("dropped_ch", new dropped_ch("dropped_ch"), 4, 1), ld_baud_h(
+					"ld_baud"), baud_0_h("baud_0"), baud_1_h("baud_1"), baud_2_h("baud_2"), baud_3_h("baud_3"), uart_map("uart_map"), ahb_map("ahb_map") {
 
 		add_to_map(ahb_map, 0x00);
 		add_to_map(uart_map, 0x20);
@@ -194,11 +187,6 @@ public:
 		uart_map.build();
 	}
 
-	~amiq_rtr_reg_block() {
-		for (int unsigned i = 0; i < dropped_ch_h.size(); i++)
-			delete dropped_ch_h[i];
-	}
-
 };
 
 class reg_test {
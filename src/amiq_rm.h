@@ -20,9 +20,31 @@
 #ifndef	AMIQ_RM
 #define	AMIQ_RM	1
 
+#include "amiq_rm_log.hpp"
 #include "amiq_rm_reg_block.hpp"
+#include "amiq_rm_signal.hpp"
+#include "amiq_rm_provider.hpp"
+#include "amiq_rm_counter.hpp"
+#include "amiq_rm_observer.hpp"
 #include "amiq_rm_field.hpp"
+#include "amiq_rm_coverage.hpp"
 #include "amiq_rm_reg.hpp"
+#include "amiq_rm_hook_queue.hpp"
+#include "amiq_rm_mem.hpp"
+#include "amiq_rm_reg_array.hpp"
+#include "amiq_rm_map_array.hpp"
+#include "amiq_rm_indirect_reg.hpp"
+#include "amiq_rm_decoder.hpp"
+#include "amiq_rm_rcu.hpp"
+#include "amiq_rm_quantum_keeper.hpp"
+#include "amiq_rm_reg_iterator.hpp"
 #include "amiq_rm_address_map.hpp"
+#include "amiq_rm_sequence.hpp"
+#include "amiq_rm_frontdoor.hpp"
+#include "amiq_rm_shm_server.hpp"
+#include "amiq_rm_map_worker.hpp"
+#include "amiq_rm_exporter.hpp"
+#include "amiq_rm_importer.hpp"
+#include "amiq_rm_vcd_writer.hpp"
 
 #endif
@@ -21,9 +21,11 @@
 #define	AMIQ_RM_ADDRESS_MAP	1
 
 #include <assert.h>
+#include <algorithm>
 #include <iostream>
 #include "amiq_rm_reg.hpp"
 #include "amiq_rm_address_map.hpp"
+#include "amiq_rm_log.hpp"
 
 using namespace std;
 
@@ -34,6 +36,14 @@ void amiq_rm_address_map::reset() {
 		it->second->reset();
 	}
 
+	for (amiq_rm_reg_array_map_t::iterator it = reg_arrays.begin(); it != reg_arrays.end(); it++) {
+		it->second->reset();
+	}
+
+	for (amiq_rm_map_array_map_t::iterator it = map_arrays.begin(); it != map_arrays.end(); it++) {
+		it->second->reset();
+	}
+
 	for (amiq_rm_addressmap_map_t::iterator it = submaps.begin(); it != submaps.end(); it++) {
 		it->second->reset();
 	}
@@ -44,21 +54,173 @@ void amiq_rm_address_map::build() {
 		it->second->build();
 	}
 
+	for (amiq_rm_reg_array_map_t::iterator it = reg_arrays.begin(); it != reg_arrays.end(); it++) {
+		it->second->build();
+	}
+
+	for (amiq_rm_map_array_map_t::iterator it = map_arrays.begin(); it != map_arrays.end(); it++) {
+		it->second->build();
+	}
+
 	for (amiq_rm_addressmap_map_t::iterator it = submaps.begin(); it != submaps.end(); it++) {
 		it->second->build();
 	}
+
+	compute_extent();
+	recompute_signals();
+	built = true;
+}
+
+void amiq_rm_address_map::report_late_add(const string &element_name) {
+	if (built)
+		AMIQ_RM_INFO(AMIQ_RM_LOW, "Warning: " << element_name << " was added to " << name << " after build(), it is not decoded until the map is built or published again");
+}
+
+void amiq_rm_address_map::set_size(amiq_rm_reg_address_t my_size) {
+	size = my_size;
+}
+
+amiq_rm_reg_address_t amiq_rm_address_map::get_size() {
+	return (size != 0) ? size : extent;
+}
+
+void amiq_rm_address_map::compute_extent() {
+	extent = 0;
+	for (amiq_rm_reg_map_t::iterator it = regs.begin(); it != regs.end(); it++) {
+		extent = max(extent, it->first + it->second->get_nof_bytes());
+	}
+
+	for (amiq_rm_reg_array_map_t::iterator it = reg_arrays.begin(); it != reg_arrays.end(); it++) {
+		extent = max(extent, it->first + it->second->stride * it->second->count);
+	}
+
+	for (amiq_rm_map_array_map_t::iterator it = map_arrays.begin(); it != map_arrays.end(); it++) {
+		extent = max(extent, it->first + it->second->stride * it->second->get_capacity());
+	}
+
+	for (amiq_rm_mem_map_t::iterator it = mems.begin(); it != mems.end(); it++) {
+		extent = max(extent, it->first + it->second->size);
+	}
+
+	for (amiq_rm_addressmap_map_t::iterator it = submaps.begin(); it != submaps.end(); it++) {
+		extent = max(extent, it->first + it->second->get_size());
+	}
+
+	//the content must fit in the declared size
+	assert((size == 0) || (extent <= size));
+}
+
+void amiq_rm_address_map::recompute_signals() {
+	uint64_t old_pending = signal_node.pending_signals;
+	signal_node.clear();
+	for (amiq_rm_reg_map_t::iterator it = regs.begin(); it != regs.end(); it++) {
+		signal_node.update(0, it->second->get_active_signals(it->second->value));
+	}
+
+	for (amiq_rm_reg_array_map_t::iterator it = reg_arrays.begin(); it != reg_arrays.end(); it++) {
+		signal_node.update(0, it->second->signal_node.pending_signals);
+	}
+
+	for (amiq_rm_map_array_map_t::iterator it = map_arrays.begin(); it != map_arrays.end(); it++) {
+		signal_node.update(0, it->second->signal_node.pending_signals);
+	}
+
+	for (amiq_rm_addressmap_map_t::iterator it = submaps.begin(); it != submaps.end(); it++) {
+		signal_node.update(0, it->second->signal_node.pending_signals);
+	}
+
+	if (signal_node.pending_signals != old_pending) {
+		for (int unsigned i = 0; i < parents.size(); i++)
+			parents[i]->update_signals(old_pending, signal_node.pending_signals);
+	}
+}
+
+void amiq_rm_address_map::update_signals(uint64_t old_signals, uint64_t new_signals) {
+	uint64_t old_pending = signal_node.pending_signals;
+	if (signal_node.update(old_signals, new_signals)) {
+		for (int unsigned i = 0; i < parents.size(); i++)
+			parents[i]->update_signals(old_pending, signal_node.pending_signals);
+	}
+}
+
+uint64_t amiq_rm_address_map::get_pending_signals() {
+	return signal_node.pending_signals;
+}
+
+bool amiq_rm_address_map::is_signal_pending(int unsigned signal_id) {
+	return ((signal_node.pending_signals & amiq_rm_signal::get_mask(signal_id)) != 0);
+}
+
+vector<amiq_rm_reg_address_t> amiq_rm_address_map::get_signal_sources(int unsigned signal_id) {
+	vector<amiq_rm_reg_address_t> my_offsets;
+	uint64_t signal_mask = amiq_rm_signal::get_mask(signal_id);
+	if ((signal_node.pending_signals & signal_mask) == 0)
+		return my_offsets;
+
+	for (amiq_rm_reg_map_t::iterator it = regs.begin(); it != regs.end(); it++) {
+		if ((it->second->get_active_signals(it->second->value) & signal_mask) != 0)
+			my_offsets.push_back(it->first);
+	}
+
+	for (amiq_rm_reg_array_map_t::iterator it = reg_arrays.begin(); it != reg_arrays.end(); it++) {
+		amiq_rm_reg_array *array = it->second;
+		if ((array->signal_node.pending_signals & signal_mask) == 0)
+			continue;
+		for (int unsigned i = 0; i < array->count; i++) {
+			if ((array->layout->get_active_signals(array->values[i]) & signal_mask) != 0)
+				my_offsets.push_back(it->first + i * array->stride);
+		}
+	}
+
+	for (amiq_rm_map_array_map_t::iterator it = map_arrays.begin(); it != map_arrays.end(); it++) {
+		amiq_rm_map_array *array = it->second;
+		if ((array->signal_node.pending_signals & signal_mask) == 0)
+			continue;
+		for (int unsigned i = 0; i < array->values.size(); i++) {
+			int unsigned slot = i % array->slots.size();
+			if ((array->slots[slot].reg->get_active_signals(array->values[i]) & signal_mask) != 0)
+				my_offsets.push_back(it->first + (i / array->slots.size()) * array->stride + array->slots[slot].offset);
+		}
+	}
+
+	for (amiq_rm_addressmap_map_t::iterator it = submaps.begin(); it != submaps.end(); it++) {
+		vector<amiq_rm_reg_address_t> submaps_results = it->second->get_signal_sources(signal_id);
+		for (unsigned int i = 0; i < submaps_results.size(); i++)
+			my_offsets.push_back(it->first + submaps_results[i]);
+	}
+	return my_offsets;
 }
 
 void amiq_rm_address_map::add_reg(amiq_rm_reg &my_reg, amiq_rm_reg_address_t my_address) {
+	report_late_add(my_reg.name);
 	regs[my_address] = &my_reg;
 	my_reg.parent_maps.push_back(this);
 }
 
 void amiq_rm_address_map::add_map(amiq_rm_address_map &my_map, amiq_rm_reg_address_t my_address) {
+	report_late_add(my_map.name);
 	submaps[my_address] = &my_map;
 	my_map.parents.push_back(this);
 }
 
+void amiq_rm_address_map::add_mem(amiq_rm_mem &my_mem, amiq_rm_reg_address_t my_address) {
+	report_late_add(my_mem.name);
+	mems[my_address] = &my_mem;
+	my_mem.parent_maps.push_back(this);
+}
+
+void amiq_rm_address_map::add_reg_array(amiq_rm_reg_array &my_array, amiq_rm_reg_address_t my_address) {
+	report_late_add(my_array.name);
+	reg_arrays[my_address] = &my_array;
+	my_array.parent_maps.push_back(this);
+}
+
+void amiq_rm_address_map::add_map_array(amiq_rm_map_array &my_array, amiq_rm_reg_address_t my_address) {
+	report_late_add(my_array.name);
+	map_arrays[my_address] = &my_array;
+	my_array.parent_maps.push_back(this);
+}
+
 void amiq_rm_address_map::add_map(amiq_rm_address_map &my_map, amiq_rm_reg_address_t my_address, amiq_rm_reg_block &reg_block) {
 	add_map(my_map, my_address);
 	my_map.reg_block = &reg_block;
@@ -118,39 +280,493 @@ vector<amiq_rm_reg_address_t> amiq_rm_address_map::get_reg_offsets(amiq_rm_reg &
 	return my_offsets;
 }
 
-pair<amiq_rm_reg_data_t, amiq_rm_status_t> amiq_rm_physical_address_map::read(amiq_rm_reg_address_t address) {
+amiq_rm_mem* amiq_rm_address_map::get_mem_by_offset(amiq_rm_reg_address_t my_address, amiq_rm_reg_address_t &mem_offset) {
+	//the candidate is the memory with the greatest offset lower or equal to my_address
+	amiq_rm_mem_map_t::iterator mem_it = mems.upper_bound(my_address);
+	if (mem_it != mems.begin()) {
+		mem_it--;
+		if (my_address - mem_it->first < mem_it->second->size) {
+			mem_offset = my_address - mem_it->first;
+			return mem_it->second;
+		}
+	}
+
+	for (amiq_rm_addressmap_map_t::iterator it = submaps.begin(); it != submaps.end(); it++) {
+		if (it->first <= my_address) {
+			amiq_rm_mem *my_mem = it->second->get_mem_by_offset(my_address - it->first, mem_offset);
+			if (my_mem != NULL) {
+				return my_mem;
+			}
+		}
+	}
+	return NULL;
+}
+
+vector<amiq_rm_reg_address_t> amiq_rm_address_map::get_mem_offsets(amiq_rm_mem &mem) {
+	vector<amiq_rm_reg_address_t> my_offsets;
+	for (amiq_rm_mem_map_t::iterator it = mems.begin(); it != mems.end(); it++) {
+		if (it->second == &mem) {
+			my_offsets.push_back(it->first);
+		}
+	}
+	for (amiq_rm_addressmap_map_t::iterator it = submaps.begin(); it != submaps.end(); it++) {
+		vector<amiq_rm_reg_address_t> submaps_results;
+		submaps_results = it->second->get_mem_offsets(mem);
+		for (unsigned int i = 0; i < submaps_results.size(); i++)
+			my_offsets.push_back(it->first + submaps_results[i]);
+	}
+	return my_offsets;
+}
+
+amiq_rm_reg_array* amiq_rm_address_map::get_reg_array_by_offset(amiq_rm_reg_address_t my_address, int unsigned &index) {
+	//the candidate is the array with the greatest offset lower or equal to my_address
+	amiq_rm_reg_array_map_t::iterator array_it = reg_arrays.upper_bound(my_address);
+	if (array_it != reg_arrays.begin()) {
+		array_it--;
+		amiq_rm_reg_array *my_array = array_it->second;
+		amiq_rm_reg_address_t delta = my_address - array_it->first;
+		if ((delta % my_array->stride == 0) && (delta / my_array->stride < my_array->count)) {
+			index = delta / my_array->stride;
+			return my_array;
+		}
+	}
+
+	for (amiq_rm_addressmap_map_t::iterator it = submaps.begin(); it != submaps.end(); it++) {
+		if (it->first <= my_address) {
+			amiq_rm_reg_array *my_array = it->second->get_reg_array_by_offset(my_address - it->first, index);
+			if (my_array != NULL) {
+				return my_array;
+			}
+		}
+	}
+	return NULL;
+}
+
+vector<amiq_rm_reg_address_t> amiq_rm_address_map::get_reg_array_offsets(amiq_rm_reg_array &array) {
+	vector<amiq_rm_reg_address_t> my_offsets;
+	for (amiq_rm_reg_array_map_t::iterator it = reg_arrays.begin(); it != reg_arrays.end(); it++) {
+		if (it->second == &array) {
+			my_offsets.push_back(it->first);
+		}
+	}
+	for (amiq_rm_addressmap_map_t::iterator it = submaps.begin(); it != submaps.end(); it++) {
+		vector<amiq_rm_reg_address_t> submaps_results;
+		submaps_results = it->second->get_reg_array_offsets(array);
+		for (unsigned int i = 0; i < submaps_results.size(); i++)
+			my_offsets.push_back(it->first + submaps_results[i]);
+	}
+	return my_offsets;
+}
+
+amiq_rm_map_array* amiq_rm_address_map::get_map_array_by_offset(amiq_rm_reg_address_t my_address, int unsigned &index) {
+	//the candidate is the map array with the greatest offset lower or equal to my_address
+	amiq_rm_map_array_map_t::iterator array_it = map_arrays.upper_bound(my_address);
+	if (array_it != map_arrays.begin()) {
+		array_it--;
+		amiq_rm_reg_address_t element_offset;
+		if (array_it->second->find(my_address - array_it->first, index, element_offset) && (element_offset == my_address - array_it->first)) {
+			return array_it->second;
+		}
+	}
+
+	for (amiq_rm_addressmap_map_t::iterator it = submaps.begin(); it != submaps.end(); it++) {
+		if (it->first <= my_address) {
+			amiq_rm_map_array *my_array = it->second->get_map_array_by_offset(my_address - it->first, index);
+			if (my_array != NULL) {
+				return my_array;
+			}
+		}
+	}
+	return NULL;
+}
+
+vector<amiq_rm_reg_address_t> amiq_rm_address_map::get_map_array_offsets(amiq_rm_map_array &array) {
+	vector<amiq_rm_reg_address_t> my_offsets;
+	for (amiq_rm_map_array_map_t::iterator it = map_arrays.begin(); it != map_arrays.end(); it++) {
+		if (it->second == &array) {
+			my_offsets.push_back(it->first);
+		}
+	}
+	for (amiq_rm_addressmap_map_t::iterator it = submaps.begin(); it != submaps.end(); it++) {
+		vector<amiq_rm_reg_address_t> submaps_results;
+		submaps_results = it->second->get_map_array_offsets(array);
+		for (unsigned int i = 0; i < submaps_results.size(); i++)
+			my_offsets.push_back(it->first + submaps_results[i]);
+	}
+	return my_offsets;
+}
+
+long long unsigned amiq_rm_address_map::randomize(uint64_t seed) {
+	uint64_t counter = 0;
+	return randomize(seed, NULL, counter);
+}
+
+long long unsigned amiq_rm_address_map::randomize(uint64_t seed, amiq_rm_reg_filter_t filter) {
+	uint64_t counter = 0;
+	return randomize(seed, filter, counter);
+}
+
+long long unsigned amiq_rm_address_map::randomize(uint64_t seed, amiq_rm_reg_filter_t filter, uint64_t &counter) {
+	long long unsigned nof_values = 0;
+	for (amiq_rm_reg_map_t::iterator it = regs.begin(); it != regs.end(); it++) {
+		amiq_rm_reg *my_reg = it->second;
+		if ((filter == NULL) || filter(*my_reg)) {
+			my_reg->randomize(seed, counter);
+			nof_values++;
+		}
+		counter++;
+	}
+
+	for (amiq_rm_reg_array_map_t::iterator it = reg_arrays.begin(); it != reg_arrays.end(); it++) {
+		if ((filter == NULL) || filter(*(it->second->layout))) {
+			it->second->randomize(seed, counter);
+			nof_values += it->second->count;
+		}
+		counter += it->second->count;
+	}
+
+	for (amiq_rm_map_array_map_t::iterator it = map_arrays.begin(); it != map_arrays.end(); it++) {
+		nof_values += it->second->randomize(seed, counter, filter);
+		counter += it->second->values.size();
+	}
+
+	for (amiq_rm_addressmap_map_t::iterator it = submaps.begin(); it != submaps.end(); it++) {
+		nof_values += it->second->randomize(seed, filter, counter);
+	}
+	return nof_values;
+}
+
+amiq_rm_physical_address_map::~amiq_rm_physical_address_map() {
+	if (published_decoder != &decoder)
+		delete published_decoder;
+}
+
+void amiq_rm_physical_address_map::build() {
+	amiq_rm_address_map::build();
+	if (rcu_enabled) {
+		//the decoder in use may be read by other threads, it is replaced instead of being built again in place
+		publish();
+		return;
+	}
+	decoder.build(*this);
+	if (published_decoder != &decoder) {
+		delete published_decoder;
+		published_decoder = &decoder;
+	}
+	AMIQ_RM_INFO(AMIQ_RM_HIGH, "Built decoder of " << name << ": " << decoder.get_targets().size() << " targets, " << decoder.get_nof_levels() << " levels, "
+			<< decoder.get_nof_nodes() << " nodes");
+}
+
+void amiq_rm_physical_address_map::enable_rcu() {
+	rcu_enabled = true;
+}
+
+void amiq_rm_physical_address_map::delete_decoder(void *object) {
+	delete (amiq_rm_radix_decoder*) object;
+}
+
+void amiq_rm_physical_address_map::publish() {
+	amiq_rm_radix_decoder *new_decoder = new amiq_rm_radix_decoder();
+	new_decoder->build(*this);
+	amiq_rm_radix_decoder *old_decoder = __atomic_exchange_n(&published_decoder, new_decoder, __ATOMIC_ACQ_REL);
+
+	//@b decoder is a member, it is cleared instead of being deleted
+	if (old_decoder != &decoder)
+		amiq_rm_rcu::get().retire(old_decoder, delete_decoder);
+	else if (!rcu_enabled)
+		decoder.clear();
+	amiq_rm_rcu::get().reclaim();
+	AMIQ_RM_INFO(AMIQ_RM_HIGH, "Published decoder of " << name << ": " << new_decoder->get_nof_targets() << " targets");
+}
+
+bool amiq_rm_physical_address_map::relocate_map(amiq_rm_address_map &submap, amiq_rm_reg_address_t new_offset) {
+	amiq_rm_addressmap_map_t::iterator it = submaps.begin();
+	while ((it != submaps.end()) && (it->second != &submap))
+		it++;
+	assert(it != submaps.end());
+	amiq_rm_reg_address_t old_offset = it->first;
+	if (new_offset == old_offset)
+		return true;
+
+	amiq_rm_radix_decoder &current = get_decoder();
+	amiq_rm_reg_address_t submap_size = submap.get_size();
+	if (current.is_built() && (submap_size > 0)) {
+		if ((new_offset + submap_size - 1 < new_offset) || !current.is_range_free(new_offset, new_offset + submap_size - 1, &submap))
+			return false;
+	}
+	if ((submaps.find(new_offset) != submaps.end()) || ((size != 0) && (new_offset + submap_size > size)))
+		return false;
+
+	submaps.erase(it);
+	submaps[new_offset] = &submap;
+	compute_extent();
+	if (current.is_built() && (submap_size > 0) && !current.relocate(&submap, old_offset, old_offset + submap_size - 1, new_offset, rcu_enabled))
+		publish();
+	AMIQ_RM_INFO(AMIQ_RM_HIGH, "Relocated " << submap.name << " of " << name << " from " << hex << old_offset << " to " << new_offset);
+	return true;
+}
+
+amiq_rm_decode_target* amiq_rm_physical_address_map::decode(amiq_rm_reg_address_t address) {
+	amiq_rm_radix_decoder *current = __atomic_load_n(&published_decoder, __ATOMIC_ACQUIRE);
+	if (current->is_built()) {
+		return current->decode(address);
+	}
+
+	//the result of the recursive search is kept per thread, so concurrent calls do not overwrite each other's target
+	static thread_local amiq_rm_decode_target search_target;
+	search_target = amiq_rm_decode_target();
 	amiq_rm_reg *my_reg = get_reg_by_offset(address);
+	if (my_reg != NULL) {
+		search_target.kind = REG_TARGET;
+		search_target.base = address;
+		search_target.size = my_reg->get_nof_bytes();
+		search_target.reg = my_reg;
+		return &search_target;
+	}
+
+	int unsigned index;
+	amiq_rm_reg_array *my_array = get_reg_array_by_offset(address, index);
+	if (my_array != NULL) {
+		search_target.kind = REG_ARRAY_TARGET;
+		search_target.base = address - index * my_array->stride;
+		search_target.size = my_array->count * my_array->stride;
+		search_target.reg_array = my_array;
+		return &search_target;
+	}
+
+	amiq_rm_map_array *my_map_array = get_map_array_by_offset(address, index);
+	if (my_map_array != NULL) {
+		search_target.kind = MAP_ARRAY_TARGET;
+		search_target.base = address - (index / my_map_array->get_nof_slots()) * my_map_array->stride
+				- my_map_array->slots[index % my_map_array->get_nof_slots()].offset;
+		search_target.size = my_map_array->get_capacity() * my_map_array->stride;
+		search_target.map_array = my_map_array;
+		return &search_target;
+	}
+
+	amiq_rm_reg_address_t mem_offset;
+	amiq_rm_mem *my_mem = get_mem_by_offset(address, mem_offset);
+	if (my_mem != NULL) {
+		search_target.kind = MEM_TARGET;
+		search_target.base = address - mem_offset;
+		search_target.size = my_mem->size;
+		search_target.mem = my_mem;
+		return &search_target;
+	}
+	return NULL;
+}
+
+amiq_rm_reg_iterator amiq_rm_physical_address_map::get_reg_iterator() {
+	return amiq_rm_reg_iterator(get_decoder(), 0, ~((amiq_rm_reg_address_t) 0));
+}
+
+amiq_rm_reg_iterator amiq_rm_physical_address_map::get_regs_in_range(amiq_rm_reg_address_t lo, amiq_rm_reg_address_t hi) {
+	assert(lo < hi);
+	return amiq_rm_reg_iterator(get_decoder(), lo, hi - 1);
+}
+
+pair<amiq_rm_reg_data_t, amiq_rm_status_t> amiq_rm_physical_address_map::read(amiq_rm_reg_address_t address) {
+	amiq_rm_rcu_read_guard guard(rcu_enabled);
+	amiq_rm_decode_target *target = decode(address);
 	pair<amiq_rm_reg_data_t, amiq_rm_status_t> data_with_status;
 
-	if (my_reg == NULL) {
+	if (target == NULL) {
 		data_with_status.first = 0;
 		data_with_status.second = HOLE;
 	} else {
-		data_with_status = my_reg->read();
+		data_with_status = target->read(address);
 	}
 	return data_with_status;
 }
 
 amiq_rm_status_t amiq_rm_physical_address_map::write(amiq_rm_reg_address_t address, amiq_rm_reg_data_t write_data) {
-	amiq_rm_reg *my_reg = get_reg_by_offset(address);
+	amiq_rm_rcu_read_guard guard(rcu_enabled);
+	amiq_rm_decode_target *target = decode(address);
 	amiq_rm_status_t status;
 
-	status = (my_reg == NULL) ? HOLE : (my_reg->write(write_data));
+	status = (target == NULL) ? HOLE : (target->write(address, write_data));
+	return status;
+}
+
+amiq_rm_decode_target* amiq_rm_physical_address_map::decode_part(amiq_rm_reg_address_t address, int unsigned size, int unsigned position,
+		amiq_rm_reg_address_t &element_address, int unsigned &lane, int unsigned &nof_bytes) {
+	amiq_rm_decode_target *target = decode(address + position);
+	int unsigned element_size;
+
+	if ((target == NULL) || !target->get_element(address + position, element_address, element_size))
+		return NULL;
+
+	lane = address + position - element_address;
+	nof_bytes = element_size - lane;
+	if (nof_bytes > size - position)
+		nof_bytes = size - position;
+	return target;
+}
+
+pair<amiq_rm_reg_data_t, amiq_rm_status_t> amiq_rm_physical_address_map::read(amiq_rm_reg_address_t address, int unsigned size, int unsigned byte_enable) {
+	return sized_read(address, size, byte_enable, NULL);
+}
+
+pair<amiq_rm_reg_data_t, amiq_rm_status_t> amiq_rm_physical_address_map::sized_read(amiq_rm_reg_address_t address, int unsigned size,
+		int unsigned byte_enable, amiq_rm_quantum_keeper *keeper) {
+	pair<amiq_rm_reg_data_t, amiq_rm_status_t> data_with_status;
+	data_with_status.first = 0;
+	data_with_status.second = OKAY;
+	assert((size > 0) && (size <= sizeof(amiq_rm_reg_data_t)));
+	amiq_rm_rcu_read_guard guard(rcu_enabled);
+
+	int unsigned nof_bytes;
+	for (int unsigned position = 0; position < size; position += nof_bytes) {
+		nof_bytes = 1;
+		if ((byte_enable & (1 << position)) == 0)
+			continue;
+
+		amiq_rm_reg_address_t element_address;
+		int unsigned lane;
+		amiq_rm_decode_target *target = decode_part(address, size, position, element_address, lane, nof_bytes);
+		//the access has the latency of the first enabled byte
+		if (keeper != NULL) {
+			keeper->inc(get_latency(target, address + position, READ));
+			keeper = NULL;
+		}
+		if (target == NULL) {
+			if (data_with_status.second == OKAY)
+				data_with_status.second = HOLE;
+			continue;
+		}
+
+		amiq_rm_reg_data_t part_mask = amiq_rm_reg::lane_masks[(1 << nof_bytes) - 1];
+		int unsigned part_enable = ((byte_enable >> position) & ((1 << nof_bytes) - 1)) << lane;
+		pair<amiq_rm_reg_data_t, amiq_rm_status_t> part = target->read(element_address, part_enable);
+
+		data_with_status.first |= ((part.first >> (8 * lane)) & part_mask) << (8 * position);
+		if ((part.second == ERROR) || (data_with_status.second == OKAY))
+			data_with_status.second = (data_with_status.second == ERROR) ? ERROR : part.second;
+	}
+	if (keeper != NULL)
+		keeper->inc(get_latency(NULL, address, READ));
+	return data_with_status;
+}
+
+amiq_rm_status_t amiq_rm_physical_address_map::write(amiq_rm_reg_address_t address, amiq_rm_reg_data_t write_data, int unsigned size, int unsigned byte_enable) {
+	return sized_write(address, write_data, size, byte_enable, NULL);
+}
+
+amiq_rm_status_t amiq_rm_physical_address_map::sized_write(amiq_rm_reg_address_t address, amiq_rm_reg_data_t write_data, int unsigned size,
+		int unsigned byte_enable, amiq_rm_quantum_keeper *keeper) {
+	amiq_rm_status_t status = OKAY;
+	assert((size > 0) && (size <= sizeof(amiq_rm_reg_data_t)));
+	amiq_rm_rcu_read_guard guard(rcu_enabled);
+
+	int unsigned nof_bytes;
+	for (int unsigned position = 0; position < size; position += nof_bytes) {
+		nof_bytes = 1;
+		if ((byte_enable & (1 << position)) == 0)
+			continue;
+
+		amiq_rm_reg_address_t element_address;
+		int unsigned lane;
+		amiq_rm_decode_target *target = decode_part(address, size, position, element_address, lane, nof_bytes);
+		if (keeper != NULL) {
+			keeper->inc(get_latency(target, address + position, WRITE));
+			keeper = NULL;
+		}
+		if (target == NULL) {
+			if (status == OKAY)
+				status = HOLE;
+			continue;
+		}
+
+		amiq_rm_reg_data_t part_mask = amiq_rm_reg::lane_masks[(1 << nof_bytes) - 1];
+		int unsigned part_enable = ((byte_enable >> position) & ((1 << nof_bytes) - 1)) << lane;
+		amiq_rm_status_t part_status = target->write(element_address, ((write_data >> (8 * position)) & part_mask) << (8 * lane), part_enable);
+
+		if ((part_status == ERROR) || (status == OKAY))
+			status = (status == ERROR) ? ERROR : part_status;
+	}
+	if (keeper != NULL)
+		keeper->inc(get_latency(NULL, address, WRITE));
 	return status;
 }
 
 amiq_rm_reg_data_t amiq_rm_physical_address_map::get(amiq_rm_reg_address_t address) {
-	amiq_rm_reg *my_reg = get_reg_by_offset(address);
+	amiq_rm_rcu_read_guard guard(rcu_enabled);
+	amiq_rm_decode_target *target = decode(address);
 
-	assert(my_reg != NULL);
-	return my_reg->get();
+	assert(target != NULL);
+	return target->get(address);
 }
 
 void amiq_rm_physical_address_map::set(amiq_rm_reg_address_t address, amiq_rm_reg_data_t write_data) {
-	amiq_rm_reg *my_reg = get_reg_by_offset(address);
+	amiq_rm_rcu_read_guard guard(rcu_enabled);
+	amiq_rm_decode_target *target = decode(address);
+
+	assert(target != NULL);
+	target->set(address, write_data);
+}
+
+void amiq_rm_physical_address_map::set_latency(uint64_t my_read_latency, uint64_t my_write_latency, uint64_t my_side_effect_latency) {
+	read_latency = my_read_latency;
+	write_latency = my_write_latency;
+	side_effect_latency = my_side_effect_latency;
+}
+
+uint64_t amiq_rm_physical_address_map::get_latency(amiq_rm_decode_target *target, amiq_rm_reg_address_t address, amiq_rm_direction_t direction) {
+	uint64_t latency = (direction == READ) ? read_latency : write_latency;
+	if (target == NULL)
+		return latency;
+
+	amiq_rm_reg *reg = NULL;
+	if (target->kind == REG_TARGET) {
+		reg = target->reg;
+	} else if (target->kind == REG_ARRAY_TARGET) {
+		reg = target->reg_array->layout;
+	} else if (target->kind == MAP_ARRAY_TARGET) {
+		int unsigned index;
+		amiq_rm_reg_address_t element_offset;
+		if (target->map_array->find(address - target->base, index, element_offset))
+			reg = target->map_array->slots[index % target->map_array->get_nof_slots()].reg;
+	}
+
+	if (reg != NULL) {
+		latency += reg->get_latency(direction);
+		if (reg->has_side_effects(direction))
+			latency += side_effect_latency;
+	}
+	return latency;
+}
+
+pair<amiq_rm_reg_data_t, amiq_rm_status_t> amiq_rm_physical_address_map::read(amiq_rm_reg_address_t address, amiq_rm_quantum_keeper &keeper) {
+	amiq_rm_rcu_read_guard guard(rcu_enabled);
+	amiq_rm_decode_target *target = decode(address);
+	pair<amiq_rm_reg_data_t, amiq_rm_status_t> data_with_status;
+
+	keeper.inc(get_latency(target, address, READ));
+	if (target == NULL) {
+		data_with_status.first = 0;
+		data_with_status.second = HOLE;
+	} else {
+		data_with_status = target->read(address);
+	}
+	return data_with_status;
+}
 
-	assert(my_reg != NULL);
-	my_reg->set(write_data);
+amiq_rm_status_t amiq_rm_physical_address_map::write(amiq_rm_reg_address_t address, amiq_rm_reg_data_t write_data, amiq_rm_quantum_keeper &keeper) {
+	amiq_rm_rcu_read_guard guard(rcu_enabled);
+	amiq_rm_decode_target *target = decode(address);
+
+	keeper.inc(get_latency(target, address, WRITE));
+	return (target == NULL) ? HOLE : (target->write(address, write_data));
+}
+
+pair<amiq_rm_reg_data_t, amiq_rm_status_t> amiq_rm_physical_address_map::read(amiq_rm_reg_address_t address, int unsigned size, int unsigned byte_enable,
+		amiq_rm_quantum_keeper &keeper) {
+	return sized_read(address, size, byte_enable, &keeper);
+}
+
+amiq_rm_status_t amiq_rm_physical_address_map::write(amiq_rm_reg_address_t address, amiq_rm_reg_data_t write_data, int unsigned size,
+		int unsigned byte_enable, amiq_rm_quantum_keeper &keeper) {
+	return sized_write(address, write_data, size, byte_enable, &keeper);
 }
 
 string amiq_rm_address_map::to_string() {
@@ -159,6 +775,15 @@ string amiq_rm_address_map::to_string() {
 	for (amiq_rm_reg_map_t::iterator it = regs.begin(); it != regs.end(); it++) {
 		convert << "Address: " << hex << it->first << "  " << it->second->to_string() << endl;
 	}
+	for (amiq_rm_reg_array_map_t::iterator it = reg_arrays.begin(); it != reg_arrays.end(); it++) {
+		convert << "Address: " << hex << it->first << "  Array: " << it->second->to_string() << endl;
+	}
+	for (amiq_rm_map_array_map_t::iterator it = map_arrays.begin(); it != map_arrays.end(); it++) {
+		convert << "Address: " << hex << it->first << "  Map array: " << it->second->to_string() << endl;
+	}
+	for (amiq_rm_mem_map_t::iterator it = mems.begin(); it != mems.end(); it++) {
+		convert << "Address: " << hex << it->first << "  Memory: " << it->second->to_string() << endl;
+	}
 	return convert.str();
 }
 
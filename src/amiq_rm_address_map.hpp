@@ -24,11 +24,18 @@
 #include <map>
 #include "amiq_rm_reg_block.hpp"
 #include "amiq_rm_reg.hpp"
+#include "amiq_rm_mem.hpp"
+#include "amiq_rm_reg_array.hpp"
+#include "amiq_rm_map_array.hpp"
+#include "amiq_rm_decoder.hpp"
+#include "amiq_rm_reg_iterator.hpp"
+#include "amiq_rm_rcu.hpp"
+#include "amiq_rm_quantum_keeper.hpp"
 
 namespace amiq_rm {
 
-/** This class is used to model an address_map. An address map may contain registers and sub-maps,
- * both categories are mapped by offset. It provides mechanisms to perform recursive search of the registers
+/** This class is used to model an address_map. An address map may contain registers, register arrays, map arrays, memories and sub-maps,
+ * all categories are mapped by offset. It provides mechanisms to perform recursive search of the registers
  * (by name, by offset). */
 class amiq_rm_address_map {
 public:
@@ -36,6 +43,12 @@ public:
 	typedef std::map<amiq_rm_reg_address_t, amiq_rm_reg*> amiq_rm_reg_map_t;
 	/** Container which stores pointers to address maps associated with an offset (the offset is used as key) */
 	typedef std::map<amiq_rm_reg_address_t, amiq_rm_address_map*> amiq_rm_addressmap_map_t;
+	/** Container which stores pointers to memories associated with an offset (the offset is used as key) */
+	typedef std::map<amiq_rm_reg_address_t, amiq_rm_mem*> amiq_rm_mem_map_t;
+	/** Container which stores pointers to register arrays associated with an offset (the offset is used as key) */
+	typedef std::map<amiq_rm_reg_address_t, amiq_rm_reg_array*> amiq_rm_reg_array_map_t;
+	/** Container which stores pointers to map arrays associated with an offset (the offset is used as key) */
+	typedef std::map<amiq_rm_reg_address_t, amiq_rm_map_array*> amiq_rm_map_array_map_t;
 
 	/** The name of the address map. */
 	std::string name;
@@ -50,9 +63,29 @@ public:
 	 * To add a sub-map the user must use add_map(). */
 	amiq_rm_addressmap_map_t submaps;
 
+	/** The map contains pointers to the memories added to the map by using the offset of the first byte as the key.
+	 * Functions like get_mem_by_offset() relies on this map.
+	 * To add a memory the user must use add_mem(). */
+	amiq_rm_mem_map_t mems;
+
+	/** The map contains pointers to the register arrays added to the map by using the offset of the first element as the key.
+	 * There is one entry for the whole array, the element is found arithmetically from the offset and the stride of the array.
+	 * To add a register array the user must use add_reg_array(). */
+	amiq_rm_reg_array_map_t reg_arrays;
+
+	/** The map contains pointers to the map arrays added to the map by using the offset of the first instance as the key.
+	 * There is one entry for the whole array, the instance is found arithmetically from the offset and the stride of the array.
+	 * To add a map array the user must use add_map_array(). */
+	amiq_rm_map_array_map_t map_arrays;
+
 	/** The vector holds the address maps which contain this map. New parents are added when amiq_rm_address_map::add_map() is called. */
 	std::vector<amiq_rm_address_map*> parents;
 
+	/** The aggregate of the signals of the map (see amiq_rm_field::add_signal()): its sources are the registers, the register arrays,
+	 * the map arrays and the sub-maps of the map. It is computed by build() and it is updated incrementally, along the path to the top map,
+	 * each time the active signals of a register or of an element change. */
+	amiq_rm_signal_node signal_node;
+
 	/** Pointer to the register block. This may be used by the user in case there is need for access to the registers or to other address_maps. */
 	amiq_rm_reg_block *reg_block;
 
@@ -62,6 +95,9 @@ public:
 		name = my_name;
 
 		reg_block = NULL;
+		size = 0;
+		extent = 0;
+		built = false;
 	}
 
 	/** There are no pointers to delete. */
@@ -75,10 +111,21 @@ public:
 
 	/** The function must be called after all registers and all sub-maps have been added.
 	 * It will recursively descend and call build() for mapped registers and sub-maps, connect parent pointers, etc.
+	 * It also computes the extent of the map (see get_size()).
 	 * It is not necessary for the build() to be called if a parent map calls it's build(). */
 	virtual void build();
 
+	/** The function declares the size of the address space of the map (e.g. the size of the address window of a block).
+	 * build() checks that the content of the map fits in it.
+	 * @param my_size is the size in bytes, 0 to use the extent of the content */
+	void set_size(amiq_rm_reg_address_t my_size);
+
+	/** @returns the size declared with set_size() or, if no size was declared, the extent of the content computed by build():
+	 * the end of the register, array, memory or sub-map which ends last. The map covers the offsets [0, get_size()). */
+	amiq_rm_reg_address_t get_size();
+
 	/**The function maps a register to the address_map. The pointer to the register is stored in a C++ map and uses the offset as key.
+	 * The elements added after build() are not decoded until the physical map is built or published again, which is reported with a message.
 	 * @param my_reg represents a reference to the register that is going to be mapped
 	 * @param my_offset represents the offset of the register within the address map */
 	void add_reg(amiq_rm_reg &my_reg, amiq_rm_reg_address_t my_offset);
@@ -88,6 +135,24 @@ public:
 	 * @param my_offset represents the offset of the register within the address map */
 	void add_map(amiq_rm_address_map &my_map, amiq_rm_reg_address_t my_offset);
 
+	/**The function maps a memory to the address_map. The pointer to the memory is stored in a C++ map and uses the offset as key.
+	 * The memory occupies the range [my_offset, my_offset + my_mem.size).
+	 * @param my_mem represents a reference to the memory that is going to be mapped
+	 * @param my_offset represents the offset of the first byte of the memory within the address map */
+	void add_mem(amiq_rm_mem &my_mem, amiq_rm_reg_address_t my_offset);
+
+	/**The function maps a register array to the address_map. The pointer to the array is stored in a C++ map and uses the offset as key.
+	 * Element @b i of the array is mapped at my_offset + i * my_array.stride.
+	 * @param my_array represents a reference to the register array that is going to be mapped
+	 * @param my_offset represents the offset of the first element within the address map */
+	void add_reg_array(amiq_rm_reg_array &my_array, amiq_rm_reg_address_t my_offset);
+
+	/**The function maps a map array to the address_map. The pointer to the array is stored in a C++ map and uses the offset as key.
+	 * Instance @b i of the array is mapped at my_offset + i * my_array.stride.
+	 * @param my_array represents a reference to the map array that is going to be mapped
+	 * @param my_offset represents the offset of the first instance within the address map */
+	void add_map_array(amiq_rm_map_array &my_array, amiq_rm_reg_address_t my_offset);
+
 	/**The function maps a sub-map to the address_map. The pointer to the map is stored in a C++ map and uses the offset as key.
 	 * @param my_map represents a reference to the address map that is going to be mapped
 	 * @param my_offset represents the offset of the register within the address map
@@ -117,43 +182,332 @@ public:
 	 * If the register is not mapped anywhere under the address map the returned vector will be 0 sized. */
 	std::vector<amiq_rm_reg_address_t> get_reg_offsets(amiq_rm_reg &reg);
 
+	/** The function returns a pointer to the memory which contains the location specified by offset.
+	 * The search will take place within directly mapped memories, but will also continue recursively through sub-maps.
+	 * @param my_offset is the offset of the location which is searched for
+	 * @param mem_offset is set to the offset of the location relative to the start of the returned memory
+	 * @returns a pointer to the memory which contains the location. In case there is no such a memory, NULL is returned. */
+	amiq_rm_mem* get_mem_by_offset(amiq_rm_reg_address_t my_offset, amiq_rm_reg_address_t &mem_offset);
+
+	/** The function returns the offsets of a memory relative to the address map which calls this function.
+	 * @param mem is a reference to the memory which is searched for in the mapped memories and sub-maps
+	 * @returns a vector which contains all the offsets at which the memory is mapped.
+	 * If the memory is not mapped anywhere under the address map the returned vector will be 0 sized. */
+	std::vector<amiq_rm_reg_address_t> get_mem_offsets(amiq_rm_mem &mem);
+
+	/** The function returns a pointer to the register array which has an element at the specified offset.
+	 * The search will take place within directly mapped arrays, but will also continue recursively through sub-maps.
+	 * @param my_offset is the offset at which an element is searched for
+	 * @param index is set to the index of the element found at the offset
+	 * @returns a pointer to the register array. In case there is no element at the offset, NULL is returned. */
+	amiq_rm_reg_array* get_reg_array_by_offset(amiq_rm_reg_address_t my_offset, int unsigned &index);
+
+	/** The function returns the offsets of the first element of a register array relative to the address map which calls this function.
+	 * @param array is a reference to the register array which is searched for in the mapped arrays and sub-maps
+	 * @returns a vector which contains all the offsets at which the array is mapped.
+	 * If the array is not mapped anywhere under the address map the returned vector will be 0 sized. */
+	std::vector<amiq_rm_reg_address_t> get_reg_array_offsets(amiq_rm_reg_array &array);
+
+	/** The function returns a pointer to the map array which has a register at the specified offset.
+	 * The search will take place within directly mapped map arrays, but will also continue recursively through sub-maps.
+	 * @param my_offset is the offset at which a register is searched for
+	 * @param index is set to the index of the value of the register found at the offset (see amiq_rm_map_array::get_index())
+	 * @returns a pointer to the map array. In case there is no register of an instance at the offset, NULL is returned. */
+	amiq_rm_map_array* get_map_array_by_offset(amiq_rm_reg_address_t my_offset, int unsigned &index);
+
+	/** The function returns the offsets of the first instance of a map array relative to the address map which calls this function.
+	 * @param array is a reference to the map array which is searched for in the mapped map arrays and sub-maps
+	 * @returns a vector which contains all the offsets at which the array is mapped.
+	 * If the array is not mapped anywhere under the address map the returned vector will be 0 sized. */
+	std::vector<amiq_rm_reg_address_t> get_map_array_offsets(amiq_rm_map_array &array);
+
+	/** The function sets random values to all registers, register array elements and map array registers of the map and of its sub-maps
+	 * in one pass (see amiq_rm_reg::get_random_value()): write masks and field constraints are honoured, read-only and reserved fields
+	 * keep their values and no pre/post access hook is called. The values are generated with amiq_rm_random(), each value having its own
+	 * position in the random sequence (in the order of the traversal), so the same seed gives the same values for the same hierarchy.
+	 * @param seed is the seed of the random values
+	 * @returns the number of values which were randomized */
+	long long unsigned randomize(uint64_t seed);
+
+	/** The function randomizes the registers selected by a filter, as randomize(seed). The positions in the random sequence do not depend
+	 * on the filter, so a register gets the same value as with randomize(seed).
+	 * @param seed is the seed of the random values
+	 * @param filter selects the registers which are randomized, NULL to randomize all of them
+	 * @returns the number of values which were randomized */
+	long long unsigned randomize(uint64_t seed, amiq_rm_reg_filter_t filter);
+
+	/** The function is called by a source of the map (register, array or sub-map) when its active signals change.
+	 * It updates @b signal_node and, if the pending signals of the map changed, the parent maps.
+	 * @param old_signals are the signals which were active in the source
+	 * @param new_signals are the signals which are active in the source */
+	void update_signals(uint64_t old_signals, uint64_t new_signals);
+
+	/** @returns the mask of the signals which are pending in the map (see amiq_rm_signal::get_mask()). */
+	uint64_t get_pending_signals();
+
+	/** @param signal_id is the id of a signal (see amiq_rm_signal::get_id())
+	 * @returns true if at least one register under the map has the signal active */
+	bool is_signal_pending(int unsigned signal_id);
+
+	/** The function returns the offsets of the registers (and of the elements of arrays) under the map which have a signal active.
+	 * Only the sub-maps and the arrays in which the signal is pending are searched.
+	 * @param signal_id is the id of a signal (see amiq_rm_signal::get_id())
+	 * @returns the offsets, relative to the map, of the sources of the signal */
+	std::vector<amiq_rm_reg_address_t> get_signal_sources(int unsigned signal_id);
+
 	/** @returns a string with debug purpose information. */
 	std::string to_string();
 
+protected:
+	/** The size declared with set_size(), 0 if it was not declared. */
+	amiq_rm_reg_address_t size;
+
+	/** The extent of the content, it is computed by build(). */
+	amiq_rm_reg_address_t extent;
+
+	/** The function computes @b extent and checks that it fits in the declared size. */
+	void compute_extent();
+
+private:
+	/** Set by build(), the elements added afterwards are reported by report_late_add(). */
+	bool built;
+
+	/** The function reports an element added after build(): it is not decoded until the next build() or publish() of the physical map.
+	 * @param element_name is the name of the added element */
+	void report_late_add(const std::string &element_name);
+
+	/** The function computes @b signal_node from the sources of the map and updates the parent maps if the pending signals changed. */
+	void recompute_signals();
+
+	/** The function randomizes the map and its sub-maps.
+	 * @param seed is the seed of the random values
+	 * @param filter selects the registers which are randomized, NULL to randomize all of them
+	 * @param counter is the position in the random sequence of the first value of the map, it is advanced past the values of the map
+	 * @returns the number of values which were randomized */
+	long long unsigned randomize(uint64_t seed, amiq_rm_reg_filter_t filter, uint64_t &counter);
 };
 
 class amiq_rm_physical_address_map: public amiq_rm_address_map {
 public:
 
+	/** The decoder of the absolute addresses, it is built by build() and used by read(), write(), get() and set().
+	 * If the topology is changed after build(), build() (or publish()) must be called again. If the decoder is cleared (decoder.clear()),
+	 * the accesses fall back to the recursive search done by get_reg_by_offset() and the equivalent functions. */
+	amiq_rm_radix_decoder decoder;
+
 	/** Create new physical address map. Calls the constructor of amiq_rm_address_map
 	 * @param name is passed to the address map constructor for setting the name of the address_map*/
 	amiq_rm_physical_address_map(std::string name) :
 			amiq_rm_address_map(name) {
+		published_decoder = &decoder;
+		rcu_enabled = false;
+		read_latency = 0;
+		write_latency = 0;
+		side_effect_latency = 0;
+	}
+
+	/** Delete the decoder published by publish(). */
+	virtual ~amiq_rm_physical_address_map();
+
+	/** The function calls amiq_rm_address_map::build() and builds the decoder of the absolute addresses. After enable_rcu(), the decoder
+	 * in use is not built again in place: a new decoder is published (see publish()). */
+	virtual void build();
+
+	/** The function enables the topology updates while other threads access the map (see publish()): from now on, read(), write(), get()
+	 * and set() run in read-side sections of amiq_rm_rcu::get(). It must be called before the map is accessed by several threads. */
+	void enable_rcu();
+
+	/** The function publishes the current topology while other threads may access the map: a new decoder is built from the topology
+	 * (on the calling thread) and replaces the previous one with an atomic store, so an access uses either the previous or the new
+	 * decoder and never a partly updated one; the previous decoder is deleted once no access uses it (see amiq_rm_rcu).
+	 * @n The elements added since the last build() or publish() must be built (their build()) before the call; the elements already
+	 * mapped are not built again and the aggregate signals of the new elements are taken into account by the next build().
+	 * The topology must be changed and published by one thread at a time, and iterators and decode() results must not be kept across a
+	 * publication (unless they are used in a read-side section). */
+	void publish();
+
+	/** The function moves a sub-map to a new offset (e.g. when the software programs a BAR), keeping its registers and their values.
+	 * If the decoder is built, only the decoding of the old and of the new range of the sub-map is updated (see
+	 * amiq_rm_radix_decoder::relocate()); the decoder is built again and published if the new range is above the addresses it can
+	 * decode or if, after enable_rcu(), the new range overlaps the old one (such a move is refused by the decoder as the moved part
+	 * would be decoded as a hole for a while). After enable_rcu(), other threads may access the map during the call (see publish()).
+	 * @param submap is a sub-map added to this map with add_map()
+	 * @param new_offset is the new offset of the sub-map
+	 * @returns false if the new range of the sub-map overlaps another element of the map (nothing is changed); overlaps are
+	 * detected only if the decoder is built */
+	bool relocate_map(amiq_rm_address_map &submap, amiq_rm_reg_address_t new_offset);
+
+	/** @returns the decoder used by the accesses: @b decoder, or the last decoder published by publish(). */
+	amiq_rm_radix_decoder& get_decoder() {
+		return *__atomic_load_n(&published_decoder, __ATOMIC_ACQUIRE);
 	}
 
+	/** The function finds what is mapped at an absolute address.
+	 * @param address is the absolute address which is decoded
+	 * @returns a pointer to the target (register, register array, map array or memory) which contains the address or NULL if the address is not mapped.
+	 * If the decoder is not built, the returned target belongs to the calling thread and is overwritten by the next call of decode()
+	 * from the same thread. */
+	amiq_rm_decode_target* decode(amiq_rm_reg_address_t address);
+
+	/** The function returns an iterator over all the registers of the map, in the order of their absolute addresses
+	 * (see amiq_rm_reg_iterator). The decoder must be built.
+	 * @returns an iterator positioned on the register with the lowest address */
+	amiq_rm_reg_iterator get_reg_iterator();
+
+	/** The function returns an iterator over the registers whose absolute address is in [lo, hi), in the order of their addresses
+	 * (see amiq_rm_reg_iterator). The decoder must be built.
+	 * @param lo is the lowest address of the range
+	 * @param hi is the address which follows the range, it must be greater than @b lo
+	 * @returns an iterator positioned on the first register of the range */
+	amiq_rm_reg_iterator get_regs_in_range(amiq_rm_reg_address_t lo, amiq_rm_reg_address_t hi);
+
 	/** The function reads the value from the register by specifying the address at which the register is instanced.
-	 * The function calls amiq_rm_reg::read() function
+	 * The function calls amiq_rm_reg::read() function. If there is no register at the address, the element of a register array
+	 * (amiq_rm_reg_array::read()), the register of a map array instance (amiq_rm_map_array::read()) or the word of a memory
+	 * (amiq_rm_mem::read()) found at the address is read.
 	 * @param address is the address of the register on which the write operation is exercised
 	 * @returns the value read from the register as well as the status of the read operation */
 	std::pair<amiq_rm_reg_data_t, amiq_rm_status_t> read(amiq_rm_reg_address_t address);
 
 	/** This function writes a data to a register by specifying the address. The function calls the amiq_rm_reg::write() function.
+	 * If there is no register at the address, the element of a register array (amiq_rm_reg_array::write()), the register of a
+	 * map array instance (amiq_rm_map_array::write()) or the word of a memory (amiq_rm_mem::write()) found at the address is written.
 	 * @param address is the absolute address of a register on which the write operation is exercised
 	 * @param write_data is the data that is going to be written to the register
 	 * @returns the status of the write operation */
 	amiq_rm_status_t write(amiq_rm_reg_address_t address, amiq_rm_reg_data_t write_data);
 
+	/** The function performs a read of @b size bytes which may start at any byte address (e.g. a byte read of the second byte of a register
+	 * or a word read which covers several narrow registers). The access is split in parts, one for each element (register, element of a
+	 * register array, memory) covered by the enabled bytes, and each part reads only the enabled lanes of its element
+	 * (see amiq_rm_reg::read(int unsigned)). The bytes of the data are in little-endian order: byte @b i is read from address + i.
+	 * @n Bytes in the middle of a register are found only if the decoder is built.
+	 * @param address is the absolute address of the first byte of the access
+	 * @param size is the number of bytes of the access, from 1 to the size of amiq_rm_reg_data_t
+	 * @param byte_enable selects the bytes of the access which are read, bit @b i selects the byte at address + i
+	 * @returns the read data (the bytes which are not enabled are 0) as well as the status of the read operation:
+	 * ERROR if a part returned ERROR, otherwise HOLE if an enabled byte is not mapped, otherwise OKAY */
+	std::pair<amiq_rm_reg_data_t, amiq_rm_status_t> read(amiq_rm_reg_address_t address, int unsigned size, int unsigned byte_enable);
+
+	/** The function performs a write of @b size bytes which may start at any byte address, it is split in parts as read(address, size, byte_enable).
+	 * @param address is the absolute address of the first byte of the access
+	 * @param write_data is the data that is going to be written, byte @b i is written to address + i
+	 * @param size is the number of bytes of the access, from 1 to the size of amiq_rm_reg_data_t
+	 * @param byte_enable selects the bytes of the access which are written, bit @b i selects the byte at address + i
+	 * @returns the status of the write operation: ERROR if a part returned ERROR, otherwise HOLE if an enabled byte is not mapped, otherwise OKAY */
+	amiq_rm_status_t write(amiq_rm_reg_address_t address, amiq_rm_reg_data_t write_data, int unsigned size, int unsigned byte_enable);
+
 	/** This function gets the register's value by specifying the address at which the register is mapped.
-	 * The function calls the amiq_rm_reg::get() function.
+	 * The function calls the amiq_rm_reg::get() function (or the equivalent function of a register array or of a memory).
 	 * @param address is the absolute address of a register on which the get operation is exercised
 	 * @returns the value of the register */
 	amiq_rm_reg_data_t get(amiq_rm_reg_address_t address);
 
 	/** This function sets the register's value by specifying the address at which the register is mapped.
-	 * The function calls the amiq_rm_reg::set() function.
+	 * The function calls the amiq_rm_reg::set() function (or the equivalent function of a register array or of a memory).
 	 * @param address is the absolute address of a register on which the set operation is exercised
 	 * @param write_data is the value set to the register */
 	void set(amiq_rm_reg_address_t address, amiq_rm_reg_data_t write_data);
+
+	/** The function annotates the map with the latency of its accesses, used by the accesses done with a quantum keeper. The latency of
+	 * an access is the latency of the map, plus the latency of the accessed register (see amiq_rm_reg::set_latency(), the layout register
+	 * for an element of a register array, the register of the prototype for an element of a map array; the elements of memories have only
+	 * the latency of the map), plus @b my_side_effect_latency if the access has side effects (see amiq_rm_reg::has_side_effects()).
+	 * @param my_read_latency is the latency of a read
+	 * @param my_write_latency is the latency of a write
+	 * @param my_side_effect_latency is the additional latency of an access with side effects */
+	void set_latency(uint64_t my_read_latency, uint64_t my_write_latency, uint64_t my_side_effect_latency);
+
+	/** @param target is the target of the access (as returned by decode()), NULL for an access to a hole
+	 * @param address is the absolute address of the access, it selects the element of a map array
+	 * @param direction is the direction of the access READ/WRITE
+	 * @returns the latency of the access (see set_latency()) */
+	uint64_t get_latency(amiq_rm_decode_target *target, amiq_rm_reg_address_t address, amiq_rm_direction_t direction);
+
+	/** The function reads a register as read(address) and adds the latency of the access to the local time of a quantum keeper.
+	 * The caller synchronizes with the simulation kernel only when the keeper needs it (see amiq_rm_quantum_keeper::need_sync()).
+	 * @param address is the address of the register
+	 * @param keeper is the quantum keeper of the initiator
+	 * @returns the read data as well as the status of the read operation */
+	std::pair<amiq_rm_reg_data_t, amiq_rm_status_t> read(amiq_rm_reg_address_t address, amiq_rm_quantum_keeper &keeper);
+
+	/** The function writes a register as write(address, write_data) and adds the latency of the access to the local time of a quantum keeper.
+	 * @param address is the address of the register
+	 * @param write_data is the data that is going to be written to the register
+	 * @param keeper is the quantum keeper of the initiator
+	 * @returns the status of the write operation */
+	amiq_rm_status_t write(amiq_rm_reg_address_t address, amiq_rm_reg_data_t write_data, amiq_rm_quantum_keeper &keeper);
+
+	/** The function performs a sized read as read(address, size, byte_enable) and adds the latency of the access, which is the latency of the
+	 * element which contains the first enabled byte, to the local time of a quantum keeper.
+	 * @param address is the absolute address of the first byte
+	 * @param size is the number of bytes (1 to the number of bytes of amiq_rm_reg_data_t)
+	 * @param byte_enable selects the bytes of the access which are read
+	 * @param keeper is the quantum keeper of the initiator
+	 * @returns the read data as well as the status of the read operation */
+	std::pair<amiq_rm_reg_data_t, amiq_rm_status_t> read(amiq_rm_reg_address_t address, int unsigned size, int unsigned byte_enable,
+			amiq_rm_quantum_keeper &keeper);
+
+	/** The function performs a sized write as write(address, write_data, size, byte_enable) and adds the latency of the access to the local time
+	 * of a quantum keeper (see the sized read()).
+	 * @param address is the absolute address of the first byte
+	 * @param write_data is the data written to the enabled bytes
+	 * @param size is the number of bytes (1 to the number of bytes of amiq_rm_reg_data_t)
+	 * @param byte_enable selects the bytes of the access which are written
+	 * @param keeper is the quantum keeper of the initiator
+	 * @returns the status of the write operation */
+	amiq_rm_status_t write(amiq_rm_reg_address_t address, amiq_rm_reg_data_t write_data, int unsigned size, int unsigned byte_enable,
+			amiq_rm_quantum_keeper &keeper);
+
+private:
+	/** The latency of a read, set with set_latency(). */
+	uint64_t read_latency;
+
+	/** The latency of a write, set with set_latency(). */
+	uint64_t write_latency;
+
+	/** The additional latency of an access with side effects, set with set_latency(). */
+	uint64_t side_effect_latency;
+
+	/** The decoder used by the accesses, it is accessed atomically. */
+	amiq_rm_radix_decoder *published_decoder;
+
+	/** Set by enable_rcu(). */
+	bool rcu_enabled;
+
+	/** The function deletes a decoder retired by publish().
+	 * @param object is the decoder */
+	static void delete_decoder(void *object);
+
+	/** The function finds the part of a sized access which starts at a given byte of the access.
+	 * @param address is the absolute address of the first byte of the access
+	 * @param size is the number of bytes of the access
+	 * @param position is the index of the byte of the access at which the part starts
+	 * @param element_address is set to the absolute address of the element accessed by the part
+	 * @param lane is set to the lane of the element which corresponds to the byte at @b position
+	 * @param nof_bytes is set to the number of bytes of the access which fall in the element, starting with the byte at @b position
+	 * @returns the target of the element or NULL if the byte at @b position is not mapped */
+	amiq_rm_decode_target* decode_part(amiq_rm_reg_address_t address, int unsigned size, int unsigned position, amiq_rm_reg_address_t &element_address,
+			int unsigned &lane, int unsigned &nof_bytes);
+
+	/** The function implements the sized read(), with or without a quantum keeper.
+	 * @param address is the absolute address of the first byte
+	 * @param size is the number of bytes
+	 * @param byte_enable selects the bytes of the access which are read
+	 * @param keeper is the quantum keeper which is annotated with the latency of the access, NULL for none
+	 * @returns the read data as well as the status of the read operation */
+	std::pair<amiq_rm_reg_data_t, amiq_rm_status_t> sized_read(amiq_rm_reg_address_t address, int unsigned size, int unsigned byte_enable,
+			amiq_rm_quantum_keeper *keeper);
+
+	/** The function implements the sized write(), with or without a quantum keeper.
+	 * @param address is the absolute address of the first byte
+	 * @param write_data is the data written to the enabled bytes
+	 * @param size is the number of bytes
+	 * @param byte_enable selects the bytes of the access which are written
+	 * @param keeper is the quantum keeper which is annotated with the latency of the access, NULL for none
+	 * @returns the status of the write operation */
+	amiq_rm_status_t sized_write(amiq_rm_reg_address_t address, amiq_rm_reg_data_t write_data, int unsigned size, int unsigned byte_enable,
+			amiq_rm_quantum_keeper *keeper);
 };
 
 }
@@ -0,0 +1,132 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_counter.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef	AMIQ_RM_COUNTER
+#define	AMIQ_RM_COUNTER	1
+
+#include <assert.h>
+#include "amiq_rm_counter.hpp"
+#include "amiq_rm_reg.hpp"
+
+using namespace std;
+
+namespace amiq_rm {
+
+void amiq_rm_time_source::set_time(uint64_t time) {
+	assert(time >= now);
+	if (time != now) {
+		now = time;
+		amiq_rm_value_provider::advance_epoch();
+	}
+}
+
+amiq_rm_counter::amiq_rm_counter(amiq_rm_time_source &my_time, amiq_rm_reg &my_reg, string field_name, uint64_t my_period) :
+		time(my_time), reg(my_reg) {
+	assert(my_period != 0);
+	period = my_period;
+	step = 1;
+	count_down = false;
+	mode = AMIQ_RM_COUNTER_WRAP;
+
+	field = reg.get_field_my_name(field_name);
+	assert((field != NULL) && (field->provider == NULL));
+	enable_field = NULL;
+	max_value = field->get_value_mask();
+
+	base = field->reset_value & max_value;
+	reload = base;
+	start_time = time.get_time();
+	phase = 0;
+	enabled = true;
+	last_value = base;
+	last_time = start_time;
+
+	field->provider = this;
+	reg.add_observer(this);
+}
+
+void amiq_rm_counter::set_enable(string field_name) {
+	enable_field = reg.get_field_my_name(field_name);
+	assert((enable_field != NULL) && (enable_field != field));
+	enabled = (enable_field->reset_value != 0);
+}
+
+amiq_rm_reg_data_t amiq_rm_counter::compute(uint64_t now) {
+	if (!enabled)
+		return base;
+
+	uint64_t ticks = (now - start_time) / period;
+	if (mode == AMIQ_RM_COUNTER_WRAP) {
+		//the field has at most 32 bits, so the product of the truncated operands is exact modulo the range of the field
+		uint64_t delta = (ticks & max_value) * (step & max_value);
+		return (count_down ? (base - delta) : (base + delta)) & max_value;
+	}
+
+	uint64_t delta;
+	bool overflow = __builtin_mul_overflow(ticks, (uint64_t) step, &delta);
+	uint64_t distance = count_down ? base : (max_value - base);
+	if (!overflow && (delta <= distance))
+		return count_down ? (base - delta) : (base + delta);
+	if (mode == AMIQ_RM_COUNTER_SATURATE)
+		return count_down ? 0 : max_value;
+
+	//AMIQ_RM_COUNTER_RELOAD: after passing the limit, the counter cycles between reload and the limit
+	uint64_t cycle = count_down ? ((uint64_t) reload + 1) : ((uint64_t) max_value - reload + 1);
+	uint64_t delta_in_cycle = ((ticks % cycle) * (step % cycle)) % cycle;
+	uint64_t remainder = (delta_in_cycle + cycle - ((distance + 1) % cycle)) % cycle;
+	return count_down ? (reload - remainder) : (reload + remainder);
+}
+
+amiq_rm_reg_data_t amiq_rm_counter::get_value(amiq_rm_reg &reg) {
+	last_time = time.get_time();
+	last_value = compute(last_time);
+	return last_value;
+}
+
+void amiq_rm_counter::value_changed(amiq_rm_reg &reg, amiq_rm_reg_data_t old_value) {
+	uint64_t now = time.get_time();
+	amiq_rm_reg_data_t new_value = (reg.value >> field->lsb_position) & max_value;
+	bool new_enabled = true;
+	if (enable_field != NULL)
+		new_enabled = (((reg.value >> enable_field->lsb_position) & enable_field->get_value_mask()) != 0);
+
+	//the counter field holds the value computed at the current time, only the enable field may have changed
+	if ((now == last_time) && (new_value == last_value)) {
+		if (new_enabled && !enabled) {
+			start_time = now - phase;
+		} else if (!new_enabled && enabled) {
+			phase = (now - start_time) % period;
+			base = new_value;
+		}
+		enabled = new_enabled;
+		return;
+	}
+
+	base = new_value;
+	reload = new_value;
+	start_time = now;
+	phase = 0;
+	enabled = new_enabled;
+	last_value = new_value;
+	last_time = now;
+}
+
+}
+
+#endif
@@ -0,0 +1,160 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_counter.hpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef AMIQ_RM_COUNTER_HEADER
+#define AMIQ_RM_COUNTER_HEADER 1
+
+#include "amiq_rm_types.cpp"
+#include "amiq_rm_provider.hpp"
+#include "amiq_rm_observer.hpp"
+#include <string>
+#include <stdint.h>
+
+namespace amiq_rm {
+
+class amiq_rm_reg;
+class amiq_rm_field;
+
+/** This class holds the simulated time used by the counters (see amiq_rm_counter). The time is advanced by the user (e.g. from the
+ * clock of the testbench); each change of the time starts a new provider epoch, so the next access of a counter computes its value again. */
+class amiq_rm_time_source {
+public:
+	/** Create new time source, the time starts at 0. */
+	amiq_rm_time_source() {
+		now = 0;
+	}
+
+	/** There are no pointers to delete. */
+	virtual ~amiq_rm_time_source() {
+	}
+
+	/** @returns the current simulated time. */
+	uint64_t get_time() {
+		return now;
+	}
+
+	/** The function sets the simulated time, the time can not go backwards.
+	 * @param time is the new time */
+	void set_time(uint64_t time);
+
+	/** The function advances the simulated time.
+	 * @param delta is the amount by which the time is advanced */
+	void advance(uint64_t delta) {
+		set_time(now + delta);
+	}
+
+private:
+	/** The current simulated time. */
+	uint64_t now;
+};
+
+/** The behavior of a counter when it passes its limit (the maximum value of the field when counting up, 0 when counting down). */
+typedef enum {
+	AMIQ_RM_COUNTER_WRAP, AMIQ_RM_COUNTER_SATURATE, AMIQ_RM_COUNTER_RELOAD
+} amiq_rm_counter_mode_t;
+
+/** This class turns a field into a free-running counter or timer: the value of the field is computed when it is accessed, from the time
+ * of an amiq_rm_time_source and from the value and the time of the last change of the field, so nothing is done between accesses.
+ * @n The counter changes by @b step every @b period time units while it is enabled, up or down (see @b count_down). When it passes its limit
+ * it wraps around, saturates or (AMIQ_RM_COUNTER_RELOAD) restarts from the last value set in the field. Any change of the field which is not
+ * done by the counter (write(), set(), reset(), etc.) loads the counter with the new value at the current time. The counter can be enabled
+ * by another field of the same register (see set_enable()); the progress within the current period is kept while it is disabled.
+ * @n The counter attaches itself to the field as provider and to the register as observer, so it must be created before the build() of the
+ * register and it must not be destroyed while the register is used. The configuration must be set before the first access. */
+class amiq_rm_counter: public amiq_rm_value_provider, public amiq_rm_reg_observer {
+public:
+	/** The number of time units between two changes of the counter. */
+	uint64_t period;
+
+	/** The amount by which the counter changes every period. */
+	amiq_rm_reg_data_t step;
+
+	/** If set, the counter counts down (a timer), otherwise it counts up. */
+	bool count_down;
+
+	/** The behavior of the counter when it passes its limit. */
+	amiq_rm_counter_mode_t mode;
+
+	/** Create new counter, which counts up by 1 every period and wraps around.
+	 * @param my_time is the time source
+	 * @param my_reg is the register of the field
+	 * @param field_name is the name of the field which holds the counter
+	 * @param my_period is set as period, it must not be 0 */
+	amiq_rm_counter(amiq_rm_time_source &my_time, amiq_rm_reg &my_reg, std::string field_name, uint64_t my_period);
+
+	/** There are no pointers to delete. */
+	virtual ~amiq_rm_counter() {
+	}
+
+	/** The function sets the field which enables the counter: the counter counts only while the field is not 0.
+	 * @param field_name is the name of a field of the register of the counter */
+	void set_enable(std::string field_name);
+
+	/** @returns the value of the counter at the current time. */
+	amiq_rm_reg_data_t get_value(amiq_rm_reg &reg);
+
+	/** The function loads the counter when the field is changed by an access, and follows the changes of the enable field. */
+	void value_changed(amiq_rm_reg &reg, amiq_rm_reg_data_t old_value);
+
+private:
+	/** The time source. */
+	amiq_rm_time_source &time;
+
+	/** The register of the field. */
+	amiq_rm_reg &reg;
+
+	/** The field which holds the counter. */
+	amiq_rm_field *field;
+
+	/** The field which enables the counter or NULL. */
+	amiq_rm_field *enable_field;
+
+	/** The mask of the values of the field. */
+	amiq_rm_reg_data_t max_value;
+
+	/** The value loaded in the counter. */
+	amiq_rm_reg_data_t base;
+
+	/** The value from which the counter restarts in AMIQ_RM_COUNTER_RELOAD mode. */
+	amiq_rm_reg_data_t reload;
+
+	/** The time at which the counter had the value @b base. */
+	uint64_t start_time;
+
+	/** The time elapsed in the current period when the counter was disabled. */
+	uint64_t phase;
+
+	/** Set while the counter is enabled. */
+	bool enabled;
+
+	/** The last value returned by get_value() or loaded in the counter. */
+	amiq_rm_reg_data_t last_value;
+
+	/** The time of @b last_value. */
+	uint64_t last_time;
+
+	/** The function computes the value of the counter.
+	 * @param now is the current time
+	 * @returns the value of the counter */
+	amiq_rm_reg_data_t compute(uint64_t now);
+};
+
+}
+
+#endif
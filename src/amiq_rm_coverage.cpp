@@ -0,0 +1,195 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_coverage.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef	AMIQ_RM_COVERAGE
+#define	AMIQ_RM_COVERAGE	1
+
+#include <stdio.h>
+#include <string.h>
+#include <map>
+#include <sstream>
+#include "amiq_rm_coverage.hpp"
+#include "amiq_rm_reg.hpp"
+#include "amiq_rm_address_map.hpp"
+
+using namespace std;
+
+namespace amiq_rm {
+
+/** Identifies a binary coverage file. */
+static const char amiq_rm_coverage_magic[8] = { 'A', 'M', 'I', 'Q', 'R', 'M', 'C', 'V' };
+
+amiq_rm_coverage& amiq_rm_coverage::get() {
+	static amiq_rm_coverage coverage;
+	return coverage;
+}
+
+string amiq_rm_coverage::get_path(const vector<amiq_rm_address_map*> &parent_maps, const string &name) {
+	string path = name;
+	amiq_rm_address_map *map = parent_maps.empty() ? NULL : parent_maps[0];
+	while (map != NULL) {
+		path = map->name + "." + path;
+		map = map->parents.empty() ? NULL : map->parents[0];
+	}
+	return path;
+}
+
+int unsigned amiq_rm_coverage::get_nof_words(int unsigned size) {
+	int unsigned nof_words = AMIQ_RM_COVERAGE_NOF_COUNTERS;
+	if (size <= AMIQ_RM_COVERAGE_MAX_VALUE_BITS)
+		nof_words += ((1 << size) + 63) / 64;
+	return nof_words;
+}
+
+int unsigned amiq_rm_coverage::add_field(string name, int unsigned size) {
+	amiq_rm_coverage_field field;
+	field.name = name;
+	field.size = size;
+	field.offset = pool.size();
+	field.nof_words = get_nof_words(size);
+	field.lsb_position = 0;
+	field.read_effect = false;
+	field.write_effect = false;
+	field.w1c = false;
+
+	pool.resize(pool.size() + field.nof_words, 0);
+	fields.push_back(field);
+	return fields.size() - 1;
+}
+
+int unsigned amiq_rm_coverage::add_reg(amiq_rm_reg &reg, string path) {
+	amiq_rm_coverage_reg coverage_reg;
+	coverage_reg.first_field = fields.size();
+	coverage_reg.nof_fields = reg.fields.size();
+
+	for (int unsigned i = 0; i < reg.fields.size(); i++) {
+		amiq_rm_field *field = reg.fields[i];
+		amiq_rm_coverage_field &coverage_field = fields[add_field(path + "." + field->name, field->size)];
+		coverage_field.lsb_position = field->lsb_position;
+		coverage_field.read_effect = (field->is_clear_on_read() || field->is_set_on_read());
+		coverage_field.w1c = (field->attrib == "W1C");
+		coverage_field.write_effect = (field->is_clear_on_write() || field->is_set_on_write() || coverage_field.w1c);
+	}
+
+	regs.push_back(coverage_reg);
+	return regs.size() - 1;
+}
+
+void amiq_rm_coverage::rename_reg(int unsigned reg_index, string path) {
+	amiq_rm_coverage_reg &coverage_reg = regs[reg_index];
+	for (int unsigned i = 0; i < coverage_reg.nof_fields; i++) {
+		string &field_name = fields[coverage_reg.first_field + i].name;
+		field_name = path + field_name.substr(field_name.rfind('.'));
+	}
+}
+
+void amiq_rm_coverage::clear() {
+	for (int unsigned i = 0; i < pool.size(); i++)
+		pool[i] = 0;
+}
+
+bool amiq_rm_coverage::save(string file_name) {
+	FILE *file = fopen(file_name.c_str(), "wb");
+	if (file == NULL)
+		return false;
+
+	uint32_t nof_fields = fields.size();
+	bool ok = (fwrite(amiq_rm_coverage_magic, sizeof(amiq_rm_coverage_magic), 1, file) == 1);
+	ok = ok && (fwrite(&nof_fields, sizeof(nof_fields), 1, file) == 1);
+	for (int unsigned i = 0; ok && (i < fields.size()); i++) {
+		uint32_t header[3] = { (uint32_t) fields[i].name.size(), fields[i].size, fields[i].nof_words };
+		ok = (fwrite(header, sizeof(header), 1, file) == 1);
+		ok = ok && (fwrite(fields[i].name.c_str(), fields[i].name.size(), 1, file) == 1);
+		ok = ok && (fwrite(&pool[fields[i].offset], sizeof(uint64_t), fields[i].nof_words, file) == fields[i].nof_words);
+	}
+	return (fclose(file) == 0) && ok;
+}
+
+bool amiq_rm_coverage::load(string file_name) {
+	FILE *file = fopen(file_name.c_str(), "rb");
+	if (file == NULL)
+		return false;
+
+	map<string, int unsigned> field_indexes;
+	for (int unsigned i = 0; i < fields.size(); i++)
+		field_indexes.insert(make_pair(fields[i].name, i));
+
+	char magic[sizeof(amiq_rm_coverage_magic)];
+	uint32_t nof_fields = 0;
+	bool ok = (fread(magic, sizeof(magic), 1, file) == 1) && (memcmp(magic, amiq_rm_coverage_magic, sizeof(magic)) == 0);
+	ok = ok && (fread(&nof_fields, sizeof(nof_fields), 1, file) == 1);
+
+	for (uint32_t i = 0; ok && (i < nof_fields); i++) {
+		//header: size of the name, size of the field, number of words of the record
+		uint32_t header[3];
+		ok = (fread(header, sizeof(header), 1, file) == 1);
+		ok = ok && (header[0] > 0) && (header[0] <= AMIQ_RM_COVERAGE_MAX_NAME_SIZE);
+		ok = ok && (header[1] > 0) && (header[1] <= 8 * sizeof(amiq_rm_reg_data_t)) && (header[2] == get_nof_words(header[1]));
+		if (!ok)
+			break;
+
+		string name(header[0], ' ');
+		vector<uint64_t> words(header[2]);
+		ok = (fread(&name[0], header[0], 1, file) == 1);
+		ok = ok && (fread(&words[0], sizeof(uint64_t), header[2], file) == header[2]);
+		if (!ok)
+			break;
+
+		int unsigned field_index;
+		map<string, int unsigned>::iterator it = field_indexes.find(name);
+		if (it != field_indexes.end()) {
+			field_index = it->second;
+			ok = (fields[field_index].size == header[1]);
+		} else {
+			field_index = add_field(name, header[1]);
+			field_indexes.insert(make_pair(name, field_index));
+		}
+
+		amiq_rm_coverage_field &field = fields[field_index];
+		for (int unsigned j = 0; ok && (j < field.nof_words); j++) {
+			if (j < AMIQ_RM_COVERAGE_NOF_COUNTERS)
+				pool[field.offset + j] += words[j];
+			else
+				pool[field.offset + j] |= words[j];
+		}
+	}
+	fclose(file);
+	return ok;
+}
+
+string amiq_rm_coverage::to_string() {
+	ostringstream convert;
+	for (int unsigned i = 0; i < fields.size(); i++) {
+		uint64_t *record = &pool[fields[i].offset];
+		convert << fields[i].name << " Reads: " << dec << record[AMIQ_RM_COVERAGE_READS] << " Writes: " << record[AMIQ_RM_COVERAGE_WRITES]
+				<< " Read effects: " << record[AMIQ_RM_COVERAGE_READ_EFFECTS] << " Write effects: " << record[AMIQ_RM_COVERAGE_WRITE_EFFECTS];
+		if (fields[i].nof_words > AMIQ_RM_COVERAGE_NOF_COUNTERS) {
+			int unsigned nof_values = 0;
+			for (int unsigned j = AMIQ_RM_COVERAGE_NOF_COUNTERS; j < fields[i].nof_words; j++)
+				nof_values += __builtin_popcountll(record[j]);
+			convert << " Values: " << nof_values << "/" << (1 << fields[i].size);
+		}
+		convert << "\n";
+	}
+	return convert.str();
+}
+
+}
+
+#endif
@@ -0,0 +1,198 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_coverage.hpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef AMIQ_RM_COVERAGE_HEADER
+#define AMIQ_RM_COVERAGE_HEADER 1
+
+#include "amiq_rm_types.cpp"
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace amiq_rm {
+
+class amiq_rm_reg;
+class amiq_rm_address_map;
+
+/** This class holds the functional coverage of the fields: for each field it counts the reads, the writes, the reads and the writes
+ * which exercised a side effect of the field (e.g. RC, W1C) and, for fields of at most AMIQ_RM_COVERAGE_MAX_VALUE_BITS bits,
+ * it keeps a bitmap of the values seen. All records are stored in one contiguous pool of 64-bit words.
+ * @n The registers sample the coverage in read() and write() only if the library is compiled with AMIQ_RM_ENABLE_COVERAGE defined
+ * (the library and the user code must be compiled with the same setting); otherwise the sampling code is not compiled at all.
+ * The sampling is meant to add at most 3 ns per field to an access, examples/bench_coverage measures it.
+ * The registers are added to the pool returned by get() when build() is called.
+ * @n The coverage is saved to a binary file with save(). load() merges a file into a pool by matching the hierarchical names of the
+ * fields (e.g. "top.sub.register.field", see get_path()) and adds the fields which are not known yet, so the coverage of many runs can be merged into an empty pool
+ * (this is what the amiq_rm_cov_merge tool does). */
+class amiq_rm_coverage {
+public:
+	/** The fields with at most this number of bits have a bitmap of the values seen. */
+	static const int unsigned AMIQ_RM_COVERAGE_MAX_VALUE_BITS = 8;
+
+	/** Index of the read counter in the record of a field. */
+	static const int unsigned AMIQ_RM_COVERAGE_READS = 0;
+
+	/** Index of the write counter in the record of a field. */
+	static const int unsigned AMIQ_RM_COVERAGE_WRITES = 1;
+
+	/** Index of the counter of reads which exercised a read side effect (clear/set on read). */
+	static const int unsigned AMIQ_RM_COVERAGE_READ_EFFECTS = 2;
+
+	/** Index of the counter of writes which exercised a write side effect (clear/set on write, W1C with at least one bit set). */
+	static const int unsigned AMIQ_RM_COVERAGE_WRITE_EFFECTS = 3;
+
+	/** Number of counters of the record of a field, the bitmap of values follows them. */
+	static const int unsigned AMIQ_RM_COVERAGE_NOF_COUNTERS = 4;
+
+	/** The longest field name accepted by load(). */
+	static const int unsigned AMIQ_RM_COVERAGE_MAX_NAME_SIZE = 4096;
+
+	/** The description of the record of a field. */
+	struct amiq_rm_coverage_field {
+		/** The hierarchical name of the field, "path.field" where path is the one given to add_reg(). */
+		std::string name;
+
+		/** The size of the field in bits. */
+		int unsigned size;
+
+		/** The position of the first word of the record in the pool. */
+		int unsigned offset;
+
+		/** The number of words of the record (counters and bitmap). */
+		int unsigned nof_words;
+
+		/** The lsb position of the field in the register. */
+		int unsigned lsb_position;
+
+		/** The field has a read side effect. */
+		bool read_effect;
+
+		/** The field has a write side effect. */
+		bool write_effect;
+
+		/** The field has the W1C attribute (its write side effect needs at least one bit set). */
+		bool w1c;
+	};
+
+	/** The contiguous pool which holds the records of all fields. */
+	std::vector<uint64_t> pool;
+
+	/** The descriptions of the records, in the order of the pool. */
+	std::vector<amiq_rm_coverage_field> fields;
+
+	/** Create an empty coverage pool. */
+	amiq_rm_coverage() {
+	}
+
+	/** There are no pointers to delete. */
+	virtual ~amiq_rm_coverage() {
+	}
+
+	/** @returns the pool to which the registers are added when the library is compiled with AMIQ_RM_ENABLE_COVERAGE. */
+	static amiq_rm_coverage& get();
+
+	/** The function returns the hierarchical path of an element: the names of the maps which contain it (following the first parent
+	 * of each map) and its own name, separated by dots. Fields of different blocks which have the same register name get different paths.
+	 * @param parent_maps are the maps which contain the element
+	 * @param name is the name of the element
+	 * @returns the path of the element, e.g. "top.sub.register" */
+	static std::string get_path(const std::vector<amiq_rm_address_map*> &parent_maps, const std::string &name);
+
+	/** The function adds the records of the fields of a register to the pool.
+	 * @param reg is the register which is added (after its fields were added)
+	 * @param path is the hierarchical path of the register (see get_path()), the fields are named "path.field"
+	 * @returns the index of the register, used by sample() */
+	int unsigned add_reg(amiq_rm_reg &reg, std::string path);
+
+	/** The function changes the names of the records of a register, e.g. when the layout of a register array is named after the array.
+	 * @param reg_index is the index returned by add_reg()
+	 * @param path is the new hierarchical path of the register */
+	void rename_reg(int unsigned reg_index, std::string path);
+
+	/** The function records an access to a register.
+	 * @param reg_index is the index returned by add_reg()
+	 * @param direction is the direction of the access
+	 * @param access_data is the written data (for WRITE)
+	 * @param value is the data returned by a READ or the value of the register after a WRITE */
+	void sample(int unsigned reg_index, amiq_rm_direction_t direction, amiq_rm_reg_data_t access_data, amiq_rm_reg_data_t value) {
+		amiq_rm_coverage_reg &reg = regs[reg_index];
+		for (int unsigned i = reg.first_field; i < reg.first_field + reg.nof_fields; i++) {
+			amiq_rm_coverage_field &field = fields[i];
+			uint64_t *record = &pool[field.offset];
+			amiq_rm_reg_data_t field_mask = amiq_rm_get_value_mask(field.size);
+
+			if (direction == READ) {
+				record[AMIQ_RM_COVERAGE_READS]++;
+				if (field.read_effect)
+					record[AMIQ_RM_COVERAGE_READ_EFFECTS]++;
+			} else {
+				record[AMIQ_RM_COVERAGE_WRITES]++;
+				if (field.write_effect && (!field.w1c || (((access_data >> field.lsb_position) & field_mask) != 0)))
+					record[AMIQ_RM_COVERAGE_WRITE_EFFECTS]++;
+			}
+
+			if (field.nof_words > AMIQ_RM_COVERAGE_NOF_COUNTERS) {
+				amiq_rm_reg_data_t field_value = (value >> field.lsb_position) & field_mask;
+				record[AMIQ_RM_COVERAGE_NOF_COUNTERS + field_value / 64] |= ((uint64_t) 1) << (field_value % 64);
+			}
+		}
+	}
+
+	/** The function sets all counters and bitmaps to 0. */
+	void clear();
+
+	/** The function writes the pool to a binary coverage file.
+	 * @param file_name is the name of the file
+	 * @returns false if the file could not be written */
+	bool save(std::string file_name);
+
+	/** The function merges a binary coverage file into the pool: counters are added, bitmaps are or-ed.
+	 * Fields which are not in the pool are added to it. The header of each record is checked before anything is allocated: the size
+	 * must be a valid field size, the number of words must match the size and a field of the pool must have the same size.
+	 * @param file_name is the name of the file
+	 * @returns false if the file could not be read or is not a valid coverage file */
+	bool load(std::string file_name);
+
+	/** @returns a string with the coverage of each field: counters and the number of values seen. */
+	std::string to_string();
+
+private:
+	/** The fields of a register which was added with add_reg(). */
+	struct amiq_rm_coverage_reg {
+		int unsigned first_field;
+		int unsigned nof_fields;
+	};
+
+	/** The registers added with add_reg(). */
+	std::vector<amiq_rm_coverage_reg> regs;
+
+	/** @param size is the size of a field in bits
+	 * @returns the number of words of the record of the field (counters and bitmap) */
+	static int unsigned get_nof_words(int unsigned size);
+
+	/** The function adds the record of a field to the pool.
+	 * @param name is the name of the field
+	 * @param size is the size of the field in bits
+	 * @returns the index of the field in @b fields */
+	int unsigned add_field(std::string name, int unsigned size);
+};
+
+}
+
+#endif
@@ -0,0 +1,578 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_decoder.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef	AMIQ_RM_DECODER
+#define	AMIQ_RM_DECODER	1
+
+#include <assert.h>
+#include <algorithm>
+#include "amiq_rm_decoder.hpp"
+#include "amiq_rm_address_map.hpp"
+#include "amiq_rm_rcu.hpp"
+
+using namespace std;
+
+namespace amiq_rm {
+
+bool amiq_rm_decode_target::get_index(amiq_rm_reg_address_t address, int unsigned &index) {
+	index = 0;
+	switch (kind) {
+	case REG_TARGET:
+		return (address == base);
+	case MEM_TARGET:
+		return (size - (address - base) >= sizeof(amiq_rm_reg_data_t));
+	case MAP_ARRAY_TARGET: {
+		amiq_rm_reg_address_t element_offset;
+		return (map_array->find(address - base, index, element_offset) && (element_offset == address - base));
+	}
+	case REG_ARRAY_TARGET:
+		break;
+	}
+	amiq_rm_reg_address_t delta = address - base;
+	index = delta / reg_array->stride;
+	return ((delta % reg_array->stride) == 0);
+}
+
+bool amiq_rm_decode_target::get_element(amiq_rm_reg_address_t address, amiq_rm_reg_address_t &element_address, int unsigned &nof_bytes) {
+	amiq_rm_reg_address_t delta = address - base;
+	switch (kind) {
+	case REG_TARGET:
+		element_address = base;
+		nof_bytes = reg->get_nof_bytes();
+		return (delta < nof_bytes);
+	case REG_ARRAY_TARGET:
+		element_address = address - (delta % reg_array->stride);
+		nof_bytes = reg_array->layout->get_nof_bytes();
+		return ((delta % reg_array->stride) < nof_bytes);
+	case MEM_TARGET:
+		element_address = address;
+		nof_bytes = (size - delta < sizeof(amiq_rm_reg_data_t)) ? (size - delta) : sizeof(amiq_rm_reg_data_t);
+		return true;
+	case MAP_ARRAY_TARGET: {
+		int unsigned index;
+		amiq_rm_reg_address_t element_offset;
+		if (!map_array->find(delta, index, element_offset))
+			return false;
+		element_address = base + element_offset;
+		nof_bytes = map_array->slots[index % map_array->get_nof_slots()].reg->get_nof_bytes();
+		return true;
+	}
+	}
+	return false;
+}
+
+pair<amiq_rm_reg_data_t, amiq_rm_status_t> amiq_rm_decode_target::read(amiq_rm_reg_address_t element_address, int unsigned byte_enable) {
+	switch (kind) {
+	case REG_TARGET:
+		return reg->read(byte_enable);
+	case REG_ARRAY_TARGET:
+		return reg_array->read((element_address - base) / reg_array->stride, byte_enable);
+	case MEM_TARGET:
+		return mem->read(element_address - base, byte_enable);
+	case MAP_ARRAY_TARGET: {
+		int unsigned index;
+		amiq_rm_reg_address_t element_offset;
+		if (map_array->find(element_address - base, index, element_offset))
+			return map_array->read(index, byte_enable);
+		break;
+	}
+	}
+	return make_pair((amiq_rm_reg_data_t) 0, HOLE);
+}
+
+amiq_rm_status_t amiq_rm_decode_target::write(amiq_rm_reg_address_t element_address, amiq_rm_reg_data_t write_data, int unsigned byte_enable) {
+	switch (kind) {
+	case REG_TARGET:
+		return reg->write(write_data, byte_enable);
+	case REG_ARRAY_TARGET:
+		return reg_array->write((element_address - base) / reg_array->stride, write_data, byte_enable);
+	case MEM_TARGET:
+		return mem->write(element_address - base, write_data, byte_enable);
+	case MAP_ARRAY_TARGET: {
+		int unsigned index;
+		amiq_rm_reg_address_t element_offset;
+		if (map_array->find(element_address - base, index, element_offset))
+			return map_array->write(index, write_data, byte_enable);
+		break;
+	}
+	}
+	return HOLE;
+}
+
+pair<amiq_rm_reg_data_t, amiq_rm_status_t> amiq_rm_decode_target::read(amiq_rm_reg_address_t address) {
+	int unsigned index;
+	switch (kind) {
+	case REG_TARGET:
+		if (address == base)
+			return reg->read();
+		break;
+	case REG_ARRAY_TARGET:
+		if (get_index(address, index))
+			return reg_array->read(index);
+		break;
+	case MAP_ARRAY_TARGET:
+		if (get_index(address, index))
+			return map_array->read(index);
+		break;
+	case MEM_TARGET:
+		return mem->read(address - base);
+	}
+	return make_pair((amiq_rm_reg_data_t) 0, HOLE);
+}
+
+amiq_rm_status_t amiq_rm_decode_target::write(amiq_rm_reg_address_t address, amiq_rm_reg_data_t write_data) {
+	int unsigned index;
+	switch (kind) {
+	case REG_TARGET:
+		if (address == base)
+			return reg->write(write_data);
+		break;
+	case REG_ARRAY_TARGET:
+		if (get_index(address, index))
+			return reg_array->write(index, write_data);
+		break;
+	case MAP_ARRAY_TARGET:
+		if (get_index(address, index))
+			return map_array->write(index, write_data);
+		break;
+	case MEM_TARGET:
+		return mem->write(address - base, write_data);
+	}
+	return HOLE;
+}
+
+amiq_rm_reg_data_t amiq_rm_decode_target::get(amiq_rm_reg_address_t address) {
+	int unsigned index;
+	//the lookups must stay outside of assert() as they are needed when NDEBUG is defined too
+	switch (kind) {
+	case REG_TARGET:
+		if (address == base)
+			return reg->get();
+		break;
+	case REG_ARRAY_TARGET:
+		if (get_index(address, index))
+			return reg_array->get(index);
+		break;
+	case MAP_ARRAY_TARGET:
+		if (get_index(address, index))
+			return map_array->get(index);
+		break;
+	case MEM_TARGET:
+		return mem->get(address - base);
+	}
+	//the address must select an element of the target
+	assert(0);
+	return 0;
+}
+
+void amiq_rm_decode_target::set(amiq_rm_reg_address_t address, amiq_rm_reg_data_t write_data) {
+	int unsigned index;
+	//the lookups must stay outside of assert() as they are needed when NDEBUG is defined too
+	switch (kind) {
+	case REG_TARGET:
+		if (address == base) {
+			reg->set(write_data);
+			return;
+		}
+		break;
+	case REG_ARRAY_TARGET:
+		if (get_index(address, index)) {
+			reg_array->set(index, write_data);
+			return;
+		}
+		break;
+	case MAP_ARRAY_TARGET:
+		if (get_index(address, index)) {
+			map_array->set(index, write_data);
+			return;
+		}
+		break;
+	case MEM_TARGET:
+		mem->set(address - base, write_data);
+		return;
+	}
+	//the address must select an element of the target
+	assert(0);
+}
+
+amiq_rm_target_table::amiq_rm_target_table(vector<amiq_rm_decode_target*> &my_targets) {
+	targets.swap(my_targets);
+	max_lasts.reserve(targets.size());
+	amiq_rm_reg_address_t max_last = 0;
+	for (int unsigned i = 0; i < targets.size(); i++) {
+		amiq_rm_reg_address_t last = targets[i]->base + targets[i]->size - 1;
+		if ((i + 1 < targets.size()) && (last >= targets[i + 1]->base)) {
+			amiq_rm_reg_address_t spanning_last = spanning_max_lasts.empty() ? 0 : spanning_max_lasts.back();
+			spanning_targets.push_back(i);
+			spanning_max_lasts.push_back((spanning_last > last) ? spanning_last : last);
+		} else if (last > max_last) {
+			max_last = last;
+		}
+		max_lasts.push_back(max_last);
+	}
+}
+
+int unsigned amiq_rm_target_table::find_first_target(amiq_rm_reg_address_t address) {
+	vector<int unsigned> spanning;
+	int unsigned first = find_first_target(address, spanning);
+	return spanning.empty() ? first : spanning[0];
+}
+
+int unsigned amiq_rm_target_table::find_first_target(amiq_rm_reg_address_t address, vector<int unsigned> &spanning) {
+	int unsigned first = lower_bound(max_lasts.begin(), max_lasts.end(), address) - max_lasts.begin();
+	spanning.clear();
+	int unsigned k = lower_bound(spanning_max_lasts.begin(), spanning_max_lasts.end(), address) - spanning_max_lasts.begin();
+	for (; (k < spanning_targets.size()) && (spanning_targets[k] < first); k++) {
+		amiq_rm_decode_target *target = targets[spanning_targets[k]];
+		if (target->base + target->size - 1 >= address)
+			spanning.push_back(spanning_targets[k]);
+	}
+	return first;
+}
+
+void amiq_rm_target_table::find_targets(amiq_rm_reg_address_t lo, amiq_rm_reg_address_t hi, vector<int unsigned> &positions) {
+	vector<int unsigned> spanning;
+	int unsigned i = find_first_target(lo, spanning);
+	positions.clear();
+	for (int unsigned k = 0; k < spanning.size(); k++) {
+		if (targets[spanning[k]]->base <= hi)
+			positions.push_back(spanning[k]);
+	}
+	for (; (i < targets.size()) && (targets[i]->base <= hi); i++)
+		positions.push_back(i);
+}
+
+amiq_rm_radix_decoder::amiq_rm_radix_node* amiq_rm_radix_decoder::new_node(amiq_rm_decode_target *fill) {
+	amiq_rm_radix_node *node = new amiq_rm_radix_node;
+	for (int unsigned i = 0; i < AMIQ_RM_RADIX_SLOTS; i++) {
+		node->targets[i] = fill;
+		node->children[i] = NULL;
+	}
+	nof_nodes++;
+	return node;
+}
+
+void amiq_rm_radix_decoder::delete_node(amiq_rm_radix_node *node) {
+	for (int unsigned i = 0; i < AMIQ_RM_RADIX_SLOTS; i++) {
+		if (node->children[i] != NULL)
+			delete_node(node->children[i]);
+	}
+	delete node;
+	nof_nodes--;
+}
+
+int unsigned amiq_rm_radix_decoder::count_nodes(amiq_rm_radix_node *node) {
+	int unsigned nof_sub_nodes = 1;
+	for (int unsigned i = 0; i < AMIQ_RM_RADIX_SLOTS; i++) {
+		if (node->children[i] != NULL)
+			nof_sub_nodes += count_nodes(node->children[i]);
+	}
+	return nof_sub_nodes;
+}
+
+void amiq_rm_radix_decoder::free_nodes(void *node) {
+	amiq_rm_radix_node *my_node = (amiq_rm_radix_node*) node;
+	for (int unsigned i = 0; i < AMIQ_RM_RADIX_SLOTS; i++) {
+		if (my_node->children[i] != NULL)
+			free_nodes(my_node->children[i]);
+	}
+	delete my_node;
+}
+
+void amiq_rm_radix_decoder::free_target(void *target) {
+	delete (amiq_rm_decode_target*) target;
+}
+
+void amiq_rm_radix_decoder::release_node(amiq_rm_radix_node *node) {
+	if (!deferred_deletion) {
+		delete_node(node);
+		return;
+	}
+	nof_nodes -= count_nodes(node);
+	amiq_rm_rcu::get().retire(node, free_nodes);
+}
+
+void amiq_rm_radix_decoder::free_table(void *table) {
+	delete (amiq_rm_target_table*) table;
+}
+
+void amiq_rm_radix_decoder::clear() {
+	if (root != NULL) {
+		delete_node(root);
+		root = NULL;
+	}
+	for (int unsigned i = 0; i < table->targets.size(); i++)
+		delete table->targets[i];
+	delete table;
+	table = new amiq_rm_target_table();
+	nof_levels = 0;
+}
+
+bool amiq_rm_radix_decoder::is_built() {
+	return (root != NULL);
+}
+
+int unsigned amiq_rm_radix_decoder::get_nof_levels() {
+	return nof_levels;
+}
+
+int unsigned amiq_rm_radix_decoder::get_nof_nodes() {
+	return nof_nodes;
+}
+
+vector<amiq_rm_decode_target*> amiq_rm_radix_decoder::get_targets() {
+	return get_table()->targets;
+}
+
+int unsigned amiq_rm_radix_decoder::find_first_target(amiq_rm_reg_address_t address) {
+	return get_table()->find_first_target(address);
+}
+
+void amiq_rm_radix_decoder::find_targets(amiq_rm_reg_address_t lo, amiq_rm_reg_address_t hi, vector<int unsigned> &positions) {
+	get_table()->find_targets(lo, hi, positions);
+}
+
+void amiq_rm_radix_decoder::collect(amiq_rm_address_map &map, amiq_rm_reg_address_t base, string path, amiq_rm_address_map *submap,
+		vector<amiq_rm_decode_target*> &list) {
+	for (amiq_rm_address_map::amiq_rm_reg_map_t::iterator it = map.regs.begin(); it != map.regs.end(); it++) {
+		amiq_rm_decode_target *target = new amiq_rm_decode_target();
+		target->kind = REG_TARGET;
+		target->base = base + it->first;
+		target->size = it->second->get_nof_bytes();
+		target->reg = it->second;
+		target->path = path + it->second->name;
+		target->submap = submap;
+		list.push_back(target);
+	}
+
+	for (amiq_rm_address_map::amiq_rm_reg_array_map_t::iterator it = map.reg_arrays.begin(); it != map.reg_arrays.end(); it++) {
+		amiq_rm_decode_target *target = new amiq_rm_decode_target();
+		target->kind = REG_ARRAY_TARGET;
+		target->base = base + it->first;
+		target->size = it->second->stride * it->second->count;
+		target->reg_array = it->second;
+		target->path = path + it->second->name;
+		target->submap = submap;
+		list.push_back(target);
+	}
+
+	for (amiq_rm_address_map::amiq_rm_map_array_map_t::iterator it = map.map_arrays.begin(); it != map.map_arrays.end(); it++) {
+		if (it->second->get_capacity() == 0)
+			continue;
+		amiq_rm_decode_target *target = new amiq_rm_decode_target();
+		target->kind = MAP_ARRAY_TARGET;
+		target->base = base + it->first;
+		target->size = it->second->stride * it->second->get_capacity();
+		target->map_array = it->second;
+		target->path = path + it->second->name;
+		target->submap = submap;
+		list.push_back(target);
+	}
+
+	for (amiq_rm_address_map::amiq_rm_mem_map_t::iterator it = map.mems.begin(); it != map.mems.end(); it++) {
+		amiq_rm_decode_target *target = new amiq_rm_decode_target();
+		target->kind = MEM_TARGET;
+		target->base = base + it->first;
+		target->size = it->second->size;
+		target->mem = it->second;
+		target->path = path + it->second->name;
+		target->submap = submap;
+		list.push_back(target);
+	}
+
+	for (amiq_rm_address_map::amiq_rm_addressmap_map_t::iterator it = map.submaps.begin(); it != map.submaps.end(); it++) {
+		collect(*(it->second), base + it->first, path + it->second->name + ".", (submap == NULL) ? it->second : submap, list);
+	}
+}
+
+void amiq_rm_radix_decoder::insert(amiq_rm_radix_node *node, int unsigned shift, amiq_rm_reg_address_t lo, amiq_rm_reg_address_t hi,
+		amiq_rm_decode_target *target) {
+	amiq_rm_reg_address_t slot_mask = (shift == 0) ? 0 : ((((amiq_rm_reg_address_t) 1) << shift) - 1);
+	amiq_rm_reg_address_t node_mask = (shift + AMIQ_RM_RADIX_BITS >= 8 * sizeof(amiq_rm_reg_address_t)) ?
+			~((amiq_rm_reg_address_t) 0) : ((((amiq_rm_reg_address_t) 1) << (shift + AMIQ_RM_RADIX_BITS)) - 1);
+	amiq_rm_reg_address_t node_base = lo & ~node_mask;
+	int unsigned first_slot = (lo >> shift) & (AMIQ_RM_RADIX_SLOTS - 1);
+	int unsigned last_slot = (hi >> shift) & (AMIQ_RM_RADIX_SLOTS - 1);
+
+	for (int unsigned slot = first_slot; slot <= last_slot; slot++) {
+		amiq_rm_reg_address_t slot_lo = node_base | (((amiq_rm_reg_address_t) slot) << shift);
+		amiq_rm_reg_address_t slot_hi = slot_lo | slot_mask;
+		if ((target == NULL) && (node->targets[slot] == NULL) && (node->children[slot] == NULL))
+			continue;
+
+		//the slots are stored in an order which lets the concurrent decode() find either the old or the new content
+		if ((lo <= slot_lo) && (hi >= slot_hi)) {
+			//the range covers the whole slot: the target is placed directly in this node
+			amiq_rm_radix_node *child = node->children[slot];
+			__atomic_store_n(&node->targets[slot], target, __ATOMIC_RELEASE);
+			if (child != NULL) {
+				__atomic_store_n(&node->children[slot], (amiq_rm_radix_node*) NULL, __ATOMIC_RELEASE);
+				release_node(child);
+			}
+		} else {
+			//the range covers part of the slot: descend, keeping what the slot decoded before for the rest of it
+			if (node->children[slot] == NULL) {
+				__atomic_store_n(&node->children[slot], new_node(node->targets[slot]), __ATOMIC_RELEASE);
+				__atomic_store_n(&node->targets[slot], (amiq_rm_decode_target*) NULL, __ATOMIC_RELEASE);
+			}
+			amiq_rm_radix_node *child = node->children[slot];
+			insert(child, shift - AMIQ_RM_RADIX_BITS, (lo > slot_lo) ? lo : slot_lo, (hi < slot_hi) ? hi : slot_hi, target);
+
+			//a child which decodes its whole range to one target (or to a hole, e.g. after relocate()) is replaced by the target
+			bool uniform = true;
+			for (int unsigned i = 0; uniform && (i < AMIQ_RM_RADIX_SLOTS); i++)
+				uniform = (child->children[i] == NULL) && (child->targets[i] == child->targets[0]);
+			if (uniform) {
+				__atomic_store_n(&node->targets[slot], child->targets[0], __ATOMIC_RELEASE);
+				__atomic_store_n(&node->children[slot], (amiq_rm_radix_node*) NULL, __ATOMIC_RELEASE);
+				release_node(child);
+			}
+		}
+	}
+}
+
+bool amiq_rm_radix_decoder::compare_bases(amiq_rm_decode_target *a, amiq_rm_decode_target *b) {
+	return (a->base < b->base);
+}
+
+void amiq_rm_radix_decoder::build(amiq_rm_address_map &map) {
+	clear();
+	vector<amiq_rm_decode_target*> list;
+	collect(map, 0, "", NULL, list);
+
+	amiq_rm_reg_address_t max_address = 0;
+	for (int unsigned i = 0; i < list.size(); i++) {
+		assert(list[i]->size > 0);
+		if (list[i]->base + list[i]->size - 1 > max_address)
+			max_address = list[i]->base + list[i]->size - 1;
+	}
+
+	nof_levels = 1;
+	while ((nof_levels < sizeof(amiq_rm_reg_address_t)) && ((max_address >> (AMIQ_RM_RADIX_BITS * nof_levels)) != 0))
+		nof_levels++;
+
+	root = new_node(NULL);
+
+	//for the targets of the same kind, the ones with higher addresses are placed later
+	stable_sort(list.begin(), list.end(), compare_bases);
+	delete table;
+	table = new amiq_rm_target_table(list);
+	insert_targets(table->targets, 0, ~((amiq_rm_reg_address_t) 0));
+}
+
+void amiq_rm_radix_decoder::insert_targets(vector<amiq_rm_decode_target*> &list, amiq_rm_reg_address_t lo, amiq_rm_reg_address_t hi) {
+	//lower priority targets are placed first, so that the ones placed later override them
+	amiq_rm_target_kind_t priority[] = { MEM_TARGET, MAP_ARRAY_TARGET, REG_ARRAY_TARGET, REG_TARGET };
+	for (int unsigned p = 0; p < 4; p++) {
+		for (int unsigned i = 0; i < list.size(); i++) {
+			amiq_rm_reg_address_t first = list[i]->base;
+			amiq_rm_reg_address_t last = list[i]->base + list[i]->size - 1;
+			if ((list[i]->kind == priority[p]) && (first <= hi) && (last >= lo)) {
+				insert(root, AMIQ_RM_RADIX_BITS * (nof_levels - 1), (first > lo) ? first : lo, (last < hi) ? last : hi, list[i]);
+			}
+		}
+	}
+}
+
+amiq_rm_reg_address_t amiq_rm_radix_decoder::get_max_address() {
+	if (nof_levels >= sizeof(amiq_rm_reg_address_t))
+		return ~((amiq_rm_reg_address_t) 0);
+	return (((amiq_rm_reg_address_t) 1) << (AMIQ_RM_RADIX_BITS * nof_levels)) - 1;
+}
+
+bool amiq_rm_radix_decoder::is_range_free(amiq_rm_reg_address_t lo, amiq_rm_reg_address_t hi, amiq_rm_address_map *ignored_submap) {
+	vector<int unsigned> positions;
+	table->find_targets(lo, hi, positions);
+	for (int unsigned i = 0; i < positions.size(); i++) {
+		if ((ignored_submap == NULL) || (table->targets[positions[i]]->submap != ignored_submap))
+			return false;
+	}
+	return true;
+}
+
+bool amiq_rm_radix_decoder::relocate(amiq_rm_address_map *submap, amiq_rm_reg_address_t lo, amiq_rm_reg_address_t hi, amiq_rm_reg_address_t new_lo, bool deferred) {
+	amiq_rm_reg_address_t new_hi = new_lo + (hi - lo);
+	assert((submap != NULL) && (lo <= hi));
+	bool disjoint = (new_hi < lo) || (new_lo > hi);
+	if ((root == NULL) || (new_hi < new_lo) || (new_hi > get_max_address()) || (deferred && !disjoint))
+		return false;
+
+	//the targets which reach the old range are either moved or placed again in the old range
+	vector<amiq_rm_decode_target*> moved;
+	vector<amiq_rm_decode_target*> new_targets;
+	vector<amiq_rm_decode_target*> kept;
+	vector<int unsigned> positions;
+	table->find_targets(lo, hi, positions);
+	for (int unsigned i = 0; i < positions.size(); i++) {
+		amiq_rm_decode_target *target = table->targets[positions[i]];
+		if ((target->base >= lo) && (target->submap == submap)) {
+			amiq_rm_decode_target *new_target = new amiq_rm_decode_target(*target);
+			new_target->base = target->base - lo + new_lo;
+			moved.push_back(target);
+			new_targets.push_back(new_target);
+		} else {
+			kept.push_back(target);
+		}
+	}
+
+	//when the ranges are disjoint, the sub-map is decoded at the new place before it is removed from the old one
+	deferred_deletion = deferred;
+	if (disjoint)
+		insert_targets(new_targets, new_lo, new_hi);
+	insert(root, AMIQ_RM_RADIX_BITS * (nof_levels - 1), lo, hi, NULL);
+	insert_targets(kept, lo, hi);
+	if (!disjoint)
+		insert_targets(new_targets, new_lo, new_hi);
+	deferred_deletion = false;
+
+	//a new table replaces the moved targets, both lists are sorted by base; the old table is not changed as it may be in use
+	vector<amiq_rm_decode_target*> &old_targets = table->targets;
+	vector<amiq_rm_decode_target*> merged;
+	merged.reserve(old_targets.size());
+	int unsigned next_moved = 0;
+	int unsigned next_new = 0;
+	for (int unsigned i = 0; i < old_targets.size(); i++) {
+		if ((next_moved < moved.size()) && (old_targets[i] == moved[next_moved])) {
+			next_moved++;
+			continue;
+		}
+		for (; (next_new < new_targets.size()) && compare_bases(new_targets[next_new], old_targets[i]); next_new++)
+			merged.push_back(new_targets[next_new]);
+		merged.push_back(old_targets[i]);
+	}
+	merged.insert(merged.end(), new_targets.begin() + next_new, new_targets.end());
+	amiq_rm_target_table *old_table = table;
+	__atomic_store_n(&table, new amiq_rm_target_table(merged), __ATOMIC_RELEASE);
+	if (deferred)
+		amiq_rm_rcu::get().retire(old_table, free_table);
+	else
+		delete old_table;
+
+	for (int unsigned i = 0; i < moved.size(); i++) {
+		if (deferred)
+			amiq_rm_rcu::get().retire(moved[i], free_target);
+		else
+			delete moved[i];
+	}
+	return true;
+}
+
+}
+
+#endif
@@ -0,0 +1,379 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_decoder.hpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef AMIQ_RM_DECODER_HEADER
+#define AMIQ_RM_DECODER_HEADER 1
+
+#include "amiq_rm_types.cpp"
+#include "amiq_rm_reg.hpp"
+#include "amiq_rm_reg_array.hpp"
+#include "amiq_rm_map_array.hpp"
+#include "amiq_rm_mem.hpp"
+#include <vector>
+
+namespace amiq_rm {
+
+class amiq_rm_address_map;
+
+typedef enum {
+	REG_TARGET = 0x0, REG_ARRAY_TARGET = 0x1, MEM_TARGET = 0x2, MAP_ARRAY_TARGET = 0x3
+} amiq_rm_target_kind_t;
+
+/** This class describes what is found in a range of absolute addresses: a register, a register array, a map array or a memory.
+ * It is the result of the address decoding done by amiq_rm_radix_decoder and it forwards the accesses to the decoded element. */
+class amiq_rm_decode_target {
+public:
+	/** The kind of the decoded element, it selects which one of @b reg, @b reg_array, @b map_array or @b mem is valid. */
+	amiq_rm_target_kind_t kind;
+
+	/** The absolute address of the first byte of the range. */
+	amiq_rm_reg_address_t base;
+
+	/** The number of bytes of the range. */
+	amiq_rm_reg_address_t size;
+
+	/** The decoded register (valid for REG_TARGET). */
+	amiq_rm_reg *reg;
+
+	/** The decoded register array (valid for REG_ARRAY_TARGET). */
+	amiq_rm_reg_array *reg_array;
+
+	/** The decoded memory (valid for MEM_TARGET). */
+	amiq_rm_mem *mem;
+
+	/** The decoded map array (valid for MAP_ARRAY_TARGET). */
+	amiq_rm_map_array *map_array;
+
+	/** The path of the element relative to the decoded map (e.g. "sub.reg", "" for the elements found by the recursive search). */
+	std::string path;
+
+	/** The sub-map of the decoded map which contains the element, directly or in one of its sub-maps (NULL for the elements of the
+	 * decoded map itself). It identifies the targets moved by amiq_rm_radix_decoder::relocate(). */
+	amiq_rm_address_map *submap;
+
+	/** Create an empty target. */
+	amiq_rm_decode_target() {
+		kind = REG_TARGET;
+		base = 0;
+		size = 0;
+		reg = NULL;
+		reg_array = NULL;
+		mem = NULL;
+		map_array = NULL;
+		submap = NULL;
+	}
+
+	/** @param address is an absolute address from the range of the target
+	 * @returns the value read from the element found at the address as well as the status of the read operation.
+	 * HOLE is returned if the address is not the one of an element (see get_index()). */
+	std::pair<amiq_rm_reg_data_t, amiq_rm_status_t> read(amiq_rm_reg_address_t address);
+
+	/** @param address is an absolute address from the range of the target
+	 * @param write_data is the data that is going to be written
+	 * @returns the status of the write operation. HOLE is returned if the address is not the one of an element (see get_index()). */
+	amiq_rm_status_t write(amiq_rm_reg_address_t address, amiq_rm_reg_data_t write_data);
+
+	/** @param address is an absolute address from the range of the target, there must be an element at the address
+	 * @returns the value of the element found at the address, without applying masks or hooks */
+	amiq_rm_reg_data_t get(amiq_rm_reg_address_t address);
+
+	/** @param address is an absolute address from the range of the target, there must be an element at the address
+	 * @param write_data is the value set to the element found at the address, without applying masks or hooks */
+	void set(amiq_rm_reg_address_t address, amiq_rm_reg_data_t write_data);
+
+	/** @param address is an absolute address from the range of the target
+	 * @param index is set to the index of the register array element (or of the map array value) found at the address
+	 * @returns true if there is an element at the address: true for a register if the address is the one of the register,
+	 * true for a register array if the address is the one of an element, true for a map array if the address is the one of
+	 * a register of an instance, true for a memory if a whole word fits between the address and the end of the memory */
+	bool get_index(amiq_rm_reg_address_t address, int unsigned &index);
+
+	/** The function finds the element which contains a byte, it is used to split sub-word and unaligned accesses.
+	 * The element of a memory is the word which starts at the byte (limited by the end of the memory).
+	 * @param address is an absolute address from the range of the target
+	 * @param element_address is set to the absolute address of the first byte of the element
+	 * @param nof_bytes is set to the number of bytes of the element
+	 * @returns false if the byte is not covered by an element (e.g. it falls between the elements of a register array) */
+	bool get_element(amiq_rm_reg_address_t address, amiq_rm_reg_address_t &element_address, int unsigned &nof_bytes);
+
+	/** @param element_address is the absolute address of an element, as returned by get_element()
+	 * @param byte_enable selects the byte lanes of the element which are read
+	 * @returns the value of the enabled lanes of the element as well as the status of the read operation. */
+	std::pair<amiq_rm_reg_data_t, amiq_rm_status_t> read(amiq_rm_reg_address_t element_address, int unsigned byte_enable);
+
+	/** @param element_address is the absolute address of an element, as returned by get_element()
+	 * @param write_data is the data that is going to be written to the enabled lanes
+	 * @param byte_enable selects the byte lanes of the element which are written
+	 * @returns the status of the write operation. */
+	amiq_rm_status_t write(amiq_rm_reg_address_t element_address, amiq_rm_reg_data_t write_data, int unsigned byte_enable);
+};
+
+/** This class holds the targets of an amiq_rm_radix_decoder sorted by base address, with the indexes used to find the targets which
+ * reach a range. A table is not changed once it is built: amiq_rm_radix_decoder::relocate() replaces it with a new table, so a thread
+ * which walks the targets meanwhile (e.g. an amiq_rm_reg_iterator) keeps a consistent view of them. */
+class amiq_rm_target_table {
+public:
+	/** The targets, sorted by base address. They are owned by the decoder. */
+	std::vector<amiq_rm_decode_target*> targets;
+
+	/** Create an empty table. */
+	amiq_rm_target_table() {
+	}
+
+	/** Create a table and compute its indexes.
+	 * @param my_targets are the targets, sorted by base address; they are moved into the table, the vector is left empty */
+	amiq_rm_target_table(std::vector<amiq_rm_decode_target*> &my_targets);
+
+	/** There are no pointers to delete, the targets belong to the decoder. */
+	virtual ~amiq_rm_target_table() {
+	}
+
+	/** The function finds with a binary search where a walk of the targets which reach an address must start.
+	 * @param address is an absolute address
+	 * @returns the position of the first target (in the order of the base addresses) whose range ends at or after the address,
+	 * the number of targets if there is no such target */
+	int unsigned find_first_target(amiq_rm_reg_address_t address);
+
+	/** The function finds where a walk of the targets which reach an address must start, without being sent back by the spanning
+	 * targets (large targets which overlap the following ones, e.g. a memory with registers placed over it): the walk starts at the
+	 * first target which is not spanning and the spanning targets placed before it are returned separately. All the targets from the
+	 * returned position on reach the address.
+	 * @param address is an absolute address
+	 * @param spanning is filled with the positions of the spanning targets placed before the returned position which reach the address
+	 * @returns the position of the first target which is not spanning and whose range ends at or after the address,
+	 * the number of targets if there is no such target */
+	int unsigned find_first_target(amiq_rm_reg_address_t address, std::vector<int unsigned> &spanning);
+
+	/** @param lo is the first address of the range
+	 * @param hi is the last address of the range
+	 * @param positions is filled with the positions of the targets which cover an address of [lo, hi], in the order of the base addresses */
+	void find_targets(amiq_rm_reg_address_t lo, amiq_rm_reg_address_t hi, std::vector<int unsigned> &positions);
+
+private:
+	/** max_lasts[i] is the highest address covered by the targets of targets[0..i] which are not spanning (see @b spanning_targets),
+	 * used by find_first_target(). A large target which overlaps the following ones (e.g. a memory with registers placed over it)
+	 * is kept out of it, otherwise all the following entries would be raised to its last address. */
+	std::vector<amiq_rm_reg_address_t> max_lasts;
+
+	/** The positions in @b targets of the spanning targets: the targets which overlap the next target. There are few of them. */
+	std::vector<int unsigned> spanning_targets;
+
+	/** spanning_max_lasts[k] is the highest address covered by the spanning targets spanning_targets[0..k]. */
+	std::vector<amiq_rm_reg_address_t> spanning_max_lasts;
+};
+
+/** This class implements a page-table-like decoder of absolute addresses. It is built from an address map hierarchy (usually
+ * by amiq_rm_physical_address_map::build()) and resolves an address with one array lookup for each byte of the highest address
+ * which is mapped, no matter how sparse or how deep the hierarchy is (e.g. 4 lookups for a 32-bit address space, 6 lookups for 48-bit).
+ * @n Each node of the trie has one slot for each value of an address byte. A slot points either to a target which covers the whole
+ * range of addresses of the slot (e.g. a large memory) or to the node of the next level. */
+class amiq_rm_radix_decoder {
+public:
+	/** Number of address bits decoded by one level of the trie. */
+	static const int unsigned AMIQ_RM_RADIX_BITS = 8;
+
+	/** Number of slots of one node of the trie. */
+	static const int unsigned AMIQ_RM_RADIX_SLOTS = 1 << AMIQ_RM_RADIX_BITS;
+
+	/** Create an empty decoder, all addresses are decoded as holes until build() is called. */
+	amiq_rm_radix_decoder() {
+		root = NULL;
+		nof_levels = 0;
+		nof_nodes = 0;
+		deferred_deletion = false;
+		table = new amiq_rm_target_table();
+	}
+
+	/** Delete the trie and the targets. */
+	virtual ~amiq_rm_radix_decoder() {
+		clear();
+		delete table;
+	}
+
+	/** The function builds the trie from all registers, register arrays and memories mapped under an address map. The previous content
+	 * of the decoder is removed. A register covers the bytes of its fields (amiq_rm_reg::get_nof_bytes()) and a map array is one target
+	 * which covers all its instances. If ranges overlap, registers take precedence over register arrays, which take precedence over
+	 * map arrays, which take precedence over memories and, between two
+	 * elements of the same kind, the one with the higher address takes precedence (so the first byte of an element always decodes to it).
+	 * @param map is the address map whose offsets are used as absolute addresses */
+	void build(amiq_rm_address_map &map);
+
+	/** The function removes the trie and the targets. */
+	void clear();
+
+	/** @returns true if build() was called and clear() was not called after it. */
+	bool is_built();
+
+	/** @param address is the absolute address which is decoded
+	 * @returns a pointer to the target which contains the address or NULL if the address is not mapped. */
+	amiq_rm_decode_target* decode(amiq_rm_reg_address_t address) {
+		if ((root == NULL) || ((nof_levels < sizeof(amiq_rm_reg_address_t)) && ((address >> (AMIQ_RM_RADIX_BITS * nof_levels)) != 0)))
+			return NULL;
+
+		//the slots are loaded atomically, as relocate() may change them while other threads decode
+		amiq_rm_radix_node *node = root;
+		for (int unsigned shift = AMIQ_RM_RADIX_BITS * (nof_levels - 1);; shift -= AMIQ_RM_RADIX_BITS) {
+			int unsigned slot = (address >> shift) & (AMIQ_RM_RADIX_SLOTS - 1);
+			amiq_rm_decode_target *target = __atomic_load_n(&node->targets[slot], __ATOMIC_ACQUIRE);
+			if ((target != NULL) || (shift == 0))
+				return target;
+			amiq_rm_radix_node *child = __atomic_load_n(&node->children[slot], __ATOMIC_ACQUIRE);
+			if (child == NULL)
+				//the child is removed only after the target which replaces it was stored
+				return __atomic_load_n(&node->targets[slot], __ATOMIC_ACQUIRE);
+			node = child;
+		}
+	}
+
+	/** @returns the number of levels of the trie (the number of lookups needed to decode an address). */
+	int unsigned get_nof_levels();
+
+	/** @returns the number of nodes of the trie. */
+	int unsigned get_nof_nodes();
+
+	/** @returns all targets of the decoder, sorted by base address. */
+	std::vector<amiq_rm_decode_target*> get_targets();
+
+	/** @returns the table of the targets. After enable_rcu() of the physical map, a table replaced by relocate() stays valid until the
+	 * read-side sections which may use it end, so a walk of the targets by another thread must be done in a read-side section. */
+	amiq_rm_target_table* get_table() {
+		return __atomic_load_n(&table, __ATOMIC_ACQUIRE);
+	}
+
+	/** @returns the number of targets of the decoder. */
+	int unsigned get_nof_targets() {
+		return get_table()->targets.size();
+	}
+
+	/** @param index is the position of the target in the order of the base addresses
+	 * @returns the target */
+	amiq_rm_decode_target* get_target(int unsigned index) {
+		return get_table()->targets[index];
+	}
+
+	/** The function finds the first target which reaches an address (see amiq_rm_target_table::find_first_target()).
+	 * @param address is an absolute address
+	 * @returns the position of the first target whose range ends at or after the address, get_nof_targets() if there is no such target */
+	int unsigned find_first_target(amiq_rm_reg_address_t address);
+
+	/** The function finds the targets which cover a range (see amiq_rm_target_table::find_targets()).
+	 * @param lo is the first address of the range
+	 * @param hi is the last address of the range
+	 * @param positions is filled with the positions of the targets which cover an address of [lo, hi], in the order of the base addresses */
+	void find_targets(amiq_rm_reg_address_t lo, amiq_rm_reg_address_t hi, std::vector<int unsigned> &positions);
+
+	/** @returns the highest address which can be decoded without adding levels to the trie. */
+	amiq_rm_reg_address_t get_max_address();
+
+	/** @param lo is the first address of the range
+	 * @param hi is the last address of the range
+	 * @param ignored_submap is a sub-map of the decoded map whose targets are not taken into account (NULL to take all of them)
+	 * @returns true if no target covers an address of [lo, hi] */
+	bool is_range_free(amiq_rm_reg_address_t lo, amiq_rm_reg_address_t hi, amiq_rm_address_map *ignored_submap);
+
+	/** The function moves the targets of a sub-map (e.g. after its base was changed) without building the decoder again: only the
+	 * nodes of the old and of the new range are changed, and the targets of the other elements which overlap the old range are placed
+	 * again in it. The moved targets are replaced by copies with the new bases. The new range must be free (see is_range_free()).
+	 * @n The slots are changed with atomic stores, the table of the targets is replaced by a new one and the removed nodes, targets and
+	 * table can be retired through amiq_rm_rcu, so other threads can decode and walk the targets during the call: each decode returns
+	 * the element at its old or at its new place. If the two ranges overlap, the part of the sub-map which is being moved would be
+	 * decoded as a hole for a while, so the relocation is refused when the removed parts are retired.
+	 * @n The table is copied (O(n) pointer copies for @b n targets), the trie is only changed for the two ranges.
+	 * @param submap is the sub-map of the decoded map whose targets are moved (see amiq_rm_decode_target::submap)
+	 * @param lo is the first address of the old range of the sub-map
+	 * @param hi is the last address of the old range of the sub-map
+	 * @param new_lo is the first address of the new range
+	 * @param deferred if set, the removed nodes and targets are retired with amiq_rm_rcu::get() instead of being deleted
+	 * @returns false if the new range does not fit in the levels of the trie or if the ranges overlap while @b deferred is set (nothing
+	 * is changed, the decoder must be built again) */
+	bool relocate(amiq_rm_address_map *submap, amiq_rm_reg_address_t lo, amiq_rm_reg_address_t hi, amiq_rm_reg_address_t new_lo, bool deferred);
+
+private:
+	/** A node of the trie. For a slot, at most one of targets[slot] and children[slot] is not NULL. */
+	struct amiq_rm_radix_node {
+		amiq_rm_decode_target *targets[AMIQ_RM_RADIX_SLOTS];
+		amiq_rm_radix_node *children[AMIQ_RM_RADIX_SLOTS];
+	};
+
+	/** The root node of the trie. */
+	amiq_rm_radix_node *root;
+
+	/** The number of levels of the trie. */
+	int unsigned nof_levels;
+
+	/** The number of nodes of the trie. */
+	int unsigned nof_nodes;
+
+	/** The table of the targets referred by the trie, the targets are owned by the decoder. It is accessed atomically. */
+	amiq_rm_target_table *table;
+
+	/** Set during relocate() if the removed nodes and targets are retired instead of being deleted. */
+	bool deferred_deletion;
+
+	/** @returns true if target @b a starts at a lower address than target @b b. */
+	static bool compare_bases(amiq_rm_decode_target *a, amiq_rm_decode_target *b);
+
+	/** @returns a new node whose slots all point to the given target (which may be NULL). */
+	amiq_rm_radix_node* new_node(amiq_rm_decode_target *fill);
+
+	/** The function deletes a node and all the nodes under it. */
+	void delete_node(amiq_rm_radix_node *node);
+
+	/** @returns the number of nodes of a sub-trie. */
+	static int unsigned count_nodes(amiq_rm_radix_node *node);
+
+	/** The function deletes a sub-trie without updating the number of nodes (it is the deleter of the retired sub-tries). */
+	static void free_nodes(void *node);
+
+	/** The function deletes a target (it is the deleter of the retired targets). */
+	static void free_target(void *target);
+
+	/** The function deletes a table of targets, not its targets (it is the deleter of the retired tables). */
+	static void free_table(void *table);
+
+	/** The function removes a sub-trie which was unlinked from the trie: it is deleted, or retired if @b deferred_deletion is set. */
+	void release_node(amiq_rm_radix_node *node);
+
+	/** The function places targets in the trie, in the order of their priority (see build()), limited to a range.
+	 * @param list are the targets, sorted by base address
+	 * @param lo is the first address of the range
+	 * @param hi is the last address of the range */
+	void insert_targets(std::vector<amiq_rm_decode_target*> &list, amiq_rm_reg_address_t lo, amiq_rm_reg_address_t hi);
+
+	/** The function collects recursively the targets of an address map (the map arrays are not descended into).
+	 * @param map is the address map which is traversed
+	 * @param base is the absolute address of the map
+	 * @param path is the path of the map ("" or ending with '.')
+	 * @param submap is the sub-map of the decoded map which contains the map (NULL for the decoded map itself)
+	 * @param list receives the new targets */
+	void collect(amiq_rm_address_map &map, amiq_rm_reg_address_t base, std::string path, amiq_rm_address_map *submap,
+			std::vector<amiq_rm_decode_target*> &list);
+
+	/** The function places a target in the trie for the range [lo, hi] (inclusive limits).
+	 * @param node is the node in which the range is placed
+	 * @param shift is the position of the address byte decoded by the node
+	 * @param lo is the first address of the range
+	 * @param hi is the last address of the range
+	 * @param target is the target placed in the trie */
+	void insert(amiq_rm_radix_node *node, int unsigned shift, amiq_rm_reg_address_t lo, amiq_rm_reg_address_t hi, amiq_rm_decode_target *target);
+};
+
+}
+
+#endif
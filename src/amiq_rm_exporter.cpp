@@ -0,0 +1,323 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_exporter.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef	AMIQ_RM_EXPORTER
+#define	AMIQ_RM_EXPORTER	1
+
+#include <assert.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "amiq_rm_exporter.hpp"
+#include "amiq_rm_address_map.hpp"
+
+using namespace std;
+
+namespace amiq_rm {
+
+/** Identifies a snapshot in BINARY_FORMAT. */
+static const char amiq_rm_snapshot_magic[8] = { 'A', 'M', 'I', 'Q', 'R', 'M', 'S', 'N' };
+
+/** The characters which make a CSV field to be quoted. */
+static const char amiq_rm_csv_special[] = ",\"\r\n";
+
+/** The digits used by put_hex(). */
+static const char amiq_rm_hex_digits[] = "0123456789abcdef";
+
+amiq_rm_exporter::amiq_rm_exporter(amiq_rm_export_format_t my_format, int unsigned buffer_size) {
+	assert(buffer_size >= 64);
+	format = my_format;
+	buffer.resize(buffer_size);
+	used = 0;
+	fd = -1;
+	owns_fd = false;
+	failed = false;
+	empty = true;
+	nof_records = 0;
+	nof_snapshot_records = 0;
+}
+
+bool amiq_rm_exporter::open(string file_name) {
+	close();
+	int file_fd = ::open(file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (file_fd < 0)
+		return false;
+
+	attach(file_fd);
+	owns_fd = true;
+	return true;
+}
+
+void amiq_rm_exporter::attach(int my_fd) {
+	close();
+	fd = my_fd;
+	owns_fd = false;
+	failed = false;
+	empty = true;
+	nof_records = 0;
+}
+
+bool amiq_rm_exporter::flush() {
+	int unsigned written = 0;
+	while ((written < used) && !failed) {
+		ssize_t result = (fd < 0) ? -1 : ::write(fd, &buffer[written], used - written);
+		if (result <= 0)
+			failed = true;
+		else
+			written += result;
+	}
+	used = 0;
+	return !failed;
+}
+
+bool amiq_rm_exporter::close() {
+	if (fd < 0)
+		return !failed;
+
+	flush();
+	if (owns_fd && (::close(fd) != 0))
+		failed = true;
+	fd = -1;
+	owns_fd = false;
+	return !failed;
+}
+
+long long unsigned amiq_rm_exporter::get_nof_records() {
+	return nof_records;
+}
+
+void amiq_rm_exporter::put(const char *bytes, int unsigned nof_bytes) {
+	while (nof_bytes > 0) {
+		if (used == buffer.size())
+			flush();
+		int unsigned chunk = buffer.size() - used;
+		if (chunk > nof_bytes)
+			chunk = nof_bytes;
+
+		memcpy(&buffer[used], bytes, chunk);
+		used += chunk;
+		bytes += chunk;
+		nof_bytes -= chunk;
+	}
+}
+
+void amiq_rm_exporter::put_string(const string &text) {
+	if ((format == BINARY_FORMAT) || ((format == CSV_FORMAT) && (text.find('"') == string::npos))) {
+		put(text.data(), text.size());
+		return;
+	}
+	for (int unsigned i = 0; i < text.size(); i++) {
+		unsigned char character = text[i];
+		if ((format == CSV_FORMAT) && (character == '"'))
+			put('"');
+		else if ((format == JSON_FORMAT) && ((character == '"') || (character == '\\')))
+			put('\\');
+		else if ((format == JSON_FORMAT) && (character < 0x20)) {
+			//the control characters are not allowed in a JSON string
+			put('\\');
+			switch (character) {
+			case '\b':
+				put('b');
+				break;
+			case '\f':
+				put('f');
+				break;
+			case '\n':
+				put('n');
+				break;
+			case '\r':
+				put('r');
+				break;
+			case '\t':
+				put('t');
+				break;
+			default:
+				put("u00", 3);
+				put(amiq_rm_hex_digits[character >> 4]);
+				put(amiq_rm_hex_digits[character & 0xF]);
+			}
+			continue;
+		}
+		put(character);
+	}
+}
+
+void amiq_rm_exporter::put_hex(uint64_t number) {
+	char digits[2 + 2 * sizeof(uint64_t)];
+	int unsigned position = sizeof(digits);
+	do {
+		digits[--position] = amiq_rm_hex_digits[number & 0xF];
+		number >>= 4;
+	} while (number != 0);
+	digits[--position] = 'x';
+	digits[--position] = '0';
+	put(&digits[position], sizeof(digits) - position);
+}
+
+void amiq_rm_exporter::put_dec(uint64_t number) {
+	char digits[20];
+	int unsigned position = sizeof(digits);
+	do {
+		digits[--position] = '0' + (number % 10);
+		number /= 10;
+	} while (number != 0);
+	put(&digits[position], sizeof(digits) - position);
+}
+
+void amiq_rm_exporter::export_record(const string &name, int unsigned index, amiq_rm_reg_address_t address, amiq_rm_reg_data_t value,
+		amiq_rm_reg &reg) {
+	if (format == BINARY_FORMAT) {
+		uint64_t record_address = address;
+		uint32_t record[2] = { value, 0 };
+		put((const char*) &record_address, sizeof(record_address));
+		put((const char*) record, sizeof(record));
+	} else {
+		//a CSV path is quoted only if needed, so the common paths stay readable
+		bool quoted = (format == CSV_FORMAT)
+				&& ((path.find_first_of(amiq_rm_csv_special) != string::npos) || (name.find_first_of(amiq_rm_csv_special) != string::npos));
+		if (format == JSON_FORMAT)
+			put((nof_snapshot_records == 0) ? "{\"path\":\"" : ",{\"path\":\"", (nof_snapshot_records == 0) ? 9 : 10);
+		if (quoted)
+			put('"');
+		put_string(path);
+		put_string(name);
+		if (index != AMIQ_RM_NO_INDEX) {
+			put('[');
+			put_dec(index);
+			put(']');
+		}
+		if (quoted)
+			put('"');
+
+		if (format == JSON_FORMAT) {
+			put("\",\"address\":\"", 13);
+			put_hex(address);
+			put("\",\"value\":\"", 11);
+			put_hex(value);
+			put("\",\"fields\":{", 12);
+			for (int unsigned i = 0; i < reg.fields.size(); i++) {
+				amiq_rm_field *field = reg.fields[i];
+				amiq_rm_reg_data_t field_mask = field->get_value_mask();
+				put((i == 0) ? "\"" : ",\"", (i == 0) ? 1 : 2);
+				put_string(field->name);
+				put("\":\"", 3);
+				put_hex((value >> field->lsb_position) & field_mask);
+				put('"');
+			}
+			put("}}", 2);
+		} else {
+			put(',');
+			put_hex(address);
+			put(',');
+			put_hex(value);
+			put('\n');
+		}
+	}
+	nof_snapshot_records++;
+}
+
+void amiq_rm_exporter::export_submap(amiq_rm_address_map &map, amiq_rm_reg_address_t base) {
+	for (amiq_rm_address_map::amiq_rm_reg_map_t::iterator it = map.regs.begin(); it != map.regs.end(); it++) {
+		export_record(it->second->name, AMIQ_RM_NO_INDEX, base + it->first, it->second->get(), *(it->second));
+	}
+
+	for (amiq_rm_address_map::amiq_rm_reg_array_map_t::iterator it = map.reg_arrays.begin(); it != map.reg_arrays.end(); it++) {
+		amiq_rm_reg_array *array = it->second;
+		for (int unsigned i = 0; i < array->count; i++)
+			export_record(array->name, i, base + it->first + i * array->stride, array->values[i], *(array->layout));
+	}
+
+	for (amiq_rm_address_map::amiq_rm_map_array_map_t::iterator it = map.map_arrays.begin(); it != map.map_arrays.end(); it++) {
+		amiq_rm_map_array *array = it->second;
+		int unsigned path_size = path.size();
+		for (int unsigned i = 0; i < array->count; i++) {
+			//the path of the instance is "array[i].", the digits are formatted in place
+			char digits[10];
+			int unsigned position = sizeof(digits);
+			int unsigned number = i;
+			do {
+				digits[--position] = '0' + (number % 10);
+				number /= 10;
+			} while (number != 0);
+			path += array->name;
+			path += '[';
+			path.append(&digits[position], sizeof(digits) - position);
+			path += "].";
+
+			for (int unsigned j = 0; j < array->slots.size(); j++) {
+				amiq_rm_map_array::amiq_rm_map_array_slot &slot = array->slots[j];
+				export_record(slot.path, AMIQ_RM_NO_INDEX, base + it->first + i * array->stride + slot.offset, array->values[i * array->slots.size() + j],
+						*(slot.reg));
+			}
+			path.resize(path_size);
+		}
+	}
+
+	for (amiq_rm_address_map::amiq_rm_addressmap_map_t::iterator it = map.submaps.begin(); it != map.submaps.end(); it++) {
+		int unsigned path_size = path.size();
+		path += it->second->name;
+		path += '.';
+		export_submap(*(it->second), base + it->first);
+		path.resize(path_size);
+	}
+}
+
+bool amiq_rm_exporter::export_map(amiq_rm_address_map &map) {
+	nof_snapshot_records = 0;
+	path = map.name;
+	path += '.';
+
+	switch (format) {
+	case CSV_FORMAT:
+		if (empty)
+			put("path,address,value\n", 19);
+		break;
+	case JSON_FORMAT:
+		put("{\"map\":\"", 8);
+		put_string(map.name);
+		put("\",\"registers\":[", 15);
+		break;
+	case BINARY_FORMAT: {
+		uint32_t name_size = map.name.size();
+		put(amiq_rm_snapshot_magic, sizeof(amiq_rm_snapshot_magic));
+		put((const char*) &name_size, sizeof(name_size));
+		put(map.name.data(), name_size);
+		break;
+	}
+	}
+
+	export_submap(map, 0);
+
+	if (format == JSON_FORMAT) {
+		put("]}\n", 3);
+	} else if (format == BINARY_FORMAT) {
+		uint64_t end_address = ~((uint64_t) 0);
+		uint32_t end_record[2] = { nof_snapshot_records, ~((uint32_t) 0) };
+		put((const char*) &end_address, sizeof(end_address));
+		put((const char*) end_record, sizeof(end_record));
+	}
+
+	empty = false;
+	nof_records += nof_snapshot_records;
+	return !failed;
+}
+
+}
+
+#endif
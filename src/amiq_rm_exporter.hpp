@@ -0,0 +1,158 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_exporter.hpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef AMIQ_RM_EXPORTER_HEADER
+#define AMIQ_RM_EXPORTER_HEADER 1
+
+#include "amiq_rm_types.cpp"
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace amiq_rm {
+
+class amiq_rm_address_map;
+class amiq_rm_reg;
+
+typedef enum {
+	CSV_FORMAT = 0x0, JSON_FORMAT = 0x1, BINARY_FORMAT = 0x2
+} amiq_rm_export_format_t;
+
+/** This class writes the state of a whole address map hierarchy (the values of the registers, of the register array elements and of
+ * the registers of the map array instances, with their paths and absolute addresses) to a file. The output is formatted directly in a buffer which is allocated once and is
+ * written to the file only when it is full, so many snapshots (e.g. one for each test phase) can be written to the same file.
+ * @n Formats, one record for each register, for each element of a register array and for each register of a map array instance:
+ * @li CSV_FORMAT: a "path,address,value" header followed by one line for each record, the numbers are hexadecimal; a path which contains
+ * a comma, a quote or a line break is enclosed in quotes and its quotes are doubled (RFC 4180)
+ * @li JSON_FORMAT: one line for each snapshot: {"map":..., "registers":[{"path":..., "address":..., "value":..., "fields":{...}}, ...]}
+ * @li BINARY_FORMAT: for each snapshot the magic "AMIQRMSN", the length (uint32_t) and the characters of the name of the map,
+ * then the records {uint64_t address, uint32_t value, uint32_t 0} and an end record {~0, number of records, ~0}, in the byte order of the host
+ * @n Memories (amiq_rm_mem) are not exported, as a snapshot holds register values; their contents can be saved with amiq_rm_mem::dump(). */
+class amiq_rm_exporter {
+public:
+	/** The default size of the buffer. */
+	static const int unsigned AMIQ_RM_EXPORT_BUFFER_SIZE = 1 << 20;
+
+	/** The format of the output. */
+	amiq_rm_export_format_t format;
+
+	/** Create new exporter, the output is selected with open() or attach().
+	 * @param my_format is the format of the output
+	 * @param buffer_size is the size of the buffer, at least 64 bytes */
+	amiq_rm_exporter(amiq_rm_export_format_t my_format, int unsigned buffer_size);
+
+	/** Flush the buffer and close the file. */
+	virtual ~amiq_rm_exporter() {
+		close();
+	}
+
+	/** The function creates (or truncates) the output file. A previous output is closed.
+	 * @param file_name is the name of the file
+	 * @returns false if the file could not be created */
+	bool open(std::string file_name);
+
+	/** The function selects an already open file descriptor as output (e.g. 1 for the standard output). The descriptor is not closed by close().
+	 * A previous output is closed.
+	 * @param my_fd is the file descriptor */
+	void attach(int my_fd);
+
+	/** The function writes a snapshot of an address map and of all its sub-maps. Absolute addresses are computed from the offsets
+	 * relative to @b map and the paths start with the name of @b map.
+	 * @param map is the address map which is exported
+	 * @returns false if a write to the output failed since the output was opened */
+	bool export_map(amiq_rm_address_map &map);
+
+	/** The function writes the content of the buffer to the output.
+	 * @returns false if a write to the output failed since the output was opened */
+	bool flush();
+
+	/** The function flushes the buffer and closes the output.
+	 * @returns false if a write to the output failed since the output was opened */
+	bool close();
+
+	/** @returns the number of records written since the output was opened. */
+	long long unsigned get_nof_records();
+
+private:
+	/** The buffer in which the output is formatted. */
+	std::vector<char> buffer;
+
+	/** The number of bytes of the buffer which are not written to the output yet. */
+	int unsigned used;
+
+	/** The output file descriptor, -1 if there is no output. */
+	int fd;
+
+	/** Set if the file descriptor was opened by open() (and must be closed by close()). */
+	bool owns_fd;
+
+	/** Set if a write to the output failed. */
+	bool failed;
+
+	/** Set if nothing was written to the output since it was opened (used for the CSV header). */
+	bool empty;
+
+	/** The number of records written since the output was opened. */
+	long long unsigned nof_records;
+
+	/** The number of records of the snapshot in progress. */
+	int unsigned nof_snapshot_records;
+
+	/** The path of the map which is exported, it is extended and truncated while descending in the hierarchy. */
+	std::string path;
+
+	/** The function appends a character to the buffer. */
+	void put(char c) {
+		if (used == buffer.size())
+			flush();
+		buffer[used++] = c;
+	}
+
+	/** The function appends bytes to the buffer. */
+	void put(const char *bytes, int unsigned nof_bytes);
+
+	/** The function appends a string to the buffer, escaping '"', '\' and the control characters (U+0000 to U+001F) for JSON_FORMAT and doubling '"' for CSV_FORMAT. */
+	void put_string(const std::string &text);
+
+	/** The function appends a number in hexadecimal format, with the "0x" prefix. */
+	void put_hex(uint64_t number);
+
+	/** The function appends a number in decimal format. */
+	void put_dec(uint64_t number);
+
+	/** The function writes the records of a map and of its sub-maps.
+	 * @param map is the map which is exported
+	 * @param base is the absolute address of the map */
+	void export_submap(amiq_rm_address_map &map, amiq_rm_reg_address_t base);
+
+	/** Value of the index of a record which is not an element of a register array. */
+	static const int unsigned AMIQ_RM_NO_INDEX = ~0U;
+
+	/** The function writes one record.
+	 * @param name is appended to @b path to get the path of the record
+	 * @param index is the index of the register array element, appended as "[index]", or AMIQ_RM_NO_INDEX
+	 * @param address is the absolute address of the record
+	 * @param value is the value of the register
+	 * @param reg is the register which defines the fields */
+	void export_record(const std::string &name, int unsigned index, amiq_rm_reg_address_t address, amiq_rm_reg_data_t value, amiq_rm_reg &reg);
+};
+
+}
+
+#endif
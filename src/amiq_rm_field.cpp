@@ -20,6 +20,7 @@
 #ifndef	AMIQ_RM_FIELD
 #define	AMIQ_RM_FIELD	1
 
+#include <assert.h>
 #include <sstream>
 #include <iostream>
 #include "amiq_rm_field.hpp"
@@ -61,6 +62,33 @@ bool amiq_rm_field::is_set_on_write() {
 	return ((attrib == "WS") || (attrib == "WSRC"));
 }
 
+void amiq_rm_field::add_signal(string signal_name) {
+	signals |= amiq_rm_signal::get_mask(amiq_rm_signal::get_id(signal_name));
+}
+
+void amiq_rm_field::set_rand_range(amiq_rm_reg_data_t my_min, amiq_rm_reg_data_t my_max) {
+	assert(my_min <= my_max);
+	rand_values.clear();
+	rand_range = true;
+	rand_min = my_min;
+	rand_max = my_max;
+}
+
+void amiq_rm_field::set_rand_values(const vector<amiq_rm_reg_data_t> &my_values) {
+	assert(my_values.size() > 0);
+	rand_values = my_values;
+	rand_range = false;
+}
+
+void amiq_rm_field::clear_rand_constraints() {
+	rand_values.clear();
+	rand_range = false;
+}
+
+bool amiq_rm_field::is_rand_constrained() {
+	return (rand_range || (rand_values.size() > 0));
+}
+
 string amiq_rm_field::to_string() {
 	ostringstream convert;
 	convert << name << " Lsb Position: " << lsb_position << " Size: " << size << " W: " << is_writable() << " R: " << is_readable() << " Reset: "
@@ -21,7 +21,10 @@
 #define AMIQ_RM_FIELD_HEADER 1
 
 #include "amiq_rm_types.cpp"
+#include "amiq_rm_signal.hpp"
+#include "amiq_rm_provider.hpp"
 #include <sstream>
+#include <vector>
 
 namespace amiq_rm {
 
@@ -61,6 +64,25 @@ public:
 	 * the attribute's behavior is extracted and used by the register at access. */
 	std::string attrib;
 
+	/** The mask of the aggregate signals to which the field contributes (see add_signal()). */
+	uint64_t signals;
+
+	/** If not NULL, the value of the field is pulled from the provider (see amiq_rm_value_provider). It is taken into account by the build()
+	 * of the register. The provider is not deleted by the field. */
+	amiq_rm_value_provider *provider;
+
+	/** If not empty, amiq_rm_reg::get_random_value() sets the field to one of these values. */
+	std::vector<amiq_rm_reg_data_t> rand_values;
+
+	/** If set (and @b rand_values is empty), amiq_rm_reg::get_random_value() sets the field to a value from [rand_min, rand_max]. */
+	bool rand_range;
+
+	/** The lowest value of the randomization range. */
+	amiq_rm_reg_data_t rand_min;
+
+	/** The highest value of the randomization range. */
+	amiq_rm_reg_data_t rand_max;
+
 	/** Create new field.
 	 * @param my_name is set as the name of the field
 	 * @param my_reset_value is set as reset value
@@ -74,6 +96,11 @@ public:
 		attrib = my_attrib;
 
 		lsb_position = 0;
+		signals = 0;
+		provider = NULL;
+		rand_range = false;
+		rand_min = 0;
+		rand_max = 0;
 	}
 
 	/** There are no pointers to delete. */
@@ -104,6 +131,31 @@ public:
 	/** @return The function returns true is the field's attribute implies the value to be set to 1 while performing a write. */
 	virtual bool is_set_on_write();
 
+	/** @returns the mask of the values of the field, starting from bit 0 (all ones for a field as wide as the register data). */
+	amiq_rm_reg_data_t get_value_mask() {
+		return amiq_rm_get_value_mask(size);
+	}
+
+	/** The function makes the field contribute to an aggregate signal: the signal is active in the register while at least one bit of the field is 1.
+	 * The signals are taken into account by the build() of the register.
+	 * @param signal_name is the name of the signal (e.g. "irq") */
+	void add_signal(std::string signal_name);
+
+	/** The function constrains the random values of the field to a range. The constraints are taken into account by the build() of the register.
+	 * @param my_min is the lowest value
+	 * @param my_max is the highest value */
+	void set_rand_range(amiq_rm_reg_data_t my_min, amiq_rm_reg_data_t my_max);
+
+	/** The function constrains the random values of the field to a list of values. The constraints are taken into account by the build() of the register.
+	 * @param my_values are the legal values, there must be at least one */
+	void set_rand_values(const std::vector<amiq_rm_reg_data_t> &my_values);
+
+	/** The function removes the randomization constraints, the field gets any value if it is writable. */
+	void clear_rand_constraints();
+
+	/** @returns true if the field has a randomization range or a list of values. */
+	bool is_rand_constrained();
+
 	/** @returns a string with debug purpose information. */
 	std::string to_string();
 
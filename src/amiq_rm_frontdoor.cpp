@@ -0,0 +1,151 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_frontdoor.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef	AMIQ_RM_FRONTDOOR
+#define	AMIQ_RM_FRONTDOOR	1
+
+#include <assert.h>
+#include "amiq_rm_frontdoor.hpp"
+#include "amiq_rm_address_map.hpp"
+
+using namespace std;
+
+namespace amiq_rm {
+
+future<pair<amiq_rm_reg_data_t, amiq_rm_status_t> > amiq_rm_frontdoor::start(amiq_rm_bus_item *item) {
+	future<pair<amiq_rm_reg_data_t, amiq_rm_status_t> > result = item->result.get_future();
+	{
+		unique_lock<mutex> lock(outstanding_mutex);
+		while (nof_outstanding >= max_outstanding)
+			outstanding_cv.wait(lock);
+		nof_outstanding++;
+	}
+	adapter.start(*this, item);
+	return result;
+}
+
+future<pair<amiq_rm_reg_data_t, amiq_rm_status_t> > amiq_rm_frontdoor::read(amiq_rm_reg_address_t address) {
+	return start(new amiq_rm_bus_item(READ, address, 0));
+}
+
+future<pair<amiq_rm_reg_data_t, amiq_rm_status_t> > amiq_rm_frontdoor::write(amiq_rm_reg_address_t address, amiq_rm_reg_data_t write_data) {
+	return start(new amiq_rm_bus_item(WRITE, address, write_data));
+}
+
+void amiq_rm_frontdoor::complete(amiq_rm_bus_item *item) {
+	if (auto_predict && (item->status == OKAY)) {
+		lock_guard<mutex> lock(model_mutex);
+		amiq_rm_decode_target *target = map.decode(item->address);
+		if (target != NULL) {
+			if (item->direction == WRITE) {
+				target->write(item->address, item->data);
+			} else {
+				int unsigned index;
+				//the register takes the value seen on the bus, then the read side effects (e.g. clear on read) are applied
+				if (target->get_index(item->address, index)) {
+					target->set(item->address, item->data);
+					target->read(item->address);
+				}
+			}
+		}
+	}
+
+	item->result.set_value(make_pair(item->data, item->status));
+	delete item;
+
+	lock_guard<mutex> lock(outstanding_mutex);
+	nof_outstanding--;
+	outstanding_cv.notify_all();
+}
+
+void amiq_rm_frontdoor::wait_all() {
+	unique_lock<mutex> lock(outstanding_mutex);
+	while (nof_outstanding > 0)
+		outstanding_cv.wait(lock);
+}
+
+int unsigned amiq_rm_frontdoor::get_nof_outstanding() {
+	lock_guard<mutex> lock(outstanding_mutex);
+	return nof_outstanding;
+}
+
+void amiq_rm_frontdoor::lock_model() {
+	model_mutex.lock();
+}
+
+void amiq_rm_frontdoor::unlock_model() {
+	model_mutex.unlock();
+}
+
+amiq_rm_local_bus_adapter::~amiq_rm_local_bus_adapter() {
+	{
+		lock_guard<mutex> lock(pending_mutex);
+		stop = true;
+	}
+	pending_cv.notify_all();
+	worker.join();
+}
+
+void amiq_rm_local_bus_adapter::start(amiq_rm_frontdoor &frontdoor, amiq_rm_bus_item *item) {
+	amiq_rm_pending_item pending_item;
+	pending_item.frontdoor = &frontdoor;
+	pending_item.item = item;
+	pending_item.due = chrono::steady_clock::now() + latency;
+	{
+		lock_guard<mutex> lock(pending_mutex);
+		pending.push_back(pending_item);
+	}
+	pending_cv.notify_all();
+}
+
+void amiq_rm_local_bus_adapter::run() {
+	unique_lock<mutex> lock(pending_mutex);
+	while (true) {
+		if (pending.empty()) {
+			if (stop)
+				return;
+			pending_cv.wait(lock);
+			continue;
+		}
+
+		amiq_rm_pending_item pending_item = pending.front();
+		if (chrono::steady_clock::now() < pending_item.due) {
+			pending_cv.wait_until(lock, pending_item.due);
+			continue;
+		}
+		pending.pop_front();
+		lock.unlock();
+
+		amiq_rm_bus_item *item = pending_item.item;
+		if (item->direction == WRITE) {
+			item->status = device.write(item->address, item->data);
+		} else {
+			pair<amiq_rm_reg_data_t, amiq_rm_status_t> data_with_status = device.read(item->address);
+			item->data = data_with_status.first;
+			item->status = data_with_status.second;
+		}
+		pending_item.frontdoor->complete(item);
+
+		lock.lock();
+	}
+}
+
+}
+
+#endif
@@ -0,0 +1,228 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_frontdoor.hpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef AMIQ_RM_FRONTDOOR_HEADER
+#define AMIQ_RM_FRONTDOOR_HEADER 1
+
+#include "amiq_rm_types.cpp"
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <deque>
+#include <chrono>
+#include <assert.h>
+
+namespace amiq_rm {
+
+class amiq_rm_physical_address_map;
+class amiq_rm_frontdoor;
+
+/** This class holds a bus transaction issued by amiq_rm_frontdoor. The bus adapter fills @b data (for reads) and @b status
+ * and then calls amiq_rm_frontdoor::complete(). */
+class amiq_rm_bus_item {
+public:
+	/** The direction of the transaction READ/WRITE. */
+	amiq_rm_direction_t direction;
+
+	/** The absolute address of the transaction. */
+	amiq_rm_reg_address_t address;
+
+	/** The data written by a WRITE transaction or the data returned by a READ transaction. */
+	amiq_rm_reg_data_t data;
+
+	/** The status of the transaction, set by the bus adapter. */
+	amiq_rm_status_t status;
+
+	/** Create new bus item.
+	 * @param my_direction is set as direction
+	 * @param my_address is set as address
+	 * @param my_data is set as data */
+	amiq_rm_bus_item(amiq_rm_direction_t my_direction, amiq_rm_reg_address_t my_address, amiq_rm_reg_data_t my_data) {
+		direction = my_direction;
+		address = my_address;
+		data = my_data;
+		status = OKAY;
+	}
+
+private:
+	friend class amiq_rm_frontdoor;
+
+	/** The promise fulfilled when the transaction completes. */
+	std::promise<std::pair<amiq_rm_reg_data_t, amiq_rm_status_t> > result;
+};
+
+/** This class is the interface between amiq_rm_frontdoor and a bus (a real bus driver or a bus-functional stand-in).
+ * The user must implement start(), which must not wait for the transaction to finish. When the transaction finishes,
+ * from any thread, the adapter must fill the item and call amiq_rm_frontdoor::complete(). */
+class amiq_rm_bus_adapter {
+public:
+	/** There are no pointers to delete. */
+	virtual ~amiq_rm_bus_adapter() {
+	}
+
+	/** The function starts a transaction on the bus.
+	 * @param frontdoor is the front-door which issued the transaction, its complete() must be called at the end of the transaction
+	 * @param item is the transaction which is started */
+	virtual void start(amiq_rm_frontdoor &frontdoor, amiq_rm_bus_item *item) = 0;
+};
+
+/** This class implements the front-door access to a physical address map: the accesses are sent to the bus through a bus adapter
+ * and many transactions can be outstanding at the same time. read() and write() return immediately with a std::future which becomes
+ * ready when the transaction completes.
+ * @n On completion (if @b auto_predict is set) the model is updated with the result of the transaction: a successful write is applied
+ * with amiq_rm_physical_address_map::write(), a successful read sets the register to the read value and then applies the read side effects.
+ * The updates are done under a lock of the front-door, so the model must not be accessed by other threads while transactions are outstanding,
+ * except through lock_model()/unlock_model(). */
+class amiq_rm_frontdoor {
+public:
+	/** The address map which holds the predicted values. */
+	amiq_rm_physical_address_map &map;
+
+	/** The adapter through which the transactions are sent. */
+	amiq_rm_bus_adapter &adapter;
+
+	/** The maximum number of outstanding transactions. read() and write() block while this number is reached. */
+	int unsigned max_outstanding;
+
+	/** Specifies if the model is updated when a transaction completes. Default value is true. */
+	bool auto_predict;
+
+	/** Create new front-door.
+	 * @param my_map is the address map which holds the predicted values
+	 * @param my_adapter is the adapter through which the transactions are sent
+	 * @param my_max_outstanding is the maximum number of outstanding transactions */
+	amiq_rm_frontdoor(amiq_rm_physical_address_map &my_map, amiq_rm_bus_adapter &my_adapter, int unsigned my_max_outstanding) :
+			map(my_map), adapter(my_adapter) {
+		assert(my_max_outstanding > 0);
+		max_outstanding = my_max_outstanding;
+		auto_predict = true;
+		nof_outstanding = 0;
+	}
+
+	/** Waits for the outstanding transactions. */
+	virtual ~amiq_rm_frontdoor() {
+		wait_all();
+	}
+
+	/** The function starts a read transaction.
+	 * @param address is the absolute address which is read
+	 * @returns a future which provides the read data and the status of the transaction */
+	std::future<std::pair<amiq_rm_reg_data_t, amiq_rm_status_t> > read(amiq_rm_reg_address_t address);
+
+	/** The function starts a write transaction.
+	 * @param address is the absolute address which is written
+	 * @param write_data is the data that is going to be written
+	 * @returns a future which provides the written data and the status of the transaction */
+	std::future<std::pair<amiq_rm_reg_data_t, amiq_rm_status_t> > write(amiq_rm_reg_address_t address, amiq_rm_reg_data_t write_data);
+
+	/** The function is called by the bus adapter when a transaction completes. It updates the model (see @b auto_predict),
+	 * makes the future of the transaction ready and deletes the item.
+	 * @param item is the transaction which completed */
+	void complete(amiq_rm_bus_item *item);
+
+	/** The function blocks until all outstanding transactions complete. */
+	void wait_all();
+
+	/** @returns the number of outstanding transactions. */
+	int unsigned get_nof_outstanding();
+
+	/** The function takes the lock under which the model is updated, so the model can be accessed while transactions are outstanding. */
+	void lock_model();
+
+	/** The function releases the lock taken with lock_model(). */
+	void unlock_model();
+
+private:
+	/** The number of outstanding transactions. */
+	int unsigned nof_outstanding;
+
+	/** Protects nof_outstanding. */
+	std::mutex outstanding_mutex;
+
+	/** Notified when a transaction completes. */
+	std::condition_variable outstanding_cv;
+
+	/** Protects the model while it is updated on completion. */
+	std::mutex model_mutex;
+
+	/** The function waits for a free slot and sends an item to the adapter.
+	 * @param item is the transaction which is started
+	 * @returns the future of the transaction */
+	std::future<std::pair<amiq_rm_reg_data_t, amiq_rm_status_t> > start(amiq_rm_bus_item *item);
+};
+
+/** This class is an in-process stand-in for a bus: the transactions are executed on another physical address map (which plays
+ * the role of the device) after a configurable latency. The transactions are pipelined: each one completes @b latency after it was
+ * started, so with N outstanding transactions the throughput is N transactions per latency. The completions are done by a worker thread. */
+class amiq_rm_local_bus_adapter: public amiq_rm_bus_adapter {
+public:
+	/** The address map on which the transactions are executed. */
+	amiq_rm_physical_address_map &device;
+
+	/** The time between the start and the completion of a transaction. */
+	std::chrono::nanoseconds latency;
+
+	/** Create new local bus adapter and start its worker thread.
+	 * @param my_device is the address map on which the transactions are executed
+	 * @param my_latency is the latency of a transaction */
+	amiq_rm_local_bus_adapter(amiq_rm_physical_address_map &my_device, std::chrono::nanoseconds my_latency) :
+			device(my_device), latency(my_latency) {
+		stop = false;
+		worker = std::thread(&amiq_rm_local_bus_adapter::run, this);
+	}
+
+	/** Stop the worker thread after the pending transactions are completed. */
+	virtual ~amiq_rm_local_bus_adapter();
+
+	/** The function queues a transaction which is completed by the worker thread after @b latency.
+	 * @param frontdoor is the front-door which issued the transaction
+	 * @param item is the transaction which is started */
+	virtual void start(amiq_rm_frontdoor &frontdoor, amiq_rm_bus_item *item);
+
+private:
+	/** A queued transaction. */
+	struct amiq_rm_pending_item {
+		amiq_rm_frontdoor *frontdoor;
+		amiq_rm_bus_item *item;
+		std::chrono::steady_clock::time_point due;
+	};
+
+	/** The queued transactions, in the order of their due time. */
+	std::deque<amiq_rm_pending_item> pending;
+
+	/** Protects pending and stop. */
+	std::mutex pending_mutex;
+
+	/** Notified when a transaction is queued or the adapter is stopped. */
+	std::condition_variable pending_cv;
+
+	/** Set by the destructor to stop the worker thread. */
+	bool stop;
+
+	/** The worker thread. */
+	std::thread worker;
+
+	/** The function executed by the worker thread. */
+	void run();
+};
+
+}
+
+#endif
@@ -0,0 +1,117 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_hook_queue.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+
+#ifndef	AMIQ_RM_HOOK_QUEUE
+#define	AMIQ_RM_HOOK_QUEUE	1
+
+#include <assert.h>
+#include "amiq_rm_hook_queue.hpp"
+#include "amiq_rm_reg.hpp"
+
+using namespace std;
+
+namespace amiq_rm {
+
+void amiq_rm_hook_queue::push(amiq_rm_reg *reg, amiq_rm_direction_t direction, amiq_rm_reg_data_t access_data,
+		amiq_rm_reg_data_t access_value, amiq_rm_reg_data_t lanes_mask, int unsigned index) {
+	amiq_rm_hook_call call;
+	call.reg = reg;
+	call.direction = direction;
+	call.access_data = access_data;
+	call.access_value = access_value;
+	call.lanes_mask = lanes_mask;
+	call.index = index;
+
+	bool was_empty;
+	{
+		lock_guard<mutex> lock(pending_mutex);
+		was_empty = pending.empty();
+		pending.push_back(call);
+	}
+	//the thread is woken up only by the first call of a batch, the next ones are taken with it
+	if (was_empty && running)
+		pending_event.notify_one();
+}
+
+int unsigned amiq_rm_hook_queue::flush() {
+	lock_guard<mutex> flush_lock(flush_mutex);
+	{
+		lock_guard<mutex> lock(pending_mutex);
+		batch.swap(pending);
+	}
+	if (batch.empty())
+		return 0;
+
+	for (int unsigned i = 0; i < batch.size(); i++)
+		batch[i].reg->deferred_access(batch[i].direction, batch[i].access_data, batch[i].access_value, batch[i].lanes_mask,
+				batch[i].index);
+
+	int unsigned nof_executed = batch.size();
+	batch.clear();
+	nof_calls += nof_executed;
+	nof_batches++;
+	return nof_executed;
+}
+
+void amiq_rm_hook_queue::start() {
+	assert(!running);
+	running = true;
+	flush_thread = thread(&amiq_rm_hook_queue::flush_loop, this);
+}
+
+void amiq_rm_hook_queue::stop() {
+	if (!running)
+		return;
+
+	{
+		lock_guard<mutex> lock(pending_mutex);
+		running = false;
+	}
+	pending_event.notify_one();
+	flush_thread.join();
+}
+
+int unsigned amiq_rm_hook_queue::get_nof_pending() {
+	lock_guard<mutex> lock(pending_mutex);
+	return pending.size();
+}
+
+long long unsigned amiq_rm_hook_queue::get_nof_calls() {
+	return nof_calls;
+}
+
+long long unsigned amiq_rm_hook_queue::get_nof_batches() {
+	return nof_batches;
+}
+
+void amiq_rm_hook_queue::flush_loop() {
+	while (running) {
+		{
+			unique_lock<mutex> lock(pending_mutex);
+			while (running && pending.empty())
+				pending_event.wait(lock);
+		}
+		flush();
+	}
+}
+
+}
+
+#endif
@@ -0,0 +1,129 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_hook_queue.hpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef AMIQ_RM_HOOK_QUEUE_HEADER
+#define AMIQ_RM_HOOK_QUEUE_HEADER 1
+
+#include "amiq_rm_types.cpp"
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+
+namespace amiq_rm {
+
+class amiq_rm_reg;
+
+/** This class holds the deferred hooks of the registers attached to it with amiq_rm_reg::set_hook_queue(): instead of calling
+ * amiq_rm_reg::deferred_access() at the end of each read()/write(), the register queues the call together with the access data,
+ * so the access returns immediately. The queued calls are executed in batches, in the order of the accesses (so the order of the
+ * calls of each register is kept), either by flush() or by the thread started with start().
+ * @n Only one batch is executed at a time, so a flush() called while the thread executes a batch waits for it and the calls are
+ * never reordered. A register must not be destroyed while it has queued calls (flush() the queue first). */
+class amiq_rm_hook_queue {
+public:
+	/** Create new queue, the queued calls are executed by flush() until start() is called. */
+	amiq_rm_hook_queue() {
+		running = false;
+		nof_calls = 0;
+		nof_batches = 0;
+	}
+
+	/** Stop the thread and execute the calls which are still queued. */
+	virtual ~amiq_rm_hook_queue() {
+		stop();
+		flush();
+	}
+
+	/** The function queues a call of amiq_rm_reg::deferred_access(), it can be called from any thread.
+	 * @param reg is the register whose hook is called
+	 * @param direction is the direction of the access READ/WRITE
+	 * @param access_data is the data of the access (0 for a READ)
+	 * @param access_value is the read data for a READ or the value of the register after a WRITE
+	 * @param lanes_mask is the mask of the bits of the lanes enabled by the access
+	 * @param index is the index of the accessed element of an array (see amiq_rm_reg::element_index) */
+	void push(amiq_rm_reg *reg, amiq_rm_direction_t direction, amiq_rm_reg_data_t access_data, amiq_rm_reg_data_t access_value,
+			amiq_rm_reg_data_t lanes_mask, int unsigned index);
+
+	/** The function executes the queued calls in the order in which they were queued. Calls queued by the hooks themselves are
+	 * executed by the next flush().
+	 * @returns the number of executed calls */
+	int unsigned flush();
+
+	/** The function starts a thread which executes the queued calls as soon as they are queued. */
+	void start();
+
+	/** The function stops the thread started with start(), the calls which are still queued are executed by flush(). */
+	void stop();
+
+	/** @returns the number of queued calls which were not executed yet. */
+	int unsigned get_nof_pending();
+
+	/** @returns the number of calls executed since the queue was created. */
+	long long unsigned get_nof_calls();
+
+	/** @returns the number of batches executed since the queue was created (nof_calls / nof_batches is the average batch size). */
+	long long unsigned get_nof_batches();
+
+private:
+	/** A queued call of amiq_rm_reg::deferred_access(). */
+	struct amiq_rm_hook_call {
+		amiq_rm_reg *reg;
+		amiq_rm_direction_t direction;
+		amiq_rm_reg_data_t access_data;
+		amiq_rm_reg_data_t access_value;
+		amiq_rm_reg_data_t lanes_mask;
+		int unsigned index;
+	};
+
+	/** The queued calls, in the order of the accesses. */
+	std::vector<amiq_rm_hook_call> pending;
+
+	/** The batch in execution; it is swapped with @b pending, so the storage of both vectors is reused. */
+	std::vector<amiq_rm_hook_call> batch;
+
+	/** Protects @b pending, it is held only to queue a call or to take the queued calls. */
+	std::mutex pending_mutex;
+
+	/** Held while a batch is executed, so that the batches are executed one at a time. */
+	std::mutex flush_mutex;
+
+	/** Notified when a call is queued or when the thread is stopped. */
+	std::condition_variable pending_event;
+
+	/** Set while the thread is running. */
+	std::atomic<bool> running;
+
+	/** The number of executed calls. */
+	std::atomic<long long unsigned> nof_calls;
+
+	/** The number of executed batches. */
+	std::atomic<long long unsigned> nof_batches;
+
+	/** The thread started with start(). */
+	std::thread flush_thread;
+
+	/** The function executed by the thread started with start(). */
+	void flush_loop();
+};
+
+}
+
+#endif
@@ -0,0 +1,375 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_importer.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+
+#ifndef	AMIQ_RM_IMPORTER
+#define	AMIQ_RM_IMPORTER	1
+
+#include <assert.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include "amiq_rm_importer.hpp"
+#include "amiq_rm_address_map.hpp"
+#include "amiq_rm_log.hpp"
+
+using namespace std;
+
+namespace amiq_rm {
+
+/** Value returned by amiq_rm_hex_value() for a character which is not a hexadecimal digit. */
+static const int unsigned AMIQ_RM_NOT_HEX = 16;
+
+/** @returns the value of a hexadecimal digit, AMIQ_RM_NOT_HEX if the character is not a hexadecimal digit. */
+static inline int unsigned amiq_rm_hex_value(unsigned char c) {
+	if ((c >= '0') && (c <= '9'))
+		return c - '0';
+	c |= 0x20;
+	if ((c >= 'a') && (c <= 'f'))
+		return c - 'a' + 10;
+	return AMIQ_RM_NOT_HEX;
+}
+
+/** The masks used by the SWAR (SIMD within a register) functions: the low bit and the high bit of each byte of a 64-bit word. */
+static const uint64_t AMIQ_RM_SWAR_LOW = 0x0101010101010101ULL;
+static const uint64_t AMIQ_RM_SWAR_HIGH = 0x8080808080808080ULL;
+
+/** @returns the high bit of each byte of @b chunk which is lower than 0x80 and at least @b n (n <= 0x80) */
+static inline uint64_t amiq_rm_swar_at_least(uint64_t chunk, int unsigned n) {
+	return ((chunk | AMIQ_RM_SWAR_HIGH) - n * AMIQ_RM_SWAR_LOW) & AMIQ_RM_SWAR_HIGH;
+}
+
+/** @returns the number of hexadecimal digits at the start of the 8 characters loaded in @b chunk (the first character is the lowest byte). */
+static inline int unsigned amiq_rm_swar_hex_run(uint64_t chunk) {
+	uint64_t lower = chunk | (0x20 * AMIQ_RM_SWAR_LOW);
+	uint64_t digits = amiq_rm_swar_at_least(chunk, '0') & ~amiq_rm_swar_at_least(chunk, '9' + 1);
+	uint64_t letters = amiq_rm_swar_at_least(lower, 'a') & ~amiq_rm_swar_at_least(lower, 'f' + 1);
+	uint64_t not_hex = ~((digits | letters) & ~chunk) & AMIQ_RM_SWAR_HIGH;
+	return (not_hex == 0) ? 8 : (__builtin_ctzll(not_hex) / 8);
+}
+
+/** @returns the value of the first @b nof_digits (1 to 8) hexadecimal digits loaded in @b chunk: each byte is turned into its digit value,
+ * then the nibbles are gathered into 32 bits with three shift-and-mask steps. */
+static inline uint64_t amiq_rm_swar_hex_value(uint64_t chunk, int unsigned nof_digits) {
+	//the first digit is in the lowest byte: after the shift, the digits are in the highest bytes and the missing leading digits are 0
+	chunk <<= 8 * (8 - nof_digits);
+	chunk = (chunk & (0x0F * AMIQ_RM_SWAR_LOW)) + 9 * ((chunk >> 6) & AMIQ_RM_SWAR_LOW);
+	chunk = ((chunk << 4) | (chunk >> 8)) & 0x00FF00FF00FF00FFULL;
+	chunk = ((chunk << 8) | (chunk >> 16)) & 0x0000FFFF0000FFFFULL;
+	return ((chunk << 16) | (chunk >> 32)) & 0x00000000FFFFFFFFULL;
+}
+
+/** The function parses a hexadecimal number, with or without the "0x" prefix. Where at least 16 bytes can be read, the digits are found
+ * and converted 8 at a time (see amiq_rm_swar_hex_run() and amiq_rm_swar_hex_value()), otherwise one at a time.
+ * @param position is the first character of the number, it is moved after the number
+ * @param eol is the end of the line
+ * @param end is the end of the file
+ * @param max_digits is the maximum number of digits of the number, at most 16
+ * @param number is set to the value of the number
+ * @returns false if there is no number or it has more than @b max_digits digits */
+static bool amiq_rm_parse_hex(const char *&position, const char *eol, const char *end, int unsigned max_digits, uint64_t &number) {
+	if ((eol - position > 2) && (position[0] == '0') && ((position[1] | 0x20) == 'x'))
+		position += 2;
+
+	int unsigned nof_digits = 0;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	if (end - position >= 16) {
+		uint64_t chunks[2];
+		memcpy(chunks, position, sizeof(chunks));
+		nof_digits = amiq_rm_swar_hex_run(chunks[0]);
+		if (nof_digits == 8)
+			nof_digits += amiq_rm_swar_hex_run(chunks[1]);
+		if ((nof_digits == 0) || (nof_digits > max_digits) || (position + nof_digits > eol))
+			return false;
+
+		if (nof_digits <= 8)
+			number = amiq_rm_swar_hex_value(chunks[0], nof_digits);
+		else
+			number = (amiq_rm_swar_hex_value(chunks[0], 8) << (4 * (nof_digits - 8))) | amiq_rm_swar_hex_value(chunks[1], nof_digits - 8);
+		position += nof_digits;
+		return true;
+	}
+#endif
+	while ((position + nof_digits < eol) && (amiq_rm_hex_value(position[nof_digits]) != AMIQ_RM_NOT_HEX))
+		nof_digits++;
+	if ((nof_digits == 0) || (nof_digits > max_digits))
+		return false;
+
+	number = 0;
+	for (int unsigned i = 0; i < nof_digits; i++)
+		number = (number << 4) | amiq_rm_hex_value(position[i]);
+	position += nof_digits;
+	return true;
+}
+
+/** @returns the first character from @b position which is not a space, a tab or a carriage return, or @b eol. */
+static inline const char* amiq_rm_skip_blanks(const char *position, const char *eol) {
+	while ((position < eol) && ((*position == ' ') || (*position == '\t') || (*position == '\r')))
+		position++;
+	return position;
+}
+
+bool amiq_rm_importer::compare_addresses(const amiq_rm_dump_entry &a, const amiq_rm_dump_entry &b) {
+	return (a.address < b.address);
+}
+
+bool amiq_rm_importer::map_file(string file_name, const char *&data, size_t &size) {
+	int fd = ::open(file_name.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) != 0) {
+		::close(fd);
+		return false;
+	}
+
+	data = NULL;
+	size = file_stat.st_size;
+	if (size > 0) {
+		void *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapping == MAP_FAILED) {
+			::close(fd);
+			return false;
+		}
+		madvise(mapping, size, MADV_SEQUENTIAL);
+		data = (const char*) mapping;
+	}
+	::close(fd);
+	return true;
+}
+
+bool amiq_rm_importer::import_text(string file_name) {
+	assert(map.get_decoder().is_built());
+	const char *data;
+	size_t size;
+	if (!map_file(file_name, data, size))
+		return false;
+
+	unmapped_ranges.clear();
+	parse(data, size);
+	if (data != NULL)
+		munmap((void*) data, size);
+
+	//dumps are usually written in address order, so the sort is skipped when it is not needed
+	if (!is_sorted(entries.begin(), entries.end(), compare_addresses))
+		stable_sort(entries.begin(), entries.end(), compare_addresses);
+	merge();
+
+	AMIQ_RM_INFO(AMIQ_RM_MEDIUM, "Imported " << file_name << " in " << map.name << ": " << nof_records << " values, " << holes.size() << " holes, "
+			<< unknown_addresses.size() << " unknown addresses, " << bad_lines.size() << " bad lines");
+	entries.clear();
+	return true;
+}
+
+void amiq_rm_importer::parse(const char *data, size_t size) {
+	const char *end = data + size;
+	long long unsigned line = 0;
+	entries.clear();
+	bad_lines.clear();
+
+	for (const char *position = data; position < end;) {
+		const char *eol = (const char*) memchr(position, '\n', end - position);
+		if (eol == NULL)
+			eol = end;
+		line++;
+
+		position = amiq_rm_skip_blanks(position, eol);
+		if ((position != eol) && (*position != '#')) {
+			amiq_rm_dump_entry entry;
+			uint64_t number;
+			bool ok = amiq_rm_parse_hex(position, eol, end, 2 * sizeof(amiq_rm_reg_address_t), number);
+			entry.address = number;
+
+			const char *separator = position;
+			while ((position < eol) && ((*position == ' ') || (*position == '\t') || (*position == ',') || (*position == ':') || (*position == '=')))
+				position++;
+			ok = ok && (position != separator) && amiq_rm_parse_hex(position, eol, end, 2 * sizeof(amiq_rm_reg_data_t), number);
+			entry.value = number;
+
+			if (ok && (amiq_rm_skip_blanks(position, eol) == eol))
+				entries.push_back(entry);
+			else
+				bad_lines.push_back(line);
+		}
+		position = eol + 1;
+	}
+}
+
+/** @returns the priority of a kind of target when targets overlap, as in amiq_rm_radix_decoder::build(). */
+static inline int unsigned amiq_rm_target_priority(amiq_rm_target_kind_t kind) {
+	switch (kind) {
+	case REG_TARGET:
+		return 3;
+	case REG_ARRAY_TARGET:
+		return 2;
+	case MAP_ARRAY_TARGET:
+		return 1;
+	case MEM_TARGET:
+		break;
+	}
+	return 0;
+}
+
+void amiq_rm_importer::merge() {
+	holes.clear();
+	unknown_addresses.clear();
+	nof_records = 0;
+
+	//the entries are sorted, so the targets are walked once together with them: @b active holds the targets which reach the address
+	//and the walk jumps with a binary search over the targets which end before it; the reports are sorted too and the repeated
+	//addresses are reported once
+	amiq_rm_target_table *table = map.get_decoder().get_table();
+	vector<amiq_rm_decode_target*> &targets = table->targets;
+	vector<int unsigned> active;
+	int unsigned next = 0;
+	for (int unsigned i = 0; i < entries.size(); i++) {
+		amiq_rm_reg_address_t address = entries[i].address;
+		if ((i == 0) || ((next < targets.size()) && (targets[next]->base + targets[next]->size - 1 < address)))
+			next = table->find_first_target(address, active);
+		for (; (next < targets.size()) && (targets[next]->base <= address); next++)
+			active.push_back(next);
+
+		//the overlapping targets are resolved as by the decoder: by kind, then the one placed later; the spanning targets found by
+		//find_first_target() may start after the address
+		amiq_rm_decode_target *target = NULL;
+		int unsigned nof_active = 0;
+		for (int unsigned k = 0; k < active.size(); k++) {
+			amiq_rm_decode_target *candidate = targets[active[k]];
+			if (candidate->base + candidate->size - 1 < address)
+				continue;
+			active[nof_active++] = active[k];
+			if ((candidate->base <= address)
+					&& ((target == NULL) || (amiq_rm_target_priority(candidate->kind) >= amiq_rm_target_priority(target->kind))))
+				target = candidate;
+		}
+		active.resize(nof_active);
+
+		int unsigned index;
+		if (target == NULL) {
+			if (holes.empty() || (holes.back() != address))
+				holes.push_back(address);
+		} else if (!target->get_index(address, index)) {
+			if (unknown_addresses.empty() || (unknown_addresses.back() != address))
+				unknown_addresses.push_back(address);
+		} else {
+			target->set(address, entries[i].value);
+			nof_records++;
+		}
+	}
+}
+
+bool amiq_rm_importer::import_image(string file_name, amiq_rm_reg_address_t base) {
+	assert(map.get_decoder().is_built());
+	const char *data;
+	size_t size;
+	if (!map_file(file_name, data, size))
+		return false;
+
+	holes.clear();
+	unknown_addresses.clear();
+	bad_lines.clear();
+	unmapped_ranges.clear();
+	nof_records = 0;
+	long long unsigned nof_unmapped_bytes = 0;
+	if (data != NULL) {
+		amiq_rm_target_table *table = map.get_decoder().get_table();
+		amiq_rm_reg_address_t last = base + size - 1;
+		vector<int unsigned> positions;
+		table->find_targets(base, last, positions);
+
+		//the positions are in the order of the base addresses, the bytes before the next target and after all of them are not mapped
+		amiq_rm_reg_address_t next_unknown = base;
+		bool covered = false;
+		for (int unsigned i = 0; i < positions.size(); i++) {
+			amiq_rm_decode_target *target = table->targets[positions[i]];
+			load_target(target, (const unsigned char*) data, base, last);
+			if (covered)
+				continue;
+
+			amiq_rm_reg_address_t target_last = target->base + target->size - 1;
+			if (target->base > next_unknown)
+				unmapped_ranges.push_back(make_pair(next_unknown, target->base - 1));
+			if (target_last >= last)
+				covered = true;
+			else if (target_last >= next_unknown)
+				next_unknown = target_last + 1;
+		}
+		if (!covered)
+			unmapped_ranges.push_back(make_pair(next_unknown, last));
+		munmap((void*) data, size);
+	}
+	for (int unsigned i = 0; i < unmapped_ranges.size(); i++)
+		nof_unmapped_bytes += unmapped_ranges[i].second - unmapped_ranges[i].first + 1;
+
+	AMIQ_RM_INFO(AMIQ_RM_MEDIUM, "Imported " << file_name << " in " << map.name << " at 0x" << hex << base << ": " << dec << nof_records << " values, "
+			<< nof_unmapped_bytes << " unmapped bytes");
+	return true;
+}
+
+void amiq_rm_importer::load_target(amiq_rm_decode_target *target, const unsigned char *image, amiq_rm_reg_address_t base,
+		amiq_rm_reg_address_t last) {
+	amiq_rm_reg_address_t target_last = target->base + target->size - 1;
+	if (target_last < base)
+		return;
+	amiq_rm_reg_address_t first = (target->base > base) ? target->base : base;
+	if (target_last > last)
+		target_last = last;
+
+	if (target->kind == MEM_TARGET) {
+		target->mem->load(first - target->base, image + (first - base), target_last - first + 1);
+		nof_records += (target_last - first + sizeof(amiq_rm_reg_data_t)) / sizeof(amiq_rm_reg_data_t);
+		return;
+	}
+
+	amiq_rm_reg_address_t address = first;
+	while (address <= target_last) {
+		amiq_rm_reg_address_t element_address;
+		int unsigned nof_bytes;
+		if (!target->get_element(address, element_address, nof_bytes)) {
+			address++;
+			continue;
+		}
+		//an element which starts before the image or ends after it is not set
+		if (element_address != address) {
+			address = element_address + nof_bytes;
+			continue;
+		}
+		if (address + nof_bytes - 1 > target_last)
+			break;
+
+		amiq_rm_reg_data_t value = 0;
+		for (int unsigned i = 0; i < nof_bytes; i++)
+			value |= ((amiq_rm_reg_data_t) image[address - base + i]) << (8 * i);
+		target->set(address, value);
+		nof_records++;
+		address += nof_bytes;
+	}
+}
+
+long long unsigned amiq_rm_importer::get_nof_records() {
+	return nof_records;
+}
+
+}
+
+#endif
@@ -0,0 +1,130 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_importer.hpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef AMIQ_RM_IMPORTER_HEADER
+#define AMIQ_RM_IMPORTER_HEADER 1
+
+#include "amiq_rm_types.cpp"
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdint.h>
+
+namespace amiq_rm {
+
+class amiq_rm_physical_address_map;
+class amiq_rm_decode_target;
+
+/** This class loads register dumps (e.g. taken on silicon or on an emulator) into a built physical address map, setting the values
+ * without calling the pre/post access hooks (as amiq_rm_physical_address_map::set()). The file is mapped in memory, so it is not copied.
+ * @n Formats:
+ * @li text dump (import_text()): one "address value" line for each register, the numbers are hexadecimal (with or without the "0x"
+ * prefix) and are separated by spaces, tabs, ',', ':' or '='; empty lines and lines starting with '#' are ignored. The lines are parsed
+ * eight digits at a time, sorted by address (unless they already are) and applied in one pass over the decoder of the map; if an
+ * address appears more than once, the last line wins.
+ * @li binary image (import_image()): the bytes of a range of addresses starting at a base address, in little-endian order; every
+ * register, array element and memory word which fits in the range is set from the image, the memories are loaded with one copy.
+ * @n The problems are reported in bulk after the import: the addresses which do not decode (@b holes), the addresses which fall inside
+ * an element but not at its start (@b unknown_addresses), the lines which could not be parsed (@b bad_lines) and the bytes of an image
+ * which do not decode (@b unmapped_ranges).
+ * The topology of the map must not change during an import. */
+class amiq_rm_importer {
+public:
+	/** The address map in which the dumps are loaded. */
+	amiq_rm_physical_address_map &map;
+
+	/** The addresses of the last import which are not mapped, in increasing order. */
+	std::vector<amiq_rm_reg_address_t> holes;
+
+	/** The addresses of the last import which are mapped but are not the address of an element, in increasing order. */
+	std::vector<amiq_rm_reg_address_t> unknown_addresses;
+
+	/** The numbers (starting with 1) of the lines of the last text import which could not be parsed. */
+	std::vector<long long unsigned> bad_lines;
+
+	/** The ranges [first, last] of the bytes of the last image import which are not mapped, in increasing order. */
+	std::vector<std::pair<amiq_rm_reg_address_t, amiq_rm_reg_address_t> > unmapped_ranges;
+
+	/** Create new importer.
+	 * @param my_map is the address map in which the dumps are loaded, its decoder must be built */
+	amiq_rm_importer(amiq_rm_physical_address_map &my_map) :
+			map(my_map) {
+		nof_records = 0;
+	}
+
+	/** There are no pointers to delete. */
+	virtual ~amiq_rm_importer() {
+	}
+
+	/** The function loads a text dump.
+	 * @param file_name is the name of the file
+	 * @returns false if the file could not be read; the problems of the content are reported in @b holes, @b unknown_addresses and @b bad_lines */
+	bool import_text(std::string file_name);
+
+	/** The function loads a binary image of a range of addresses.
+	 * @param file_name is the name of the file
+	 * @param base is the address of the first byte of the image
+	 * @returns false if the file could not be read; the bytes of the image which are not mapped are reported in @b unmapped_ranges */
+	bool import_image(std::string file_name, amiq_rm_reg_address_t base);
+
+	/** @returns the number of values set by the last import. */
+	long long unsigned get_nof_records();
+
+private:
+	/** A line of a text dump. */
+	struct amiq_rm_dump_entry {
+		amiq_rm_reg_address_t address;
+		amiq_rm_reg_data_t value;
+	};
+
+	/** The entries parsed from the last text dump. */
+	std::vector<amiq_rm_dump_entry> entries;
+
+	/** The number of values set by the last import. */
+	long long unsigned nof_records;
+
+	/** @returns true if the entry a has a lower address than the entry b. */
+	static bool compare_addresses(const amiq_rm_dump_entry &a, const amiq_rm_dump_entry &b);
+
+	/** The function maps a file in memory.
+	 * @param file_name is the name of the file
+	 * @param data is set to the content of the file (NULL for an empty file)
+	 * @param size is set to the size of the file
+	 * @returns false if the file could not be mapped */
+	static bool map_file(std::string file_name, const char *&data, std::size_t &size);
+
+	/** The function parses the lines of a text dump into @b entries.
+	 * @param data is the content of the file
+	 * @param size is the size of the content */
+	void parse(const char *data, std::size_t size);
+
+	/** The function sets the values of @b entries, which are sorted by address, walking the targets of the decoder together with them. */
+	void merge();
+
+	/** The function sets the elements of a target from the part of an image which overlaps it.
+	 * @param target is the target
+	 * @param image is the image
+	 * @param base is the address of the first byte of the image
+	 * @param last is the address of the last byte of the image */
+	void load_target(amiq_rm_decode_target *target, const unsigned char *image, amiq_rm_reg_address_t base, amiq_rm_reg_address_t last);
+};
+
+}
+
+#endif
@@ -0,0 +1,72 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_indirect_reg.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef	AMIQ_RM_INDIRECT_REG
+#define	AMIQ_RM_INDIRECT_REG	1
+
+#include <assert.h>
+#include "amiq_rm_indirect_reg.hpp"
+
+using namespace std;
+
+namespace amiq_rm {
+
+amiq_rm_indirect_reg::amiq_rm_indirect_reg(string my_name, amiq_rm_reg_array &my_target, amiq_rm_reg &index_reg, string my_index_field) :
+		amiq_rm_reg(my_name), target(my_target) {
+	add_field(new amiq_rm_field("data", 0, 8 * sizeof(amiq_rm_reg_data_t), "RW"));
+	index_field = index_reg.get_field_my_name(my_index_field);
+	assert(index_field != NULL);
+	index = extract_index(index_field->reset_value << index_field->lsb_position);
+	index_reg.add_observer(this);
+}
+
+int unsigned amiq_rm_indirect_reg::extract_index(amiq_rm_reg_data_t index_value) {
+	return (index_value >> index_field->lsb_position) & index_field->get_value_mask();
+}
+
+amiq_rm_status_t amiq_rm_indirect_reg::pre_access(amiq_rm_direction_t direction, amiq_rm_reg_data_t access_data) {
+	if (index >= target.count)
+		return ERROR;
+
+	//the lanes of the access are forwarded to the element
+	int unsigned byte_enable = 0;
+	for (int unsigned i = 0; i < AMIQ_RM_NOF_LANES; i++) {
+		if (((get_access_mask() >> (8 * i)) & 0xff) != 0)
+			byte_enable |= (1 << i);
+	}
+
+	if (direction == READ) {
+		pair<amiq_rm_reg_data_t, amiq_rm_status_t> data_with_status = target.read(index, byte_enable);
+		value = data_with_status.first;
+		return data_with_status.second;
+	}
+	return target.write(index, access_data, byte_enable);
+}
+
+void amiq_rm_indirect_reg::post_access(amiq_rm_direction_t direction, amiq_rm_reg_data_t access_data) {
+	value = target.get(index);
+}
+
+void amiq_rm_indirect_reg::value_changed(amiq_rm_reg &reg, amiq_rm_reg_data_t old_value) {
+	index = extract_index(reg.value);
+}
+
+}
+
+#endif
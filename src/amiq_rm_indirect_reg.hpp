@@ -0,0 +1,85 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_indirect_reg.hpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef AMIQ_RM_INDIRECT_REG_HEADER
+#define AMIQ_RM_INDIRECT_REG_HEADER 1
+
+#include "amiq_rm_types.cpp"
+#include "amiq_rm_reg.hpp"
+#include "amiq_rm_reg_array.hpp"
+#include <string>
+
+namespace amiq_rm {
+
+/** This class models the data register of an indirect index/data register pair: an access to the data register is an access to the
+ * element of a register array selected by a field of the index register. The index is kept up to date when the index register changes
+ * (the data register observes it), so an access is forwarded to the element without any lookup.
+ * @n The data register has one field ("data") which covers all its bits; the masks, field attributes and hooks of the layout of the array
+ * are applied by the forwarded access. An access with an index outside the array returns ERROR. After each access, @b value holds the value
+ * of the accessed element. The index register must not be destroyed before the data register. */
+class amiq_rm_indirect_reg: public amiq_rm_reg, public amiq_rm_reg_observer {
+public:
+	/** The register array whose elements are accessed. */
+	amiq_rm_reg_array &target;
+
+	/** Create new data register.
+	 * @param my_name is set as name
+	 * @param my_target is the register array whose elements are accessed
+	 * @param index_reg is the index register
+	 * @param index_field is the name of the field of the index register which holds the index */
+	amiq_rm_indirect_reg(std::string my_name, amiq_rm_reg_array &my_target, amiq_rm_reg &index_reg, std::string index_field);
+
+	/** There are no pointers to delete (the fields are deleted by amiq_rm_reg). */
+	virtual ~amiq_rm_indirect_reg() {
+	}
+
+	/** @returns the index of the element which is accessed. */
+	int unsigned get_index() {
+		return index;
+	}
+
+	/** The function forwards the access to the selected element.
+	 * @param direction is the direction of the operation READ/WRITE
+	 * @param access_data is the written data
+	 * @returns the status of the access to the element, ERROR if the index is outside the array */
+	amiq_rm_status_t pre_access(amiq_rm_direction_t direction, amiq_rm_reg_data_t access_data);
+
+	/** The function sets @b value to the value of the accessed element (the side effects were applied by the forwarded access).
+	 * @param direction is the direction of the operation READ/WRITE
+	 * @param access_data is the written data */
+	void post_access(amiq_rm_direction_t direction, amiq_rm_reg_data_t access_data);
+
+	/** The function updates the index when the index register changes. */
+	void value_changed(amiq_rm_reg &reg, amiq_rm_reg_data_t old_value);
+
+private:
+	/** The field of the index register which holds the index. */
+	amiq_rm_field *index_field;
+
+	/** The index of the element which is accessed. */
+	int unsigned index;
+
+	/** @returns the index held by a value of the index register.
+	 * @param index_value is the value of the index register */
+	int unsigned extract_index(amiq_rm_reg_data_t index_value);
+};
+
+}
+
+#endif
@@ -0,0 +1,44 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_log.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef	AMIQ_RM_LOG
+#define	AMIQ_RM_LOG	1
+
+#include <iostream>
+#include "amiq_rm_log.hpp"
+
+using namespace std;
+
+namespace amiq_rm {
+
+int amiq_rm_log::verbosity = AMIQ_RM_LOW;
+
+ostream *amiq_rm_log::stream = &cout;
+
+void amiq_rm_log::set_verbosity(int my_verbosity) {
+	verbosity = my_verbosity;
+}
+
+void amiq_rm_log::set_stream(ostream &my_stream) {
+	stream = &my_stream;
+}
+
+}
+
+#endif
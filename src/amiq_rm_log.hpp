@@ -0,0 +1,77 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_log.hpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef AMIQ_RM_LOG_HEADER
+#define AMIQ_RM_LOG_HEADER 1
+
+#include <ostream>
+
+namespace amiq_rm {
+
+typedef enum {
+	AMIQ_RM_NONE = 0, AMIQ_RM_LOW = 100, AMIQ_RM_MEDIUM = 200, AMIQ_RM_HIGH = 300, AMIQ_RM_FULL = 400, AMIQ_RM_DEBUG = 500
+} amiq_rm_verbosity_t;
+
+/** The highest verbosity compiled in the library and in the user code (AMIQ_RM_DEBUG by default).
+ * The messages with a higher verbosity are removed at compile time. */
+#ifndef AMIQ_RM_MAX_VERBOSITY
+#define AMIQ_RM_MAX_VERBOSITY 500
+#endif
+
+/** The macro prints a message if its verbosity is not higher than the current verbosity (amiq_rm_log::set_verbosity()).
+ * The message is a stream expression (e.g. AMIQ_RM_INFO(AMIQ_RM_HIGH, "built " << name)), it is evaluated only if the message is printed,
+ * so a disabled message costs only one comparison. */
+#define AMIQ_RM_INFO(verbosity, message) \
+	do { \
+		if (((verbosity) <= AMIQ_RM_MAX_VERBOSITY) && ((verbosity) <= amiq_rm::amiq_rm_log::get_verbosity())) { \
+			amiq_rm::amiq_rm_log::get_stream() << "[amiq_rm] " << message << std::endl; \
+		} \
+	} while (0)
+
+/** This class holds the settings of the messages printed by the library and by the user code with AMIQ_RM_INFO(): the current verbosity and the output stream.
+ * The default verbosity is AMIQ_RM_LOW and the default stream is std::cout. */
+class amiq_rm_log {
+public:
+	/** @returns the current verbosity. */
+	static int get_verbosity() {
+		return verbosity;
+	}
+
+	/** @param my_verbosity is the new verbosity: the messages with a higher verbosity are not printed */
+	static void set_verbosity(int my_verbosity);
+
+	/** @returns the stream to which the messages are printed. */
+	static std::ostream& get_stream() {
+		return *stream;
+	}
+
+	/** @param my_stream is the stream to which the messages are printed from now on */
+	static void set_stream(std::ostream &my_stream);
+
+private:
+	/** The current verbosity. */
+	static int verbosity;
+
+	/** The stream to which the messages are printed. */
+	static std::ostream *stream;
+};
+
+}
+
+#endif
@@ -0,0 +1,404 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_map_array.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef	AMIQ_RM_MAP_ARRAY
+#define	AMIQ_RM_MAP_ARRAY	1
+
+#include <algorithm>
+#include <sstream>
+#include "amiq_rm_map_array.hpp"
+#include "amiq_rm_address_map.hpp"
+
+using namespace std;
+
+namespace amiq_rm {
+
+/** @returns true if slot @b a is placed before slot @b b. */
+static bool amiq_rm_compare_slots(const amiq_rm_map_array::amiq_rm_map_array_slot &a, const amiq_rm_map_array::amiq_rm_map_array_slot &b) {
+	return (a.offset < b.offset);
+}
+
+void amiq_rm_map_array::flatten(amiq_rm_address_map &map, amiq_rm_reg_address_t base, string path) {
+	//memories are not duplicated in the instances
+	assert(map.mems.empty());
+
+	for (amiq_rm_address_map::amiq_rm_reg_map_t::iterator it = map.regs.begin(); it != map.regs.end(); it++) {
+		amiq_rm_map_array_slot slot;
+		slot.offset = base + it->first;
+		slot.reg = it->second;
+		slot.path = path + it->second->name;
+		slots.push_back(slot);
+	}
+
+	for (amiq_rm_address_map::amiq_rm_reg_array_map_t::iterator it = map.reg_arrays.begin(); it != map.reg_arrays.end(); it++) {
+		amiq_rm_reg_array *array = it->second;
+		for (int unsigned i = 0; i < array->count; i++) {
+			ostringstream element_path;
+			element_path << path << array->name << "[" << dec << i << "]";
+			amiq_rm_map_array_slot slot;
+			slot.offset = base + it->first + i * array->stride;
+			slot.reg = array->layout;
+			slot.path = element_path.str();
+			slots.push_back(slot);
+		}
+	}
+
+	for (amiq_rm_address_map::amiq_rm_map_array_map_t::iterator it = map.map_arrays.begin(); it != map.map_arrays.end(); it++) {
+		amiq_rm_map_array *array = it->second;
+		for (int unsigned i = 0; i < array->count; i++) {
+			ostringstream instance_path;
+			instance_path << path << array->name << "[" << dec << i << "].";
+			for (int unsigned j = 0; j < array->slots.size(); j++) {
+				amiq_rm_map_array_slot slot = array->slots[j];
+				slot.offset += base + it->first + i * array->stride;
+				slot.path = instance_path.str() + slot.path;
+				slots.push_back(slot);
+			}
+		}
+	}
+
+	for (amiq_rm_address_map::amiq_rm_addressmap_map_t::iterator it = map.submaps.begin(); it != map.submaps.end(); it++) {
+		flatten(*(it->second), base + it->first, path + it->second->name + ".");
+	}
+}
+
+void amiq_rm_map_array::build() {
+	prototype->build();
+
+	vector<amiq_rm_map_array_slot> old_slots;
+	old_slots.swap(slots);
+	flatten(*prototype, 0, "");
+	stable_sort(slots.begin(), slots.end(), amiq_rm_compare_slots);
+
+	offsets.clear();
+	reset_values.clear();
+	has_signal_slots = false;
+	for (int unsigned i = 0; i < slots.size(); i++) {
+		//the registers of an instance must not overlap and must fit in the stride
+		assert((i == 0) || (slots[i - 1].offset + slots[i - 1].reg->get_nof_bytes() <= slots[i].offset));
+		assert(slots[i].offset + slots[i].reg->get_nof_bytes() <= stride);
+		//the providers keep one value per register, not per instance
+		assert(!slots[i].reg->has_providers());
+		has_signal_slots |= (slots[i].reg->get_signal_mask() != 0);
+		offsets.push_back(slots[i].offset);
+		reset_values.push_back(slots[i].reg->get_reset_value());
+	}
+
+	//with the same slots, the values of the existing instances are kept and only the new instances are set to the reset values
+	bool same_slots = (old_slots.size() == slots.size());
+	for (int unsigned i = 0; same_slots && (i < slots.size()); i++)
+		same_slots = (old_slots[i].reg == slots[i].reg) && (old_slots[i].offset == slots[i].offset);
+	if (!same_slots || slots.empty()) {
+		for (int unsigned i = 0; i < banks.size(); i++)
+			get_bank_values(i).resize(count * slots.size());
+		reset();
+		return;
+	}
+
+	for (int unsigned i = 0; i < banks.size(); i++) {
+		vector<amiq_rm_reg_data_t> &bank_values = get_bank_values(i);
+		int unsigned old_count = bank_values.size() / slots.size();
+		bank_values.resize(count * slots.size());
+		for (int unsigned j = old_count; j < count; j++)
+			copy(reset_values.begin(), reset_values.end(), bank_values.begin() + j * slots.size());
+		if (i != bank)
+			compute_signals(bank_values, bank_signal_nodes[i]);
+	}
+	recompute_signals();
+}
+
+void amiq_rm_map_array::set_capacity(int unsigned my_capacity) {
+	capacity = my_capacity;
+}
+
+void amiq_rm_map_array::reset() {
+	if (slots.empty())
+		return;
+	for (int unsigned i = 0; i < banks.size(); i++) {
+		vector<amiq_rm_reg_data_t> &bank_values = get_bank_values(i);
+		for (int unsigned j = 0; j < count; j++)
+			copy(reset_values.begin(), reset_values.end(), bank_values.begin() + j * slots.size());
+		if (i != bank)
+			compute_signals(bank_values, bank_signal_nodes[i]);
+	}
+	recompute_signals();
+}
+
+void amiq_rm_map_array::set_nof_banks(int unsigned nof_banks) {
+	assert((nof_banks > 0) && values.empty());
+	bank = 0;
+	banks.assign(nof_banks, vector<amiq_rm_reg_data_t>());
+	bank_signal_nodes.assign(nof_banks, amiq_rm_signal_node());
+}
+
+int unsigned amiq_rm_map_array::get_nof_banks() {
+	return banks.size();
+}
+
+void amiq_rm_map_array::select_bank(int unsigned new_bank) {
+	assert(new_bank < banks.size());
+	if (new_bank == bank)
+		return;
+
+	//only the buffers of the vectors are exchanged, the values are not copied
+	values.swap(banks[bank]);
+	values.swap(banks[new_bank]);
+	int unsigned old_bank = bank;
+	bank = new_bank;
+	if (!has_signal_slots)
+		return;
+
+	uint64_t old_pending = signal_node.pending_signals;
+	bank_signal_nodes[old_bank] = signal_node;
+	signal_node = bank_signal_nodes[new_bank];
+	if (signal_node.pending_signals != old_pending) {
+		for (int unsigned i = 0; i < parent_maps.size(); i++)
+			parent_maps[i]->update_signals(old_pending, signal_node.pending_signals);
+	}
+}
+
+int unsigned amiq_rm_map_array::get_bank() {
+	return bank;
+}
+
+vector<amiq_rm_reg_data_t>& amiq_rm_map_array::get_bank_values(int unsigned bank_index) {
+	assert(bank_index < banks.size());
+	return (bank_index == bank) ? values : banks[bank_index];
+}
+
+void amiq_rm_map_array::set_bank_selector(amiq_rm_reg &reg, string field_name) {
+	assert(selector_field == NULL);
+	selector_field = reg.get_field_my_name(field_name);
+	assert(selector_field != NULL);
+	reg.add_observer(this);
+}
+
+void amiq_rm_map_array::value_changed(amiq_rm_reg &reg, amiq_rm_reg_data_t old_value) {
+	amiq_rm_reg_data_t selector = (reg.value >> selector_field->lsb_position) & selector_field->get_value_mask();
+	if (selector < banks.size())
+		select_bank(selector);
+}
+
+int unsigned amiq_rm_map_array::add_instance() {
+	int unsigned first_index = values.size();
+	for (int unsigned i = 0; i < banks.size(); i++) {
+		vector<amiq_rm_reg_data_t> &bank_values = get_bank_values(i);
+		bank_values.insert(bank_values.end(), reset_values.begin(), reset_values.end());
+		if (i == bank)
+			continue;
+		for (int unsigned j = 0; j < slots.size(); j++) {
+			amiq_rm_reg *reg = slots[j].reg;
+			if (reg->get_signal_mask() != 0)
+				bank_signal_nodes[i].update(0, reg->get_active_signals(reset_values[j]));
+		}
+	}
+	for (int unsigned i = 0; i < slots.size(); i++)
+		changed(first_index + i, 0, values[first_index + i]);
+	return count++;
+}
+
+int unsigned amiq_rm_map_array::get_nof_slots() {
+	return slots.size();
+}
+
+int unsigned amiq_rm_map_array::get_index(int unsigned instance, amiq_rm_reg &reg) {
+	assert(instance < count);
+	for (int unsigned i = 0; i < slots.size(); i++) {
+		if (slots[i].reg == &reg)
+			return instance * slots.size() + i;
+	}
+	assert(0);
+	return 0;
+}
+
+int unsigned amiq_rm_map_array::get_index(int unsigned instance, string path) {
+	assert(instance < count);
+	for (int unsigned i = 0; i < slots.size(); i++) {
+		if (slots[i].path == path)
+			return instance * slots.size() + i;
+	}
+	assert(0);
+	return 0;
+}
+
+bool amiq_rm_map_array::find(amiq_rm_reg_address_t offset, int unsigned &index, amiq_rm_reg_address_t &element_offset) {
+	amiq_rm_reg_address_t instance = offset / stride;
+	amiq_rm_reg_address_t instance_offset = offset % stride;
+	if (instance >= count)
+		return false;
+
+	//the candidate is the slot with the greatest offset lower or equal to instance_offset
+	vector<amiq_rm_reg_address_t>::iterator it = upper_bound(offsets.begin(), offsets.end(), instance_offset);
+	if (it == offsets.begin())
+		return false;
+	int unsigned slot = (it - offsets.begin()) - 1;
+	if (instance_offset - offsets[slot] >= slots[slot].reg->get_nof_bytes())
+		return false;
+
+	index = instance * slots.size() + slot;
+	element_offset = instance * stride + offsets[slot];
+	return true;
+}
+
+int unsigned amiq_rm_map_array::find_first_slot(amiq_rm_reg_address_t instance_offset) {
+	return lower_bound(offsets.begin(), offsets.end(), instance_offset) - offsets.begin();
+}
+
+void amiq_rm_map_array::load(int unsigned index) {
+	assert(index < values.size());
+	current_index = index;
+	amiq_rm_reg *reg = slots[index % slots.size()].reg;
+	reg->value = values[index];
+	reg->element_index = index;
+}
+
+void amiq_rm_map_array::store() {
+	amiq_rm_reg_data_t old_value = values[current_index];
+	amiq_rm_reg *reg = slots[current_index % slots.size()].reg;
+	values[current_index] = reg->value;
+	reg->element_index = 0;
+	changed(current_index, old_value, values[current_index]);
+}
+
+void amiq_rm_map_array::changed(int unsigned index, amiq_rm_reg_data_t old_value, amiq_rm_reg_data_t new_value) {
+	amiq_rm_reg *reg = slots[index % slots.size()].reg;
+	if ((reg->get_signal_mask() == 0) || (old_value == new_value))
+		return;
+
+	uint64_t old_pending = signal_node.pending_signals;
+	if (signal_node.update(reg->get_active_signals(old_value), reg->get_active_signals(new_value))) {
+		for (int unsigned i = 0; i < parent_maps.size(); i++)
+			parent_maps[i]->update_signals(old_pending, signal_node.pending_signals);
+	}
+}
+
+void amiq_rm_map_array::compute_signals(vector<amiq_rm_reg_data_t> &bank_values, amiq_rm_signal_node &node) {
+	node.clear();
+	for (int unsigned j = 0; j < slots.size(); j++) {
+		amiq_rm_reg *reg = slots[j].reg;
+		if (reg->get_signal_mask() == 0)
+			continue;
+		for (int unsigned i = j; i < bank_values.size(); i += slots.size())
+			node.update(0, reg->get_active_signals(bank_values[i]));
+	}
+}
+
+void amiq_rm_map_array::recompute_signals() {
+	uint64_t old_pending = signal_node.pending_signals;
+	compute_signals(values, signal_node);
+
+	if (signal_node.pending_signals != old_pending) {
+		for (int unsigned i = 0; i < parent_maps.size(); i++)
+			parent_maps[i]->update_signals(old_pending, signal_node.pending_signals);
+	}
+}
+
+pair<amiq_rm_reg_data_t, amiq_rm_status_t> amiq_rm_map_array::read(int unsigned index) {
+	load(index);
+	pair<amiq_rm_reg_data_t, amiq_rm_status_t> data_with_status = slots[index % slots.size()].reg->read();
+	store();
+	return data_with_status;
+}
+
+amiq_rm_status_t amiq_rm_map_array::write(int unsigned index, amiq_rm_reg_data_t write_data) {
+	load(index);
+	amiq_rm_status_t status = slots[index % slots.size()].reg->write(write_data);
+	store();
+	return status;
+}
+
+pair<amiq_rm_reg_data_t, amiq_rm_status_t> amiq_rm_map_array::read(int unsigned index, int unsigned byte_enable) {
+	load(index);
+	pair<amiq_rm_reg_data_t, amiq_rm_status_t> data_with_status = slots[index % slots.size()].reg->read(byte_enable);
+	store();
+	return data_with_status;
+}
+
+amiq_rm_status_t amiq_rm_map_array::write(int unsigned index, amiq_rm_reg_data_t write_data, int unsigned byte_enable) {
+	load(index);
+	amiq_rm_status_t status = slots[index % slots.size()].reg->write(write_data, byte_enable);
+	store();
+	return status;
+}
+
+amiq_rm_reg_data_t amiq_rm_map_array::get(int unsigned index) {
+	assert(index < values.size());
+	return values[index];
+}
+
+void amiq_rm_map_array::set(int unsigned index, amiq_rm_reg_data_t write_data) {
+	assert(index < values.size());
+	amiq_rm_reg_data_t old_value = values[index];
+	values[index] = write_data;
+	changed(index, old_value, write_data);
+}
+
+amiq_rm_reg_data_t amiq_rm_map_array::get_field_value(int unsigned index, string field_name) {
+	assert(index < values.size());
+	return slots[index % slots.size()].reg->get_access_data_for_field(field_name, values[index]);
+}
+
+void amiq_rm_map_array::set_field_value(int unsigned index, string field_name, amiq_rm_reg_data_t new_value) {
+	load(index);
+	slots[index % slots.size()].reg->set_field_value(field_name, new_value);
+	store();
+}
+
+long long unsigned amiq_rm_map_array::randomize(uint64_t seed, uint64_t counter, amiq_rm_reg_filter_t filter) {
+	long long unsigned nof_values = 0;
+	for (int unsigned j = 0; j < slots.size(); j++) {
+		amiq_rm_reg *reg = slots[j].reg;
+		if ((filter != NULL) && !filter(*reg))
+			continue;
+
+		for (int unsigned i = j; i < values.size(); i += slots.size())
+			values[i] = reg->get_random_value(values[i], amiq_rm_random(seed, counter + i));
+		nof_values += count;
+	}
+	recompute_signals();
+	return nof_values;
+}
+
+int unsigned amiq_rm_map_array::get_current_index() {
+	return current_index;
+}
+
+vector<amiq_rm_reg_address_t> amiq_rm_map_array::get_offsets(amiq_rm_address_map &map) {
+	return map.get_map_array_offsets(*this);
+}
+
+string amiq_rm_map_array::to_string() {
+	ostringstream convert;
+	convert << name << " Count: " << dec << count << " Stride: " << hex << stride << " Prototype: " << prototype->name << " Slots: " << dec
+			<< slots.size();
+	if (banks.size() > 1)
+		convert << " Bank: " << bank << "/" << banks.size();
+	convert << "\n";
+	for (int unsigned i = 0; i < count; i++) {
+		for (int unsigned j = 0; j < slots.size(); j++) {
+			convert << "[" << dec << i << "]." << slots[j].path << " Offset: " << hex << (i * stride + slots[j].offset) << " Value: " << hex
+					<< values[i * slots.size() + j] << "\n";
+		}
+	}
+	return convert.str();
+}
+
+}
+
+#endif
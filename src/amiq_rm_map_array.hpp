@@ -0,0 +1,307 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_map_array.hpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef AMIQ_RM_MAP_ARRAY_HEADER
+#define AMIQ_RM_MAP_ARRAY_HEADER 1
+
+#include "amiq_rm_types.cpp"
+#include "amiq_rm_reg.hpp"
+#include <string>
+#include <vector>
+#include <assert.h>
+
+namespace amiq_rm {
+
+class amiq_rm_address_map;
+
+/** This class is used to model many identical instances of a block (e.g. 64 copies of an IP) without building the registers,
+ * the fields and the maps of each instance. The block is described once by an address map (the @b prototype) and the array is mapped
+ * in an address map with amiq_rm_address_map::add_map_array(); instance @b i is placed at offset + i * stride.
+ * @n build() flattens the prototype (its registers, register arrays, map arrays and sub-maps) into @b slots, a table sorted by offset
+ * which is shared by all instances. Each instance only owns a block of @b values, one value for each slot, and all blocks are stored
+ * contiguously: the value of slot @b s of instance @b i is at index i * get_nof_slots() + s. An address is decoded arithmetically
+ * to the instance and with a binary search in the slots to the register.
+ * @n An access loads the value in the register of the prototype which defines the slot, performs the operation of that register
+ * (masks, field attributes, hooks) and stores the value back, as for amiq_rm_reg_array. The prototype is used only as a description:
+ * the values of its registers are overwritten by the accesses and it must not contain memories.
+ * @n The array can hold several banks of values (e.g. one for each context of a virtualized device, see set_nof_banks()): each bank is a
+ * separate block of values, the selected bank is the one held in @b values and switching banks with select_bank() swaps the blocks
+ * without copying them. The bank can be selected by a field of a register (see set_bank_selector()). */
+class amiq_rm_map_array: public amiq_rm_reg_observer {
+public:
+	/** A register of the prototype, with its position in an instance. */
+	struct amiq_rm_map_array_slot {
+		/** The offset of the register relative to the start of an instance. */
+		amiq_rm_reg_address_t offset;
+
+		/** The register which defines the fields of the slot (for an element of a register array it is the layout of the array). */
+		amiq_rm_reg *reg;
+
+		/** The path of the register relative to the prototype (e.g. "sub.reg" or "arr[3]"). */
+		std::string path;
+	};
+
+	/** The name of the map array. */
+	std::string name;
+
+	/** The address map which describes one instance. It is not deleted by the array and it can be used by several arrays. */
+	amiq_rm_address_map *prototype;
+
+	/** The number of instances. */
+	int unsigned count;
+
+	/** The distance (in bytes) between the offsets of two consecutive instances. */
+	amiq_rm_reg_address_t stride;
+
+	/** The registers of one instance, sorted by offset. It is computed by build(). */
+	std::vector<amiq_rm_map_array_slot> slots;
+
+	/** The values of the registers of all instances, see get_index(). */
+	std::vector<amiq_rm_reg_data_t> values;
+
+	/** The vector holds the address maps which contain the array. New parents are added when amiq_rm_address_map::add_map_array() is called.*/
+	std::vector<amiq_rm_address_map*> parent_maps;
+
+	/** The aggregate of the signals of the registers of all instances (see amiq_rm_field::add_signal()). It is kept up to date by the functions
+	 * which modify the values; changing @b values directly does not update it. The aggregates of the prototype map are not meaningful,
+	 * as the values of its registers are overwritten by the accesses. */
+	amiq_rm_signal_node signal_node;
+
+	/** Create new map array, the values are allocated by build().
+	 * @param my_name is set as name
+	 * @param my_prototype is the address map which describes one instance
+	 * @param my_count is the number of instances
+	 * @param my_stride is the distance (in bytes) between two consecutive instances */
+	amiq_rm_map_array(std::string my_name, amiq_rm_address_map &my_prototype, int unsigned my_count, amiq_rm_reg_address_t my_stride) {
+		assert(my_stride > 0);
+		name = my_name;
+		prototype = &my_prototype;
+		count = my_count;
+		stride = my_stride;
+		capacity = 0;
+		current_index = 0;
+		bank = 0;
+		banks.resize(1);
+		bank_signal_nodes.resize(1);
+		selector_field = NULL;
+		has_signal_slots = false;
+	}
+
+	/** There are no pointers to delete. */
+	virtual ~amiq_rm_map_array() {
+	}
+
+	/** The function builds the prototype, computes the slots and allocates the values of all instances (set to the reset values).
+	 * When the array is built again with the same slots (e.g. by a new build() of a parent map), the values of the existing instances
+	 * are kept in all banks and only the instances added since then get the reset values.
+	 * It is not necessary for the build() to be called if the @b address map::build() from one of the parent maps is called */
+	void build();
+
+	/** The function implements the reset functionality for all instances of all banks. */
+	void reset();
+
+	/** The function sets the number of banks of values, bank 0 is selected. It must be called before build().
+	 * @param nof_banks is the number of banks, at least 1 */
+	void set_nof_banks(int unsigned nof_banks);
+
+	/** @returns the number of banks of values. */
+	int unsigned get_nof_banks();
+
+	/** The function selects the bank of values which is accessed, the blocks of values are swapped without being copied.
+	 * The aggregate signals follow the selected bank.
+	 * @param new_bank is the index of the bank */
+	void select_bank(int unsigned new_bank);
+
+	/** @returns the index of the selected bank. */
+	int unsigned get_bank();
+
+	/** @param bank_index is the index of a bank
+	 * @returns the values of the bank (the values of the selected bank are in @b values). */
+	std::vector<amiq_rm_reg_data_t>& get_bank_values(int unsigned bank_index);
+
+	/** The function makes a field select the bank: each time the register of the field changes, the bank given by the value of the field
+	 * is selected. Values greater or equal to get_nof_banks() do not change the selected bank.
+	 * @param reg is the register of the selector field, it must not be destroyed before the array
+	 * @param field_name is the name of the selector field */
+	void set_bank_selector(amiq_rm_reg &reg, std::string field_name);
+
+	/** The function follows the changes of the selector field (see set_bank_selector()). */
+	void value_changed(amiq_rm_reg &reg, amiq_rm_reg_data_t old_value);
+
+	/** The function adds one instance at the end of the array (in all banks), with the reset values. It must be called after build().
+	 * The decoders map the address range of get_capacity() instances and find the instance of an address arithmetically (offset / stride),
+	 * so an instance which fits in the capacity is decoded right away; beyond it, the physical maps which contain the array must be
+	 * built (or published) again.
+	 * @returns the index of the new instance */
+	int unsigned add_instance();
+
+	/** The function reserves the address range of a number of instances, so the instances added later with add_instance() are decoded
+	 * without building the physical maps again. It must be called before the maps which contain the array are built.
+	 * @param my_capacity is the number of instances whose range is reserved */
+	void set_capacity(int unsigned my_capacity);
+
+	/** @returns the number of instances whose address range is decoded: the greater of @b count and the capacity set with set_capacity(). */
+	int unsigned get_capacity() {
+		return (count > capacity) ? count : capacity;
+	}
+
+	/** @returns the number of registers of one instance. */
+	int unsigned get_nof_slots();
+
+	/** @param instance is the index of the instance
+	 * @param reg is a register of the prototype (or the layout of a register array of the prototype, for its first element)
+	 * @returns the index of the value of the register in the given instance */
+	int unsigned get_index(int unsigned instance, amiq_rm_reg &reg);
+
+	/** @param instance is the index of the instance
+	 * @param path is the path of a register relative to the prototype, as in @b slots
+	 * @returns the index of the value of the register in the given instance */
+	int unsigned get_index(int unsigned instance, std::string path);
+
+	/** The function decodes an offset relative to the start of the array.
+	 * @param offset is the offset which is decoded
+	 * @param index is set to the index of the value of the register which covers the offset
+	 * @param element_offset is set to the offset of the first byte of that register
+	 * @returns false if no register covers the offset */
+	bool find(amiq_rm_reg_address_t offset, int unsigned &index, amiq_rm_reg_address_t &element_offset);
+
+	/** @param instance_offset is an offset relative to the start of an instance
+	 * @returns the first slot whose offset is greater or equal to instance_offset, get_nof_slots() if there is no such slot */
+	int unsigned find_first_slot(amiq_rm_reg_address_t instance_offset);
+
+	/** @param index is the index of the value which is read
+	 * @returns the value as well as the status of the read operation (see amiq_rm_reg::read()). */
+	std::pair<amiq_rm_reg_data_t, amiq_rm_status_t> read(int unsigned index);
+
+	/** @param index is the index of the value which is written
+	 * @param write_data is the data that is going to be written (see amiq_rm_reg::write())
+	 * @returns the status of the write operation */
+	amiq_rm_status_t write(int unsigned index, amiq_rm_reg_data_t write_data);
+
+	/** @param index is the index of the value which is read
+	 * @param byte_enable selects the byte lanes which are read
+	 * @returns the value of the enabled lanes as well as the status of the read operation (see amiq_rm_reg::read()). */
+	std::pair<amiq_rm_reg_data_t, amiq_rm_status_t> read(int unsigned index, int unsigned byte_enable);
+
+	/** @param index is the index of the value which is written
+	 * @param write_data is the data that is going to be written to the enabled lanes (see amiq_rm_reg::write())
+	 * @param byte_enable selects the byte lanes which are written
+	 * @returns the status of the write operation */
+	amiq_rm_status_t write(int unsigned index, amiq_rm_reg_data_t write_data, int unsigned byte_enable);
+
+	/** @param index is the index of the value
+	 * @returns the value - it does not apply masking, no pre/post access hooks are called. */
+	amiq_rm_reg_data_t get(int unsigned index);
+
+	/** The function modifies a value - it does not apply masking, no pre/post access hooks are called.
+	 * @param index is the index of the value
+	 * @param write_data is the data that is going to be set as the value */
+	void set(int unsigned index, amiq_rm_reg_data_t write_data);
+
+	/** @param index is the index of the value
+	 * @param field_name is the name of the field on which the operation is addressed to
+	 * @returns the value of a field. */
+	amiq_rm_reg_data_t get_field_value(int unsigned index, std::string field_name);
+
+	/** Changes the value of a field.
+	 * @param index is the index of the value
+	 * @param field_name is the name of the field on which the operation is addressed to
+	 * @param new_value is the value that is going to be set to the field */
+	void set_field_value(int unsigned index, std::string field_name, amiq_rm_reg_data_t new_value);
+
+	/** The function sets random values to the registers of all instances of the selected bank (see amiq_rm_reg::get_random_value()), without calling
+	 * the pre/post access hooks. The value with index @b i gets the random number amiq_rm_random(seed, counter + i).
+	 * @param seed is the seed of the random values
+	 * @param counter is the position in the random sequence of the first value
+	 * @param filter selects the slots which are randomized (by their register), NULL to randomize all of them
+	 * @returns the number of values which were randomized */
+	long long unsigned randomize(uint64_t seed, uint64_t counter, amiq_rm_reg_filter_t filter);
+
+	/** @returns the index of the value which is currently accessed (useful inside the hooks of the registers of the prototype).
+	 * The instance is get_current_index() / get_nof_slots(). */
+	int unsigned get_current_index();
+
+	/** The function returns the offsets of the first instance of the array. The offsets are calculated relative to the address map passed as argument.
+	 * This function is a wrapper of the equivalent function @b amiq_rm_address_map::get_map_array_offsets().
+	 * @param map pointer to the address map relative to which the calculation of the offset takes place.
+	 * @returns a vector which contains all the offsets at which the array is mapped under the map argument. */
+	std::vector<amiq_rm_reg_address_t> get_offsets(amiq_rm_address_map &map);
+
+	/** @returns a string with debug purpose information. */
+	std::string to_string();
+
+private:
+	/** The offsets of the slots, used by find(). */
+	std::vector<amiq_rm_reg_address_t> offsets;
+
+	/** The reset values of the slots. */
+	std::vector<amiq_rm_reg_data_t> reset_values;
+
+	/** The index of the value which is currently accessed. */
+	int unsigned current_index;
+
+	/** The number of instances reserved with set_capacity(). */
+	int unsigned capacity;
+
+	/** The index of the selected bank. */
+	int unsigned bank;
+
+	/** The values of the banks which are not selected; the entry of the selected bank is empty, as its values are in @b values. */
+	std::vector<std::vector<amiq_rm_reg_data_t> > banks;
+
+	/** The aggregate signals of the banks which are not selected (the one of the selected bank is @b signal_node). */
+	std::vector<amiq_rm_signal_node> bank_signal_nodes;
+
+	/** Set if at least one slot contributes to aggregate signals. It is set when calling build(). */
+	bool has_signal_slots;
+
+	/** The field which selects the bank or NULL. */
+	amiq_rm_field *selector_field;
+
+	/** The function adds the slots of a map of the prototype.
+	 * @param map is the map whose registers are added
+	 * @param base is the offset of the map relative to the prototype
+	 * @param path is the path of the map relative to the prototype ("" or ending with '.') */
+	void flatten(amiq_rm_address_map &map, amiq_rm_reg_address_t base, std::string path);
+
+	/** The function loads a value in the register of its slot.
+	 * @param index is the index of the value */
+	void load(int unsigned index);
+
+	/** The function stores the value of the register of the slot back in the value which was loaded with load(). */
+	void store();
+
+	/** The function updates @b signal_node, and the parent maps if the pending signals changed, after a value changed.
+	 * @param index is the index of the value
+	 * @param old_value is the value before the change
+	 * @param new_value is the value after the change */
+	void changed(int unsigned index, amiq_rm_reg_data_t old_value, amiq_rm_reg_data_t new_value);
+
+	/** The function computes @b signal_node from all values and updates the parent maps if the pending signals changed. */
+	void recompute_signals();
+
+	/** The function computes the aggregate signals of a block of values.
+	 * @param bank_values are the values
+	 * @param node is set to the aggregate signals of the values */
+	void compute_signals(std::vector<amiq_rm_reg_data_t> &bank_values, amiq_rm_signal_node &node);
+};
+
+}
+
+#endif
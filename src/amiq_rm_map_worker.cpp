@@ -0,0 +1,212 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_map_worker.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef	AMIQ_RM_MAP_WORKER
+#define	AMIQ_RM_MAP_WORKER	1
+
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <chrono>
+#include <set>
+#include "amiq_rm_map_worker.hpp"
+#include "amiq_rm_address_map.hpp"
+
+using namespace std;
+
+namespace amiq_rm {
+
+const int unsigned amiq_rm_map_worker::AMIQ_RM_WORKER_IDLE_SLEEP_US;
+
+/** Number of tests of the completion flag after which wait() yields the processor between tests. */
+static const int unsigned amiq_rm_request_spins = 1000;
+
+void amiq_rm_access_request::wait() {
+	for (int unsigned i = 0; !is_done(); i++) {
+		if (i >= amiq_rm_request_spins)
+			this_thread::yield();
+	}
+}
+
+amiq_rm_access_request amiq_rm_map_worker::closed(READ, 0, 0);
+
+/** The function collects the maps of the tree of a map: its sub-maps and the prototypes of its map arrays, recursively.
+ * @param map is the root of the tree
+ * @param tree is filled with the maps of the tree */
+static void amiq_rm_collect_tree(amiq_rm_address_map &map, set<amiq_rm_address_map*> &tree) {
+	if (!tree.insert(&map).second)
+		return;
+	for (amiq_rm_address_map::amiq_rm_addressmap_map_t::iterator it = map.submaps.begin(); it != map.submaps.end(); it++)
+		amiq_rm_collect_tree(*it->second, tree);
+	for (amiq_rm_address_map::amiq_rm_map_array_map_t::iterator it = map.map_arrays.begin(); it != map.map_arrays.end(); it++)
+		amiq_rm_collect_tree(*it->second->prototype, tree);
+}
+
+/** @param parents are the maps which contain an element
+ * @param tree is the set of maps of a tree
+ * @returns true if all the parents belong to the tree */
+static bool amiq_rm_is_inside(const vector<amiq_rm_address_map*> &parents, const set<amiq_rm_address_map*> &tree) {
+	for (int unsigned i = 0; i < parents.size(); i++) {
+		if (tree.find(parents[i]) == tree.end())
+			return false;
+	}
+	return true;
+}
+
+bool amiq_rm_map_worker::is_disjoint() {
+	set<amiq_rm_address_map*> tree;
+	amiq_rm_collect_tree(map, tree);
+	for (set<amiq_rm_address_map*>::iterator it = tree.begin(); it != tree.end(); it++) {
+		amiq_rm_address_map *node = *it;
+		if ((node != &map) && !amiq_rm_is_inside(node->parents, tree))
+			return false;
+		for (amiq_rm_address_map::amiq_rm_reg_map_t::iterator reg = node->regs.begin(); reg != node->regs.end(); reg++) {
+			if (!amiq_rm_is_inside(reg->second->parent_maps, tree))
+				return false;
+		}
+		for (amiq_rm_address_map::amiq_rm_mem_map_t::iterator mem = node->mems.begin(); mem != node->mems.end(); mem++) {
+			if (!amiq_rm_is_inside(mem->second->parent_maps, tree))
+				return false;
+		}
+		for (amiq_rm_address_map::amiq_rm_reg_array_map_t::iterator array = node->reg_arrays.begin(); array != node->reg_arrays.end(); array++) {
+			if (!amiq_rm_is_inside(array->second->parent_maps, tree))
+				return false;
+		}
+		for (amiq_rm_address_map::amiq_rm_map_array_map_t::iterator array = node->map_arrays.begin(); array != node->map_arrays.end(); array++) {
+			if (!amiq_rm_is_inside(array->second->parent_maps, tree))
+				return false;
+		}
+	}
+	return map.parents.empty();
+}
+
+bool amiq_rm_map_worker::start(int cpu) {
+	assert(!running);
+	assert(is_disjoint());
+	__atomic_store_n(&head, (amiq_rm_access_request*) NULL, __ATOMIC_RELEASE);
+	running = true;
+	worker_thread = thread(&amiq_rm_map_worker::worker_loop, this);
+	if (cpu == AMIQ_RM_NO_CPU)
+		return true;
+
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	CPU_SET(cpu, &cpus);
+	return (pthread_setaffinity_np(worker_thread.native_handle(), sizeof(cpus), &cpus) == 0);
+}
+
+void amiq_rm_map_worker::stop() {
+	if (!running)
+		return;
+
+	running = false;
+	worker_thread.join();
+	//the queue is closed by the last drain, the requests submitted after it are rejected
+	drain(&closed);
+}
+
+bool amiq_rm_map_worker::submit(amiq_rm_access_request *request) {
+	__atomic_store_n(&request->done, 0, __ATOMIC_RELAXED);
+	request->next = __atomic_load_n(&head, __ATOMIC_RELAXED);
+	do {
+		if (request->next == &closed)
+			return false;
+	} while (!__atomic_compare_exchange_n(&head, &request->next, request, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+	return true;
+}
+
+pair<amiq_rm_reg_data_t, amiq_rm_status_t> amiq_rm_map_worker::read(amiq_rm_reg_address_t address) {
+	amiq_rm_access_request request(READ, address, 0);
+	if (!submit(&request))
+		return make_pair(0, ERROR);
+	request.wait();
+	return make_pair(request.data, request.status);
+}
+
+amiq_rm_status_t amiq_rm_map_worker::write(amiq_rm_reg_address_t address, amiq_rm_reg_data_t write_data) {
+	amiq_rm_access_request request(WRITE, address, write_data);
+	if (!submit(&request))
+		return ERROR;
+	request.wait();
+	return request.status;
+}
+
+long long unsigned amiq_rm_map_worker::get_nof_requests() {
+	return nof_requests;
+}
+
+long long unsigned amiq_rm_map_worker::get_nof_batches() {
+	return nof_batches;
+}
+
+void amiq_rm_map_worker::execute(amiq_rm_access_request &request) {
+	if (request.direction == READ) {
+		pair<amiq_rm_reg_data_t, amiq_rm_status_t> data_with_status = map.read(request.address);
+		request.data = data_with_status.first;
+		request.status = data_with_status.second;
+	} else {
+		request.status = map.write(request.address, request.data);
+	}
+}
+
+bool amiq_rm_map_worker::drain(amiq_rm_access_request *empty) {
+	amiq_rm_access_request *batch = __atomic_exchange_n(&head, empty, __ATOMIC_ACQ_REL);
+	if ((batch == NULL) || (batch == &closed))
+		return false;
+
+	//the queue is linked from the newest request, reverse it to execute the requests in the order of submission
+	amiq_rm_access_request *oldest = NULL;
+	while (batch != NULL) {
+		amiq_rm_access_request *next = batch->next;
+		batch->next = oldest;
+		oldest = batch;
+		batch = next;
+	}
+
+	long long unsigned nof_batch_requests = 0;
+	while (oldest != NULL) {
+		//the request may be destroyed by its producer as soon as it is done
+		amiq_rm_access_request *next = oldest->next;
+		execute(*oldest);
+		__atomic_store_n(&oldest->done, 1, __ATOMIC_RELEASE);
+		oldest = next;
+		nof_batch_requests++;
+	}
+	nof_requests += nof_batch_requests;
+	nof_batches++;
+	return true;
+}
+
+void amiq_rm_map_worker::worker_loop() {
+	int unsigned idle_sweeps = 0;
+	while (running) {
+		if (drain(NULL)) {
+			idle_sweeps = 0;
+		} else if (idle_sweeps < AMIQ_RM_WORKER_IDLE_SWEEPS) {
+			idle_sweeps++;
+			this_thread::yield();
+		} else {
+			this_thread::sleep_for(chrono::microseconds(AMIQ_RM_WORKER_IDLE_SLEEP_US));
+		}
+	}
+}
+
+}
+
+#endif
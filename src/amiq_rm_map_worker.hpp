@@ -0,0 +1,194 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_map_worker.hpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef AMIQ_RM_MAP_WORKER_HEADER
+#define AMIQ_RM_MAP_WORKER_HEADER 1
+
+#include "amiq_rm_types.cpp"
+#include <utility>
+#include <thread>
+#include <atomic>
+
+namespace amiq_rm {
+
+class amiq_rm_physical_address_map;
+class amiq_rm_map_worker;
+
+/** This class holds an access submitted to amiq_rm_map_worker. The producer fills @b direction, @b address and @b data (for writes),
+ * submits the request and waits for it with wait() (or tests is_done()); the worker then fills @b data (for reads) and @b status.
+ * The request must not be modified or destroyed while it is in progress. */
+class amiq_rm_access_request {
+public:
+	/** The direction of the access READ/WRITE. */
+	amiq_rm_direction_t direction;
+
+	/** The absolute address of the access. */
+	amiq_rm_reg_address_t address;
+
+	/** The data written by a WRITE or the data returned by a READ. */
+	amiq_rm_reg_data_t data;
+
+	/** The status of the access, set by the worker. */
+	amiq_rm_status_t status;
+
+	/** Create new request.
+	 * @param my_direction is set as direction
+	 * @param my_address is set as address
+	 * @param my_data is set as data */
+	amiq_rm_access_request(amiq_rm_direction_t my_direction, amiq_rm_reg_address_t my_address, amiq_rm_reg_data_t my_data) {
+		direction = my_direction;
+		address = my_address;
+		data = my_data;
+		status = OKAY;
+		done = 0;
+		next = NULL;
+	}
+
+	/** @returns true if the worker executed the request. */
+	bool is_done() {
+		return (__atomic_load_n(&done, __ATOMIC_ACQUIRE) != 0);
+	}
+
+	/** The function waits until the worker executed the request: it spins for a short time, then it yields the processor between tests. */
+	void wait();
+
+private:
+	friend class amiq_rm_map_worker;
+
+	/** The completion flag, set by the worker after @b data and @b status. */
+	int unsigned done;
+
+	/** The link of the queue of the worker. */
+	amiq_rm_access_request *next;
+};
+
+/** This class executes the accesses to one physical address map on a dedicated thread (the map is owned by the worker): any number of
+ * producer threads submit requests through a lock-free queue and each request is completed through its own flag, so the producers
+ * never take a lock and never touch the map. Several maps (e.g. one physical map for each shard of a design) can be driven in parallel
+ * by several workers as long as their trees are disjoint: an access changes the element, its observers and the aggregate signals of
+ * all the maps which contain it, so no register, array, memory, sub-map or map array prototype may be shared between the maps.
+ * start() checks that every map containing an element of the tree belongs to the tree; the sharing through observers, providers,
+ * hooks or prototypes used by several map arrays is not checked.
+ * @n The worker takes all queued requests at once (a batch) and executes them in the order of submission of each producer. After
+ * AMIQ_RM_WORKER_IDLE_SWEEPS polls of an empty queue (the worker yields the processor between them, so the producers can run even
+ * when the threads outnumber the processors), the worker sleeps AMIQ_RM_WORKER_IDLE_SLEEP_US between polls.
+ * While the worker is running, the map must not be accessed by other threads. */
+class amiq_rm_map_worker {
+public:
+	/** Number of consecutive polls of an empty queue after which the worker starts to sleep between polls. */
+	static const int unsigned AMIQ_RM_WORKER_IDLE_SWEEPS = 10000;
+
+	/** Duration (in microseconds) of the sleep between two polls of an idle worker. */
+	static const int unsigned AMIQ_RM_WORKER_IDLE_SLEEP_US = 50;
+
+	/** Value of the cpu argument of start() which does not pin the worker. */
+	static const int AMIQ_RM_NO_CPU = -1;
+
+	/** The address map on which the accesses are executed. */
+	amiq_rm_physical_address_map &map;
+
+	/** Create new worker, the worker is started with start().
+	 * @param my_map is the address map on which the accesses are executed, it must be built */
+	amiq_rm_map_worker(amiq_rm_physical_address_map &my_map) :
+			map(my_map) {
+		head = &closed;
+		running = false;
+		nof_requests = 0;
+		nof_batches = 0;
+	}
+
+	/** Stop the worker. */
+	virtual ~amiq_rm_map_worker() {
+		stop();
+	}
+
+	/** The function starts the thread of the worker. The tree of the map must be disjoint from the maps driven by other threads
+	 * (see the description of the class).
+	 * @param cpu is the processor on which the thread is pinned, AMIQ_RM_NO_CPU to let the system place it
+	 * @returns false if the thread could not be pinned (the worker runs anyway) */
+	bool start(int cpu);
+
+	/** The function executes the requests which are still queued and stops the thread of the worker. The requests submitted afterwards
+	 * are rejected. */
+	void stop();
+
+	/** The function queues a request, it can be called from any thread.
+	 * @param request is the request, it is completed by the worker
+	 * @returns false if the worker is not running, the request is not queued and it will not be completed */
+	bool submit(amiq_rm_access_request *request);
+
+	/** The function submits a read and waits for it.
+	 * @param address is the absolute address of the read
+	 * @returns the read data as well as the status of the read operation, ERROR if the worker is not running */
+	std::pair<amiq_rm_reg_data_t, amiq_rm_status_t> read(amiq_rm_reg_address_t address);
+
+	/** The function submits a write and waits for it.
+	 * @param address is the absolute address of the write
+	 * @param write_data is the written data
+	 * @returns the status of the write operation, ERROR if the worker is not running */
+	amiq_rm_status_t write(amiq_rm_reg_address_t address, amiq_rm_reg_data_t write_data);
+
+	/** The function checks that the map does not share an element with another map: the changes of an element are propagated to the
+	 * maps which contain it (e.g. the aggregate signals), so every map containing an element of the tree of the map must belong to
+	 * the tree. It is checked by start().
+	 * @returns true if the tree of the map is disjoint from the other maps */
+	bool is_disjoint();
+
+	/** @returns the number of requests executed since the worker was created. */
+	long long unsigned get_nof_requests();
+
+	/** @returns the number of batches executed since the worker was created (nof_requests / nof_batches is the average batch size). */
+	long long unsigned get_nof_batches();
+
+private:
+	/** The last submitted request; the queued requests are linked from the newest to the oldest. It is accessed atomically.
+	 * It is @b closed while the worker is stopped. */
+	amiq_rm_access_request *head;
+
+	/** The value of @b head which marks a stopped worker, it is never executed. */
+	static amiq_rm_access_request closed;
+
+	/** Set while the worker is running. */
+	std::atomic<bool> running;
+
+	/** The number of executed requests, written only by the worker. */
+	std::atomic<long long unsigned> nof_requests;
+
+	/** The number of executed batches, written only by the worker. */
+	std::atomic<long long unsigned> nof_batches;
+
+	/** The thread of the worker. */
+	std::thread worker_thread;
+
+	/** The function executed by the thread of the worker. */
+	void worker_loop();
+
+	/** The function takes the queued requests and executes them.
+	 * @param empty is the value left in @b head: NULL, or @b closed to reject the following requests
+	 * @returns true if there were requests to execute */
+	bool drain(amiq_rm_access_request *empty);
+
+	/** The function executes one access on the map.
+	 * @param request is the access, the results are written in it */
+	void execute(amiq_rm_access_request &request);
+};
+
+}
+
+#endif
@@ -0,0 +1,202 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_mem.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef	AMIQ_RM_MEM
+#define	AMIQ_RM_MEM	1
+
+#include <assert.h>
+#include <string.h>
+#include <sstream>
+#include "amiq_rm_mem.hpp"
+#include "amiq_rm_address_map.hpp"
+
+using namespace std;
+
+namespace amiq_rm {
+
+void amiq_rm_mem::clear() {
+	for (int unsigned i = 0; i < pages.size(); i++) {
+		delete[] pages[i];
+		pages[i] = NULL;
+	}
+}
+
+unsigned char* amiq_rm_mem::get_page(amiq_rm_reg_address_t page_index, bool allocate) {
+	unsigned char *page = pages[page_index];
+	if ((page == NULL) && allocate) {
+		page = new unsigned char[AMIQ_RM_MEM_PAGE_SIZE];
+		memset(page, 0, AMIQ_RM_MEM_PAGE_SIZE);
+		pages[page_index] = page;
+	}
+	return page;
+}
+
+bool amiq_rm_mem::is_inside(amiq_rm_reg_address_t offset, size_t nof_bytes) {
+	return ((offset <= size) && (nof_bytes <= size - offset));
+}
+
+pair<amiq_rm_reg_data_t, amiq_rm_status_t> amiq_rm_mem::read(amiq_rm_reg_address_t offset) {
+	pair<amiq_rm_reg_data_t, amiq_rm_status_t> data_with_status;
+	if (is_inside(offset, sizeof(amiq_rm_reg_data_t))) {
+		data_with_status.first = get(offset);
+		data_with_status.second = OKAY;
+	} else {
+		data_with_status.first = 0;
+		data_with_status.second = ERROR;
+	}
+	return data_with_status;
+}
+
+amiq_rm_status_t amiq_rm_mem::write(amiq_rm_reg_address_t offset, amiq_rm_reg_data_t write_data) {
+	if (!is_inside(offset, sizeof(amiq_rm_reg_data_t))) {
+		return ERROR;
+	}
+	set(offset, write_data);
+	return OKAY;
+}
+
+pair<amiq_rm_reg_data_t, amiq_rm_status_t> amiq_rm_mem::read(amiq_rm_reg_address_t offset, int unsigned byte_enable) {
+	pair<amiq_rm_reg_data_t, amiq_rm_status_t> data_with_status;
+	data_with_status.first = 0;
+	data_with_status.second = OKAY;
+	for (int unsigned i = 0; i < sizeof(amiq_rm_reg_data_t); i++) {
+		if ((byte_enable & (1 << i)) == 0)
+			continue;
+		if (!is_inside(offset + i, 1)) {
+			data_with_status.first = 0;
+			data_with_status.second = ERROR;
+			break;
+		}
+
+		unsigned char byte;
+		dump(offset + i, &byte, 1);
+		data_with_status.first |= ((amiq_rm_reg_data_t) byte) << (8 * i);
+	}
+	return data_with_status;
+}
+
+amiq_rm_status_t amiq_rm_mem::write(amiq_rm_reg_address_t offset, amiq_rm_reg_data_t write_data, int unsigned byte_enable) {
+	for (int unsigned i = 0; i < sizeof(amiq_rm_reg_data_t); i++) {
+		if (((byte_enable & (1 << i)) != 0) && !is_inside(offset + i, 1))
+			return ERROR;
+	}
+	for (int unsigned i = 0; i < sizeof(amiq_rm_reg_data_t); i++) {
+		if ((byte_enable & (1 << i)) != 0) {
+			unsigned char byte = (write_data >> (8 * i)) & 0xFF;
+			load(offset + i, &byte, 1);
+		}
+	}
+	return OKAY;
+}
+
+amiq_rm_reg_data_t amiq_rm_mem::get(amiq_rm_reg_address_t offset) {
+	unsigned char bytes[sizeof(amiq_rm_reg_data_t)];
+	amiq_rm_reg_data_t data = 0;
+
+	dump(offset, bytes, sizeof(amiq_rm_reg_data_t));
+	for (int unsigned i = 0; i < sizeof(amiq_rm_reg_data_t); i++)
+		data |= ((amiq_rm_reg_data_t) bytes[i]) << (8 * i);
+
+	return data;
+}
+
+void amiq_rm_mem::set(amiq_rm_reg_address_t offset, amiq_rm_reg_data_t write_data) {
+	unsigned char bytes[sizeof(amiq_rm_reg_data_t)];
+
+	for (int unsigned i = 0; i < sizeof(amiq_rm_reg_data_t); i++)
+		bytes[i] = (write_data >> (8 * i)) & 0xFF;
+	load(offset, bytes, sizeof(amiq_rm_reg_data_t));
+}
+
+void amiq_rm_mem::load(amiq_rm_reg_address_t offset, const unsigned char *src, size_t nof_bytes) {
+	assert(is_inside(offset, nof_bytes));
+	while (nof_bytes > 0) {
+		amiq_rm_reg_address_t page_offset = offset % AMIQ_RM_MEM_PAGE_SIZE;
+		size_t chunk = AMIQ_RM_MEM_PAGE_SIZE - page_offset;
+		if (chunk > nof_bytes)
+			chunk = nof_bytes;
+
+		memcpy(get_page(offset / AMIQ_RM_MEM_PAGE_SIZE, true) + page_offset, src, chunk);
+
+		offset += chunk;
+		src += chunk;
+		nof_bytes -= chunk;
+	}
+}
+
+void amiq_rm_mem::dump(amiq_rm_reg_address_t offset, unsigned char *dst, size_t nof_bytes) {
+	assert(is_inside(offset, nof_bytes));
+	while (nof_bytes > 0) {
+		amiq_rm_reg_address_t page_offset = offset % AMIQ_RM_MEM_PAGE_SIZE;
+		size_t chunk = AMIQ_RM_MEM_PAGE_SIZE - page_offset;
+		if (chunk > nof_bytes)
+			chunk = nof_bytes;
+
+		unsigned char *page = get_page(offset / AMIQ_RM_MEM_PAGE_SIZE, false);
+		if (page != NULL)
+			memcpy(dst, page + page_offset, chunk);
+		else
+			memset(dst, 0, chunk);
+
+		offset += chunk;
+		dst += chunk;
+		nof_bytes -= chunk;
+	}
+}
+
+void amiq_rm_mem::fill(amiq_rm_reg_address_t offset, unsigned char pattern, size_t nof_bytes) {
+	assert(is_inside(offset, nof_bytes));
+	while (nof_bytes > 0) {
+		amiq_rm_reg_address_t page_offset = offset % AMIQ_RM_MEM_PAGE_SIZE;
+		size_t chunk = AMIQ_RM_MEM_PAGE_SIZE - page_offset;
+		if (chunk > nof_bytes)
+			chunk = nof_bytes;
+
+		//a page which was never written already contains only 0
+		unsigned char *page = get_page(offset / AMIQ_RM_MEM_PAGE_SIZE, (pattern != 0));
+		if (page != NULL)
+			memset(page + page_offset, pattern, chunk);
+
+		offset += chunk;
+		nof_bytes -= chunk;
+	}
+}
+
+int unsigned amiq_rm_mem::get_nof_allocated_pages() {
+	int unsigned nof_pages = 0;
+	for (int unsigned i = 0; i < pages.size(); i++) {
+		if (pages[i] != NULL)
+			nof_pages++;
+	}
+	return nof_pages;
+}
+
+vector<amiq_rm_reg_address_t> amiq_rm_mem::get_offsets(amiq_rm_address_map &map) {
+	return map.get_mem_offsets(*this);
+}
+
+string amiq_rm_mem::to_string() {
+	ostringstream convert;
+	convert << name << " Size: " << hex << size << " Allocated pages: " << dec << get_nof_allocated_pages() << "/" << pages.size();
+	return convert.str();
+}
+
+}
+
+#endif
@@ -0,0 +1,154 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_mem.hpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef AMIQ_RM_MEM_HEADER
+#define AMIQ_RM_MEM_HEADER 1
+
+#include "amiq_rm_types.cpp"
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace amiq_rm {
+
+class amiq_rm_address_map;
+
+/** This class is used to model a memory region (buffers, descriptor RAMs, etc.). The memory is mapped in an address map with
+ * amiq_rm_address_map::add_mem() and occupies @b size bytes starting from its offset, without creating a register for each location.
+ * @n The contents are kept in pages of AMIQ_RM_MEM_PAGE_SIZE bytes which are allocated on the first write to the page.
+ * Locations from pages which were never written read as 0, so a large memory costs only the pages actually used.
+ * @n Word accesses (read(), write(), get(), set()) use sizeof(amiq_rm_reg_data_t) bytes in little-endian order. Bulk accesses
+ * are done with load(), dump() and fill(). */
+class amiq_rm_mem {
+public:
+	/** Size in bytes of a storage page. */
+	static const int unsigned AMIQ_RM_MEM_PAGE_SIZE = 4096;
+
+	/** The name of the memory. */
+	std::string name;
+
+	/** The size of the memory in terms of bytes. */
+	amiq_rm_reg_address_t size;
+
+	/** The vector holds the address maps which contain the memory. New parents are added when amiq_rm_address_map::add_mem() is called.*/
+	std::vector<amiq_rm_address_map*> parent_maps;
+
+	/** Create new memory. No storage is allocated until the first write.
+	 * @param my_name is set as name
+	 * @param my_size is the size of the memory in bytes */
+	amiq_rm_mem(std::string my_name, amiq_rm_reg_address_t my_size) {
+		name = my_name;
+		size = my_size;
+
+		pages.resize((my_size + AMIQ_RM_MEM_PAGE_SIZE - 1) / AMIQ_RM_MEM_PAGE_SIZE, NULL);
+	}
+
+	/** Delete the allocated pages. */
+	virtual ~amiq_rm_mem() {
+		clear();
+	}
+
+	/** The function releases all allocated pages, thus all locations of the memory will read as 0.
+	 * It is not called by amiq_rm_address_map::reset() as register reset does not affect memory contents. */
+	void clear();
+
+	/** @param offset is the offset (in bytes, relative to the start of the memory) of the word which is read
+	 * @returns the word from the given offset as well as the status of the read operation.
+	 * ERROR is returned if the word does not fit inside the memory. */
+	std::pair<amiq_rm_reg_data_t, amiq_rm_status_t> read(amiq_rm_reg_address_t offset);
+
+	/** @param offset is the offset (in bytes, relative to the start of the memory) of the word which is written
+	 * @param write_data is the data that is going to be written to the memory
+	 * @returns the status of the write operation. ERROR is returned if the word does not fit inside the memory. */
+	amiq_rm_status_t write(amiq_rm_reg_address_t offset, amiq_rm_reg_data_t write_data);
+
+	/** @param offset is the offset (in bytes, relative to the start of the memory) of the word which is read
+	 * @param byte_enable selects the bytes of the word which are read, bit @b i selects the byte at offset + i
+	 * @returns the enabled bytes of the word (the others are 0) as well as the status of the read operation.
+	 * ERROR is returned if an enabled byte is not inside the memory. */
+	std::pair<amiq_rm_reg_data_t, amiq_rm_status_t> read(amiq_rm_reg_address_t offset, int unsigned byte_enable);
+
+	/** @param offset is the offset (in bytes, relative to the start of the memory) of the word which is written
+	 * @param write_data is the data that is going to be written to the enabled bytes of the word
+	 * @param byte_enable selects the bytes of the word which are written, bit @b i selects the byte at offset + i
+	 * @returns the status of the write operation. ERROR is returned if an enabled byte is not inside the memory. */
+	amiq_rm_status_t write(amiq_rm_reg_address_t offset, amiq_rm_reg_data_t write_data, int unsigned byte_enable);
+
+	/** @param offset is the offset (in bytes, relative to the start of the memory) of the word which is returned
+	 * @returns the word from the given offset. The word must fit inside the memory. */
+	amiq_rm_reg_data_t get(amiq_rm_reg_address_t offset);
+
+	/** @param offset is the offset (in bytes, relative to the start of the memory) of the word which is modified
+	 * @param write_data is the value set to the word. The word must fit inside the memory. */
+	void set(amiq_rm_reg_address_t offset, amiq_rm_reg_data_t write_data);
+
+	/** The function copies a buffer into the memory (equivalent of a memcpy() to the memory).
+	 * @param offset is the offset (in bytes) from which the copy starts
+	 * @param src is the buffer which is copied
+	 * @param nof_bytes is the number of bytes which are copied; the range must fit inside the memory */
+	void load(amiq_rm_reg_address_t offset, const unsigned char *src, std::size_t nof_bytes);
+
+	/** The function copies the contents of the memory into a buffer (equivalent of a memcpy() from the memory).
+	 * Locations from pages which were never written are returned as 0.
+	 * @param offset is the offset (in bytes) from which the copy starts
+	 * @param dst is the buffer in which the contents are copied
+	 * @param nof_bytes is the number of bytes which are copied; the range must fit inside the memory */
+	void dump(amiq_rm_reg_address_t offset, unsigned char *dst, std::size_t nof_bytes);
+
+	/** The function sets a range of the memory to a value (equivalent of a memset() on the memory).
+	 * Filling with 0 does not allocate pages which were not written before.
+	 * @param offset is the offset (in bytes) from which the fill starts
+	 * @param pattern is the value set to each byte of the range
+	 * @param nof_bytes is the number of bytes which are filled; the range must fit inside the memory */
+	void fill(amiq_rm_reg_address_t offset, unsigned char pattern, std::size_t nof_bytes);
+
+	/** @returns the number of pages which are currently allocated. */
+	int unsigned get_nof_allocated_pages();
+
+	/** The function returns the offsets of the memory. The offsets are calculated relative to the address map passed as argument.
+	 * This function is a wrapper of the equivalent function @b amiq_rm_address_map::get_mem_offsets().
+	 * @param map pointer to the address map relative to which the calculation of the offset takes place.
+	 * @returns a vector which contains all the offsets at which the memory is mapped under the map argument. */
+	std::vector<amiq_rm_reg_address_t> get_offsets(amiq_rm_address_map &map);
+
+	/** @returns a string with debug purpose information. */
+	std::string to_string();
+
+private:
+	/** The page table of the memory. An entry is NULL until the first write to the page. */
+	std::vector<unsigned char*> pages;
+
+	/** @param page_index is the index of the page in the page table
+	 * @param allocate specifies if the page is allocated (and zeroed) in case it was not used before
+	 * @returns a pointer to the page or NULL if the page is not allocated and @b allocate is false */
+	unsigned char* get_page(amiq_rm_reg_address_t page_index, bool allocate);
+
+	/** @returns true if the range [offset, offset + nof_bytes) is inside the memory. */
+	bool is_inside(amiq_rm_reg_address_t offset, std::size_t nof_bytes);
+
+	/** The memory owns its pages, so it can not be copied. Declared but not defined. */
+	amiq_rm_mem(const amiq_rm_mem &other);
+
+	/** The memory owns its pages, so it can not be assigned. Declared but not defined. */
+	amiq_rm_mem& operator=(const amiq_rm_mem &other);
+};
+
+}
+
+#endif
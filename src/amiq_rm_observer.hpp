@@ -0,0 +1,47 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_observer.hpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef AMIQ_RM_OBSERVER_HEADER
+#define AMIQ_RM_OBSERVER_HEADER 1
+
+#include "amiq_rm_types.cpp"
+
+namespace amiq_rm {
+
+class amiq_rm_reg;
+
+/** This class is the base of the objects which are notified when the value of a register changes (e.g. the probes of amiq_rm_vcd_writer).
+ * An observer is attached with amiq_rm_reg::add_observer(). It is notified after reset(), set(), set_field_value(), randomize(), after
+ * the value is pulled from a provider and once at the end of read() and write() (so the side effects are included), only if the value
+ * changed. Changing amiq_rm_reg::value directly is not notified. */
+class amiq_rm_reg_observer {
+public:
+	/** There are no pointers to delete. */
+	virtual ~amiq_rm_reg_observer() {
+	}
+
+	/** The function is called after the value of an observed register changed.
+	 * @param reg is the register, reg.value holds the new value
+	 * @param old_value is the value before the change */
+	virtual void value_changed(amiq_rm_reg &reg, amiq_rm_reg_data_t old_value) = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,32 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_provider.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef	AMIQ_RM_PROVIDER
+#define	AMIQ_RM_PROVIDER	1
+
+#include "amiq_rm_provider.hpp"
+
+namespace amiq_rm {
+
+//the registers start with epoch 0 as pulled, so the first epoch is 1
+uint64_t amiq_rm_value_provider::epoch = 1;
+
+}
+
+#endif
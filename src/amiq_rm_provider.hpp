@@ -0,0 +1,64 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_provider.hpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef AMIQ_RM_PROVIDER_HEADER
+#define AMIQ_RM_PROVIDER_HEADER 1
+
+#include "amiq_rm_types.cpp"
+#include <stdint.h>
+
+namespace amiq_rm {
+
+class amiq_rm_reg;
+
+/** This class is the base of the value providers: objects which supply the value of a field or of a register driven by the DUT
+ * (e.g. a counter or a status), so the value does not have to be pushed into the model with set() on each change of the hardware.
+ * @n A provider is attached with amiq_rm_reg::set_provider() or amiq_rm_field::provider and it is pulled only when the value is needed:
+ * by read(), write(), get(), get_field_value() and set_field_value() of the register. The pulled value is kept until the epoch changes,
+ * so the accesses done in the same epoch call the provider only once; advance_epoch() must be called each time the hardware may
+ * have changed (e.g. on each clock edge or each time the simulation advances). */
+class amiq_rm_value_provider {
+public:
+	/** There are no pointers to delete. */
+	virtual ~amiq_rm_value_provider() {
+	}
+
+	/** The function is implemented by the user to supply the value.
+	 * @param reg is the register whose value is pulled
+	 * @returns the value of the register, or the value of the field (starting from bit 0) for a provider attached to a field */
+	virtual amiq_rm_reg_data_t get_value(amiq_rm_reg &reg) = 0;
+
+	/** @returns the current epoch. */
+	static uint64_t get_epoch() {
+		return epoch;
+	}
+
+	/** The function starts a new epoch: the next access of each register with providers pulls the value again. */
+	static void advance_epoch() {
+		epoch++;
+	}
+
+private:
+	/** The current epoch. */
+	static uint64_t epoch;
+};
+
+}
+
+#endif
@@ -0,0 +1,43 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_quantum_keeper.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+
+#ifndef	AMIQ_RM_QUANTUM_KEEPER
+#define	AMIQ_RM_QUANTUM_KEEPER	1
+
+#include "amiq_rm_quantum_keeper.hpp"
+#include "amiq_rm_counter.hpp"
+
+using namespace std;
+
+namespace amiq_rm {
+
+void amiq_rm_quantum_keeper::sync() {
+	uint64_t consumed_time = local_time;
+	local_time = 0;
+	nof_syncs++;
+	if (sync_function)
+		sync_function(consumed_time);
+	if ((time_source != NULL) && (consumed_time > 0))
+		time_source->advance(consumed_time);
+}
+
+}
+
+#endif
@@ -0,0 +1,109 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_quantum_keeper.hpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef AMIQ_RM_QUANTUM_KEEPER_HEADER
+#define AMIQ_RM_QUANTUM_KEEPER_HEADER 1
+
+#include "amiq_rm_types.cpp"
+#include <functional>
+#include <stdint.h>
+
+namespace amiq_rm {
+
+class amiq_rm_time_source;
+
+/** This class keeps the local time of an initiator of a loosely-timed platform (temporal decoupling): the accesses done with a keeper
+ * (see amiq_rm_physical_address_map::read() and amiq_rm_sequence::run()) add their latency to the local time instead of synchronizing
+ * with the simulation kernel, and the initiator synchronizes only when the local time reaches the quantum (need_sync(), sync()).
+ * @n sync() calls the synchronization function (e.g. a function which waits in the simulation kernel for the given time) and then
+ * advances the optional time source (see amiq_rm_time_source), so the counters see the time of the kernel. Inside a quantum the
+ * counters do not see the local time, as for any other model which is not synchronized. */
+class amiq_rm_quantum_keeper {
+public:
+	/** The function which synchronizes with the simulation kernel, it receives the local time which is consumed. */
+	typedef std::function<void(uint64_t)> amiq_rm_sync_function_t;
+
+	/** The local time after which the initiator must synchronize. */
+	uint64_t quantum;
+
+	/** Create new keeper, the local time starts at 0.
+	 * @param my_quantum is set as quantum */
+	amiq_rm_quantum_keeper(uint64_t my_quantum) {
+		quantum = my_quantum;
+		local_time = 0;
+		nof_syncs = 0;
+		time_source = NULL;
+	}
+
+	/** There are no pointers to delete. */
+	virtual ~amiq_rm_quantum_keeper() {
+	}
+
+	/** @param function is called by sync() with the local time which is consumed */
+	void set_sync_function(amiq_rm_sync_function_t function) {
+		sync_function = function;
+	}
+
+	/** @param source is advanced by sync() with the local time which is consumed, NULL if there is no time source; it is not deleted by the keeper */
+	void set_time_source(amiq_rm_time_source *source) {
+		time_source = source;
+	}
+
+	/** The function annotates a delay (e.g. the latency of an access) on the local time.
+	 * @param delay is added to the local time */
+	void inc(uint64_t delay) {
+		local_time += delay;
+	}
+
+	/** @returns the local time, i.e. the time consumed since the last synchronization. */
+	uint64_t get_local_time() {
+		return local_time;
+	}
+
+	/** @returns true if the local time reached the quantum. */
+	bool need_sync() {
+		return (local_time >= quantum);
+	}
+
+	/** The function synchronizes with the simulation kernel: it calls the synchronization function and advances the time source
+	 * with the local time, then sets the local time to 0. */
+	void sync();
+
+	/** @returns the number of synchronizations done by sync(). */
+	long long unsigned get_nof_syncs() {
+		return nof_syncs;
+	}
+
+private:
+	/** The time consumed since the last synchronization. */
+	uint64_t local_time;
+
+	/** The number of synchronizations done by sync(). */
+	long long unsigned nof_syncs;
+
+	/** The function set with set_sync_function(). */
+	amiq_rm_sync_function_t sync_function;
+
+	/** The time source set with set_time_source() or NULL. */
+	amiq_rm_time_source *time_source;
+};
+
+}
+
+#endif
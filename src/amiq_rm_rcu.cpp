@@ -0,0 +1,136 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_rcu.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef	AMIQ_RM_RCU
+#define	AMIQ_RM_RCU	1
+
+#include <assert.h>
+#include "amiq_rm_rcu.hpp"
+
+using namespace std;
+
+namespace amiq_rm {
+
+/** Releases the record of a reader thread when the thread ends. */
+class amiq_rm_rcu_thread_record {
+public:
+	amiq_rm_rcu::amiq_rm_rcu_reader *reader;
+
+	amiq_rm_rcu_thread_record() {
+		reader = NULL;
+	}
+
+	virtual ~amiq_rm_rcu_thread_record() {
+		if (reader != NULL)
+			__atomic_store_n(&reader->in_use, false, __ATOMIC_RELEASE);
+	}
+};
+
+/** The record of the calling thread in the domain returned by amiq_rm_rcu::get(). */
+static thread_local amiq_rm_rcu_thread_record amiq_rm_rcu_record;
+
+amiq_rm_rcu& amiq_rm_rcu::get() {
+	static amiq_rm_rcu rcu;
+	return rcu;
+}
+
+amiq_rm_rcu::~amiq_rm_rcu() {
+	for (int unsigned i = 0; i < retired.size(); i++)
+		retired[i].deleter(retired[i].object);
+	for (int unsigned i = 0; i < readers.size(); i++)
+		delete readers[i];
+}
+
+amiq_rm_rcu::amiq_rm_rcu_reader* amiq_rm_rcu::get_reader() {
+	//only the default domain keeps a record in each thread
+	assert(this == &get());
+	if (amiq_rm_rcu_record.reader != NULL)
+		return amiq_rm_rcu_record.reader;
+
+	lock_guard<mutex> lock(update_mutex);
+	amiq_rm_rcu_reader *reader = NULL;
+	for (int unsigned i = 0; (reader == NULL) && (i < readers.size()); i++) {
+		if (!__atomic_load_n(&readers[i]->in_use, __ATOMIC_ACQUIRE))
+			reader = readers[i];
+	}
+	if (reader == NULL) {
+		reader = new amiq_rm_rcu_reader();
+		readers.push_back(reader);
+	}
+	reader->epoch = 0;
+	reader->nesting = 0;
+	__atomic_store_n(&reader->in_use, true, __ATOMIC_RELAXED);
+	amiq_rm_rcu_record.reader = reader;
+	return reader;
+}
+
+void amiq_rm_rcu::read_lock() {
+	amiq_rm_rcu_reader *reader = get_reader();
+	if (reader->nesting++ == 0) {
+		//the store must be visible to the updaters before the shared structure is read
+		__atomic_store_n(&reader->epoch, __atomic_load_n(&epoch, __ATOMIC_ACQUIRE), __ATOMIC_SEQ_CST);
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	}
+}
+
+void amiq_rm_rcu::read_unlock() {
+	amiq_rm_rcu_reader *reader = amiq_rm_rcu_record.reader;
+	assert((reader != NULL) && (reader->nesting > 0));
+	if (--reader->nesting == 0)
+		__atomic_store_n(&reader->epoch, 0, __ATOMIC_RELEASE);
+}
+
+void amiq_rm_rcu::retire(void *object, amiq_rm_rcu_deleter_t deleter) {
+	lock_guard<mutex> lock(update_mutex);
+	amiq_rm_rcu_retired item;
+	item.object = object;
+	item.deleter = deleter;
+	//the readers which start after the increment can not see the object, which was unpublished before
+	item.epoch = __atomic_fetch_add(&epoch, 1, __ATOMIC_SEQ_CST);
+	retired.push_back(item);
+}
+
+int unsigned amiq_rm_rcu::reclaim() {
+	lock_guard<mutex> lock(update_mutex);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	uint64_t oldest = ~((uint64_t) 0);
+	for (int unsigned i = 0; i < readers.size(); i++) {
+		uint64_t reader_epoch = __atomic_load_n(&readers[i]->epoch, __ATOMIC_ACQUIRE);
+		if ((reader_epoch != 0) && (reader_epoch < oldest))
+			oldest = reader_epoch;
+	}
+
+	//an object retired in an epoch can be used only by the readers which started in that epoch or before
+	int unsigned nof_deleted = 0;
+	while ((nof_deleted < retired.size()) && (retired[nof_deleted].epoch < oldest)) {
+		retired[nof_deleted].deleter(retired[nof_deleted].object);
+		nof_deleted++;
+	}
+	retired.erase(retired.begin(), retired.begin() + nof_deleted);
+	return nof_deleted;
+}
+
+int unsigned amiq_rm_rcu::get_nof_retired() {
+	lock_guard<mutex> lock(update_mutex);
+	return retired.size();
+}
+
+}
+
+#endif
@@ -0,0 +1,129 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_rcu.hpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef AMIQ_RM_RCU_HEADER
+#define AMIQ_RM_RCU_HEADER 1
+
+#include "amiq_rm_types.cpp"
+#include <vector>
+#include <mutex>
+#include <stdint.h>
+
+namespace amiq_rm {
+
+/** This class implements read-copy-update with epoch-based reclamation: an updater replaces a shared structure by publishing a new
+ * copy with an atomic pointer store, and retires the old copy with retire(); the old copy is deleted by reclaim() only after all the
+ * readers which might have seen it left their read-side sections. The readers never block: a read-side section (read_lock()/read_unlock(),
+ * usually through amiq_rm_rcu_read_guard) only publishes the epoch in which it started in a record owned by the thread.
+ * @n The read-side sections can be nested. The updaters are serialized by a mutex. */
+class amiq_rm_rcu {
+public:
+	/** The function which deletes a retired object. */
+	typedef void (*amiq_rm_rcu_deleter_t)(void *object);
+
+	/** @returns the domain used by the address maps. */
+	static amiq_rm_rcu& get();
+
+	/** Create a domain without readers. */
+	amiq_rm_rcu() {
+		epoch = 1;
+	}
+
+	/** Delete the records of the readers and the objects which are still retired (there must be no readers left). */
+	virtual ~amiq_rm_rcu();
+
+	/** The function starts a read-side section of the calling thread. */
+	void read_lock();
+
+	/** The function ends a read-side section of the calling thread. */
+	void read_unlock();
+
+	/** The function retires an object which was unpublished; it is deleted once no reader can use it.
+	 * @param object is the object
+	 * @param deleter is the function which deletes the object */
+	void retire(void *object, amiq_rm_rcu_deleter_t deleter);
+
+	/** The function deletes the retired objects which can no longer be used by readers.
+	 * @returns the number of deleted objects */
+	int unsigned reclaim();
+
+	/** @returns the number of retired objects which were not deleted yet. */
+	int unsigned get_nof_retired();
+
+	/** The record of a reader thread. */
+	struct amiq_rm_rcu_reader {
+		/** The epoch in which the outermost read-side section started, 0 outside read-side sections. Written by the reader. */
+		uint64_t epoch;
+
+		/** The depth of the nested read-side sections. */
+		int unsigned nesting;
+
+		/** Set while the record is owned by a thread. */
+		bool in_use;
+	};
+
+private:
+	/** A retired object. */
+	struct amiq_rm_rcu_retired {
+		void *object;
+		amiq_rm_rcu_deleter_t deleter;
+		uint64_t epoch;
+	};
+
+	/** The global epoch, advanced by each retire(). */
+	uint64_t epoch;
+
+	/** The records of the reader threads; a record is reused when its thread ends. */
+	std::vector<amiq_rm_rcu_reader*> readers;
+
+	/** The retired objects, in the order of their retirement. */
+	std::vector<amiq_rm_rcu_retired> retired;
+
+	/** Protects @b readers and @b retired. */
+	std::mutex update_mutex;
+
+	/** @returns the record of the calling thread, it is created at the first call. */
+	amiq_rm_rcu_reader* get_reader();
+};
+
+/** A read-side section of amiq_rm_rcu::get() which lasts for the scope of the guard. */
+class amiq_rm_rcu_read_guard {
+public:
+	/** Start the read-side section.
+	 * @param my_enabled if not set, the guard does nothing (the structure is not updated concurrently) */
+	amiq_rm_rcu_read_guard(bool my_enabled) {
+		enabled = my_enabled;
+		if (enabled)
+			amiq_rm_rcu::get().read_lock();
+	}
+
+	/** End the read-side section. */
+	virtual ~amiq_rm_rcu_read_guard() {
+		if (enabled)
+			amiq_rm_rcu::get().read_unlock();
+	}
+
+private:
+	/** Set if the guard started a read-side section. */
+	bool enabled;
+};
+
+}
+
+#endif
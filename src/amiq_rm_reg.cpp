@@ -21,15 +21,49 @@
 #define	AMIQ_RM_REG	1
 
 #include <assert.h>
+#include <stdint.h>
+#include <mutex>
+#include <condition_variable>
 #include "amiq_rm_reg.hpp"
 #include "amiq_rm_address_map.hpp"
+#include "amiq_rm_hook_queue.hpp"
 
 using namespace std;
 
 namespace amiq_rm {
 
+//the table below has one entry for each byte enable of a 4-byte data type
+typedef char amiq_rm_lane_masks_check[(sizeof(amiq_rm_reg_data_t) == 4) ? 1 : -1];
+
+/** A lock and a condition shared by the registers whose address hashes to it, used by wait_for(). */
+struct amiq_rm_wait_slot {
+	/** Protects the waits of wait_for(). */
+	mutex wait_mutex;
+
+	/** Notified when a register of the slot with waiting threads changes. */
+	condition_variable wait_condition;
+};
+
+/** The number of wait slots, the waits on different registers rarely share a slot. */
+static const int unsigned AMIQ_RM_NOF_WAIT_SLOTS = 64;
+
+/** The wait slots, a register uses the slot given by amiq_rm_get_wait_slot(). */
+static amiq_rm_wait_slot amiq_rm_wait_slots[AMIQ_RM_NOF_WAIT_SLOTS];
+
+/** @returns the wait slot of a register */
+static amiq_rm_wait_slot& amiq_rm_get_wait_slot(const amiq_rm_reg *reg) {
+	return amiq_rm_wait_slots[(reinterpret_cast<uintptr_t>(reg) / sizeof(void*)) % AMIQ_RM_NOF_WAIT_SLOTS];
+}
+
+const amiq_rm_reg_data_t amiq_rm_reg::lane_masks[1 << AMIQ_RM_NOF_LANES] = { 0x00000000, 0x000000FF, 0x0000FF00, 0x0000FFFF, 0x00FF0000, 0x00FF00FF,
+		0x00FFFF00, 0x00FFFFFF, 0xFF000000, 0xFF0000FF, 0xFF00FF00, 0xFF00FFFF, 0xFFFF0000, 0xFFFF00FF, 0xFFFFFF00, 0xFFFFFFFF };
+
 void amiq_rm_reg::reset() {
+	//the providers are pulled first, so the change is notified from the current value
+	refresh();
+	amiq_rm_reg_data_t old_value = value;
 	value = reset_value;
+	changed(old_value);
 }
 
 void amiq_rm_reg::add_field(amiq_rm_field *my_field) {
@@ -57,6 +91,7 @@ amiq_rm_field* amiq_rm_reg::get_field_my_name(string my_name) {
 }
 
 amiq_rm_reg_data_t amiq_rm_reg::get_field_value(string field_name) {
+	refresh();
 	return get_access_data_for_field(field_name, value);
 }
 
@@ -64,13 +99,18 @@ void amiq_rm_reg::set_field_value(string field_name, amiq_rm_reg_data_t new_valu
 	amiq_rm_field *field = get_field_my_name(field_name);
 
 	if (field != NULL) {
+		refresh();
 		amiq_rm_reg_data_t field_mask = extract_mask(field->lsb_position, field->lsb_position + field->size - 1);
 		amiq_rm_reg_data_t value_to_write = (new_value << field->lsb_position);
 		value_to_write = value_to_write & field_mask;
 
 		//clear previous field value and replace with new value;
-		value = value & (!field_mask);
+		amiq_rm_reg_data_t old_value = value;
+		value = value & (~field_mask);
 		value = value ^ value_to_write;
+		//the hooks of read() and write() may set fields, the change is notified at the end of the access
+		if (!in_access)
+			changed(old_value);
 	} else {
 		assert(0);
 	}
@@ -109,6 +149,209 @@ amiq_rm_reg_data_t amiq_rm_reg::compute_read_mask() {
 	return my_mask;
 }
 
+void amiq_rm_reg::compute_effect_masks() {
+	w1c_mask = 0;
+	clear_on_read_mask = 0;
+	set_on_read_mask = 0;
+	clear_on_write_mask = 0;
+	set_on_write_mask = 0;
+	for (int unsigned i = 0; i < fields.size(); i++) {
+		amiq_rm_reg_data_t field_mask = extract_mask(fields[i]->lsb_position, fields[i]->lsb_position + fields[i]->size - 1);
+		if (fields[i]->attrib == "W1C")
+			w1c_mask |= field_mask;
+		if (fields[i]->is_clear_on_read())
+			clear_on_read_mask |= field_mask;
+		if (fields[i]->is_set_on_read())
+			set_on_read_mask |= field_mask;
+		if (fields[i]->is_clear_on_write())
+			clear_on_write_mask |= field_mask;
+		if (fields[i]->is_set_on_write())
+			set_on_write_mask |= field_mask;
+	}
+}
+
+void amiq_rm_reg::compute_rand_masks() {
+	rand_mask = 0;
+	rand_fields.clear();
+	rand_field_masks.clear();
+	for (int unsigned i = 0; i < fields.size(); i++) {
+		if (!fields[i]->is_writable())
+			continue;
+
+		amiq_rm_reg_data_t field_mask = extract_mask(fields[i]->lsb_position, fields[i]->lsb_position + fields[i]->size - 1);
+		if (fields[i]->is_rand_constrained()) {
+			rand_fields.push_back(i);
+			rand_field_masks.push_back(field_mask);
+		} else {
+			rand_mask |= field_mask;
+		}
+	}
+}
+
+void amiq_rm_reg::compute_field_layout() {
+	field_shifts.clear();
+	field_value_masks.clear();
+	for (int unsigned i = 0; i < fields.size(); i++) {
+		field_shifts.push_back(fields[i]->lsb_position);
+		field_value_masks.push_back(extract_mask(0, fields[i]->size - 1));
+	}
+}
+
+void amiq_rm_reg::unpack_columns(const amiq_rm_reg_data_t *words, int unsigned nof_words, amiq_rm_reg_data_t * const *columns) {
+	//one pass over the words for each field: the shift and the mask are constant in the inner loop, so it is vectorized
+	for (int unsigned i = 0; i < field_shifts.size(); i++) {
+		int unsigned shift = field_shifts[i];
+		amiq_rm_reg_data_t mask = field_value_masks[i];
+		amiq_rm_reg_data_t *column = columns[i];
+		for (int unsigned j = 0; j < nof_words; j++)
+			column[j] = (words[j] >> shift) & mask;
+	}
+}
+
+amiq_rm_reg_data_t amiq_rm_reg::constrain_random_value(amiq_rm_reg_data_t new_value, uint64_t random) {
+	for (int unsigned i = 0; i < rand_fields.size(); i++) {
+		amiq_rm_field *field = fields[rand_fields[i]];
+		uint64_t field_random = amiq_rm_random(random, i);
+		amiq_rm_reg_data_t field_value;
+
+		if (field->rand_values.size() > 0)
+			field_value = field->rand_values[field_random % field->rand_values.size()];
+		else
+			field_value = field->rand_min + (field_random % (((uint64_t) field->rand_max) - field->rand_min + 1));
+
+		new_value = (new_value & (~rand_field_masks[i])) | ((field_value << field->lsb_position) & rand_field_masks[i]);
+	}
+	return new_value;
+}
+
+void amiq_rm_reg::randomize(uint64_t seed) {
+	randomize(seed, 0);
+}
+
+void amiq_rm_reg::randomize(uint64_t seed, uint64_t counter) {
+	amiq_rm_reg_data_t old_value = value;
+	value = get_random_value(value, amiq_rm_random(seed, counter));
+	changed(old_value);
+}
+
+void amiq_rm_reg::set_provider(amiq_rm_value_provider *my_provider) {
+	provider = my_provider;
+	provider_epoch = 0;
+}
+
+void amiq_rm_reg::pull() {
+	amiq_rm_reg_data_t old_value = value;
+	provider_epoch = amiq_rm_value_provider::get_epoch();
+	if (provider != NULL)
+		value = provider->get_value(*this);
+	for (int unsigned i = 0; i < provided_fields.size(); i++) {
+		amiq_rm_field *field = fields[provided_fields[i]];
+		amiq_rm_reg_data_t field_mask = extract_mask(field->lsb_position, field->lsb_position + field->size - 1);
+		value = (value & (~field_mask)) | ((field->provider->get_value(*this) << field->lsb_position) & field_mask);
+	}
+	if (!in_access)
+		changed(old_value);
+}
+
+void amiq_rm_reg::compute_signal_masks() {
+	signal_mask = 0;
+	signal_ids.clear();
+	signal_value_masks.clear();
+	for (int unsigned i = 0; i < fields.size(); i++) {
+		amiq_rm_reg_data_t field_mask = extract_mask(fields[i]->lsb_position, fields[i]->lsb_position + fields[i]->size - 1);
+		for (int unsigned id = 0; id < amiq_rm_signal::AMIQ_RM_MAX_SIGNALS; id++) {
+			if ((fields[i]->signals & amiq_rm_signal::get_mask(id)) == 0)
+				continue;
+
+			int unsigned j = 0;
+			while ((j < signal_ids.size()) && (signal_ids[j] != id))
+				j++;
+			if (j == signal_ids.size()) {
+				signal_ids.push_back(id);
+				signal_value_masks.push_back(0);
+			}
+			signal_value_masks[j] |= field_mask;
+		}
+		signal_mask |= fields[i]->signals;
+	}
+}
+
+void amiq_rm_reg::changed(amiq_rm_reg_data_t old_value) {
+	if (old_value == value)
+		return;
+
+	if (signal_mask != 0) {
+		uint64_t old_signals = get_active_signals(old_value);
+		uint64_t new_signals = get_active_signals(value);
+		if (old_signals != new_signals) {
+			for (int unsigned i = 0; i < parent_maps.size(); i++)
+				parent_maps[i]->update_signals(old_signals, new_signals);
+		}
+	}
+
+	for (int unsigned i = 0; i < observers.size(); i++)
+		observers[i]->value_changed(*this, old_value);
+
+	//the value is stored before the waiters are counted and a waiter is counted before it checks the value: either the waiter
+	//sees the new value or it is seen here and notified
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&nof_waiters, __ATOMIC_SEQ_CST) != 0)
+		notify_waiters();
+}
+
+void amiq_rm_reg::notify_waiters() {
+	amiq_rm_wait_slot &slot = amiq_rm_get_wait_slot(this);
+	{
+		//a waiter which checked the old value is waiting once the lock is released
+		lock_guard<mutex> lock(slot.wait_mutex);
+	}
+	slot.wait_condition.notify_all();
+}
+
+bool amiq_rm_reg::wait_for(string field_name, function<bool(amiq_rm_reg_data_t)> predicate, chrono::nanoseconds timeout) {
+	amiq_rm_field *field = get_field_my_name(field_name);
+	assert(field != NULL);
+	amiq_rm_reg_data_t field_mask = extract_mask(0, field->size - 1);
+	chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + timeout;
+
+	amiq_rm_wait_slot &slot = amiq_rm_get_wait_slot(this);
+	unique_lock<mutex> lock(slot.wait_mutex);
+	__atomic_add_fetch(&nof_waiters, 1, __ATOMIC_SEQ_CST);
+	bool satisfied = false;
+	while (true) {
+		//the value is written without a lock by the accessing threads (an aligned word), it is read atomically here
+		satisfied = predicate((__atomic_load_n(&value, __ATOMIC_SEQ_CST) >> field->lsb_position) & field_mask);
+		if (satisfied || (slot.wait_condition.wait_until(lock, deadline) == cv_status::timeout))
+			break;
+	}
+	if (!satisfied)
+		satisfied = predicate((__atomic_load_n(&value, __ATOMIC_SEQ_CST) >> field->lsb_position) & field_mask);
+	__atomic_sub_fetch(&nof_waiters, 1, __ATOMIC_SEQ_CST);
+	return satisfied;
+}
+
+/** The predicate of wait_for() with an expected value. */
+static bool amiq_rm_is_equal(amiq_rm_reg_data_t expected, amiq_rm_reg_data_t field_value) {
+	return (field_value == expected);
+}
+
+bool amiq_rm_reg::wait_for(string field_name, amiq_rm_reg_data_t expected, chrono::nanoseconds timeout) {
+	return wait_for(field_name, bind(amiq_rm_is_equal, expected, placeholders::_1), timeout);
+}
+
+void amiq_rm_reg::add_observer(amiq_rm_reg_observer *observer) {
+	observers.push_back(observer);
+}
+
+void amiq_rm_reg::remove_observer(amiq_rm_reg_observer *observer) {
+	for (int unsigned i = 0; i < observers.size(); i++) {
+		if (observers[i] == observer) {
+			observers.erase(observers.begin() + i);
+			return;
+		}
+	}
+}
+
 amiq_rm_reg_data_t amiq_rm_reg::compute_reset_value() {
 	amiq_rm_reg_data_t my_reset_value = 0;
 	if (fields.size() > 0) {
@@ -128,7 +371,7 @@ void amiq_rm_reg::validate_fields() {
 		}
 	}
 	//total size of the fields must not exceed the size of register data type
-	assert((total_size / 8) < sizeof(amiq_rm_reg_data_t));
+	assert(total_size <= 8 * sizeof(amiq_rm_reg_data_t));
 
 	//TODO maybe add a check for overlapping fields
 }
@@ -138,6 +381,24 @@ void amiq_rm_reg::build() {
 	write_mask = compute_write_mask();
 	read_mask = compute_read_mask();
 	reset_value = compute_reset_value();
+
+	compute_effect_masks();
+	compute_rand_masks();
+	compute_field_layout();
+	compute_signal_masks();
+	provided_fields.clear();
+	for (int unsigned i = 0; i < fields.size(); i++) {
+		if (fields[i]->provider != NULL)
+			provided_fields.push_back(i);
+	}
+	provider_epoch = 0;
+	nof_bytes = (get_size() + 7) / 8;
+	if (nof_bytes == 0)
+		nof_bytes = 1;
+#ifdef AMIQ_RM_ENABLE_COVERAGE
+	if (coverage_index == AMIQ_RM_NO_COVERAGE_INDEX)
+		coverage_index = amiq_rm_coverage::get().add_reg(*this, amiq_rm_coverage::get_path(parent_maps, name));
+#endif
 }
 
 amiq_rm_reg_data_t amiq_rm_reg::get_write_mask() {
@@ -162,30 +423,84 @@ int unsigned amiq_rm_reg::get_size() {
 	return total_size;
 }
 
+int unsigned amiq_rm_reg::get_nof_bytes() {
+	return nof_bytes;
+}
+
+amiq_rm_reg_data_t amiq_rm_reg::get_access_mask() {
+	return access_mask;
+}
+
 pair<amiq_rm_reg_data_t, amiq_rm_status_t> amiq_rm_reg::read() {
+	return read(AMIQ_RM_ALL_LANES);
+}
+
+pair<amiq_rm_reg_data_t, amiq_rm_status_t> amiq_rm_reg::read(int unsigned byte_enable) {
 	pair<amiq_rm_reg_data_t, amiq_rm_status_t> data_with_status;
-	data_with_status.second = pre_access(READ, NULL);
+	assert(byte_enable <= AMIQ_RM_ALL_LANES);
+	refresh();
+	amiq_rm_reg_data_t old_value = value;
+	access_mask = lane_masks[byte_enable];
+	in_access = true;
+	data_with_status.first = 0;
+	data_with_status.second = pre_access(READ, 0);
 	if (data_with_status.second == OKAY) {
-		data_with_status.first = value & read_mask;
-		post_access(READ, NULL);
+		data_with_status.first = value & read_mask & access_mask;
+		post_access(READ, 0);
+		if (hook_queue != NULL)
+			hook_queue->push(this, READ, 0, data_with_status.first, access_mask, element_index);
+		else
+			deferred_access(READ, 0, data_with_status.first, access_mask, element_index);
+#ifdef AMIQ_RM_ENABLE_COVERAGE
+		if (coverage_index != AMIQ_RM_NO_COVERAGE_INDEX)
+			amiq_rm_coverage::get().sample(coverage_index, READ, 0, data_with_status.first);
+#endif
 	}
+	in_access = false;
+	access_mask = ~((amiq_rm_reg_data_t) 0);
+	changed(old_value);
 	return data_with_status;
 }
 
 amiq_rm_reg_data_t amiq_rm_reg::get() {
+	refresh();
 	return value;
 }
 
 void amiq_rm_reg::set(amiq_rm_reg_data_t write_data) {
+	refresh();
+	amiq_rm_reg_data_t old_value = value;
 	value = write_data;
+	changed(old_value);
 }
 
 amiq_rm_status_t amiq_rm_reg::write(amiq_rm_reg_data_t write_data) {
+	return write(write_data, AMIQ_RM_ALL_LANES);
+}
+
+amiq_rm_status_t amiq_rm_reg::write(amiq_rm_reg_data_t write_data, int unsigned byte_enable) {
+	assert(byte_enable <= AMIQ_RM_ALL_LANES);
+	refresh();
+	amiq_rm_reg_data_t old_value = value;
+	access_mask = lane_masks[byte_enable];
+	in_access = true;
 	amiq_rm_status_t status = pre_access(WRITE, write_data);
 	if (status == OKAY) {
-		value = write_data & write_mask;
+		amiq_rm_reg_data_t mask = write_mask & access_mask;
+		value = (value & (~mask)) | (write_data & mask);
 		post_access(WRITE, write_data);
+		if (hook_queue != NULL)
+			hook_queue->push(this, WRITE, write_data, value, access_mask, element_index);
+		else
+			deferred_access(WRITE, write_data, value, access_mask, element_index);
+#ifdef AMIQ_RM_ENABLE_COVERAGE
+		if (coverage_index != AMIQ_RM_NO_COVERAGE_INDEX)
+			amiq_rm_coverage::get().sample(coverage_index, WRITE, write_data, value);
+#endif
 	}
+	in_access = false;
+	access_mask = ~((amiq_rm_reg_data_t) 0);
+	changed(old_value);
 	return status;
 }
 
@@ -212,18 +527,15 @@ amiq_rm_reg_data_t amiq_rm_reg::get_access_data_for_field(string field_name, ami
 }
 
 void amiq_rm_reg::post_access(amiq_rm_direction_t direction, amiq_rm_reg_data_t access_data) {
-	if (fields.size() > 0) {
-		for (int unsigned i = 0; i <= fields.size() - 1; i++) {
-			//implement W1C mechanism
-			if ((direction == WRITE) && (fields[i]->attrib == "W1C")) {
-				set_field_value(fields[i]->name, get_field_value(fields[i]->name) ^ (!get_access_data_for_field(fields[i]->name, access_data)));
-			}
-
-			//clear field
-			if (((direction == READ) && (fields[i]->is_clear_on_read())) || ((direction == WRITE) && (fields[i]->is_clear_on_write()))) {
-				set_field_value(fields[i]->name, 0);
-			}
-		}
+	//the side effects are applied with the masks computed at build(), only the bits of the enabled lanes are affected
+	if (direction == WRITE) {
+		//implement W1C mechanism: the bits written with 1 are cleared
+		value = value & (~(access_data & w1c_mask & access_mask));
+		value = value & (~(clear_on_write_mask & access_mask));
+		value = value | (set_on_write_mask & access_mask);
+	} else {
+		value = value & (~(clear_on_read_mask & access_mask));
+		value = value | (set_on_read_mask & access_mask);
 	}
 }
 
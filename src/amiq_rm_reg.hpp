@@ -22,11 +22,30 @@
 
 #include "amiq_rm_types.cpp"
 #include "amiq_rm_field.hpp"
+#include "amiq_rm_coverage.hpp"
+#include "amiq_rm_observer.hpp"
 #include <vector>
+#include <functional>
+#include <chrono>
+#include <stdint.h>
 
 namespace amiq_rm {
 
 class amiq_rm_address_map;
+class amiq_rm_hook_queue;
+
+/** The function implements a counter-based pseudo-random generator (the SplitMix64 mix function): the number depends only on the seed and
+ * on the counter, so the numbers can be generated in any order (e.g. for all elements of contiguous storage in one loop) and a sequence
+ * is reproduced from its seed.
+ * @param seed is the seed of the sequence
+ * @param counter is the position in the sequence
+ * @returns a 64-bit pseudo-random number */
+inline uint64_t amiq_rm_random(uint64_t seed, uint64_t counter) {
+	uint64_t z = seed + (counter + 1) * 0x9E3779B97F4A7C15ULL;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
 
 /** This class is used to model a register. It contains a mechanism for field operations: adding fields, getting and setting the value
  * of a field. Basic register operations on a register are supported: reset, reading and writing, setting and getting the value of the register.
@@ -40,12 +59,27 @@ class amiq_rm_address_map;
  */
 class amiq_rm_reg {
 public:
+	/** Number of byte lanes of the register data type. */
+	static const int unsigned AMIQ_RM_NOF_LANES = sizeof(amiq_rm_reg_data_t);
+
+	/** Byte enable which selects all lanes, it is used by read() and write() without a byte enable. */
+	static const int unsigned AMIQ_RM_ALL_LANES = (1 << AMIQ_RM_NOF_LANES) - 1;
+
+	/** lane_masks[byte_enable] is the mask of the bits of the lanes selected by byte_enable (bit @b i of byte_enable selects byte @b i). */
+	static const amiq_rm_reg_data_t lane_masks[1 << AMIQ_RM_NOF_LANES];
+
 	/** The name of the register. */
 	std::string name;
 
-	/** The value of the register. */
+	/** The value of the register. Changing it directly (instead of with set(), write(), etc.) does not update the aggregate signals.
+	 * If the register has providers, the value is pulled only when get(), read(), etc. are called (see refresh()). */
 	amiq_rm_reg_data_t value;
 
+	/** The index of the accessed element when the register is the layout of a register array or a register of the prototype of a map array
+	 * (see amiq_rm_reg_array::get_current_index() and amiq_rm_map_array::get_current_index()), 0 otherwise. It is set by the array
+	 * for the duration of the access. */
+	int unsigned element_index;
+
 	/** The vector contains the fields from the register. Functions like get_field_by_name() relies on this vector.
 	 * To add a field the user must use add_field().*/
 	std::vector<amiq_rm_field*> fields;
@@ -59,9 +93,29 @@ public:
 		name = my_name;
 
 		value = 0;
+		element_index = 0;
 		read_mask = 0;
 		write_mask = 0;
 		reset_value = 0;
+		nof_bytes = 1;
+		w1c_mask = 0;
+		clear_on_read_mask = 0;
+		set_on_read_mask = 0;
+		clear_on_write_mask = 0;
+		set_on_write_mask = 0;
+		rand_mask = 0;
+		nof_waiters = 0;
+		provider = NULL;
+		provider_epoch = 0;
+		in_access = false;
+		hook_queue = NULL;
+		read_latency = 0;
+		write_latency = 0;
+		signal_mask = 0;
+		access_mask = ~((amiq_rm_reg_data_t) 0);
+#ifdef AMIQ_RM_ENABLE_COVERAGE
+		coverage_index = AMIQ_RM_NO_COVERAGE_INDEX;
+#endif
 	}
 
 	/** Delete the fields vector. */
@@ -96,6 +150,33 @@ public:
 	 * @param new_value is the value that is going to be set to the field */
 	void set_field_value(std::string field_name, amiq_rm_reg_data_t new_value);
 
+	/** The function packs the values of all fields in a register word, with the layout computed by build(); the bits of a value which
+	 * do not fit in its field are ignored. The register is not modified.
+	 * @param field_values holds one value for each field, in the order of @b fields
+	 * @returns the register word */
+	amiq_rm_reg_data_t pack(const amiq_rm_reg_data_t *field_values) {
+		amiq_rm_reg_data_t word = 0;
+		for (int unsigned i = 0; i < field_shifts.size(); i++)
+			word |= (field_values[i] & field_value_masks[i]) << field_shifts[i];
+		return word;
+	}
+
+	/** The function unpacks the values of all fields from a register word, with the layout computed by build().
+	 * @param word is the register word (e.g. the result of get())
+	 * @param field_values receives one value for each field, in the order of @b fields */
+	void unpack(amiq_rm_reg_data_t word, amiq_rm_reg_data_t *field_values) {
+		for (int unsigned i = 0; i < field_shifts.size(); i++)
+			field_values[i] = (word >> field_shifts[i]) & field_value_masks[i];
+	}
+
+	/** The function unpacks many register words with the layout of this register in columns, one column for each field
+	 * (e.g. the elements of an amiq_rm_reg_array or values sampled over time).
+	 * @param words are the register words
+	 * @param nof_words is the number of words
+	 * @param columns holds one array of @b nof_words values for each field, in the order of @b fields; columns[f][w] receives
+	 * the value of field @b f in word @b w */
+	void unpack_columns(const amiq_rm_reg_data_t *words, int unsigned nof_words, amiq_rm_reg_data_t * const *columns);
+
 	/** @returns the write_mask. The value is taken from class member write_mask (computed by calling build()).*/
 	amiq_rm_reg_data_t get_write_mask();
 
@@ -108,16 +189,124 @@ public:
 	/** @returns the size of the register in terms of bits by adding the size of each field. */
 	int unsigned get_size();
 
+	/** @returns the number of bytes covered by the register (computed by calling build()), at least 1. */
+	int unsigned get_nof_bytes();
+
 	/** @returns the value of the register as well as the status of the read operation.
 	 * For the read data the read_mask is applied. pre_access() and post_access() hooks are also called. */
 	std::pair<amiq_rm_reg_data_t, amiq_rm_status_t> read();
 
+	/** The function reads only some byte lanes of the register. The bytes of the lanes which are not enabled are returned as 0 and
+	 * the read side effects are applied only to the bits of the enabled lanes of the fields which have at least one bit in them.
+	 * @param byte_enable selects the lanes, bit @b i selects byte @b i of the register
+	 * @returns the value of the enabled lanes of the register as well as the status of the read operation */
+	std::pair<amiq_rm_reg_data_t, amiq_rm_status_t> read(int unsigned byte_enable);
+
 	/** @param write_data is the data that is going to be written to the register.
-	 * The value is written to the register my applying the write_mask. pre_access() and post_access() hooks are also called.
+	 * The value is written to the register my applying the write_mask, the bits which are not writable keep their value.
+	 * pre_access() and post_access() hooks are also called.
 	 * @returns the status of the write operation */
 	amiq_rm_status_t write(amiq_rm_reg_data_t write_data);
 
-	/** @returns the value of the register - it does not apply masking, no pre/post access hooks are called. The value is taken from class member value. */
+	/** The function writes only some byte lanes of the register. The other lanes keep their value and the write side effects
+	 * are applied only to the bits of the enabled lanes of the fields which have at least one bit in them.
+	 * @param write_data is the data that is going to be written to the register (the bytes of the lanes which are not enabled are ignored)
+	 * @param byte_enable selects the lanes, bit @b i selects byte @b i of the register
+	 * @returns the status of the write operation */
+	amiq_rm_status_t write(amiq_rm_reg_data_t write_data, int unsigned byte_enable);
+
+	/** The function computes a random value of the register: the writable bits of the fields which are not constrained get the bits of
+	 * @b random, the writable fields with constraints (amiq_rm_field::set_rand_range(), amiq_rm_field::set_rand_values()) get a legal value
+	 * and the other bits (read-only, reserved) keep their value. The constraints are the ones at the last build().
+	 * @param old_value is the current value of the register
+	 * @param random is a 64-bit random number (e.g. from amiq_rm_random())
+	 * @returns the random value */
+	amiq_rm_reg_data_t get_random_value(amiq_rm_reg_data_t old_value, uint64_t random) {
+		amiq_rm_reg_data_t new_value = (old_value & (~rand_mask)) | (((amiq_rm_reg_data_t) random) & rand_mask);
+		if (rand_fields.size() > 0)
+			new_value = constrain_random_value(new_value, random);
+		return new_value;
+	}
+
+	/** The function sets a random value to the register (see get_random_value()), without calling the pre/post access hooks.
+	 * @param seed is the seed of the random value */
+	void randomize(uint64_t seed);
+
+	/** The function sets a random value to the register (see get_random_value()), without calling the pre/post access hooks.
+	 * @param seed is the seed of the random value
+	 * @param counter is the position of the value in the random sequence (see amiq_rm_random()) */
+	void randomize(uint64_t seed, uint64_t counter);
+
+	/** The function attaches a provider which supplies the value of the register (see amiq_rm_value_provider). The fields which have their
+	 * own provider take their value from it.
+	 * @param my_provider is the provider, NULL to detach the provider; it is not deleted by the register */
+	void set_provider(amiq_rm_value_provider *my_provider);
+
+	/** The function attaches an observer which is notified when the value of the register changes (see amiq_rm_reg_observer).
+	 * @param observer is the observer, it is not deleted by the register */
+	void add_observer(amiq_rm_reg_observer *observer);
+
+	/** The function detaches an observer attached with add_observer().
+	 * @param observer is the observer */
+	void remove_observer(amiq_rm_reg_observer *observer);
+
+	/** The function blocks the calling thread until a field satisfies a condition or until a timeout, without polling the register:
+	 * the threads which change the value of the register (write(), set(), reset(), side effects, etc.) wake up the waiting threads.
+	 * Many threads can wait on the same register; when no thread waits, the accesses only test a counter. The waits on different
+	 * registers use different locks, unless the registers hash to the same wait slot.
+	 * @n The value is read without calling the providers and without side effects. Only stand-alone registers can be waited on
+	 * (not the layouts of the arrays).
+	 * @n The accessing threads write the value without a lock while the waiting thread reads it with an atomic load: the value is
+	 * an aligned word, so the waiting thread sees either the old or the new value, and a change is always followed by a notification
+	 * checked against the number of waiters after a full fence, so it is not missed.
+	 * @param field_name is the name of the field
+	 * @param predicate is the condition, it is called with the value of the field (starting from bit 0)
+	 * @param timeout is the maximum duration of the wait
+	 * @returns true if the condition is satisfied, false if the timeout expired */
+	bool wait_for(std::string field_name, std::function<bool(amiq_rm_reg_data_t)> predicate, std::chrono::nanoseconds timeout);
+
+	/** The function blocks the calling thread until a field has a value or until a timeout (see wait_for() with a predicate).
+	 * @param field_name is the name of the field
+	 * @param expected is the value of the field which is waited for
+	 * @param timeout is the maximum duration of the wait
+	 * @returns true if the field has the expected value, false if the timeout expired */
+	bool wait_for(std::string field_name, amiq_rm_reg_data_t expected, std::chrono::nanoseconds timeout);
+
+	/** @returns true if the register or one of its fields has a provider (the fields are taken into account after build()). */
+	bool has_providers() {
+		return ((provider != NULL) || (provided_fields.size() > 0));
+	}
+
+	/** The function pulls the value of the register from its providers, if this was not done in the current epoch.
+	 * It is called by the functions which need the value (read(), write(), get(), etc.). */
+	void refresh() {
+		if (has_providers() && (provider_epoch != amiq_rm_value_provider::get_epoch()))
+			pull();
+	}
+
+	/** @returns the mask of the aggregate signals to which the fields of the register contribute (computed by calling build()). */
+	uint64_t get_signal_mask() {
+		return signal_mask;
+	}
+
+	/** @param my_value is a value of the register
+	 * @returns the mask of the aggregate signals which are active for the given value: a signal is active if a field which contributes
+	 * to it (amiq_rm_field::add_signal()) has at least one bit set */
+	uint64_t get_active_signals(amiq_rm_reg_data_t my_value) {
+		uint64_t active_signals = 0;
+		for (int unsigned i = 0; i < signal_ids.size(); i++) {
+			if ((my_value & signal_value_masks[i]) != 0)
+				active_signals |= amiq_rm_signal::get_mask(signal_ids[i]);
+		}
+		return active_signals;
+	}
+
+	/** @returns the mask of the bits of the lanes enabled by the access in progress (all bits outside of an access).
+	 * It can be used in pre_access() and post_access() to restrict the side effects to the accessed lanes. */
+	amiq_rm_reg_data_t get_access_mask();
+
+	/** @returns the value of the register - it does not apply masking, no pre/post access hooks are called. The value is taken from class member value
+	 * (after pulling it from the providers, see refresh()). */
 	amiq_rm_reg_data_t get();
 
 	/** The function modifies the value of the register - it does not apply masking, no pre/post access hooks are called.
@@ -131,12 +320,59 @@ public:
 	 * @returns the status of the access to the register. */
 	virtual amiq_rm_status_t pre_access(amiq_rm_direction_t direction, amiq_rm_reg_data_t access_data);
 
-	/** The function is used for side-effects that take place after the actual READ/WRITE operation. In this function are implemented mechanisms like W1C.
+	/** The function is used for side-effects that take place after the actual READ/WRITE operation. In this function are implemented mechanisms like W1C,
+	 * clear on read/write and set on read/write; they are applied only to the lanes enabled by the access (see get_access_mask()).
 	 * The user can use this function as a hook and rewrite it, thus making possible an implementation of more exotic side-effects.
 	 * @param direction is the direction of the operation READ/WRITE
 	 * @param access_data is the data which the register is going to be accessed with. In case of a READ operation access_data is NULL*/
 	virtual void post_access(amiq_rm_direction_t direction, amiq_rm_reg_data_t access_data);
 
+	/** The function is a hook for the side effects which do not change the register and may run later than the access (e.g. notifying other
+	 * models, updating a scoreboard). It is called at the end of each successful read()/write() or, if the register has a hook queue
+	 * (see set_hook_queue()), when the queue executes the call, in the order of the accesses. The default implementation does nothing.
+	 * @param direction is the direction of the operation READ/WRITE
+	 * @param access_data is the data which the register was accessed with. In case of a READ operation access_data is 0
+	 * @param access_value is the read data for a READ or the value of the register after the side effects of a WRITE
+	 * @param lanes_mask is the mask of the bits of the lanes enabled by the access (see get_access_mask())
+	 * @param index is the index of the accessed element (see element_index), as the register of an array is shared by all its elements */
+	virtual void deferred_access(amiq_rm_direction_t direction, amiq_rm_reg_data_t access_data, amiq_rm_reg_data_t access_value,
+			amiq_rm_reg_data_t lanes_mask, int unsigned index) {
+	}
+
+	/** The function sets the queue in which the calls of deferred_access() are placed, so read() and write() return without calling it.
+	 * @param queue is the queue, NULL to call deferred_access() during the access; it is not deleted by the register */
+	void set_hook_queue(amiq_rm_hook_queue *queue) {
+		hook_queue = queue;
+	}
+
+	/** @returns the queue set with set_hook_queue() or NULL. */
+	amiq_rm_hook_queue* get_hook_queue() {
+		return hook_queue;
+	}
+
+	/** The function annotates the register with the latency of its accesses, it is added to the latency of the physical map
+	 * (see amiq_rm_physical_address_map::set_latency()) by the accesses done with a quantum keeper.
+	 * @param my_read_latency is the additional latency of a read
+	 * @param my_write_latency is the additional latency of a write */
+	void set_latency(uint64_t my_read_latency, uint64_t my_write_latency) {
+		read_latency = my_read_latency;
+		write_latency = my_write_latency;
+	}
+
+	/** @param direction is the direction of the access READ/WRITE
+	 * @returns the additional latency set with set_latency() */
+	uint64_t get_latency(amiq_rm_direction_t direction) {
+		return (direction == READ) ? read_latency : write_latency;
+	}
+
+	/** @param direction is the direction of the access READ/WRITE
+	 * @returns true if an access in the given direction has side effects (clear/set on read, W1C, clear/set on write), computed by calling build() */
+	bool has_side_effects(amiq_rm_direction_t direction) {
+		if (direction == READ)
+			return ((clear_on_read_mask | set_on_read_mask) != 0);
+		return ((w1c_mask | clear_on_write_mask | set_on_write_mask) != 0);
+	}
+
 	amiq_rm_reg_data_t get_access_data_for_field(std::string field_name, amiq_rm_reg_data_t access_data);
 
 	/** The function returns the offsets of the registers. The offsets are calculated relative to the address map passed as argument.
@@ -160,6 +396,95 @@ private:
 	/** reset_mask of the register. It is set when calling build() (which calls compute_reset_mask()). To access reset_mask, user can call get_reset_mask(). */
 	amiq_rm_reg_data_t reset_value;
 
+	/** The number of bytes covered by the fields. It is set when calling build(). */
+	int unsigned nof_bytes;
+
+	/** The mask of the W1C fields. It is set when calling build() (which calls compute_effect_masks()). */
+	amiq_rm_reg_data_t w1c_mask;
+
+	/** The mask of the fields cleared by a read. It is set when calling build(). */
+	amiq_rm_reg_data_t clear_on_read_mask;
+
+	/** The mask of the fields set by a read. It is set when calling build(). */
+	amiq_rm_reg_data_t set_on_read_mask;
+
+	/** The mask of the fields cleared by a write. It is set when calling build(). */
+	amiq_rm_reg_data_t clear_on_write_mask;
+
+	/** The mask of the fields set by a write. It is set when calling build(). */
+	amiq_rm_reg_data_t set_on_write_mask;
+
+	/** The mask of the lanes enabled by the access in progress. */
+	amiq_rm_reg_data_t access_mask;
+
+	/** The mask of the writable bits which are not constrained, they are randomized freely. It is set when calling build(). */
+	amiq_rm_reg_data_t rand_mask;
+
+	/** The number of threads waiting in wait_for(), it is accessed atomically. */
+	int unsigned nof_waiters;
+
+	/** The function wakes up the threads waiting in wait_for(). */
+	void notify_waiters();
+
+	/** The observers attached with add_observer(). */
+	std::vector<amiq_rm_reg_observer*> observers;
+
+	/** The queue of the calls of deferred_access() or NULL. */
+	amiq_rm_hook_queue *hook_queue;
+
+	/** The additional latency of a read, set with set_latency(). */
+	uint64_t read_latency;
+
+	/** The additional latency of a write, set with set_latency(). */
+	uint64_t write_latency;
+
+	/** The provider of the register value or NULL. */
+	amiq_rm_value_provider *provider;
+
+	/** The indexes of the fields which have a provider. They are set when calling build(). */
+	std::vector<int unsigned> provided_fields;
+
+	/** The epoch in which the value was pulled from the providers. */
+	uint64_t provider_epoch;
+
+	/** The function pulls the value of the register from the register provider and from the field providers. */
+	void pull();
+
+	/** Set during read() and write(), the changes done by the hooks are notified once, at the end of the access. */
+	bool in_access;
+
+	/** The mask of the aggregate signals to which the fields contribute. It is set when calling build(). */
+	uint64_t signal_mask;
+
+	/** The ids of the signals to which the fields contribute. They are set when calling build(). */
+	std::vector<int unsigned> signal_ids;
+
+	/** For each signal in @b signal_ids, the mask of the bits of the fields which contribute to it. */
+	std::vector<amiq_rm_reg_data_t> signal_value_masks;
+
+	/** The indexes of the writable fields with randomization constraints. They are set when calling build(). */
+	std::vector<int unsigned> rand_fields;
+
+	/** The masks of the fields in @b rand_fields. */
+	std::vector<amiq_rm_reg_data_t> rand_field_masks;
+
+	/** The lsb position of each field, used by pack() and unpack(). They are set when calling build(). */
+	std::vector<int unsigned> field_shifts;
+
+	/** The mask of the values of each field (the field mask shifted to bit 0). They are set when calling build(). */
+	std::vector<amiq_rm_reg_data_t> field_value_masks;
+
+#ifdef AMIQ_RM_ENABLE_COVERAGE
+	/** Value of coverage_index before the register is added to the coverage pool. */
+	static const int unsigned AMIQ_RM_NO_COVERAGE_INDEX = ~0U;
+
+	/** The index of the register in the coverage pool (amiq_rm_coverage::get()). It is set by the first call of build(). */
+	int unsigned coverage_index;
+
+	//the layout of a register array is named after the array in the coverage pool
+	friend class amiq_rm_reg_array;
+#endif
+
 	/** The function is used to create an extraction mask (with 1 from bit @b a to bit @b b) - useful when extracting field values.
 	 * @param a is the lsb used for creating the mask
 	 * @param b is the msb used for creating the mask
@@ -175,10 +500,37 @@ private:
 	/** @returns the reset_mask which is computed from the fields which were added with add_field().*/
 	amiq_rm_reg_data_t compute_reset_value();
 
+	/** The function computes the masks of the fields with side effects (W1C, clear/set on read/write) from the fields which were added with add_field().*/
+	void compute_effect_masks();
+
+	/** The function computes signal_mask, signal_ids and signal_value_masks from the fields which were added with add_field().*/
+	void compute_signal_masks();
+
+	/** The function is called after the value of the register was modified by reset(), set(), set_field_value(), randomize() or by an access
+	 * (once, at the end of read() and write()). It updates the aggregate signals of the parent maps and notifies the observers.
+	 * @param old_value is the value of the register before the modification */
+	void changed(amiq_rm_reg_data_t old_value);
+
+	/** The function computes rand_mask, rand_fields and rand_field_masks from the fields which were added with add_field().*/
+	void compute_rand_masks();
+
+	/** The function computes field_shifts and field_value_masks from the fields which were added with add_field().*/
+	void compute_field_layout();
+
+	/** The function sets legal values to the constrained fields.
+	 * @param new_value is the value whose constrained fields are set
+	 * @param random is the random number from which the values of the fields are derived
+	 * @returns the value with the constrained fields set */
+	amiq_rm_reg_data_t constrain_random_value(amiq_rm_reg_data_t new_value, uint64_t random);
+
 	/** The function is called in build(). It verifies the sanity of the definition of the fields. */
 	void validate_fields();
 };
 
+/** Type of the functions which select registers (e.g. the registers randomized by amiq_rm_address_map::randomize()).
+ * For the elements of a register array the layout register is passed, for a map array the register of the prototype. */
+typedef bool (*amiq_rm_reg_filter_t)(amiq_rm_reg &reg);
+
 }
 
 #endif
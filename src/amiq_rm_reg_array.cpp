@@ -0,0 +1,164 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_reg_array.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef	AMIQ_RM_REG_ARRAY
+#define	AMIQ_RM_REG_ARRAY	1
+
+#include <assert.h>
+#include <sstream>
+#include "amiq_rm_reg_array.hpp"
+#include "amiq_rm_address_map.hpp"
+
+using namespace std;
+
+namespace amiq_rm {
+
+void amiq_rm_reg_array::load(int unsigned index) {
+	assert(index < count);
+	current_index = index;
+	layout->value = values[index];
+	layout->element_index = index;
+}
+
+void amiq_rm_reg_array::store() {
+	amiq_rm_reg_data_t old_value = values[current_index];
+	values[current_index] = layout->value;
+	layout->element_index = 0;
+	changed(old_value, layout->value);
+}
+
+void amiq_rm_reg_array::changed(amiq_rm_reg_data_t old_value, amiq_rm_reg_data_t new_value) {
+	if ((layout->get_signal_mask() == 0) || (old_value == new_value))
+		return;
+
+	uint64_t old_pending = signal_node.pending_signals;
+	if (signal_node.update(layout->get_active_signals(old_value), layout->get_active_signals(new_value))) {
+		for (int unsigned i = 0; i < parent_maps.size(); i++)
+			parent_maps[i]->update_signals(old_pending, signal_node.pending_signals);
+	}
+}
+
+void amiq_rm_reg_array::recompute_signals() {
+	uint64_t old_pending = signal_node.pending_signals;
+	signal_node.clear();
+	if (layout->get_signal_mask() != 0) {
+		for (int unsigned i = 0; i < count; i++)
+			signal_node.update(0, layout->get_active_signals(values[i]));
+	}
+
+	if (signal_node.pending_signals != old_pending) {
+		for (int unsigned i = 0; i < parent_maps.size(); i++)
+			parent_maps[i]->update_signals(old_pending, signal_node.pending_signals);
+	}
+}
+
+void amiq_rm_reg_array::build() {
+	layout->build();
+#ifdef AMIQ_RM_ENABLE_COVERAGE
+	amiq_rm_coverage::get().rename_reg(layout->coverage_index, amiq_rm_coverage::get_path(parent_maps, name));
+#endif
+	//the providers keep one value per register, not per element
+	assert(!layout->has_providers());
+	recompute_signals();
+}
+
+void amiq_rm_reg_array::reset() {
+	amiq_rm_reg_data_t reset_value = layout->get_reset_value();
+	for (int unsigned i = 0; i < count; i++)
+		values[i] = reset_value;
+	recompute_signals();
+}
+
+pair<amiq_rm_reg_data_t, amiq_rm_status_t> amiq_rm_reg_array::read(int unsigned index) {
+	load(index);
+	pair<amiq_rm_reg_data_t, amiq_rm_status_t> data_with_status = layout->read();
+	store();
+	return data_with_status;
+}
+
+amiq_rm_status_t amiq_rm_reg_array::write(int unsigned index, amiq_rm_reg_data_t write_data) {
+	load(index);
+	amiq_rm_status_t status = layout->write(write_data);
+	store();
+	return status;
+}
+
+pair<amiq_rm_reg_data_t, amiq_rm_status_t> amiq_rm_reg_array::read(int unsigned index, int unsigned byte_enable) {
+	load(index);
+	pair<amiq_rm_reg_data_t, amiq_rm_status_t> data_with_status = layout->read(byte_enable);
+	store();
+	return data_with_status;
+}
+
+amiq_rm_status_t amiq_rm_reg_array::write(int unsigned index, amiq_rm_reg_data_t write_data, int unsigned byte_enable) {
+	load(index);
+	amiq_rm_status_t status = layout->write(write_data, byte_enable);
+	store();
+	return status;
+}
+
+amiq_rm_reg_data_t amiq_rm_reg_array::get(int unsigned index) {
+	assert(index < count);
+	return values[index];
+}
+
+void amiq_rm_reg_array::set(int unsigned index, amiq_rm_reg_data_t write_data) {
+	assert(index < count);
+	amiq_rm_reg_data_t old_value = values[index];
+	values[index] = write_data;
+	changed(old_value, write_data);
+}
+
+amiq_rm_reg_data_t amiq_rm_reg_array::get_field_value(int unsigned index, string field_name) {
+	assert(index < count);
+	return layout->get_access_data_for_field(field_name, values[index]);
+}
+
+void amiq_rm_reg_array::set_field_value(int unsigned index, string field_name, amiq_rm_reg_data_t new_value) {
+	load(index);
+	layout->set_field_value(field_name, new_value);
+	store();
+}
+
+void amiq_rm_reg_array::randomize(uint64_t seed, uint64_t counter) {
+	for (int unsigned i = 0; i < count; i++)
+		values[i] = layout->get_random_value(values[i], amiq_rm_random(seed, counter + i));
+	recompute_signals();
+}
+
+int unsigned amiq_rm_reg_array::get_current_index() {
+	return current_index;
+}
+
+vector<amiq_rm_reg_address_t> amiq_rm_reg_array::get_offsets(amiq_rm_address_map &map) {
+	return map.get_reg_array_offsets(*this);
+}
+
+string amiq_rm_reg_array::to_string() {
+	ostringstream convert;
+	convert << name << " Count: " << dec << count << " Stride: " << hex << stride << " Layout: " << layout->to_string();
+	for (int unsigned i = 0; i < count; i++) {
+		convert << "[" << dec << i << "] Value: " << hex << values[i] << "\n";
+	}
+	return convert.str();
+}
+
+}
+
+#endif
@@ -0,0 +1,179 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_reg_array.hpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef AMIQ_RM_REG_ARRAY_HEADER
+#define AMIQ_RM_REG_ARRAY_HEADER 1
+
+#include "amiq_rm_types.cpp"
+#include "amiq_rm_reg.hpp"
+#include <vector>
+#include <assert.h>
+
+namespace amiq_rm {
+
+class amiq_rm_address_map;
+
+/** This class is used to model an array of identical registers (e.g. per-channel registers). All elements share the field layout of
+ * one register (the @b layout) and their values are stored contiguously in @b values. The array is mapped in an address map with
+ * amiq_rm_address_map::add_reg_array() and element @b i is placed at offset + i * stride.
+ * @n An access to an element loads the element value in the layout register, performs the operation of the layout register
+ * (so masks, field attributes and pre_access()/post_access() hooks behave as for a stand-alone register) and stores the value back.
+ * During the access, layout->value holds the value of the accessed element and get_current_index() (as well as layout->element_index)
+ * returns its index. */
+class amiq_rm_reg_array {
+public:
+	/** The name of the register array. */
+	std::string name;
+
+	/** The register which defines the field layout of all elements. The array takes ownership of it. */
+	amiq_rm_reg *layout;
+
+	/** The number of elements of the array. */
+	int unsigned count;
+
+	/** The distance (in bytes) between the offsets of two consecutive elements. */
+	amiq_rm_reg_address_t stride;
+
+	/** The values of the elements, element @b i is stored at index @b i. */
+	std::vector<amiq_rm_reg_data_t> values;
+
+	/** The vector holds the address maps which contain the array. New parents are added when amiq_rm_address_map::add_reg_array() is called.*/
+	std::vector<amiq_rm_address_map*> parent_maps;
+
+	/** The aggregate of the signals of the elements (see amiq_rm_field::add_signal()). It is kept up to date by the functions which modify
+	 * the values; changing @b values directly does not update it. */
+	amiq_rm_signal_node signal_node;
+
+	/** Create new register array, the values of the elements are set to 0.
+	 * @param my_name is set as name
+	 * @param my_layout is a pointer to the register which defines the field layout; it is deleted by the array
+	 * @param my_count is the number of elements
+	 * @param my_stride is the distance (in bytes) between two consecutive elements */
+	amiq_rm_reg_array(std::string my_name, amiq_rm_reg *my_layout, int unsigned my_count, amiq_rm_reg_address_t my_stride) {
+		assert(my_layout != NULL);
+		assert(my_stride > 0);
+		name = my_name;
+		layout = my_layout;
+		count = my_count;
+		stride = my_stride;
+
+		values.resize(my_count, 0);
+		current_index = 0;
+	}
+
+	/** Delete the layout register. */
+	virtual ~amiq_rm_reg_array() {
+		delete layout;
+	}
+
+	/** The function must be called after all fields have been added to the layout register. It calls build() of the layout register.
+	 * It is not necessary for the build() to be called if the @b address map::build() from one of the parent maps is called */
+	void build();
+
+	/** The function implements the reset functionality for all elements. The value of each element is set to the reset value of the layout. */
+	void reset();
+
+	/** @param index is the index of the element which is read
+	 * @returns the value of the element as well as the status of the read operation (see amiq_rm_reg::read()). */
+	std::pair<amiq_rm_reg_data_t, amiq_rm_status_t> read(int unsigned index);
+
+	/** @param index is the index of the element which is written
+	 * @param write_data is the data that is going to be written to the element (see amiq_rm_reg::write())
+	 * @returns the status of the write operation */
+	amiq_rm_status_t write(int unsigned index, amiq_rm_reg_data_t write_data);
+
+	/** @param index is the index of the element which is read
+	 * @param byte_enable selects the byte lanes of the element which are read
+	 * @returns the value of the enabled lanes of the element as well as the status of the read operation (see amiq_rm_reg::read()). */
+	std::pair<amiq_rm_reg_data_t, amiq_rm_status_t> read(int unsigned index, int unsigned byte_enable);
+
+	/** @param index is the index of the element which is written
+	 * @param write_data is the data that is going to be written to the enabled lanes of the element (see amiq_rm_reg::write())
+	 * @param byte_enable selects the byte lanes of the element which are written
+	 * @returns the status of the write operation */
+	amiq_rm_status_t write(int unsigned index, amiq_rm_reg_data_t write_data, int unsigned byte_enable);
+
+	/** @param index is the index of the element
+	 * @returns the value of the element - it does not apply masking, no pre/post access hooks are called. */
+	amiq_rm_reg_data_t get(int unsigned index);
+
+	/** The function modifies the value of an element - it does not apply masking, no pre/post access hooks are called.
+	 * @param index is the index of the element
+	 * @param write_data is the data that is going to be set as the element value */
+	void set(int unsigned index, amiq_rm_reg_data_t write_data);
+
+	/** @param index is the index of the element
+	 * @param field_name is the name of the field on which the operation is addressed to
+	 * @returns the value of a field of the element. */
+	amiq_rm_reg_data_t get_field_value(int unsigned index, std::string field_name);
+
+	/** Changes the value of a field of an element.
+	 * @param index is the index of the element
+	 * @param field_name is the name of the field on which the operation is addressed to
+	 * @param new_value is the value that is going to be set to the field */
+	void set_field_value(int unsigned index, std::string field_name, amiq_rm_reg_data_t new_value);
+
+	/** The function unpacks the values of all elements in columns, one column for each field of the layout register
+	 * (see amiq_rm_reg::unpack_columns()).
+	 * @param columns holds one array of @b count values for each field; columns[f][i] receives the value of field @b f of element @b i */
+	void unpack_columns(amiq_rm_reg_data_t * const *columns) {
+		layout->unpack_columns(&values[0], count, columns);
+	}
+
+	/** The function sets random values to all elements (see amiq_rm_reg::get_random_value()), without calling the pre/post access hooks.
+	 * Element @b i gets the random number amiq_rm_random(seed, counter + i).
+	 * @param seed is the seed of the random values
+	 * @param counter is the position in the random sequence of the first element */
+	void randomize(uint64_t seed, uint64_t counter);
+
+	/** @returns the index of the element which is currently accessed (useful inside the hooks of the layout register). */
+	int unsigned get_current_index();
+
+	/** The function returns the offsets of the first element of the array. The offsets are calculated relative to the address map passed as argument.
+	 * This function is a wrapper of the equivalent function @b amiq_rm_address_map::get_reg_array_offsets().
+	 * @param map pointer to the address map relative to which the calculation of the offset takes place.
+	 * @returns a vector which contains all the offsets at which the array is mapped under the map argument. */
+	std::vector<amiq_rm_reg_address_t> get_offsets(amiq_rm_address_map &map);
+
+	/** @returns a string with debug purpose information. */
+	std::string to_string();
+
+private:
+	/** The index of the element which is currently accessed. */
+	int unsigned current_index;
+
+	/** The function loads the value of an element in the layout register.
+	 * @param index is the index of the element */
+	void load(int unsigned index);
+
+	/** The function stores the value of the layout register back in the element which was loaded with load(). */
+	void store();
+
+	/** The function updates @b signal_node, and the parent maps if the pending signals changed, after the value of an element changed.
+	 * @param old_value is the value of the element before the change
+	 * @param new_value is the value of the element after the change */
+	void changed(amiq_rm_reg_data_t old_value, amiq_rm_reg_data_t new_value);
+
+	/** The function computes @b signal_node from the values of all elements and updates the parent maps if the pending signals changed. */
+	void recompute_signals();
+};
+
+}
+
+#endif
@@ -0,0 +1,182 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_reg_iterator.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef	AMIQ_RM_REG_ITERATOR
+#define	AMIQ_RM_REG_ITERATOR	1
+
+#include <assert.h>
+#include <algorithm>
+#include <sstream>
+#include "amiq_rm_reg_iterator.hpp"
+
+using namespace std;
+
+namespace amiq_rm {
+
+amiq_rm_reg_iterator::amiq_rm_reg_iterator(amiq_rm_radix_decoder &my_decoder, amiq_rm_reg_address_t my_first, amiq_rm_reg_address_t my_last) {
+	assert(my_decoder.is_built());
+	assert(my_first <= my_last);
+	decoder = &my_decoder;
+	table = my_decoder.get_table();
+	first = my_first;
+	last = my_last;
+	current.address = 0;
+	current.target = 0;
+	current.index = 0;
+	done = false;
+
+	//the spanning targets placed before the start of the walk are started right away
+	vector<int unsigned> spanning;
+	next_target = table->find_first_target(first, spanning);
+	for (int unsigned i = 0; i < spanning.size(); i++) {
+		amiq_rm_reg_cursor cursor;
+		if (start(spanning[i], cursor)) {
+			cursors.push_back(cursor);
+			push_heap(cursors.begin(), cursors.end(), compare_cursors);
+		}
+	}
+	next();
+}
+
+bool amiq_rm_reg_iterator::compare_cursors(const amiq_rm_reg_cursor &a, const amiq_rm_reg_cursor &b) {
+	return ((a.address > b.address) || ((a.address == b.address) && (a.target > b.target)));
+}
+
+void amiq_rm_reg_iterator::set_address(amiq_rm_reg_cursor &cursor) {
+	amiq_rm_decode_target *target = table->targets[cursor.target];
+	if (target->kind == REG_ARRAY_TARGET) {
+		cursor.address = target->base + cursor.index * target->reg_array->stride;
+	} else if (target->kind == MAP_ARRAY_TARGET) {
+		int unsigned nof_slots = target->map_array->get_nof_slots();
+		cursor.address = target->base + (cursor.index / nof_slots) * target->map_array->stride + target->map_array->slots[cursor.index % nof_slots].offset;
+	} else {
+		cursor.address = target->base;
+	}
+}
+
+bool amiq_rm_reg_iterator::start(int unsigned target_index, amiq_rm_reg_cursor &cursor) {
+	amiq_rm_decode_target *target = table->targets[target_index];
+	cursor.target = target_index;
+	cursor.index = 0;
+
+	if (target->kind == REG_TARGET) {
+		if (target->base < first)
+			return false;
+	} else if (target->kind == REG_ARRAY_TARGET) {
+		amiq_rm_reg_array *array = target->reg_array;
+		if (target->base < first)
+			cursor.index = (first - target->base + array->stride - 1) / array->stride;
+		if (cursor.index >= array->count)
+			return false;
+	} else if (target->kind == MAP_ARRAY_TARGET) {
+		amiq_rm_map_array *array = target->map_array;
+		int unsigned nof_slots = array->get_nof_slots();
+		if (nof_slots == 0)
+			return false;
+		if (target->base < first) {
+			amiq_rm_reg_address_t instance = (first - target->base) / array->stride;
+			int unsigned slot = array->find_first_slot((first - target->base) % array->stride);
+			if (slot == nof_slots) {
+				instance++;
+				slot = 0;
+			}
+			if (instance >= array->count)
+				return false;
+			cursor.index = instance * nof_slots + slot;
+		}
+	} else {
+		//the memories are not walked
+		return false;
+	}
+
+	set_address(cursor);
+	return (cursor.address <= last);
+}
+
+bool amiq_rm_reg_iterator::advance(amiq_rm_reg_cursor &cursor) {
+	amiq_rm_decode_target *target = table->targets[cursor.target];
+	cursor.index++;
+	if ((target->kind == REG_TARGET) || ((target->kind == REG_ARRAY_TARGET) && (cursor.index >= target->reg_array->count))
+			|| ((target->kind == MAP_ARRAY_TARGET) && (cursor.index >= target->map_array->values.size())))
+		return false;
+
+	set_address(cursor);
+	return (cursor.address <= last);
+}
+
+void amiq_rm_reg_iterator::next() {
+	while (!done) {
+		//a target must be reached before its base is passed, the targets are sorted by base
+		while ((next_target < table->targets.size()) && (cursors.empty() || (table->targets[next_target]->base <= cursors[0].address))) {
+			if (table->targets[next_target]->base > last) {
+				next_target = table->targets.size();
+				break;
+			}
+
+			amiq_rm_reg_cursor cursor;
+			if (start(next_target, cursor)) {
+				cursors.push_back(cursor);
+				push_heap(cursors.begin(), cursors.end(), compare_cursors);
+			}
+			next_target++;
+		}
+
+		if (cursors.empty()) {
+			done = true;
+			return;
+		}
+
+		pop_heap(cursors.begin(), cursors.end(), compare_cursors);
+		current = cursors.back();
+		if (advance(cursors.back()))
+			push_heap(cursors.begin(), cursors.end(), compare_cursors);
+		else
+			cursors.pop_back();
+
+		//skip the elements shadowed by other targets
+		if (decoder->decode(current.address) == table->targets[current.target])
+			return;
+	}
+}
+
+amiq_rm_reg& amiq_rm_reg_iterator::get_reg() {
+	amiq_rm_decode_target *target = get_target();
+	if (target->kind == REG_ARRAY_TARGET)
+		return *(target->reg_array->layout);
+	if (target->kind == MAP_ARRAY_TARGET)
+		return *(target->map_array->slots[current.index % target->map_array->get_nof_slots()].reg);
+	return *(target->reg);
+}
+
+string amiq_rm_reg_iterator::get_path() {
+	amiq_rm_decode_target *target = get_target();
+	ostringstream path;
+	path << target->path;
+	if (target->kind == REG_ARRAY_TARGET) {
+		path << "[" << dec << current.index << "]";
+	} else if (target->kind == MAP_ARRAY_TARGET) {
+		int unsigned nof_slots = target->map_array->get_nof_slots();
+		path << "[" << dec << (current.index / nof_slots) << "]." << target->map_array->slots[current.index % nof_slots].path;
+	}
+	return path.str();
+}
+
+}
+
+#endif
@@ -0,0 +1,141 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_reg_iterator.hpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef AMIQ_RM_REG_ITERATOR_HEADER
+#define AMIQ_RM_REG_ITERATOR_HEADER 1
+
+#include "amiq_rm_types.cpp"
+#include "amiq_rm_decoder.hpp"
+#include <string>
+#include <vector>
+
+namespace amiq_rm {
+
+/** This class walks the registers of a physical address map in the order of their absolute addresses, across sub-maps: the stand-alone
+ * registers, the elements of the register arrays and the registers of the map array instances (the memories are not walked).
+ * It is created by amiq_rm_physical_address_map::get_reg_iterator() or get_regs_in_range() and it is backed by the decoder built by
+ * build(): the first register of a range is found with a binary search in the targets of the decoder and the elements of the arrays
+ * are computed arithmetically, so a walk of @b k registers costs O(log n + k) for a map with @b n targets.
+ * @n An element shadowed by another one (e.g. a register placed over an element of an array) is skipped, as it is not decoded.
+ * The iterator must not be used after the decoder is built again or cleared. It walks the table of targets taken when it is created, so
+ * a relocation done meanwhile (see amiq_rm_physical_address_map::relocate_map()) is not seen by the walk; after enable_rcu(), the
+ * iterator must then be used in a read-side section (see amiq_rm_rcu_read_guard).
+ * @n Usage: for (amiq_rm_reg_iterator it = map.get_regs_in_range(lo, hi); !it.is_done(); it.next()) { ... it.get_address() ... } */
+class amiq_rm_reg_iterator {
+public:
+	/** Create an iterator positioned on the first register of a range.
+	 * @param my_decoder is the built decoder whose targets are walked
+	 * @param my_first is the lowest absolute address of the range
+	 * @param my_last is the highest absolute address of the range (inclusive) */
+	amiq_rm_reg_iterator(amiq_rm_radix_decoder &my_decoder, amiq_rm_reg_address_t my_first, amiq_rm_reg_address_t my_last);
+
+	/** There are no pointers to delete. */
+	virtual ~amiq_rm_reg_iterator() {
+	}
+
+	/** @returns true if all registers of the range were walked. */
+	bool is_done() {
+		return done;
+	}
+
+	/** The function moves the iterator to the next register of the range. */
+	void next();
+
+	/** @returns the absolute address of the current register. */
+	amiq_rm_reg_address_t get_address() {
+		return current.address;
+	}
+
+	/** @returns the target which contains the current register, it may be used to access it (e.g. get_target()->read(get_address())). */
+	amiq_rm_decode_target* get_target() {
+		return table->targets[current.target];
+	}
+
+	/** @returns the index of the current element for a register array, the index of the current value for a map array
+	 * (see amiq_rm_map_array::get_index()), 0 for a register. */
+	int unsigned get_index() {
+		return current.index;
+	}
+
+	/** @returns the register which describes the fields of the current register: the register itself, the layout of the register array
+	 * or the register of the prototype of the map array. */
+	amiq_rm_reg& get_reg();
+
+	/** @returns the path of the current register relative to the physical map (e.g. "sub.reg", "sub.arr[3]", "sub.blocks[2].ctrl"). */
+	std::string get_path();
+
+private:
+	/** The position of the walk in one target. */
+	struct amiq_rm_reg_cursor {
+		/** The absolute address of the element. */
+		amiq_rm_reg_address_t address;
+
+		/** The position of the target in the table. */
+		int unsigned target;
+
+		/** The index of the element in the target. */
+		int unsigned index;
+	};
+
+	/** The decoder whose targets are walked. */
+	amiq_rm_radix_decoder *decoder;
+
+	/** The table of the targets of the decoder, taken when the iterator is created. */
+	amiq_rm_target_table *table;
+
+	/** The lowest address of the range. */
+	amiq_rm_reg_address_t first;
+
+	/** The highest address of the range. */
+	amiq_rm_reg_address_t last;
+
+	/** The position of the next target which was not reached yet. */
+	int unsigned next_target;
+
+	/** The cursors of the targets reached by the walk, kept as a heap with the lowest address on top. */
+	std::vector<amiq_rm_reg_cursor> cursors;
+
+	/** The current register. */
+	amiq_rm_reg_cursor current;
+
+	/** Set when all registers of the range were walked. */
+	bool done;
+
+	/** @returns true if cursor @b a is placed after cursor @b b (the comparison of the heap). */
+	static bool compare_cursors(const amiq_rm_reg_cursor &a, const amiq_rm_reg_cursor &b);
+
+	/** The function computes the address of the element of a cursor.
+	 * @param cursor is the cursor whose address is set */
+	void set_address(amiq_rm_reg_cursor &cursor);
+
+	/** The function positions a cursor on the first element of a target which is in the range.
+	 * @param target is the position of the target in the table
+	 * @param cursor is the cursor which is positioned
+	 * @returns false if the target has no element in the range */
+	bool start(int unsigned target, amiq_rm_reg_cursor &cursor);
+
+	/** The function moves a cursor to the next element of its target.
+	 * @param cursor is the cursor which is moved
+	 * @returns false if the target has no more elements in the range */
+	bool advance(amiq_rm_reg_cursor &cursor);
+};
+
+}
+
+#endif
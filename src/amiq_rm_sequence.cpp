@@ -0,0 +1,358 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_sequence.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef	AMIQ_RM_SEQUENCE
+#define	AMIQ_RM_SEQUENCE	1
+
+#include <assert.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include "amiq_rm_sequence.hpp"
+#include "amiq_rm_address_map.hpp"
+#include "amiq_rm_log.hpp"
+#include "amiq_rm_quantum_keeper.hpp"
+
+using namespace std;
+
+namespace amiq_rm {
+
+/** The keywords of the text format, indexed by amiq_rm_step_kind_t. */
+static const char *amiq_rm_step_keywords[] = { "write", "read", "write_field", "poll", "check" };
+
+/** The steps which refer to each register path. */
+typedef map<string, vector<int unsigned> > amiq_rm_step_paths_t;
+
+/** The function parses a number in C format.
+ * @param text is the text of the number
+ * @param number is set to the value of the number
+ * @returns false if the text is not a number */
+static bool amiq_rm_parse_number(const string &text, long long unsigned &number) {
+	char *end;
+	if (text.empty() || !isdigit(text[0]))
+		return false;
+	number = strtoull(text.c_str(), &end, 0);
+	return (*end == 0);
+}
+
+amiq_rm_sequence::amiq_rm_step& amiq_rm_sequence::add_step(amiq_rm_step_kind_t kind, string reg) {
+	amiq_rm_step step;
+	step.kind = kind;
+	step.reg = reg;
+	step.value = 0;
+	step.mask = 0;
+	step.max_reads = 1;
+	step.index = 0;
+	step.field_mask = 0;
+	step.field_lsb = 0;
+	steps.push_back(step);
+	compiled = false;
+	return steps.back();
+}
+
+void amiq_rm_sequence::add_write(string reg, amiq_rm_reg_data_t value) {
+	add_step(WRITE_STEP, reg).value = value;
+}
+
+void amiq_rm_sequence::add_read(string reg) {
+	add_step(READ_STEP, reg);
+}
+
+void amiq_rm_sequence::add_read(string reg, amiq_rm_reg_data_t expected, amiq_rm_reg_data_t mask) {
+	amiq_rm_step &step = add_step(READ_STEP, reg);
+	step.value = expected;
+	step.mask = mask;
+}
+
+void amiq_rm_sequence::add_write_field(string reg, string field, amiq_rm_reg_data_t value) {
+	amiq_rm_step &step = add_step(WRITE_FIELD_STEP, reg);
+	step.field = field;
+	step.value = value;
+}
+
+void amiq_rm_sequence::add_poll(string reg, amiq_rm_reg_data_t mask, amiq_rm_reg_data_t expected, int unsigned max_reads) {
+	assert(max_reads > 0);
+	amiq_rm_step &step = add_step(POLL_STEP, reg);
+	step.value = expected;
+	step.mask = mask;
+	step.max_reads = max_reads;
+}
+
+void amiq_rm_sequence::add_check(string reg, amiq_rm_reg_data_t expected, amiq_rm_reg_data_t mask) {
+	amiq_rm_step &step = add_step(CHECK_STEP, reg);
+	step.value = expected;
+	step.mask = mask;
+}
+
+bool amiq_rm_sequence::load(string file_name) {
+	ifstream file(file_name.c_str());
+	if (!file.is_open())
+		return false;
+
+	//the steps are parsed into another sequence and appended only if the whole file is valid
+	amiq_rm_sequence loaded(name);
+	string line;
+	for (int unsigned line_number = 1; getline(file, line); line_number++) {
+		string::size_type comment = line.find('#');
+		if (comment != string::npos)
+			line.erase(comment);
+
+		istringstream words_stream(line);
+		vector<string> words;
+		string word;
+		while (words_stream >> word)
+			words.push_back(word);
+		if (words.empty())
+			continue;
+
+		long long unsigned numbers[3] = { 0, ~0ULL, 0 };
+		bool ok = (words.size() >= 2);
+		if (ok && (words[0] == "write")) {
+			ok = (words.size() == 3) && amiq_rm_parse_number(words[2], numbers[0]);
+			if (ok)
+				loaded.add_write(words[1], numbers[0]);
+		} else if (ok && (words[0] == "read")) {
+			ok = (words.size() <= 4);
+			for (int unsigned i = 2; ok && (i < words.size()); i++)
+				ok = amiq_rm_parse_number(words[i], numbers[i - 2]);
+			if (ok && (words.size() == 2))
+				loaded.add_read(words[1]);
+			else if (ok)
+				loaded.add_read(words[1], numbers[0], numbers[1]);
+		} else if (ok && (words[0] == "write_field")) {
+			ok = (words.size() == 4) && amiq_rm_parse_number(words[3], numbers[0]);
+			if (ok)
+				loaded.add_write_field(words[1], words[2], numbers[0]);
+		} else if (ok && (words[0] == "poll")) {
+			ok = (words.size() == 5);
+			for (int unsigned i = 2; ok && (i < words.size()); i++)
+				ok = amiq_rm_parse_number(words[i], numbers[i - 2]);
+			ok = ok && (numbers[2] > 0);
+			if (ok)
+				loaded.add_poll(words[1], numbers[0], numbers[1], numbers[2]);
+		} else if (ok && (words[0] == "check")) {
+			ok = (words.size() == 3) || (words.size() == 4);
+			for (int unsigned i = 2; ok && (i < words.size()); i++)
+				ok = amiq_rm_parse_number(words[i], numbers[i - 2]);
+			if (ok)
+				loaded.add_check(words[1], numbers[0], numbers[1]);
+		} else {
+			ok = false;
+		}
+
+		if (!ok) {
+			AMIQ_RM_INFO(AMIQ_RM_LOW, "Sequence " << name << ": line " << line_number << " of " << file_name << " is not valid");
+			return false;
+		}
+	}
+
+	if (!loaded.steps.empty()) {
+		steps.insert(steps.end(), loaded.steps.begin(), loaded.steps.end());
+		compiled = false;
+	}
+	return true;
+}
+
+bool amiq_rm_sequence::resolve(amiq_rm_physical_address_map &map, amiq_rm_step &step, amiq_rm_reg_address_t address) {
+	int unsigned index;
+	amiq_rm_decode_target *target = map.decode(address);
+	if ((target == NULL) || !target->get_index(address, index))
+		return false;
+
+	//the target is copied, as the decoder may replace it (e.g. when the map is published or a sub-map is relocated)
+	step.target = *target;
+	step.index = (target->kind == MEM_TARGET) ? (address - target->base) : index;
+	step.read_latency = map.get_latency(target, address, READ);
+	step.write_latency = map.get_latency(target, address, WRITE);
+	return true;
+}
+
+bool amiq_rm_sequence::compile(amiq_rm_physical_address_map &map) {
+	assert(map.get_decoder().is_built());
+	compiled = false;
+
+	//the registers given by path are resolved with one walk of the map
+	amiq_rm_step_paths_t paths;
+	for (int unsigned i = 0; i < steps.size(); i++) {
+		long long unsigned address;
+		if (amiq_rm_parse_number(steps[i].reg, address)) {
+			if (!resolve(map, steps[i], address)) {
+				AMIQ_RM_INFO(AMIQ_RM_LOW, "Sequence " << name << ": no register at " << steps[i].reg);
+				return false;
+			}
+		} else {
+			paths[steps[i].reg].push_back(i);
+		}
+	}
+
+	for (amiq_rm_reg_iterator it = map.get_reg_iterator(); !paths.empty() && !it.is_done(); it.next()) {
+		amiq_rm_step_paths_t::iterator path = paths.find(it.get_path());
+		if (path == paths.end())
+			continue;
+		for (int unsigned i = 0; i < path->second.size(); i++)
+			resolve(map, steps[path->second[i]], it.get_address());
+		paths.erase(path);
+	}
+	if (!paths.empty()) {
+		AMIQ_RM_INFO(AMIQ_RM_LOW, "Sequence " << name << ": no register " << paths.begin()->first);
+		return false;
+	}
+
+	for (int unsigned i = 0; i < steps.size(); i++) {
+		amiq_rm_step &step = steps[i];
+		if (step.kind != WRITE_FIELD_STEP)
+			continue;
+
+		amiq_rm_reg *reg = NULL;
+		if (step.target.kind == REG_TARGET)
+			reg = step.target.reg;
+		else if (step.target.kind == REG_ARRAY_TARGET)
+			reg = step.target.reg_array->layout;
+		else if (step.target.kind == MAP_ARRAY_TARGET)
+			reg = step.target.map_array->slots[step.index % step.target.map_array->get_nof_slots()].reg;
+
+		amiq_rm_field *field = (reg == NULL) ? NULL : reg->get_field_my_name(step.field);
+		if (field == NULL) {
+			AMIQ_RM_INFO(AMIQ_RM_LOW, "Sequence " << name << ": no field " << step.field << " in " << step.reg);
+			return false;
+		}
+		step.field_lsb = field->lsb_position;
+		step.field_mask = field->get_value_mask() << field->lsb_position;
+	}
+
+	compiled = true;
+	return true;
+}
+
+bool amiq_rm_sequence::run() {
+	return execute(NULL);
+}
+
+bool amiq_rm_sequence::run(amiq_rm_quantum_keeper &keeper) {
+	return execute(&keeper);
+}
+
+void amiq_rm_sequence::annotate(amiq_rm_quantum_keeper *keeper, uint64_t latency) {
+	if (keeper != NULL) {
+		keeper->inc(latency);
+		if (keeper->need_sync())
+			keeper->sync();
+	}
+}
+
+bool amiq_rm_sequence::execute(amiq_rm_quantum_keeper *keeper) {
+	assert(compiled);
+	failed_step = AMIQ_RM_NO_STEP;
+	for (int unsigned i = 0; i < steps.size(); i++) {
+		amiq_rm_step &step = steps[i];
+		pair<amiq_rm_reg_data_t, amiq_rm_status_t> data_with_status(0, OKAY);
+		bool ok = true;
+
+		switch (step.kind) {
+		case WRITE_STEP:
+			data_with_status.second = write(step, step.value);
+			annotate(keeper, step.write_latency);
+			break;
+		case READ_STEP:
+			data_with_status = read(step);
+			annotate(keeper, step.read_latency);
+			ok = (((data_with_status.first ^ step.value) & step.mask) == 0);
+			break;
+		case WRITE_FIELD_STEP:
+			data_with_status = read(step);
+			annotate(keeper, step.read_latency);
+			if (data_with_status.second == OKAY) {
+				amiq_rm_reg_data_t field_value = (step.value << step.field_lsb) & step.field_mask;
+				data_with_status.second = write(step, (data_with_status.first & (~step.field_mask)) | field_value);
+				annotate(keeper, step.write_latency);
+			}
+			break;
+		case POLL_STEP:
+			ok = false;
+			for (int unsigned j = 0; !ok && (j < step.max_reads) && (data_with_status.second == OKAY); j++) {
+				data_with_status = read(step);
+				annotate(keeper, step.read_latency);
+				ok = (((data_with_status.first ^ step.value) & step.mask) == 0);
+			}
+			break;
+		case CHECK_STEP:
+			data_with_status.first = get(step);
+			ok = (((data_with_status.first ^ step.value) & step.mask) == 0);
+			break;
+		}
+
+		if (!ok || (data_with_status.second != OKAY)) {
+			failed_step = i;
+			failed_status = data_with_status.second;
+			failed_data = data_with_status.first;
+			return false;
+		}
+	}
+	return true;
+}
+
+int unsigned amiq_rm_sequence::get_nof_steps() {
+	return steps.size();
+}
+
+int unsigned amiq_rm_sequence::get_failed_step() {
+	return failed_step;
+}
+
+amiq_rm_status_t amiq_rm_sequence::get_failed_status() {
+	return failed_status;
+}
+
+amiq_rm_reg_data_t amiq_rm_sequence::get_failed_data() {
+	return failed_data;
+}
+
+string amiq_rm_sequence::to_string() {
+	ostringstream convert;
+	for (int unsigned i = 0; i < steps.size(); i++) {
+		amiq_rm_step &step = steps[i];
+		convert << amiq_rm_step_keywords[step.kind] << " " << step.reg << hex;
+		switch (step.kind) {
+		case WRITE_STEP:
+			convert << " 0x" << step.value;
+			break;
+		case READ_STEP:
+			if (step.mask != 0)
+				convert << " 0x" << step.value << " 0x" << step.mask;
+			break;
+		case WRITE_FIELD_STEP:
+			convert << " " << step.field << " 0x" << step.value;
+			break;
+		case POLL_STEP:
+			convert << " 0x" << step.mask << " 0x" << step.value << " " << dec << step.max_reads;
+			break;
+		case CHECK_STEP:
+			convert << " 0x" << step.value << " 0x" << step.mask;
+			break;
+		}
+		convert << "\n";
+	}
+	return convert.str();
+}
+
+}
+
+#endif
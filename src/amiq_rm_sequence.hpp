@@ -0,0 +1,264 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_sequence.hpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef AMIQ_RM_SEQUENCE_HEADER
+#define AMIQ_RM_SEQUENCE_HEADER 1
+
+#include "amiq_rm_types.cpp"
+#include "amiq_rm_decoder.hpp"
+#include <string>
+#include <vector>
+
+namespace amiq_rm {
+
+class amiq_rm_physical_address_map;
+class amiq_rm_quantum_keeper;
+
+typedef enum {
+	WRITE_STEP = 0x0, READ_STEP = 0x1, WRITE_FIELD_STEP = 0x2, POLL_STEP = 0x3, CHECK_STEP = 0x4
+} amiq_rm_step_kind_t;
+
+/** This class holds a sequence of register accesses (e.g. the initialization of a block) which is described once, compiled once against
+ * a built physical address map and then executed many times with run().
+ * @n The steps are added with the add_*() functions or loaded from a text file with load(). A register is given by its path relative to
+ * the physical map, as returned by amiq_rm_reg_iterator::get_path() (e.g. "sub.ctrl", "sub.chan[3]", "blocks[2].status"), or by its
+ * absolute address (a number, e.g. "0x1000"). compile() resolves each step to the decoded element (register, element of an array or
+ * word of a memory) and to the mask of its field, so run() does not search names and does not decode addresses.
+ * @n The compiled steps keep the elements they were resolved to, not the targets of the decoder: they stay valid when the map is built
+ * again, published or when a sub-map is relocated, but the program must be compiled again to follow a change of the topology.
+ * @n Text format, one step on each line, numbers in C format (e.g. 0x1F, 31), '#' starts a comment:
+ * @li write REG VALUE
+ * @li read REG [EXPECTED [MASK]] - checks (data & MASK) == (EXPECTED & MASK), MASK is all ones if omitted, no check without EXPECTED
+ * @li write_field REG FIELD VALUE - reads the register, replaces the field and writes the result
+ * @li poll REG MASK EXPECTED MAX_READS - reads until (data & MASK) == (EXPECTED & MASK), fails after MAX_READS reads
+ * @li check REG EXPECTED [MASK] - compares the value of the model (get(), without side effects) */
+class amiq_rm_sequence {
+public:
+	/** Value of get_failed_step() when no step failed. */
+	static const int unsigned AMIQ_RM_NO_STEP = ~0U;
+
+	/** The name of the sequence. */
+	std::string name;
+
+	/** Create an empty sequence.
+	 * @param my_name is set as name */
+	amiq_rm_sequence(std::string my_name) {
+		name = my_name;
+		compiled = false;
+		failed_step = AMIQ_RM_NO_STEP;
+		failed_status = OKAY;
+		failed_data = 0;
+	}
+
+	/** There are no pointers to delete. */
+	virtual ~amiq_rm_sequence() {
+	}
+
+	/** The function adds a write.
+	 * @param reg is the path or the address of the register
+	 * @param value is the written data */
+	void add_write(std::string reg, amiq_rm_reg_data_t value);
+
+	/** The function adds a read whose data is not checked.
+	 * @param reg is the path or the address of the register */
+	void add_read(std::string reg);
+
+	/** The function adds a read whose data is checked.
+	 * @param reg is the path or the address of the register
+	 * @param expected is the expected data
+	 * @param mask selects the bits which are checked */
+	void add_read(std::string reg, amiq_rm_reg_data_t expected, amiq_rm_reg_data_t mask);
+
+	/** The function adds a read-modify-write of a field: the register is read, the field is replaced and the result is written.
+	 * @param reg is the path or the address of the register
+	 * @param field is the name of the field
+	 * @param value is the new value of the field */
+	void add_write_field(std::string reg, std::string field, amiq_rm_reg_data_t value);
+
+	/** The function adds a poll: the register is read until the masked data is the expected one.
+	 * @param reg is the path or the address of the register
+	 * @param mask selects the bits which are checked
+	 * @param expected is the expected data
+	 * @param max_reads is the number of reads after which the step fails */
+	void add_poll(std::string reg, amiq_rm_reg_data_t mask, amiq_rm_reg_data_t expected, int unsigned max_reads);
+
+	/** The function adds a check of the value of the model (amiq_rm_reg::get(), without side effects).
+	 * @param reg is the path or the address of the register
+	 * @param expected is the expected value
+	 * @param mask selects the bits which are checked */
+	void add_check(std::string reg, amiq_rm_reg_data_t expected, amiq_rm_reg_data_t mask);
+
+	/** The function adds the steps described in a text file (see the format above).
+	 * @param file_name is the name of the file
+	 * @returns false if the file could not be read or a line is not valid (no step of the file is added then) */
+	bool load(std::string file_name);
+
+	/** The function resolves the registers and the fields of all steps.
+	 * @param map is the physical map on which the sequence is run, its decoder must be built
+	 * @returns false if a register or a field is not found (the sequence can not be run) */
+	bool compile(amiq_rm_physical_address_map &map);
+
+	/** The function executes the steps, in order, until a step fails. The sequence must be compiled.
+	 * @returns true if all steps succeeded */
+	bool run();
+
+	/** The function executes the steps as run() and adds the latency of each access (see amiq_rm_physical_address_map::set_latency(),
+	 * the latencies are taken by compile()) to the local time of a quantum keeper; it synchronizes the keeper whenever its quantum
+	 * is reached, so a POLL step sees the changes done by the other models while it polls.
+	 * @param keeper is the quantum keeper of the initiator
+	 * @returns true if all steps succeeded */
+	bool run(amiq_rm_quantum_keeper &keeper);
+
+	/** @returns the number of steps. */
+	int unsigned get_nof_steps();
+
+	/** @returns the index of the step which failed in the last run(), AMIQ_RM_NO_STEP if all steps succeeded. */
+	int unsigned get_failed_step();
+
+	/** @returns the status of the access of the failed step, OKAY if the step failed because of the data. */
+	amiq_rm_status_t get_failed_status();
+
+	/** @returns the last data read (or the value checked) by the failed step. */
+	amiq_rm_reg_data_t get_failed_data();
+
+	/** @returns a string with debug purpose information: the steps, one on each line, in the text format. */
+	std::string to_string();
+
+private:
+	/** A step of the sequence. */
+	struct amiq_rm_step {
+		/** The kind of the step. */
+		amiq_rm_step_kind_t kind;
+
+		/** The path or the address of the register. */
+		std::string reg;
+
+		/** The name of the field (for WRITE_FIELD_STEP). */
+		std::string field;
+
+		/** The written data, the new value of the field or the expected data. */
+		amiq_rm_reg_data_t value;
+
+		/** The bits which are checked. */
+		amiq_rm_reg_data_t mask;
+
+		/** The maximum number of reads (for POLL_STEP). */
+		int unsigned max_reads;
+
+		/** A copy of the decoded target, set by compile(). */
+		amiq_rm_decode_target target;
+
+		/** The index of the element in the target (or the offset of the word in the memory), set by compile(). */
+		amiq_rm_reg_address_t index;
+
+		/** The mask of the field in the register, set by compile(). */
+		amiq_rm_reg_data_t field_mask;
+
+		/** The lsb position of the field, set by compile(). */
+		int unsigned field_lsb;
+
+		/** The latency of a read of the element, set by compile(). */
+		uint64_t read_latency;
+
+		/** The latency of a write of the element, set by compile(). */
+		uint64_t write_latency;
+	};
+
+	/** The steps of the sequence. */
+	std::vector<amiq_rm_step> steps;
+
+	/** Set by compile() if all steps were resolved, cleared when a step is added. */
+	bool compiled;
+
+	/** The index of the step which failed in the last run(). */
+	int unsigned failed_step;
+
+	/** The status of the access of the failed step. */
+	amiq_rm_status_t failed_status;
+
+	/** The last data read by the failed step. */
+	amiq_rm_reg_data_t failed_data;
+
+	/** The function adds a step.
+	 * @returns the new step */
+	amiq_rm_step& add_step(amiq_rm_step_kind_t kind, std::string reg);
+
+	/** The function resolves the element of a step given by address.
+	 * @param map is the physical map
+	 * @param step is the step
+	 * @param address is the absolute address of the register
+	 * @returns false if there is no element at the address */
+	bool resolve(amiq_rm_physical_address_map &map, amiq_rm_step &step, amiq_rm_reg_address_t address);
+
+	/** The function executes the steps.
+	 * @param keeper is the quantum keeper to which the latencies are added, NULL to ignore the latencies
+	 * @returns true if all steps succeeded */
+	bool execute(amiq_rm_quantum_keeper *keeper);
+
+	/** The function adds the latency of an access to the local time of a quantum keeper and synchronizes the keeper if its quantum is reached.
+	 * @param keeper is the quantum keeper or NULL
+	 * @param latency is the latency of the access */
+	void annotate(amiq_rm_quantum_keeper *keeper, uint64_t latency);
+
+	/** The function reads the element of a step. */
+	std::pair<amiq_rm_reg_data_t, amiq_rm_status_t> read(amiq_rm_step &step) {
+		switch (step.target.kind) {
+		case REG_TARGET:
+			return step.target.reg->read();
+		case REG_ARRAY_TARGET:
+			return step.target.reg_array->read(step.index);
+		case MAP_ARRAY_TARGET:
+			return step.target.map_array->read(step.index);
+		default:
+			return step.target.mem->read(step.index);
+		}
+	}
+
+	/** The function writes the element of a step. */
+	amiq_rm_status_t write(amiq_rm_step &step, amiq_rm_reg_data_t data) {
+		switch (step.target.kind) {
+		case REG_TARGET:
+			return step.target.reg->write(data);
+		case REG_ARRAY_TARGET:
+			return step.target.reg_array->write(step.index, data);
+		case MAP_ARRAY_TARGET:
+			return step.target.map_array->write(step.index, data);
+		default:
+			return step.target.mem->write(step.index, data);
+		}
+	}
+
+	/** The function gets the value of the element of a step. */
+	amiq_rm_reg_data_t get(amiq_rm_step &step) {
+		switch (step.target.kind) {
+		case REG_TARGET:
+			return step.target.reg->get();
+		case REG_ARRAY_TARGET:
+			return step.target.reg_array->get(step.index);
+		case MAP_ARRAY_TARGET:
+			return step.target.map_array->get(step.index);
+		default:
+			return step.target.mem->get(step.index);
+		}
+	}
+};
+
+}
+
+#endif
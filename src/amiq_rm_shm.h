@@ -0,0 +1,128 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_shm.h
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+/* This file describes the protocol between amiq_rm_shm_server and the out-of-process clients, and the C client library
+ * (libamiq_rm_shm_client.a / libamiq_rm_shm_client.so, which do not depend on the register model).
+ * A client attaches through the Unix-domain control socket of the server and receives the name of a POSIX shared memory
+ * object which holds one request/response ring:
+ * - the client writes requests in the entries following @b head and then advances @b head (one store for a whole batch)
+ * - the server executes the entries between @b done and @b head on the register model, writes the results in place and advances @b done
+ * Both sides only spin on the two counters, so an access does not need any system call. */
+
+#ifndef AMIQ_RM_SHM_HEADER
+#define AMIQ_RM_SHM_HEADER 1
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Identifies a valid ring. */
+#define AMIQ_RM_SHM_MAGIC 0x414D5251
+
+/** Number of entries of a ring (a power of 2). */
+#define AMIQ_RM_SHM_NOF_ENTRIES 1024
+
+/** Size of the name of a shared memory object, including the terminating 0. */
+#define AMIQ_RM_SHM_NAME_SIZE 64
+
+/** Default time (in milliseconds) a client waits for the server to execute a batch, see amiq_rm_shm_set_timeout(). */
+#define AMIQ_RM_SHM_DEFAULT_TIMEOUT_MS 5000
+
+/** Values of the status of an entry, they correspond to amiq_rm_status_t. */
+#define AMIQ_RM_SHM_OKAY 0x0
+#define AMIQ_RM_SHM_ERROR 0x1
+#define AMIQ_RM_SHM_HOLE 0x2
+
+/** Operations of a ring entry, they correspond to the functions of amiq_rm_physical_address_map. */
+typedef enum {
+	AMIQ_RM_SHM_READ = 0x0, AMIQ_RM_SHM_WRITE = 0x1, AMIQ_RM_SHM_GET = 0x2, AMIQ_RM_SHM_SET = 0x3
+} amiq_rm_shm_op_t;
+
+/** Operations of the control channel. */
+typedef enum {
+	AMIQ_RM_SHM_ATTACH = 0x1, AMIQ_RM_SHM_DETACH = 0x2
+} amiq_rm_shm_control_op_t;
+
+/** An access. @b status takes the values of amiq_rm_status_t (AMIQ_RM_SHM_OKAY, AMIQ_RM_SHM_ERROR, AMIQ_RM_SHM_HOLE),
+ * @b data holds the result of READ and GET. */
+typedef struct {
+	uint64_t address;
+	uint32_t data;
+	uint8_t op;
+	uint8_t status;
+	uint16_t reserved;
+} amiq_rm_shm_entry_t;
+
+/** The content of the shared memory object of a client. */
+typedef struct {
+	uint32_t magic;
+	uint32_t nof_entries;
+	uint64_t head __attribute__((aligned(64)));
+	uint64_t done __attribute__((aligned(64)));
+	amiq_rm_shm_entry_t entries[AMIQ_RM_SHM_NOF_ENTRIES] __attribute__((aligned(64)));
+} amiq_rm_shm_region_t;
+
+/** A message of the control channel (in both directions). In a reply, @b op is 0 on success. */
+typedef struct {
+	uint32_t op;
+	char name[AMIQ_RM_SHM_NAME_SIZE];
+} amiq_rm_shm_control_t;
+
+/** Handle of an attached client. */
+typedef struct amiq_rm_shm_client amiq_rm_shm_client_t;
+
+/** Attaches to a server.
+ * @param socket_path is the path of the control socket of the server
+ * @returns a client handle or NULL in case of error */
+amiq_rm_shm_client_t* amiq_rm_shm_attach(const char *socket_path);
+
+/** Detaches from the server and releases the handle.
+ * @param client is the handle returned by amiq_rm_shm_attach() */
+void amiq_rm_shm_detach(amiq_rm_shm_client_t *client);
+
+/** Sets the time a client waits for the server to execute a chunk of a batch (AMIQ_RM_SHM_DEFAULT_TIMEOUT_MS by default).
+ * @param client is the handle returned by amiq_rm_shm_attach()
+ * @param timeout_ms is the time in milliseconds */
+void amiq_rm_shm_set_timeout(amiq_rm_shm_client_t *client, uint32_t timeout_ms);
+
+/** Executes a batch of accesses, in order. The batch is split in chunks of at most AMIQ_RM_SHM_NOF_ENTRIES entries,
+ * each chunk is published with a single update of the ring.
+ * @n If the server closes the connection (e.g. it stopped or crashed) or does not execute a chunk within the timeout, the ring
+ * can no longer be used: the remaining entries get the AMIQ_RM_SHM_ERROR status and so do the entries of all the following calls.
+ * @param client is the handle returned by amiq_rm_shm_attach()
+ * @param entries are the accesses; on return @b data and @b status hold the results
+ * @param nof_entries is the number of accesses
+ * @returns 0 on success, -1 if the entries were not executed */
+int amiq_rm_shm_execute(amiq_rm_shm_client_t *client, amiq_rm_shm_entry_t *entries, uint32_t nof_entries);
+
+/** Reads a register (amiq_rm_physical_address_map::read()).
+ * @returns the status of the access (AMIQ_RM_SHM_ERROR if the server did not execute it), the read value is stored in @b data */
+uint8_t amiq_rm_shm_read(amiq_rm_shm_client_t *client, uint64_t address, uint32_t *data);
+
+/** Writes a register (amiq_rm_physical_address_map::write()).
+ * @returns the status of the access (AMIQ_RM_SHM_ERROR if the server did not execute it) */
+uint8_t amiq_rm_shm_write(amiq_rm_shm_client_t *client, uint64_t address, uint32_t data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,205 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_shm_client.c
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "amiq_rm_shm.h"
+
+/* Number of polls of the ring between two checks of the connection and of the timeout. */
+#define AMIQ_RM_SHM_SPINS_PER_CHECK 1024
+
+struct amiq_rm_shm_client {
+	int control_fd;
+	amiq_rm_shm_region_t *region;
+	uint32_t timeout_ms;
+	/* set when the server did not execute a chunk, the ring can no longer be used */
+	int broken;
+};
+
+static uint64_t amiq_rm_shm_now_us(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((uint64_t) now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
+/* Waits until the server executed the requests up to @b head. The server never writes on the control socket unless it is asked,
+ * so a readable or hung up socket means that the server closed the connection. */
+static int amiq_rm_shm_wait(amiq_rm_shm_client_t *client, uint64_t head) {
+	uint64_t deadline = amiq_rm_shm_now_us() + ((uint64_t) client->timeout_ms) * 1000;
+	uint32_t nof_spins = 0;
+
+	while (__atomic_load_n(&client->region->done, __ATOMIC_ACQUIRE) != head) {
+		struct pollfd control;
+		int nof_ready;
+
+		if (++nof_spins < AMIQ_RM_SHM_SPINS_PER_CHECK) {
+#if defined(__x86_64__) || defined(__i386__)
+			__builtin_ia32_pause();
+#endif
+			continue;
+		}
+		nof_spins = 0;
+
+		control.fd = client->control_fd;
+		control.events = POLLIN;
+		control.revents = 0;
+		nof_ready = poll(&control, 1, 0);
+		if ((nof_ready > 0) || ((nof_ready < 0) && (errno != EINTR)) || (amiq_rm_shm_now_us() > deadline))
+			return -1;
+	}
+	return 0;
+}
+
+static int amiq_rm_shm_transfer(int fd, amiq_rm_shm_control_t *message) {
+	/* a server which crashed must not kill the client with SIGPIPE */
+	if (send(fd, message, sizeof(*message), MSG_NOSIGNAL) != sizeof(*message))
+		return -1;
+	if (recv(fd, message, sizeof(*message), MSG_WAITALL) != sizeof(*message))
+		return -1;
+	return 0;
+}
+
+amiq_rm_shm_client_t* amiq_rm_shm_attach(const char *socket_path) {
+	struct sockaddr_un socket_address;
+	amiq_rm_shm_control_t message;
+	amiq_rm_shm_client_t *client;
+	int shm_fd;
+
+	client = (amiq_rm_shm_client_t*) malloc(sizeof(amiq_rm_shm_client_t));
+	if (client == NULL)
+		return NULL;
+
+	client->control_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (client->control_fd < 0) {
+		free(client);
+		return NULL;
+	}
+	client->timeout_ms = AMIQ_RM_SHM_DEFAULT_TIMEOUT_MS;
+	client->broken = 0;
+
+	memset(&socket_address, 0, sizeof(socket_address));
+	socket_address.sun_family = AF_UNIX;
+	strncpy(socket_address.sun_path, socket_path, sizeof(socket_address.sun_path) - 1);
+
+	memset(&message, 0, sizeof(message));
+	message.op = AMIQ_RM_SHM_ATTACH;
+	if ((connect(client->control_fd, (struct sockaddr*) &socket_address, sizeof(socket_address)) != 0)
+			|| (amiq_rm_shm_transfer(client->control_fd, &message) != 0) || (message.op != 0)) {
+		close(client->control_fd);
+		free(client);
+		return NULL;
+	}
+
+	message.name[AMIQ_RM_SHM_NAME_SIZE - 1] = 0;
+	shm_fd = shm_open(message.name, O_RDWR, 0);
+	if (shm_fd < 0) {
+		close(client->control_fd);
+		free(client);
+		return NULL;
+	}
+	client->region = (amiq_rm_shm_region_t*) mmap(NULL, sizeof(amiq_rm_shm_region_t), PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+	close(shm_fd);
+	if ((client->region == MAP_FAILED) || (client->region->magic != AMIQ_RM_SHM_MAGIC)) {
+		if (client->region != MAP_FAILED)
+			munmap(client->region, sizeof(amiq_rm_shm_region_t));
+		close(client->control_fd);
+		free(client);
+		return NULL;
+	}
+	return client;
+}
+
+void amiq_rm_shm_detach(amiq_rm_shm_client_t *client) {
+	amiq_rm_shm_control_t message;
+
+	munmap(client->region, sizeof(amiq_rm_shm_region_t));
+
+	memset(&message, 0, sizeof(message));
+	message.op = AMIQ_RM_SHM_DETACH;
+	amiq_rm_shm_transfer(client->control_fd, &message);
+
+	close(client->control_fd);
+	free(client);
+}
+
+void amiq_rm_shm_set_timeout(amiq_rm_shm_client_t *client, uint32_t timeout_ms) {
+	client->timeout_ms = timeout_ms;
+}
+
+int amiq_rm_shm_execute(amiq_rm_shm_client_t *client, amiq_rm_shm_entry_t *entries, uint32_t nof_entries) {
+	amiq_rm_shm_region_t *region = client->region;
+
+	while ((nof_entries > 0) && !client->broken) {
+		uint32_t chunk = (nof_entries < AMIQ_RM_SHM_NOF_ENTRIES) ? nof_entries : AMIQ_RM_SHM_NOF_ENTRIES;
+		/* all previous requests are done when execute() returns, so the whole ring is free */
+		uint64_t head = region->head;
+		uint32_t i;
+
+		for (i = 0; i < chunk; i++)
+			region->entries[(head + i) & (AMIQ_RM_SHM_NOF_ENTRIES - 1)] = entries[i];
+		__atomic_store_n(&region->head, head + chunk, __ATOMIC_RELEASE);
+
+		if (amiq_rm_shm_wait(client, head + chunk) != 0) {
+			client->broken = 1;
+			break;
+		}
+
+		for (i = 0; i < chunk; i++)
+			entries[i] = region->entries[(head + i) & (AMIQ_RM_SHM_NOF_ENTRIES - 1)];
+
+		entries += chunk;
+		nof_entries -= chunk;
+	}
+
+	if (nof_entries == 0)
+		return 0;
+	for (; nof_entries > 0; entries++, nof_entries--)
+		entries->status = AMIQ_RM_SHM_ERROR;
+	return -1;
+}
+
+uint8_t amiq_rm_shm_read(amiq_rm_shm_client_t *client, uint64_t address, uint32_t *data) {
+	amiq_rm_shm_entry_t entry;
+
+	memset(&entry, 0, sizeof(entry));
+	entry.op = AMIQ_RM_SHM_READ;
+	entry.address = address;
+	amiq_rm_shm_execute(client, &entry, 1);
+	*data = entry.data;
+	return entry.status;
+}
+
+uint8_t amiq_rm_shm_write(amiq_rm_shm_client_t *client, uint64_t address, uint32_t data) {
+	amiq_rm_shm_entry_t entry;
+
+	memset(&entry, 0, sizeof(entry));
+	entry.op = AMIQ_RM_SHM_WRITE;
+	entry.address = address;
+	entry.data = data;
+	amiq_rm_shm_execute(client, &entry, 1);
+	return entry.status;
+}
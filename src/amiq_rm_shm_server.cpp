@@ -0,0 +1,312 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_shm_server.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef	AMIQ_RM_SHM_SERVER
+#define	AMIQ_RM_SHM_SERVER	1
+
+#include <assert.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sstream>
+#include <chrono>
+#include "amiq_rm_shm_server.hpp"
+#include "amiq_rm_address_map.hpp"
+#include "amiq_rm_log.hpp"
+
+using namespace std;
+
+namespace amiq_rm {
+
+const int unsigned amiq_rm_shm_server::AMIQ_RM_SHM_IDLE_SLEEP_US;
+
+bool amiq_rm_shm_server::start() {
+	assert(!running);
+
+	struct sockaddr_un socket_address;
+	memset(&socket_address, 0, sizeof(socket_address));
+	socket_address.sun_family = AF_UNIX;
+	if (socket_path.size() >= sizeof(socket_address.sun_path))
+		return false;
+	strncpy(socket_address.sun_path, socket_path.c_str(), sizeof(socket_address.sun_path) - 1);
+
+	listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listen_fd < 0)
+		return false;
+	unlink(socket_path.c_str());
+	if ((bind(listen_fd, (struct sockaddr*) &socket_address, sizeof(socket_address)) != 0) || (listen(listen_fd, 16) != 0)
+			|| (pipe(wakeup_fds) != 0)) {
+		close(listen_fd);
+		listen_fd = -1;
+		return false;
+	}
+
+	running = true;
+	control_thread = thread(&amiq_rm_shm_server::control_loop, this);
+	service_thread = thread(&amiq_rm_shm_server::service_loop, this);
+	return true;
+}
+
+void amiq_rm_shm_server::stop() {
+	if (!running)
+		return;
+
+	running = false;
+	char wakeup = 0;
+	if (write(wakeup_fds[1], &wakeup, 1) != 1)
+		assert(0);
+	control_thread.join();
+	service_thread.join();
+
+	for (int unsigned i = 0; i < connections.size(); i++)
+		release(connections[i]);
+	connections.clear();
+
+	close(listen_fd);
+	close(wakeup_fds[0]);
+	close(wakeup_fds[1]);
+	listen_fd = -1;
+	unlink(socket_path.c_str());
+}
+
+int unsigned amiq_rm_shm_server::get_nof_clients() {
+	lock_guard<mutex> lock(connections_mutex);
+	int unsigned nof_clients = 0;
+	for (int unsigned i = 0; i < connections.size(); i++) {
+		if (connections[i]->region != NULL)
+			nof_clients++;
+	}
+	return nof_clients;
+}
+
+bool amiq_rm_shm_server::attach(amiq_rm_shm_connection *connection) {
+	ostringstream name;
+	name << "/amiq_rm_" << getpid() << "_" << next_id++;
+
+	int shm_fd = shm_open(name.str().c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+	if (shm_fd < 0)
+		return false;
+	if (ftruncate(shm_fd, sizeof(amiq_rm_shm_region_t)) != 0) {
+		close(shm_fd);
+		shm_unlink(name.str().c_str());
+		return false;
+	}
+	void *region = mmap(NULL, sizeof(amiq_rm_shm_region_t), PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+	close(shm_fd);
+	if (region == MAP_FAILED) {
+		shm_unlink(name.str().c_str());
+		return false;
+	}
+
+	memset(region, 0, sizeof(amiq_rm_shm_region_t));
+	((amiq_rm_shm_region_t*) region)->magic = AMIQ_RM_SHM_MAGIC;
+	((amiq_rm_shm_region_t*) region)->nof_entries = AMIQ_RM_SHM_NOF_ENTRIES;
+
+	lock_guard<mutex> lock(connections_mutex);
+	connection->shm_name = name.str();
+	connection->region = (amiq_rm_shm_region_t*) region;
+	AMIQ_RM_INFO(AMIQ_RM_MEDIUM, "Client attached to " << socket_path << " with ring " << name.str());
+	return true;
+}
+
+void amiq_rm_shm_server::release(amiq_rm_shm_connection *connection) {
+	if (connection->region != NULL) {
+		munmap(connection->region, sizeof(amiq_rm_shm_region_t));
+		shm_unlink(connection->shm_name.c_str());
+	}
+	close(connection->control_fd);
+	delete connection;
+}
+
+void amiq_rm_shm_server::control_loop() {
+	while (running) {
+		vector<struct pollfd> fds(2);
+		fds[0].fd = wakeup_fds[0];
+		fds[0].events = POLLIN;
+		fds[1].fd = listen_fd;
+		fds[1].events = POLLIN;
+		for (int unsigned i = 0; i < connections.size(); i++) {
+			struct pollfd connection_fd;
+			connection_fd.fd = connections[i]->control_fd;
+			connection_fd.events = POLLIN;
+			fds.push_back(connection_fd);
+		}
+
+		if (poll(&fds[0], fds.size(), -1) <= 0)
+			continue;
+		if (fds[0].revents != 0)
+			return;
+
+		//serve the existing connections first, as the vector changes when a new connection is accepted
+		for (int unsigned i = 2; i < fds.size(); i++) {
+			if (fds[i].revents == 0)
+				continue;
+
+			amiq_rm_shm_connection *connection = connections[i - 2];
+			if (!receive(connection)) {
+				{
+					lock_guard<mutex> lock(connections_mutex);
+					connections[i - 2] = NULL;
+				}
+				release(connection);
+			}
+		}
+
+		{
+			lock_guard<mutex> lock(connections_mutex);
+			vector<amiq_rm_shm_connection*> open_connections;
+			for (int unsigned i = 0; i < connections.size(); i++) {
+				if (connections[i] != NULL)
+					open_connections.push_back(connections[i]);
+			}
+
+			if (fds[1].revents != 0) {
+				int control_fd = accept(listen_fd, NULL, NULL);
+				if ((control_fd >= 0) && (fcntl(control_fd, F_SETFL, fcntl(control_fd, F_GETFL) | O_NONBLOCK) != 0)) {
+					close(control_fd);
+					control_fd = -1;
+				}
+				if (control_fd >= 0) {
+					amiq_rm_shm_connection *connection = new amiq_rm_shm_connection();
+					connection->control_fd = control_fd;
+					connection->region = NULL;
+					connection->done = 0;
+					connection->dropped = false;
+					connection->nof_received = 0;
+					open_connections.push_back(connection);
+				}
+			}
+			connections = open_connections;
+		}
+	}
+}
+
+bool amiq_rm_shm_server::receive(amiq_rm_shm_connection *connection) {
+	ssize_t nof_bytes = recv(connection->control_fd, ((char*) &connection->message) + connection->nof_received,
+			sizeof(connection->message) - connection->nof_received, 0);
+	if (nof_bytes < 0)
+		return (errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR);
+	if (nof_bytes == 0)
+		return false;
+
+	connection->nof_received += nof_bytes;
+	if (connection->nof_received < sizeof(connection->message))
+		return true;
+
+	//the replies are small and the client waits for them, so a reply which does not fit in the socket closes the connection
+	amiq_rm_shm_control_t &message = connection->message;
+	connection->nof_received = 0;
+	if ((message.op == AMIQ_RM_SHM_ATTACH) && (connection->region == NULL)) {
+		memset(&message, 0, sizeof(message));
+		if (attach(connection))
+			strncpy(message.name, connection->shm_name.c_str(), AMIQ_RM_SHM_NAME_SIZE - 1);
+		else
+			message.op = ERROR;
+		return send(connection->control_fd, &message, sizeof(message), 0) == sizeof(message);
+	} else if (message.op == AMIQ_RM_SHM_DETACH) {
+		memset(&message, 0, sizeof(message));
+		send(connection->control_fd, &message, sizeof(message), 0);
+	}
+	return false;
+}
+
+bool amiq_rm_shm_server::process(amiq_rm_shm_connection *connection) {
+	amiq_rm_shm_region_t *region = connection->region;
+	uint64_t done = connection->done;
+	uint64_t head = __atomic_load_n(&region->head, __ATOMIC_ACQUIRE);
+	if (head == done)
+		return false;
+
+	//the unsigned difference also catches a head moved backwards
+	if (head - done > AMIQ_RM_SHM_NOF_ENTRIES) {
+		AMIQ_RM_INFO(AMIQ_RM_LOW, "Client of " << socket_path << " with ring " << connection->shm_name << " published an invalid head, it is dropped");
+		connection->dropped = true;
+		shutdown(connection->control_fd, SHUT_RDWR);
+		return false;
+	}
+
+	for (uint64_t i = done; i != head; i++)
+		execute(region->entries[i & (AMIQ_RM_SHM_NOF_ENTRIES - 1)]);
+	connection->done = head;
+	__atomic_store_n(&region->done, head, __ATOMIC_RELEASE);
+	return true;
+}
+
+void amiq_rm_shm_server::execute(amiq_rm_shm_entry_t &entry) {
+	amiq_rm_decode_target *target = map.decode(entry.address);
+	int unsigned index;
+
+	if ((target == NULL) || ((entry.op >= AMIQ_RM_SHM_GET) && !target->get_index(entry.address, index))) {
+		entry.status = HOLE;
+		return;
+	}
+
+	pair<amiq_rm_reg_data_t, amiq_rm_status_t> data_with_status;
+	switch (entry.op) {
+	case AMIQ_RM_SHM_READ:
+		data_with_status = target->read(entry.address);
+		entry.data = data_with_status.first;
+		entry.status = data_with_status.second;
+		break;
+	case AMIQ_RM_SHM_WRITE:
+		entry.status = target->write(entry.address, entry.data);
+		break;
+	case AMIQ_RM_SHM_GET:
+		entry.data = target->get(entry.address);
+		entry.status = OKAY;
+		break;
+	case AMIQ_RM_SHM_SET:
+		target->set(entry.address, entry.data);
+		entry.status = OKAY;
+		break;
+	default:
+		entry.status = ERROR;
+	}
+}
+
+void amiq_rm_shm_server::service_loop() {
+	int unsigned idle_sweeps = 0;
+	while (running) {
+		bool busy = false;
+		{
+			lock_guard<mutex> lock(connections_mutex);
+			for (int unsigned i = 0; i < connections.size(); i++) {
+				if ((connections[i] != NULL) && (connections[i]->region != NULL) && !connections[i]->dropped)
+					busy |= process(connections[i]);
+			}
+		}
+
+		if (busy) {
+			idle_sweeps = 0;
+		} else if (idle_sweeps < AMIQ_RM_SHM_IDLE_SWEEPS) {
+			idle_sweeps++;
+		} else {
+			this_thread::sleep_for(chrono::microseconds(AMIQ_RM_SHM_IDLE_SLEEP_US));
+		}
+	}
+}
+
+}
+
+#endif
@@ -0,0 +1,162 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_shm_server.hpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef AMIQ_RM_SHM_SERVER_HEADER
+#define AMIQ_RM_SHM_SERVER_HEADER 1
+
+#include "amiq_rm_types.cpp"
+#include "amiq_rm_shm.h"
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <atomic>
+
+namespace amiq_rm {
+
+class amiq_rm_physical_address_map;
+
+/** This class exposes a physical address map to other processes (e.g. checkers written in Python, another simulator).
+ * The clients use the C library declared in amiq_rm_shm.h: they attach through a Unix-domain socket (the control channel) and
+ * then exchange batches of accesses with the server through a request/response ring placed in shared memory (see amiq_rm_shm.h).
+ * @n The server uses two threads: one serves the control channel, the other one polls the rings of the attached clients and executes
+ * the accesses on the map. While the server is running, the map must not be accessed by other threads. After
+ * AMIQ_RM_SHM_IDLE_SWEEPS polls without any request, the polling thread sleeps AMIQ_RM_SHM_IDLE_SLEEP_US between polls. */
+class amiq_rm_shm_server {
+public:
+	/** Number of consecutive polls without requests after which the polling thread starts to sleep between polls. */
+	static const int unsigned AMIQ_RM_SHM_IDLE_SWEEPS = 10000;
+
+	/** Duration (in microseconds) of the sleep between two polls of an idle server. */
+	static const int unsigned AMIQ_RM_SHM_IDLE_SLEEP_US = 50;
+
+	/** The address map on which the accesses are executed. */
+	amiq_rm_physical_address_map &map;
+
+	/** The path of the Unix-domain socket of the control channel. */
+	std::string socket_path;
+
+	/** Create new server, the server is started with start().
+	 * @param my_map is the address map on which the accesses are executed
+	 * @param my_socket_path is the path of the control socket */
+	amiq_rm_shm_server(amiq_rm_physical_address_map &my_map, std::string my_socket_path) :
+			map(my_map) {
+		socket_path = my_socket_path;
+		listen_fd = -1;
+		wakeup_fds[0] = -1;
+		wakeup_fds[1] = -1;
+		next_id = 0;
+		running = false;
+	}
+
+	/** Stop the server. */
+	virtual ~amiq_rm_shm_server() {
+		stop();
+	}
+
+	/** The function creates the control socket and starts the threads of the server.
+	 * @returns false if the control socket could not be created */
+	bool start();
+
+	/** The function detaches all the clients, removes the control socket and stops the threads of the server. */
+	void stop();
+
+	/** @returns the number of attached clients. */
+	int unsigned get_nof_clients();
+
+private:
+	/** A connection on the control channel and, after ATTACH, the ring of the client. */
+	struct amiq_rm_shm_connection {
+		int control_fd;
+		std::string shm_name;
+		amiq_rm_shm_region_t *region;
+
+		/** The number of executed requests. It is kept by the server, as the ring can be written by the client. */
+		uint64_t done;
+
+		/** Set by the polling thread when the client wrote an invalid head, the ring is not polled any more. */
+		bool dropped;
+
+		/** The control message being received, the socket is not blocking so a message can arrive in several parts. */
+		amiq_rm_shm_control_t message;
+
+		/** The number of bytes of @b message received so far. */
+		int unsigned nof_received;
+	};
+
+	/** The connections of the control channel. */
+	std::vector<amiq_rm_shm_connection*> connections;
+
+	/** Protects connections, it is taken by the polling thread for each poll. */
+	std::mutex connections_mutex;
+
+	/** Set while the server is running. */
+	std::atomic<bool> running;
+
+	/** The listening socket of the control channel. */
+	int listen_fd;
+
+	/** A pipe used by stop() to wake up the control thread. */
+	int wakeup_fds[2];
+
+	/** Used to give unique names to the shared memory objects. */
+	int unsigned next_id;
+
+	/** The thread which serves the control channel. */
+	std::thread control_thread;
+
+	/** The thread which polls the rings. */
+	std::thread service_thread;
+
+	/** The function executed by the control thread. The control sockets are not blocking, so a client which sends part of a message
+	 * does not stop the thread from serving the other clients. */
+	void control_loop();
+
+	/** The function executed by the polling thread. */
+	void service_loop();
+
+	/** The function creates the ring of a client.
+	 * @param connection is the connection on which ATTACH was received
+	 * @returns true if the ring was created */
+	bool attach(amiq_rm_shm_connection *connection);
+
+	/** The function closes a connection and removes the ring of the client.
+	 * @param connection is the connection which is closed */
+	void release(amiq_rm_shm_connection *connection);
+
+	/** The function receives the available part of a control message and serves the message once it is complete.
+	 * @param connection is the connection on which data arrived
+	 * @returns false if the connection must be closed */
+	bool receive(amiq_rm_shm_connection *connection);
+
+	/** The function executes the requests of a client which were not executed yet. A client which published more requests than
+	 * the ring holds (or moved @b head backwards) is dropped: its ring is not polled any more and its control socket is shut down,
+	 * so the control thread closes the connection.
+	 * @param connection is the connection of the client, it must have a ring
+	 * @returns true if there were requests to execute */
+	bool process(amiq_rm_shm_connection *connection);
+
+	/** The function executes one access on the map.
+	 * @param entry is the access, the results are written in it */
+	void execute(amiq_rm_shm_entry_t &entry);
+};
+
+}
+
+#endif
@@ -0,0 +1,54 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_signal.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef	AMIQ_RM_SIGNAL
+#define	AMIQ_RM_SIGNAL	1
+
+#include <assert.h>
+#include "amiq_rm_signal.hpp"
+
+using namespace std;
+
+namespace amiq_rm {
+
+vector<string>& amiq_rm_signal::get_names() {
+	static vector<string> names;
+	return names;
+}
+
+int unsigned amiq_rm_signal::get_id(string name) {
+	vector<string> &names = get_names();
+	for (int unsigned i = 0; i < names.size(); i++) {
+		if (names[i] == name)
+			return i;
+	}
+
+	assert(names.size() < AMIQ_RM_MAX_SIGNALS);
+	names.push_back(name);
+	return names.size() - 1;
+}
+
+string amiq_rm_signal::get_name(int unsigned id) {
+	assert(id < get_names().size());
+	return get_names()[id];
+}
+
+}
+
+#endif
@@ -0,0 +1,113 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_signal.hpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef AMIQ_RM_SIGNAL_HEADER
+#define AMIQ_RM_SIGNAL_HEADER 1
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace amiq_rm {
+
+/** This class holds the names of the aggregate signals (e.g. "irq", "error") to which fields contribute (amiq_rm_field::add_signal()).
+ * The names are interned: each name gets a small id (the position of its bit in the 64-bit signal masks), which is the same in all
+ * registers and maps. At most AMIQ_RM_MAX_SIGNALS names can be used. */
+class amiq_rm_signal {
+public:
+	/** The maximum number of signals. */
+	static const int unsigned AMIQ_RM_MAX_SIGNALS = 64;
+
+	/** @param name is the name of the signal
+	 * @returns the id of the signal, a new id is given to a name which was not seen yet */
+	static int unsigned get_id(std::string name);
+
+	/** @param id is the id of a signal
+	 * @returns the name of the signal */
+	static std::string get_name(int unsigned id);
+
+	/** @param id is the id of a signal
+	 * @returns the mask of the signal (the bit of the signal in the 64-bit signal masks) */
+	static uint64_t get_mask(int unsigned id) {
+		return ((uint64_t) 1) << id;
+	}
+
+private:
+	/** @returns the names of the signals, the id of a signal is its position. */
+	static std::vector<std::string>& get_names();
+};
+
+/** This class holds the aggregate of the signals for a node of the hierarchy (an address map, a register array or a map array):
+ * for each signal, the number of sources under the node (registers, elements, sub-maps) which have the signal active. A signal is
+ * pending in the node if at least one source has it active. */
+class amiq_rm_signal_node {
+public:
+	/** The mask of the pending signals. */
+	uint64_t pending_signals;
+
+	/** Create a node without pending signals. */
+	amiq_rm_signal_node() {
+		clear();
+	}
+
+	/** The function removes all sources. */
+	void clear() {
+		pending_signals = 0;
+		for (int unsigned i = 0; i < amiq_rm_signal::AMIQ_RM_MAX_SIGNALS; i++)
+			counts[i] = 0;
+	}
+
+	/** The function updates the counts when the active signals of a source change.
+	 * @param old_signals are the signals which were active in the source
+	 * @param new_signals are the signals which are active in the source
+	 * @returns true if the pending signals of the node changed */
+	bool update(uint64_t old_signals, uint64_t new_signals) {
+		uint64_t old_pending = pending_signals;
+		uint64_t rising = new_signals & (~old_signals);
+		uint64_t falling = old_signals & (~new_signals);
+
+		while (rising != 0) {
+			int unsigned id = __builtin_ctzll(rising);
+			rising &= rising - 1;
+			if (counts[id]++ == 0)
+				pending_signals |= amiq_rm_signal::get_mask(id);
+		}
+		while (falling != 0) {
+			int unsigned id = __builtin_ctzll(falling);
+			falling &= falling - 1;
+			if (--counts[id] == 0)
+				pending_signals &= ~amiq_rm_signal::get_mask(id);
+		}
+		return (pending_signals != old_pending);
+	}
+
+	/** @param id is the id of a signal
+	 * @returns the number of sources which have the signal active */
+	int unsigned get_count(int unsigned id) {
+		return counts[id];
+	}
+
+private:
+	/** The number of sources which have each signal active. */
+	int unsigned counts[amiq_rm_signal::AMIQ_RM_MAX_SIGNALS];
+};
+
+}
+
+#endif
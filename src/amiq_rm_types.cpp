@@ -23,7 +23,7 @@
 namespace amiq_rm {
 
 typedef int unsigned amiq_rm_reg_data_t;
-typedef int unsigned amiq_rm_reg_address_t;
+typedef long long unsigned amiq_rm_reg_address_t;
 typedef enum {
 	READ = 0x0, WRITE = 0x1
 } amiq_rm_direction_t;
@@ -31,6 +31,12 @@ typedef enum {
 	OKAY = 0x0, ERROR = 0x1, HOLE = 0x2
 } amiq_rm_status_t;
 
+/** @param size is the number of bits of a field, at most the number of bits of amiq_rm_reg_data_t
+ * @returns the mask of the values of a field of @b size bits, starting from bit 0 */
+inline amiq_rm_reg_data_t amiq_rm_get_value_mask(int unsigned size) {
+	return (size >= 8 * sizeof(amiq_rm_reg_data_t)) ? ~((amiq_rm_reg_data_t) 0) : ((((amiq_rm_reg_data_t) 1) << size) - 1);
+}
+
 }
 
 #endif
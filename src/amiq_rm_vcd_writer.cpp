@@ -0,0 +1,238 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_vcd_writer.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef	AMIQ_RM_VCD_WRITER
+#define	AMIQ_RM_VCD_WRITER	1
+
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "amiq_rm_vcd_writer.hpp"
+#include "amiq_rm_address_map.hpp"
+
+using namespace std;
+
+namespace amiq_rm {
+
+/** The first and the number of the printable characters used in the identifiers of the variables. */
+static const char amiq_rm_vcd_first_code = '!';
+static const int unsigned amiq_rm_vcd_nof_code_chars = '~' - '!' + 1;
+
+amiq_rm_vcd_writer::amiq_rm_vcd_writer(int unsigned buffer_size) {
+	assert(buffer_size >= 64);
+	timescale = "1ns";
+	buffer.resize(buffer_size);
+	used = 0;
+	fd = -1;
+	owns_fd = false;
+	failed = false;
+	time = 0;
+	time_pending = false;
+	nof_changes = 0;
+	nof_codes = 0;
+}
+
+amiq_rm_vcd_writer::~amiq_rm_vcd_writer() {
+	close();
+}
+
+void amiq_rm_vcd_writer::add_map(amiq_rm_address_map &map) {
+	assert(fd < 0);
+	maps.push_back(&map);
+}
+
+bool amiq_rm_vcd_writer::open(string file_name) {
+	close();
+	int file_fd = ::open(file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (file_fd < 0)
+		return false;
+
+	attach(file_fd);
+	owns_fd = true;
+	return true;
+}
+
+void amiq_rm_vcd_writer::attach(int my_fd) {
+	close();
+	fd = my_fd;
+	owns_fd = false;
+	failed = false;
+	nof_changes = 0;
+	start();
+}
+
+void amiq_rm_vcd_writer::set_time(uint64_t my_time) {
+	assert(my_time >= time);
+	if (my_time != time) {
+		time = my_time;
+		time_pending = true;
+	}
+}
+
+bool amiq_rm_vcd_writer::flush() {
+	int unsigned written = 0;
+	while ((written < used) && !failed) {
+		ssize_t result = (fd < 0) ? -1 : ::write(fd, &buffer[written], used - written);
+		if (result <= 0)
+			failed = true;
+		else
+			written += result;
+	}
+	used = 0;
+	return !failed;
+}
+
+bool amiq_rm_vcd_writer::close() {
+	for (int unsigned i = 0; i < probes.size(); i++) {
+		probes[i]->reg->remove_observer(probes[i]);
+		delete probes[i];
+	}
+	probes.clear();
+	traced_regs.clear();
+
+	if (fd < 0)
+		return !failed;
+
+	flush();
+	if (owns_fd && (::close(fd) != 0))
+		failed = true;
+	fd = -1;
+	owns_fd = false;
+	return !failed;
+}
+
+long long unsigned amiq_rm_vcd_writer::get_nof_changes() {
+	return nof_changes;
+}
+
+void amiq_rm_vcd_writer::put(const string &text) {
+	for (int unsigned i = 0; i < text.size(); i++)
+		put(text[i]);
+}
+
+void amiq_rm_vcd_writer::put_dec(uint64_t number) {
+	char digits[20];
+	int unsigned position = sizeof(digits);
+	do {
+		digits[--position] = '0' + (number % 10);
+		number /= 10;
+	} while (number != 0);
+	while (position < sizeof(digits))
+		put(digits[position++]);
+}
+
+void amiq_rm_vcd_writer::put_change(amiq_rm_reg_data_t value, const string &code) {
+	put('b');
+	int bit = 8 * sizeof(amiq_rm_reg_data_t) - 1;
+	while ((bit > 0) && (((value >> bit) & 1) == 0))
+		bit--;
+	for (; bit >= 0; bit--)
+		put(((value >> bit) & 1) ? '1' : '0');
+	put(' ');
+	put(code);
+	put('\n');
+}
+
+string amiq_rm_vcd_writer::new_code() {
+	string code;
+	int unsigned number = nof_codes++;
+	do {
+		code += (char) (amiq_rm_vcd_first_code + number % amiq_rm_vcd_nof_code_chars);
+		number /= amiq_rm_vcd_nof_code_chars;
+	} while (number != 0);
+	return code;
+}
+
+void amiq_rm_vcd_writer::start() {
+	nof_codes = 0;
+	time_pending = false;
+	put("$timescale " + timescale + " $end\n");
+	for (int unsigned i = 0; i < maps.size(); i++)
+		write_scope(*maps[i]);
+	put("$enddefinitions $end\n#");
+	put_dec(time);
+	put("\n$dumpvars\n");
+
+	for (int unsigned i = 0; i < probes.size(); i++) {
+		amiq_rm_reg &reg = *(probes[i]->reg);
+		put_change(reg.value, probes[i]->code);
+		for (int unsigned j = 0; j < reg.fields.size(); j++)
+			put_change(reg.get_access_data_for_field(reg.fields[j]->name, reg.value), probes[i]->field_codes[j]);
+		reg.add_observer(probes[i]);
+	}
+	put("$end\n");
+}
+
+void amiq_rm_vcd_writer::write_scope(amiq_rm_address_map &map) {
+	put("$scope module " + map.name + " $end\n");
+	for (amiq_rm_address_map::amiq_rm_reg_map_t::iterator it = map.regs.begin(); it != map.regs.end(); it++) {
+		amiq_rm_reg *reg = it->second;
+		if (!traced_regs.insert(reg).second)
+			continue;
+
+		amiq_rm_vcd_probe *probe = new amiq_rm_vcd_probe();
+		probe->writer = this;
+		probe->reg = reg;
+		probe->code = new_code();
+		put("$scope module " + reg->name + " $end\n$var wire ");
+		put_dec((reg->get_size() > 0) ? reg->get_size() : 1);
+		put(" " + probe->code + " value $end\n");
+		for (int unsigned i = 0; i < reg->fields.size(); i++) {
+			probe->field_codes.push_back(new_code());
+			put("$var wire ");
+			put_dec(reg->fields[i]->size);
+			put(" " + probe->field_codes[i] + " " + reg->fields[i]->name + " $end\n");
+		}
+		put("$upscope $end\n");
+		probes.push_back(probe);
+	}
+
+	for (amiq_rm_address_map::amiq_rm_addressmap_map_t::iterator it = map.submaps.begin(); it != map.submaps.end(); it++) {
+		write_scope(*(it->second));
+	}
+	put("$upscope $end\n");
+}
+
+void amiq_rm_vcd_writer::amiq_rm_vcd_probe::value_changed(amiq_rm_reg &my_reg, amiq_rm_reg_data_t old_value) {
+	writer->record(*this, old_value);
+}
+
+void amiq_rm_vcd_writer::record(amiq_rm_vcd_probe &probe, amiq_rm_reg_data_t old_value) {
+	amiq_rm_reg &reg = *(probe.reg);
+	if (time_pending) {
+		put('#');
+		put_dec(time);
+		put('\n');
+		time_pending = false;
+	}
+
+	put_change(reg.value, probe.code);
+	for (int unsigned i = 0; i < reg.fields.size(); i++) {
+		amiq_rm_field *field = reg.fields[i];
+		amiq_rm_reg_data_t field_mask = field->get_value_mask();
+		amiq_rm_reg_data_t field_value = (reg.value >> field->lsb_position) & field_mask;
+		if (field_value != ((old_value >> field->lsb_position) & field_mask))
+			put_change(field_value, probe.field_codes[i]);
+	}
+	nof_changes++;
+}
+
+}
+
+#endif
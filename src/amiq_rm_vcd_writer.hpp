@@ -0,0 +1,179 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_vcd_writer.hpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef AMIQ_RM_VCD_WRITER_HEADER
+#define AMIQ_RM_VCD_WRITER_HEADER 1
+
+#include "amiq_rm_types.cpp"
+#include "amiq_rm_observer.hpp"
+#include <string>
+#include <vector>
+#include <set>
+#include <stdint.h>
+
+namespace amiq_rm {
+
+class amiq_rm_address_map;
+class amiq_rm_reg;
+
+/** This class records the changes of the values of registers and fields in a Value Change Dump (VCD) file, which can be opened
+ * with waveform viewers (e.g. GTKWave) or converted to FST (e.g. with vcd2fst).
+ * @n Only the registers of the sub-trees selected with add_map() are traced, the other registers are not slowed down. Each map is a
+ * scope, each register is a scope with a "value" variable and one variable for each field. A register found under several maps is
+ * traced once, under the first path. The elements of the register arrays and of the map arrays are not traced.
+ * @n When the output is opened, the writer attaches an observer (amiq_rm_reg_observer) to each traced register and dumps the current
+ * values; then each change (write, set, reset, side effects) is formatted in a buffer which is allocated once and is written to
+ * the file only when it is full. The time of the changes is given with set_time(). */
+class amiq_rm_vcd_writer {
+public:
+	/** The default size of the buffer. */
+	static const int unsigned AMIQ_RM_VCD_BUFFER_SIZE = 1 << 20;
+
+	/** The time unit written in the header of the file. */
+	std::string timescale;
+
+	/** Create new writer, the output is selected with open() or attach().
+	 * @param buffer_size is the size of the buffer, at least 64 bytes */
+	amiq_rm_vcd_writer(int unsigned buffer_size);
+
+	/** Flush the buffer, close the file and detach the observers. */
+	virtual ~amiq_rm_vcd_writer();
+
+	/** The function selects a sub-tree whose registers are traced. It must be called before the output is opened.
+	 * @param map is the address map whose registers and sub-maps are traced */
+	void add_map(amiq_rm_address_map &map);
+
+	/** The function creates (or truncates) the output file and writes the header and the current values. A previous output is closed.
+	 * @param file_name is the name of the file
+	 * @returns false if the file could not be created */
+	bool open(std::string file_name);
+
+	/** The function selects an already open file descriptor as output and writes the header and the current values.
+	 * The descriptor is not closed by close(). A previous output is closed.
+	 * @param my_fd is the file descriptor */
+	void attach(int my_fd);
+
+	/** The function sets the time of the changes which follow.
+	 * @param time is the time, in units of @b timescale; it must not be lower than the previous time */
+	void set_time(uint64_t time);
+
+	/** The function writes the content of the buffer to the output.
+	 * @returns false if a write to the output failed since the output was opened */
+	bool flush();
+
+	/** The function detaches the observers, flushes the buffer and closes the output.
+	 * @returns false if a write to the output failed since the output was opened */
+	bool close();
+
+	/** @returns the number of register changes recorded since the output was opened. */
+	long long unsigned get_nof_changes();
+
+private:
+	/** The observer of a traced register. */
+	class amiq_rm_vcd_probe: public amiq_rm_reg_observer {
+	public:
+		/** The writer which records the changes. */
+		amiq_rm_vcd_writer *writer;
+
+		/** The traced register. */
+		amiq_rm_reg *reg;
+
+		/** The identifier of the "value" variable. */
+		std::string code;
+
+		/** The identifiers of the variables of the fields, in the order of amiq_rm_reg::fields. */
+		std::vector<std::string> field_codes;
+
+		/** Record the change. */
+		virtual void value_changed(amiq_rm_reg &my_reg, amiq_rm_reg_data_t old_value);
+	};
+
+	/** The maps selected with add_map(). */
+	std::vector<amiq_rm_address_map*> maps;
+
+	/** The probes of the traced registers, they exist while the output is open. */
+	std::vector<amiq_rm_vcd_probe*> probes;
+
+	/** The traced registers, used to trace a register only once. */
+	std::set<amiq_rm_reg*> traced_regs;
+
+	/** The buffer in which the output is formatted. */
+	std::vector<char> buffer;
+
+	/** The number of bytes of the buffer which are not written to the output yet. */
+	int unsigned used;
+
+	/** The output file descriptor, -1 if there is no output. */
+	int fd;
+
+	/** Set if the file descriptor was opened by open() (and must be closed by close()). */
+	bool owns_fd;
+
+	/** Set if a write to the output failed. */
+	bool failed;
+
+	/** The time of the changes. */
+	uint64_t time;
+
+	/** Set if the time was changed and it was not written yet (it is written before the next change). */
+	bool time_pending;
+
+	/** The number of changes recorded since the output was opened. */
+	long long unsigned nof_changes;
+
+	/** The number of identifiers given to the variables. */
+	int unsigned nof_codes;
+
+	/** The function appends a character to the buffer. */
+	void put(char c) {
+		if (used == buffer.size())
+			flush();
+		buffer[used++] = c;
+	}
+
+	/** The function appends a string to the buffer. */
+	void put(const std::string &text);
+
+	/** The function appends a number in decimal format. */
+	void put_dec(uint64_t number);
+
+	/** The function appends a value change: 'b', the bits of the value without the leading zeros, ' ' and the identifier.
+	 * @param value is the value of the variable
+	 * @param code is the identifier of the variable */
+	void put_change(amiq_rm_reg_data_t value, const std::string &code);
+
+	/** @returns a new identifier for a variable. */
+	std::string new_code();
+
+	/** The function writes the header, creates the probes and dumps the current values. */
+	void start();
+
+	/** The function writes the scope of a map and of its sub-maps and creates the probes of the registers.
+	 * @param map is the map which is written */
+	void write_scope(amiq_rm_address_map &map);
+
+	/** The function records a change of a traced register.
+	 * @param probe is the probe of the register
+	 * @param old_value is the value before the change */
+	void record(amiq_rm_vcd_probe &probe, amiq_rm_reg_data_t old_value);
+};
+
+}
+
+#endif
@@ -0,0 +1,49 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_test.hpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#ifndef AMIQ_RM_TEST_HEADER
+#define AMIQ_RM_TEST_HEADER 1
+
+#include <iostream>
+
+/** Number of failed checks of the current unit test program. */
+static int unsigned amiq_rm_test_nof_failures = 0;
+
+/** Check a condition of a unit test. A failing check is reported with its location and the test continues,
+ * so that one run reports all the failures. Unlike assert(), the check is never compiled out. */
+#define AMIQ_RM_CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #condition << std::endl; \
+			amiq_rm_test_nof_failures++; \
+		} \
+	} while (0)
+
+/** Report the result of a unit test program. To be returned from main().
+ * @param test_name is the name printed in the report
+ * @returns 0 if all checks passed, 1 otherwise */
+static inline int amiq_rm_test_result(const char *test_name) {
+	if (amiq_rm_test_nof_failures == 0)
+		std::cout << test_name << ": PASSED" << std::endl;
+	else
+		std::cout << test_name << ": FAILED (" << amiq_rm_test_nof_failures << " checks)" << std::endl;
+	return (amiq_rm_test_nof_failures == 0) ? 0 : 1;
+}
+
+#endif
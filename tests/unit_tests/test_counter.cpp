@@ -0,0 +1,210 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        test_counter.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+
+#include "amiq_rm.h"
+#include "amiq_rm_test.hpp"
+
+using namespace std;
+using namespace amiq_rm;
+
+/** A register with one counter field, owned by the test. */
+struct counter_reg {
+	amiq_rm_reg reg;
+	amiq_rm_counter counter;
+
+	/** @param time is the time source
+	 * @param size is the number of bits of the "count" field
+	 * @param reset_value is the reset value of the field
+	 * @param attrib is the attribute of the field
+	 * @param period is the period of the counter */
+	counter_reg(amiq_rm_time_source &time, int unsigned size, amiq_rm_reg_data_t reset_value, string attrib, uint64_t period) :
+			reg("reg"), counter(time, add_count(reg, size, reset_value, attrib), "count", period) {
+	}
+
+	/** The function adds the counter field, before the counter is created.
+	 * @returns the register */
+	static amiq_rm_reg& add_count(amiq_rm_reg &reg, int unsigned size, amiq_rm_reg_data_t reset_value, string attrib) {
+		reg.add_field(new amiq_rm_field("count", reset_value, size, attrib));
+		return reg;
+	}
+
+	/** @returns the value of the counter at time @b at */
+	amiq_rm_reg_data_t at(amiq_rm_time_source &time, uint64_t at_time) {
+		time.set_time(at_time);
+		return reg.get_field_value("count");
+	}
+};
+
+/** The time source starts a new provider epoch on each change of the time. */
+static void check_time_source() {
+	amiq_rm_time_source time;
+	AMIQ_RM_CHECK(time.get_time() == 0);
+	uint64_t epoch = amiq_rm_value_provider::get_epoch();
+	time.set_time(10);
+	AMIQ_RM_CHECK((time.get_time() == 10) && (amiq_rm_value_provider::get_epoch() == epoch + 1));
+	time.set_time(10);
+	AMIQ_RM_CHECK(amiq_rm_value_provider::get_epoch() == epoch + 1);
+	time.advance(5);
+	AMIQ_RM_CHECK((time.get_time() == 15) && (amiq_rm_value_provider::get_epoch() == epoch + 2));
+}
+
+/** The three modes, counting up and down. */
+static void check_modes() {
+	//wrap around, up and down, with a step
+	amiq_rm_time_source time;
+	counter_reg up(time, 4, 0xE, "RO", 10);
+	up.reg.build();
+	up.reg.reset();
+	AMIQ_RM_CHECK(up.at(time, 0) == 0xE);
+	AMIQ_RM_CHECK(up.at(time, 9) == 0xE);
+	AMIQ_RM_CHECK(up.at(time, 10) == 0xF);
+	AMIQ_RM_CHECK(up.at(time, 20) == 0x0);
+	AMIQ_RM_CHECK(up.at(time, 35) == 0x1);
+
+	amiq_rm_time_source down_time;
+	counter_reg down(down_time, 4, 0x1, "RO", 1);
+	down.counter.count_down = true;
+	down.counter.step = 3;
+	down.reg.build();
+	down.reg.reset();
+	AMIQ_RM_CHECK(down.at(down_time, 1) == 0xE);
+	AMIQ_RM_CHECK(down.at(down_time, 2) == 0xB);
+	AMIQ_RM_CHECK(down.at(down_time, 16) == 0x1);
+
+	//saturate at the maximum value and at 0
+	amiq_rm_time_source saturate_time;
+	counter_reg saturate_up(saturate_time, 4, 0xD, "RO", 1);
+	saturate_up.counter.mode = AMIQ_RM_COUNTER_SATURATE;
+	saturate_up.reg.build();
+	saturate_up.reg.reset();
+	counter_reg saturate_down(saturate_time, 4, 0x2, "RO", 1);
+	saturate_down.counter.mode = AMIQ_RM_COUNTER_SATURATE;
+	saturate_down.counter.count_down = true;
+	saturate_down.reg.build();
+	saturate_down.reg.reset();
+	AMIQ_RM_CHECK(saturate_up.at(saturate_time, 1) == 0xE);
+	AMIQ_RM_CHECK(saturate_down.reg.get() == 0x1);
+	AMIQ_RM_CHECK(saturate_up.at(saturate_time, 2) == 0xF);
+	AMIQ_RM_CHECK(saturate_down.reg.get() == 0x0);
+	AMIQ_RM_CHECK(saturate_up.at(saturate_time, 1000) == 0xF);
+	AMIQ_RM_CHECK(saturate_down.reg.get() == 0x0);
+
+	//reload: after passing the limit the counter restarts from the value loaded in the field
+	amiq_rm_time_source reload_time;
+	counter_reg timer(reload_time, 4, 0x0, "RW", 1);
+	timer.counter.mode = AMIQ_RM_COUNTER_RELOAD;
+	timer.counter.count_down = true;
+	timer.reg.build();
+	timer.reg.reset();
+	AMIQ_RM_CHECK(timer.reg.write(0x3) == OKAY);
+	amiq_rm_reg_data_t expected_timer[] = { 0x3, 0x2, 0x1, 0x0, 0x3, 0x2, 0x1, 0x0, 0x3 };
+	for (int unsigned i = 0; i < sizeof(expected_timer) / sizeof(expected_timer[0]); i++)
+		AMIQ_RM_CHECK(timer.at(reload_time, i) == expected_timer[i]);
+
+	amiq_rm_time_source reload_up_time;
+	counter_reg reload_up(reload_up_time, 4, 0xC, "RO", 1);
+	reload_up.counter.mode = AMIQ_RM_COUNTER_RELOAD;
+	reload_up.reg.build();
+	reload_up.reg.reset();
+	amiq_rm_reg_data_t expected_up[] = { 0xC, 0xD, 0xE, 0xF, 0xC, 0xD };
+	for (int unsigned i = 0; i < sizeof(expected_up) / sizeof(expected_up[0]); i++)
+		AMIQ_RM_CHECK(reload_up.at(reload_up_time, i) == expected_up[i]);
+	AMIQ_RM_CHECK(reload_up.at(reload_up_time, 4000 + 3) == 0xF);
+}
+
+/** The counter stops while its enable field is 0 and keeps the progress within the current period. */
+static void check_enable() {
+	amiq_rm_time_source time;
+	counter_reg enabled(time, 8, 0x0, "RO", 10);
+	enabled.reg.add_field(new amiq_rm_field("enable", 0x1, 1, "RW"));
+	enabled.counter.set_enable("enable");
+	enabled.reg.build();
+	enabled.reg.reset();
+
+	AMIQ_RM_CHECK(enabled.at(time, 25) == 2);
+	AMIQ_RM_CHECK(enabled.reg.write(0x000) == OKAY);
+	AMIQ_RM_CHECK(enabled.at(time, 100) == 2);
+	AMIQ_RM_CHECK(enabled.reg.write(0x100) == OKAY);
+	//5 time units of the period were spent before the counter was disabled
+	AMIQ_RM_CHECK(enabled.at(time, 104) == 2);
+	AMIQ_RM_CHECK(enabled.at(time, 105) == 3);
+	AMIQ_RM_CHECK(enabled.at(time, 125) == 5);
+
+	//a counter whose enable field is 0 after reset does not count
+	amiq_rm_time_source disabled_time;
+	counter_reg disabled(disabled_time, 8, 0x7, "RO", 1);
+	disabled.reg.add_field(new amiq_rm_field("enable", 0x0, 1, "RW"));
+	disabled.counter.set_enable("enable");
+	disabled.reg.build();
+	disabled.reg.reset();
+	AMIQ_RM_CHECK(disabled.at(disabled_time, 50) == 0x7);
+	AMIQ_RM_CHECK(disabled.reg.write(0x100) == OKAY);
+	AMIQ_RM_CHECK(disabled.at(disabled_time, 53) == 0xA);
+}
+
+/** A write, a set() or a reset() of the field loads the counter at the current time. */
+static void check_load() {
+	amiq_rm_time_source time;
+	counter_reg loaded(time, 8, 0x0, "RW", 10);
+	loaded.reg.build();
+	loaded.reg.reset();
+
+	AMIQ_RM_CHECK(loaded.at(time, 30) == 0x3);
+	AMIQ_RM_CHECK(loaded.reg.write(0x50) == OKAY);
+	AMIQ_RM_CHECK(loaded.reg.read().first == 0x50);
+	AMIQ_RM_CHECK(loaded.at(time, 39) == 0x50);
+	AMIQ_RM_CHECK(loaded.at(time, 40) == 0x51);
+	loaded.reg.set(0x10);
+	AMIQ_RM_CHECK(loaded.at(time, 55) == 0x11);
+	loaded.reg.reset();
+	AMIQ_RM_CHECK(loaded.reg.get() == 0x0);
+	AMIQ_RM_CHECK(loaded.at(time, 75) == 0x2);
+}
+
+/** A field as wide as the register data. */
+static void check_wide_field() {
+	amiq_rm_time_source time;
+	counter_reg wide(time, 32, 0xFFFFFFFE, "RO", 1);
+	wide.reg.build();
+	wide.reg.reset();
+	AMIQ_RM_CHECK(wide.at(time, 1) == 0xFFFFFFFF);
+	AMIQ_RM_CHECK(wide.at(time, 2) == 0x0);
+	AMIQ_RM_CHECK(wide.at(time, 3) == 0x1);
+	AMIQ_RM_CHECK(wide.at(time, (1ULL << 40) + 5) == 0x3);
+
+	amiq_rm_time_source saturate_time;
+	counter_reg saturate(saturate_time, 32, 0x0, "RO", 1);
+	saturate.counter.mode = AMIQ_RM_COUNTER_SATURATE;
+	saturate.counter.step = 0x80000000;
+	saturate.reg.build();
+	saturate.reg.reset();
+	AMIQ_RM_CHECK(saturate.at(saturate_time, 1) == 0x80000000);
+	AMIQ_RM_CHECK(saturate.at(saturate_time, 2) == 0xFFFFFFFF);
+	AMIQ_RM_CHECK(saturate.at(saturate_time, 1ULL << 62) == 0xFFFFFFFF);
+}
+
+int main() {
+	check_time_source();
+	check_modes();
+	check_enable();
+	check_load();
+	check_wide_field();
+	return amiq_rm_test_result("test_counter");
+}
@@ -0,0 +1,114 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        test_coverage.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#include "amiq_rm.h"
+#include "amiq_rm_test.hpp"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+using namespace std;
+using namespace amiq_rm;
+
+/** File used by the test. */
+static const char *FILE_NAME = "/tmp/amiq_rm_test_coverage.cov";
+
+/** The function writes a coverage file with one record.
+ * @param header is the header of the record (size of the name, size of the field, number of words)
+ * @param name is the name of the field
+ * @param nof_words is the number of words which are actually written */
+static void write_file(uint32_t header[3], const char *name, int unsigned nof_words) {
+	FILE *file = fopen(FILE_NAME, "wb");
+	uint32_t nof_fields = 1;
+	vector<uint64_t> words(nof_words + 1, 1);
+	fwrite("AMIQRMCV", 8, 1, file);
+	fwrite(&nof_fields, sizeof(nof_fields), 1, file);
+	fwrite(header, sizeof(uint32_t), 3, file);
+	fwrite(name, strlen(name), 1, file);
+	fwrite(&words[0], sizeof(uint64_t), nof_words, file);
+	fclose(file);
+}
+
+int main() {
+	//two blocks with registers of the same name
+	amiq_rm_address_map top("top");
+	amiq_rm_address_map block0("block0");
+	amiq_rm_address_map block1("block1");
+	amiq_rm_reg ctrl0("ctrl");
+	amiq_rm_reg ctrl1("ctrl");
+	ctrl0.add_field(new amiq_rm_field("enable", 0, 1, "RW"));
+	ctrl1.add_field(new amiq_rm_field("enable", 0, 1, "RW"));
+	block0.add_reg(ctrl0, 0x0);
+	block1.add_reg(ctrl1, 0x0);
+	top.add_map(block0, 0x0);
+	top.add_map(block1, 0x100);
+	top.build();
+
+	amiq_rm_coverage coverage;
+	int unsigned index0 = coverage.add_reg(ctrl0, amiq_rm_coverage::get_path(ctrl0.parent_maps, ctrl0.name));
+	int unsigned index1 = coverage.add_reg(ctrl1, amiq_rm_coverage::get_path(ctrl1.parent_maps, ctrl1.name));
+	AMIQ_RM_CHECK(coverage.fields.size() == 2);
+	AMIQ_RM_CHECK(coverage.fields[0].name == "top.block0.ctrl.enable");
+	AMIQ_RM_CHECK(coverage.fields[1].name == "top.block1.ctrl.enable");
+
+	coverage.sample(index0, WRITE, 1, 1);
+	coverage.sample(index1, READ, 0, 0);
+	AMIQ_RM_CHECK(coverage.save(FILE_NAME));
+
+	//the records of the two blocks are merged separately
+	amiq_rm_coverage merged;
+	AMIQ_RM_CHECK(merged.load(FILE_NAME));
+	AMIQ_RM_CHECK(merged.load(FILE_NAME));
+	AMIQ_RM_CHECK(merged.fields.size() == 2);
+	AMIQ_RM_CHECK(merged.pool[merged.fields[0].offset + amiq_rm_coverage::AMIQ_RM_COVERAGE_WRITES] == 2);
+	AMIQ_RM_CHECK(merged.pool[merged.fields[1].offset + amiq_rm_coverage::AMIQ_RM_COVERAGE_READS] == 2);
+
+	coverage.rename_reg(index1, "top.block2.ctrl");
+	AMIQ_RM_CHECK(coverage.fields[1].name == "top.block2.ctrl.enable");
+
+	//records with invalid headers are rejected before anything is allocated
+	uint32_t no_words[3] = { 5, 1, 0 };
+	write_file(no_words, "a.bcd", 0);
+	AMIQ_RM_CHECK(!merged.load(FILE_NAME));
+
+	uint32_t huge_words[3] = { 5, 32, 0xFFFFFFFF };
+	write_file(huge_words, "a.bcd", 4);
+	AMIQ_RM_CHECK(!merged.load(FILE_NAME));
+
+	uint32_t bad_size[3] = { 5, 0, 4 };
+	write_file(bad_size, "a.bcd", 4);
+	AMIQ_RM_CHECK(!merged.load(FILE_NAME));
+
+	uint32_t huge_name[3] = { 0xFFFFFFFF, 32, 4 };
+	write_file(huge_name, "a.bcd", 4);
+	AMIQ_RM_CHECK(!merged.load(FILE_NAME));
+
+	//a known field must keep its size
+	uint32_t other_size[3] = { 22, 32, 4 };
+	write_file(other_size, "top.block0.ctrl.enable", 4);
+	AMIQ_RM_CHECK(!merged.load(FILE_NAME));
+
+	uint32_t valid[3] = { 5, 32, 4 };
+	write_file(valid, "a.bcd", 4);
+	AMIQ_RM_CHECK(merged.load(FILE_NAME));
+	AMIQ_RM_CHECK(merged.fields.size() == 3);
+
+	remove(FILE_NAME);
+	return amiq_rm_test_result("test_coverage");
+}
@@ -0,0 +1,188 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        test_decoder.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#include "amiq_rm.h"
+#include "amiq_rm_test.hpp"
+#include <thread>
+#include <sstream>
+
+using namespace std;
+using namespace amiq_rm;
+
+/** A 32-bit read-write register. */
+class test_reg: public amiq_rm_reg {
+public:
+	test_reg(string my_name, amiq_rm_reg_data_t reset_value) :
+			amiq_rm_reg(my_name) {
+		add_field(new amiq_rm_field("value", reset_value, 32, "RW"));
+	}
+};
+
+/** The topology used by the tests: registers, a register array, a map array and a memory in a sub-map. */
+class test_topology {
+public:
+	amiq_rm_physical_address_map top;
+	amiq_rm_address_map sub;
+	amiq_rm_address_map instance;
+	test_reg reg0;
+	test_reg reg1;
+	test_reg sub_reg;
+	test_reg instance_reg;
+	amiq_rm_reg_array reg_array;
+	amiq_rm_map_array map_array;
+	amiq_rm_mem mem;
+
+	test_topology() :
+			top("top"), sub("sub"), instance("instance"), reg0("reg0", 0x10), reg1("reg1", 0x11), sub_reg("sub_reg", 0x20), instance_reg("instance_reg", 0x30),
+					reg_array("reg_array", new test_reg("element", 0x40), 8, 8), map_array("map_array", instance, 4, 0x10), mem("mem", 0x100) {
+		instance.add_reg(instance_reg, 0x4);
+		sub.add_reg(sub_reg, 0x0);
+		sub.add_mem(mem, 0x100);
+		top.add_reg(reg0, 0x0);
+		top.add_reg(reg1, 0x4);
+		top.add_reg_array(reg_array, 0x100);
+		top.add_map_array(map_array, 0x200);
+		top.add_map(sub, 0x1000);
+	}
+};
+
+/** Check the decoding of each kind of target, with the decoder built or not. */
+static void check_decode(amiq_rm_physical_address_map &top) {
+	amiq_rm_decode_target *target = top.decode(0x4);
+	AMIQ_RM_CHECK((target != NULL) && (target->kind == REG_TARGET) && (target->base == 0x4));
+
+	target = top.decode(0x118);
+	AMIQ_RM_CHECK((target != NULL) && (target->kind == REG_ARRAY_TARGET) && (target->base == 0x100));
+
+	target = top.decode(0x224);
+	AMIQ_RM_CHECK((target != NULL) && (target->kind == MAP_ARRAY_TARGET) && (target->base == 0x200));
+
+	target = top.decode(0x1180);
+	AMIQ_RM_CHECK((target != NULL) && (target->kind == MEM_TARGET) && (target->base == 0x1100));
+
+	AMIQ_RM_CHECK(top.decode(0x8) == NULL);
+	AMIQ_RM_CHECK(top.read(0x8).second == HOLE);
+
+	AMIQ_RM_CHECK(top.get(0x0) == 0x10);
+	AMIQ_RM_CHECK(top.get(0x1000) == 0x20);
+	AMIQ_RM_CHECK(top.get(0x118) == 0x40);
+	AMIQ_RM_CHECK(top.get(0x224) == 0x30);
+
+	top.set(0x118, 0x41);
+	AMIQ_RM_CHECK(top.decode(0x118)->reg_array->get(3) == 0x41);
+	top.set(0x224, 0x31);
+	AMIQ_RM_CHECK(top.read(0x224).first == 0x31);
+	AMIQ_RM_CHECK(top.write(0x1180, 0x12345678) == OKAY);
+	AMIQ_RM_CHECK(top.get(0x1180) == 0x12345678);
+}
+
+/** Check the target lookups against a linear search when a memory spans registers placed over it. */
+static void check_find_targets() {
+	amiq_rm_physical_address_map top("top");
+	amiq_rm_mem mem("mem", 0x100000);
+	vector<test_reg*> regs;
+	top.add_mem(mem, 0x0);
+	for (int unsigned i = 0; i < 256; i++) {
+		regs.push_back(new test_reg("reg", i));
+		top.add_reg(*regs.back(), ((i < 128) ? 0x1000 : 0x200000) + 0x10 * i);
+	}
+	top.build();
+
+	amiq_rm_radix_decoder &decoder = top.get_decoder();
+	AMIQ_RM_CHECK(decoder.get_nof_targets() == 257);
+	for (amiq_rm_reg_address_t address = 0; address < 0x202000; address += 0x44) {
+		vector<int unsigned> expected;
+		for (int unsigned i = 0; i < decoder.get_nof_targets(); i++) {
+			amiq_rm_decode_target *target = decoder.get_target(i);
+			if ((target->base <= address + 0x20) && (target->base + target->size - 1 >= address))
+				expected.push_back(i);
+		}
+		vector<int unsigned> positions;
+		decoder.find_targets(address, address + 0x20, positions);
+		AMIQ_RM_CHECK(positions == expected);
+
+		int unsigned first = 0;
+		while ((first < decoder.get_nof_targets()) && (decoder.get_target(first)->base + decoder.get_target(first)->size - 1 < address))
+			first++;
+		AMIQ_RM_CHECK(decoder.find_first_target(address) == first);
+	}
+
+	//a walk inside the memory starts at the registers placed over it, the memory is returned aside
+	vector<int unsigned> spanning;
+	int unsigned first = decoder.get_table()->find_first_target(0x1000 + 0x10 * 100, spanning);
+	AMIQ_RM_CHECK(decoder.get_target(first)->reg == regs[100]);
+	AMIQ_RM_CHECK((spanning.size() == 1) && (decoder.get_target(spanning[0])->kind == MEM_TARGET));
+	AMIQ_RM_CHECK(decoder.get_target(decoder.find_first_target(0x200000 + 0x10 * 200))->reg == regs[200]);
+
+	AMIQ_RM_CHECK(!decoder.is_range_free(0x80000, 0x80003, NULL));
+	AMIQ_RM_CHECK(decoder.is_range_free(0x180000, 0x180003, NULL));
+
+	int unsigned i = 100;
+	for (amiq_rm_reg_iterator it = top.get_regs_in_range(0x1000 + 0x10 * 100, 0x1000 + 0x10 * 110); !it.is_done(); it.next()) {
+		AMIQ_RM_CHECK((i < regs.size()) && (&it.get_reg() == regs[i]));
+		i++;
+	}
+	AMIQ_RM_CHECK(i == 110);
+
+	for (int unsigned i = 0; i < regs.size(); i++)
+		delete regs[i];
+}
+
+int main() {
+	check_find_targets();
+
+	test_topology topology;
+	amiq_rm_physical_address_map &top = topology.top;
+
+	//the recursive search is used as long as the decoder is not built
+	top.amiq_rm_address_map::build();
+	top.reset();
+	AMIQ_RM_CHECK(!top.get_decoder().is_built());
+	check_decode(top);
+
+	//each thread gets its own result from the recursive search
+	amiq_rm_decode_target *main_target = top.decode(0x0);
+	amiq_rm_decode_target *thread_target = NULL;
+	thread other([&]() {
+		thread_target = top.decode(0x118);
+	});
+	other.join();
+	AMIQ_RM_CHECK(main_target != thread_target);
+	AMIQ_RM_CHECK((main_target->kind == REG_TARGET) && (main_target->reg == &topology.reg0));
+
+	top.build();
+	top.reset();
+	AMIQ_RM_CHECK(top.get_decoder().is_built());
+	check_decode(top);
+
+	//an element added after build() is reported and decoded only after the next publication
+	ostringstream log;
+	amiq_rm_log::set_stream(log);
+	test_reg late_reg("late_reg", 0x50);
+	top.add_reg(late_reg, 0x8);
+	amiq_rm_log::set_stream(cout);
+	AMIQ_RM_CHECK(log.str().find("late_reg") != string::npos);
+	AMIQ_RM_CHECK(top.decode(0x8) == NULL);
+	late_reg.build();
+	late_reg.reset();
+	top.publish();
+	AMIQ_RM_CHECK(top.get(0x8) == 0x50);
+
+	return amiq_rm_test_result("test_decoder");
+}
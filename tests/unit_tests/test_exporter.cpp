@@ -0,0 +1,88 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        test_exporter.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#include "amiq_rm.h"
+#include "amiq_rm_test.hpp"
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+
+using namespace std;
+using namespace amiq_rm;
+
+/** File used by the test. */
+static const char *FILE_NAME = "/tmp/amiq_rm_test_exporter.csv";
+
+/** @returns the content of the exported file */
+static string read_file() {
+	ifstream file(FILE_NAME);
+	ostringstream content;
+	content << file.rdbuf();
+	return content.str();
+}
+
+int main() {
+	amiq_rm_physical_address_map top("top");
+	amiq_rm_address_map block("blk,0");
+	amiq_rm_reg plain("plain");
+	amiq_rm_reg quoted("say \"hi\"");
+	amiq_rm_mem mem("mem", 0x100);
+	plain.add_field(new amiq_rm_field("value", 0x1, 32, "RW"));
+	quoted.add_field(new amiq_rm_field("value", 0x2, 32, "RW"));
+	top.add_reg(plain, 0x0);
+	top.add_mem(mem, 0x100);
+	block.add_reg(quoted, 0x4);
+	top.add_map(block, 0x1000);
+	top.build();
+	top.reset();
+
+	amiq_rm_exporter exporter(CSV_FORMAT, 64);
+	AMIQ_RM_CHECK(exporter.open(FILE_NAME));
+	AMIQ_RM_CHECK(exporter.export_map(top));
+	AMIQ_RM_CHECK(exporter.close());
+
+	//the memory is not exported, the path with a comma and quotes is quoted
+	AMIQ_RM_CHECK(exporter.get_nof_records() == 2);
+	AMIQ_RM_CHECK(read_file() == "path,address,value\ntop.plain,0x0,0x1\n\"top.blk,0.say \"\"hi\"\"\",0x1004,0x2\n");
+
+	//JSON escapes the quotes
+	amiq_rm_exporter json_exporter(JSON_FORMAT, 64);
+	AMIQ_RM_CHECK(json_exporter.open(FILE_NAME));
+	AMIQ_RM_CHECK(json_exporter.export_map(block));
+	AMIQ_RM_CHECK(json_exporter.close());
+	AMIQ_RM_CHECK(read_file().find("\"path\":\"blk,0.say \\\"hi\\\"\"") != string::npos);
+
+	//JSON escapes the control characters, with the short form where there is one
+	amiq_rm_address_map control_block(string("ctl\n\t\r\b\f") + '\0' + "\x1f\\");
+	amiq_rm_reg control_reg("reg");
+	control_reg.add_field(new amiq_rm_field("value", 0x3, 32, "RW"));
+	control_block.add_reg(control_reg, 0x0);
+	control_block.build();
+	control_block.reset();
+	AMIQ_RM_CHECK(json_exporter.open(FILE_NAME));
+	AMIQ_RM_CHECK(json_exporter.export_map(control_block));
+	AMIQ_RM_CHECK(json_exporter.close());
+	string content = read_file();
+	AMIQ_RM_CHECK(content.find("\"path\":\"ctl\\n\\t\\r\\b\\f\\u0000\\u001f\\\\.reg\"") != string::npos);
+	for (int unsigned i = 0; i < content.size(); i++)
+		AMIQ_RM_CHECK((content[i] == '\n') || ((unsigned char) content[i] >= 0x20));
+
+	remove(FILE_NAME);
+	return amiq_rm_test_result("test_exporter");
+}
@@ -0,0 +1,156 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        test_frontdoor.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+
+#include "amiq_rm.h"
+#include "amiq_rm_test.hpp"
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace amiq_rm;
+
+/** Bus adapter whose transactions are completed by the test, with the status chosen by the test. */
+class manual_bus_adapter: public amiq_rm_bus_adapter {
+public:
+	vector<amiq_rm_bus_item*> items;
+	mutex items_mutex;
+
+	virtual void start(amiq_rm_frontdoor &frontdoor, amiq_rm_bus_item *item) {
+		lock_guard<mutex> lock(items_mutex);
+		items.push_back(item);
+	}
+
+	int unsigned get_nof_items() {
+		lock_guard<mutex> lock(items_mutex);
+		return items.size();
+	}
+
+	/** Complete the oldest transaction which was not completed yet. */
+	void complete(amiq_rm_frontdoor &frontdoor, amiq_rm_reg_data_t data, amiq_rm_status_t status) {
+		amiq_rm_bus_item *item;
+		{
+			lock_guard<mutex> lock(items_mutex);
+			item = items.front();
+			items.erase(items.begin());
+		}
+		if (item->direction == READ)
+			item->data = data;
+		item->status = status;
+		frontdoor.complete(item);
+	}
+};
+
+/** A map with a RW register at 0x0 and a clear on read register at 0x4. */
+class device_map {
+public:
+	amiq_rm_physical_address_map map;
+	amiq_rm_reg ctrl;
+	amiq_rm_reg status;
+
+	device_map(string name) : map(name), ctrl("ctrl"), status("status") {
+		ctrl.add_field(new amiq_rm_field("value", 0x0, 32, "RW"));
+		status.add_field(new amiq_rm_field("value", 0x0, 32, "RC"));
+		map.add_reg(ctrl, 0x0);
+		map.add_reg(status, 0x4);
+		map.build();
+		map.reset();
+	}
+};
+
+/** The function checks the limit of outstanding transactions, the prediction and the error status with a manual adapter. */
+static void check_manual_adapter() {
+	device_map model("model");
+	manual_bus_adapter adapter;
+	amiq_rm_frontdoor frontdoor(model.map, adapter, 2);
+
+	//the writes are predicted only when they complete successfully
+	future<pair<amiq_rm_reg_data_t, amiq_rm_status_t> > first = frontdoor.write(0x0, 0x11);
+	future<pair<amiq_rm_reg_data_t, amiq_rm_status_t> > second = frontdoor.write(0x0, 0x22);
+	AMIQ_RM_CHECK(frontdoor.get_nof_outstanding() == 2);
+	AMIQ_RM_CHECK(model.ctrl.get() == 0);
+
+	//a third transaction waits for a free slot
+	future<pair<amiq_rm_reg_data_t, amiq_rm_status_t> > third;
+	thread issuer([&]() { third = frontdoor.read(0x4); });
+	this_thread::sleep_for(chrono::milliseconds(20));
+	AMIQ_RM_CHECK(adapter.get_nof_items() == 2);
+
+	adapter.complete(frontdoor, 0, OKAY);
+	AMIQ_RM_CHECK(first.get() == make_pair((amiq_rm_reg_data_t) 0x11, OKAY));
+	AMIQ_RM_CHECK(model.ctrl.get() == 0x11);
+	issuer.join();
+	AMIQ_RM_CHECK(adapter.get_nof_items() == 2);
+	AMIQ_RM_CHECK(frontdoor.get_nof_outstanding() == 2);
+
+	adapter.complete(frontdoor, 0, ERROR);
+	AMIQ_RM_CHECK(second.get().second == ERROR);
+	AMIQ_RM_CHECK(model.ctrl.get() == 0x11);
+
+	//a read sets the model to the value seen on the bus, then applies the read side effects
+	model.status.set(0x5);
+	adapter.complete(frontdoor, 0x33, OKAY);
+	AMIQ_RM_CHECK(third.get() == make_pair((amiq_rm_reg_data_t) 0x33, OKAY));
+	AMIQ_RM_CHECK(model.status.get() == 0);
+	AMIQ_RM_CHECK(frontdoor.get_nof_outstanding() == 0);
+
+	//without prediction, the model is not changed
+	frontdoor.auto_predict = false;
+	future<pair<amiq_rm_reg_data_t, amiq_rm_status_t> > fourth = frontdoor.read(0x0);
+	adapter.complete(frontdoor, 0x44, OKAY);
+	AMIQ_RM_CHECK(fourth.get() == make_pair((amiq_rm_reg_data_t) 0x44, OKAY));
+	AMIQ_RM_CHECK(model.ctrl.get() == 0x11);
+}
+
+/** The function checks the ordering and the prediction with the worker thread of the local adapter. */
+static void check_local_adapter() {
+	device_map device("device");
+	device_map model("model");
+	amiq_rm_local_bus_adapter adapter(device.map, chrono::microseconds(200));
+	amiq_rm_frontdoor frontdoor(model.map, adapter, 4);
+
+	//the transactions complete in the order in which they were started, so each read returns the previous write
+	vector<future<pair<amiq_rm_reg_data_t, amiq_rm_status_t> > > reads;
+	for (int unsigned i = 1; i <= 16; i++) {
+		frontdoor.write(0x0, i);
+		reads.push_back(frontdoor.read(0x0));
+		AMIQ_RM_CHECK(frontdoor.get_nof_outstanding() <= 4);
+	}
+	frontdoor.wait_all();
+	for (int unsigned i = 0; i < reads.size(); i++)
+		AMIQ_RM_CHECK(reads[i].get() == make_pair((amiq_rm_reg_data_t) (i + 1), OKAY));
+	AMIQ_RM_CHECK(model.ctrl.get() == 16);
+
+	//the clear on read is applied by the device and by the prediction
+	device.status.set(0x7);
+	model.status.set(0x7);
+	AMIQ_RM_CHECK(frontdoor.read(0x4).get() == make_pair((amiq_rm_reg_data_t) 0x7, OKAY));
+	AMIQ_RM_CHECK((device.status.get() == 0) && (model.status.get() == 0));
+
+	//a hole of the device is reported and does not change the model
+	AMIQ_RM_CHECK(frontdoor.write(0x100, 0x1).get().second == HOLE);
+	frontdoor.wait_all();
+	AMIQ_RM_CHECK(frontdoor.get_nof_outstanding() == 0);
+}
+
+int main() {
+	check_manual_adapter();
+	check_local_adapter();
+	return amiq_rm_test_result("test_frontdoor");
+}
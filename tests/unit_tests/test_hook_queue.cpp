@@ -0,0 +1,112 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        test_hook_queue.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+
+#include "amiq_rm.h"
+#include "amiq_rm_test.hpp"
+
+using namespace std;
+using namespace amiq_rm;
+
+/** Register which records the calls of its deferred hook. */
+class recording_reg : public amiq_rm_reg {
+public:
+	vector<int unsigned> indexes;
+	vector<amiq_rm_reg_data_t> access_values;
+
+	recording_reg(string my_name) : amiq_rm_reg(my_name) {
+		add_field(new amiq_rm_field("value", 0x0, 32, "RW"));
+	}
+
+	virtual void deferred_access(amiq_rm_direction_t direction, amiq_rm_reg_data_t access_data, amiq_rm_reg_data_t access_value,
+			amiq_rm_reg_data_t lanes_mask, int unsigned index) {
+		indexes.push_back(index);
+		access_values.push_back(access_value);
+	}
+};
+
+int main() {
+	amiq_rm_hook_queue queue;
+
+	//a register array of 4 elements at 0x0 and a map array of 3 instances with two registers at 0x100
+	recording_reg *layout = new recording_reg("layout");
+	layout->set_hook_queue(&queue);
+	amiq_rm_reg_array elements("elements", layout, 4, 0x4);
+
+	amiq_rm_address_map instance("instance");
+	recording_reg status("status");
+	recording_reg ctrl("ctrl");
+	ctrl.set_hook_queue(&queue);
+	instance.add_reg(status, 0x0);
+	instance.add_reg(ctrl, 0x4);
+	amiq_rm_map_array channels("channels", instance, 3, 0x10);
+
+	recording_reg single("single");
+	single.set_hook_queue(&queue);
+
+	amiq_rm_physical_address_map top("top");
+	top.add_reg_array(elements, 0x0);
+	top.add_map_array(channels, 0x100);
+	top.add_reg(single, 0x200);
+	top.build();
+	top.reset();
+
+	//the queued calls keep the element which was accessed, not only the shared register
+	AMIQ_RM_CHECK(top.write(0x8, 0x12) == OKAY);
+	AMIQ_RM_CHECK(top.write(0x4, 0x11) == OKAY);
+	AMIQ_RM_CHECK(top.read(0x8).first == 0x12);
+	AMIQ_RM_CHECK(top.write(0x124, 0x24) == OKAY);
+	AMIQ_RM_CHECK(top.write(0x104, 0x4) == OKAY);
+	AMIQ_RM_CHECK(top.write(0x200, 0x1) == OKAY);
+	AMIQ_RM_CHECK(layout->indexes.empty() && ctrl.indexes.empty());
+	AMIQ_RM_CHECK(queue.get_nof_pending() == 6);
+	AMIQ_RM_CHECK(queue.flush() == 6);
+
+	AMIQ_RM_CHECK(layout->indexes.size() == 3);
+	AMIQ_RM_CHECK(layout->indexes[0] == 2 && layout->access_values[0] == 0x12);
+	AMIQ_RM_CHECK(layout->indexes[1] == 1 && layout->access_values[1] == 0x11);
+	AMIQ_RM_CHECK(layout->indexes[2] == 2 && layout->access_values[2] == 0x12);
+
+	//the index of a map array value is instance * get_nof_slots() + slot
+	AMIQ_RM_CHECK(ctrl.indexes.size() == 2);
+	AMIQ_RM_CHECK(ctrl.indexes[0] == channels.get_index(2, ctrl) && ctrl.access_values[0] == 0x24);
+	AMIQ_RM_CHECK(ctrl.indexes[1] == channels.get_index(0, ctrl) && ctrl.access_values[1] == 0x4);
+
+	AMIQ_RM_CHECK(single.indexes.size() == 1 && single.indexes[0] == 0);
+
+	//the index is cleared after the access and passed as well when the hook is called during the access
+	AMIQ_RM_CHECK(layout->element_index == 0 && ctrl.element_index == 0);
+	AMIQ_RM_CHECK(top.write(0x114, 0x14) == OKAY);
+	AMIQ_RM_CHECK(top.write(0x110, 0x10) == OKAY);
+	AMIQ_RM_CHECK(queue.flush() == 1);
+	AMIQ_RM_CHECK(ctrl.indexes.size() == 3 && ctrl.indexes[2] == channels.get_index(1, ctrl));
+	AMIQ_RM_CHECK(status.indexes.size() == 1 && status.indexes[0] == channels.get_index(1, status));
+
+	//the thread executes the calls in the order of the accesses
+	queue.start();
+	for (int unsigned i = 0; i < 4; i++)
+		AMIQ_RM_CHECK(elements.write(i, i) == OKAY);
+	queue.stop();
+	queue.flush();
+	AMIQ_RM_CHECK(layout->indexes.size() == 7);
+	for (int unsigned i = 0; i < 4; i++)
+		AMIQ_RM_CHECK(layout->indexes[3 + i] == i && layout->access_values[3 + i] == i);
+
+	return amiq_rm_test_result("test_hook_queue");
+}
@@ -0,0 +1,151 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        test_importer.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+
+#include "amiq_rm.h"
+#include "amiq_rm_test.hpp"
+#include <cstdio>
+#include <map>
+
+using namespace std;
+using namespace amiq_rm;
+
+static const char *FILE_NAME = "/tmp/amiq_rm_test_importer.dump";
+
+/** @returns a register with one RW field of 32 bits. */
+static amiq_rm_reg* new_reg(string name) {
+	amiq_rm_reg *reg = new amiq_rm_reg(name);
+	reg->add_field(new amiq_rm_field("value", 0x0, 32, "RW"));
+	return reg;
+}
+
+int main() {
+	//a memory with a register placed over it, a register array with gaps between the elements, two overlapping registers and a map array
+	amiq_rm_mem mem("mem", 0x100);
+	amiq_rm_reg over("over");
+	amiq_rm_reg ctrl("ctrl");
+	amiq_rm_reg high("high");
+	over.add_field(new amiq_rm_field("value", 0x0, 32, "RW"));
+	ctrl.add_field(new amiq_rm_field("value", 0x0, 32, "RW"));
+	high.add_field(new amiq_rm_field("value", 0x0, 32, "RW"));
+	amiq_rm_reg_array elements("elements", new_reg("layout"), 4, 0x8);
+	amiq_rm_address_map instance("instance");
+	amiq_rm_reg status("status");
+	amiq_rm_reg data("data");
+	status.add_field(new amiq_rm_field("value", 0x0, 32, "RW"));
+	data.add_field(new amiq_rm_field("value", 0x0, 32, "RW"));
+	instance.add_reg(status, 0x0);
+	instance.add_reg(data, 0x4);
+	amiq_rm_map_array channels("channels", instance, 2, 0x10);
+
+	amiq_rm_physical_address_map top("top");
+	top.add_mem(mem, 0x0);
+	top.add_reg(over, 0x40);
+	top.add_reg_array(elements, 0x200);
+	top.add_reg(ctrl, 0x300);
+	top.add_reg(high, 0x302);
+	top.add_map_array(channels, 0x400);
+	top.build();
+	top.reset();
+
+	//a text dump out of order, with repeated addresses, holes, addresses inside elements and bad lines
+	FILE *file = fopen(FILE_NAME, "w");
+	fprintf(file, "# dump\n0x300 0x11\n208: 22\n40=33\n0x300, 0x44\n\n180 1\n20c 2\nzz 3\n404 55\n10000 4\n301 6\n303 7\n");
+	fclose(file);
+	amiq_rm_importer importer(top);
+	AMIQ_RM_CHECK(importer.import_text(FILE_NAME));
+	AMIQ_RM_CHECK(importer.get_nof_records() == 5);
+	AMIQ_RM_CHECK((top.get(0x300) == 0x44) && (high.get() == 0));
+	AMIQ_RM_CHECK(elements.get(1) == 0x22);
+	AMIQ_RM_CHECK((over.get() == 0x33) && (mem.get(0x40) == 0));
+	AMIQ_RM_CHECK(top.get(0x404) == 0x55);
+	AMIQ_RM_CHECK((importer.holes.size() == 2) && (importer.holes[0] == 0x180) && (importer.holes[1] == 0x10000));
+	//the register with the higher address takes precedence where two registers overlap
+	AMIQ_RM_CHECK((importer.unknown_addresses.size() == 3) && (importer.unknown_addresses[0] == 0x20C));
+	AMIQ_RM_CHECK((importer.unknown_addresses[1] == 0x301) && (importer.unknown_addresses[2] == 0x303));
+	AMIQ_RM_CHECK((importer.bad_lines.size() == 1) && (importer.bad_lines[0] == 9));
+
+	//the walk of the targets decodes as decode(): random dumps with dense and sparse addresses
+	uint64_t seed = 1;
+	for (int unsigned round = 0; round < 20; round++) {
+		map<amiq_rm_reg_address_t, amiq_rm_reg_data_t> expected;
+		map<amiq_rm_reg_address_t, int unsigned> nof_lines_per_address;
+		file = fopen(FILE_NAME, "w");
+		int unsigned nof_lines = (round % 2 == 0) ? 400 : 5;
+		for (int unsigned i = 0; i < nof_lines; i++) {
+			seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+			amiq_rm_reg_address_t address = (seed >> 33) % 0x480;
+			amiq_rm_reg_data_t value = seed >> 40;
+			fprintf(file, "%llx %x\n", (long long unsigned) address, (int unsigned) value);
+			expected[address] = value;
+			nof_lines_per_address[address]++;
+		}
+		fclose(file);
+		AMIQ_RM_CHECK(importer.import_text(FILE_NAME));
+
+		vector<amiq_rm_reg_address_t> holes;
+		vector<amiq_rm_reg_address_t> unknown_addresses;
+		long long unsigned nof_records = 0;
+		for (map<amiq_rm_reg_address_t, amiq_rm_reg_data_t>::iterator it = expected.begin(); it != expected.end(); it++) {
+			amiq_rm_decode_target *target = top.decode(it->first);
+			int unsigned index;
+			if (target == NULL) {
+				holes.push_back(it->first);
+			} else if (!target->get_index(it->first, index)) {
+				unknown_addresses.push_back(it->first);
+			} else {
+				//the words of the memory overlap, so only the registers keep the value of their last line
+				if (target->kind != MEM_TARGET)
+					AMIQ_RM_CHECK(target->get(it->first) == it->second);
+				nof_records += nof_lines_per_address[it->first];
+			}
+		}
+		AMIQ_RM_CHECK(importer.holes == holes);
+		AMIQ_RM_CHECK(importer.unknown_addresses == unknown_addresses);
+		AMIQ_RM_CHECK(importer.get_nof_records() == nof_records);
+	}
+
+	//an image reports the bytes which are not mapped
+	unsigned char image[0x40];
+	for (int unsigned i = 0; i < sizeof(image); i++)
+		image[i] = i;
+	file = fopen(FILE_NAME, "wb");
+	fwrite(image, 1, sizeof(image), file);
+	fclose(file);
+	AMIQ_RM_CHECK(importer.import_image(FILE_NAME, 0x2F0));
+	AMIQ_RM_CHECK((ctrl.get() == 0x13121110) && (high.get() == 0x15141312));
+	AMIQ_RM_CHECK(importer.get_nof_records() == 2);
+	AMIQ_RM_CHECK(importer.unmapped_ranges.size() == 2);
+	AMIQ_RM_CHECK((importer.unmapped_ranges[0].first == 0x2F0) && (importer.unmapped_ranges[0].second == 0x2FF));
+	AMIQ_RM_CHECK((importer.unmapped_ranges[1].first == 0x306) && (importer.unmapped_ranges[1].second == 0x32F));
+
+	//an image inside a memory, ending after it
+	AMIQ_RM_CHECK(importer.import_image(FILE_NAME, 0xE0));
+	AMIQ_RM_CHECK(mem.get(0xE0) == 0x03020100);
+	AMIQ_RM_CHECK((importer.unmapped_ranges.size() == 1) && (importer.unmapped_ranges[0].first == 0x100)
+			&& (importer.unmapped_ranges[0].second == 0x11F));
+
+	//an image covered by the targets
+	AMIQ_RM_CHECK(importer.import_image(FILE_NAME, 0x20));
+	AMIQ_RM_CHECK(importer.unmapped_ranges.empty());
+	AMIQ_RM_CHECK(over.get() == 0x23222120);
+
+	remove(FILE_NAME);
+	return amiq_rm_test_result("test_importer");
+}
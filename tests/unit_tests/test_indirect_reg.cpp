@@ -0,0 +1,110 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        test_indirect_reg.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+
+#include "amiq_rm.h"
+#include "amiq_rm_test.hpp"
+
+using namespace std;
+using namespace amiq_rm;
+
+int main() {
+	//index register at 0x0: sel[3:0] RW (reset value 2), other[7:4] RW
+	amiq_rm_reg index_reg("index");
+	index_reg.add_field(new amiq_rm_field("sel", 0x2, 4, "RW"));
+	index_reg.add_field(new amiq_rm_field("other", 0x0, 4, "RW"));
+
+	//8 elements at 0x100: lo[7:0] RW, status[15:8] W1C, hi[31:16] RW; the data register at 0x4
+	amiq_rm_reg *layout = new amiq_rm_reg("entry");
+	layout->add_field(new amiq_rm_field("lo", 0x0, 8, "RW"));
+	layout->add_field(new amiq_rm_field("status", 0x0, 8, "W1C"));
+	layout->add_field(new amiq_rm_field("hi", 0x0, 16, "RW"));
+	amiq_rm_reg_array table("table", layout, 8, 4);
+	amiq_rm_indirect_reg data("data", table, index_reg, "sel");
+
+	amiq_rm_physical_address_map top("top");
+	top.add_reg(index_reg, 0x0);
+	top.add_reg(data, 0x4);
+	top.add_reg_array(table, 0x100);
+	top.build();
+	top.reset();
+
+	//the index starts with the reset value of the field
+	AMIQ_RM_CHECK(data.get_index() == 2);
+	AMIQ_RM_CHECK(top.write(0x4, 0x12340056) == OKAY);
+	AMIQ_RM_CHECK(table.get(2) == 0x12340056);
+	AMIQ_RM_CHECK(data.get() == 0x12340056);
+
+	//the accesses follow the index after a write of the index register
+	table.set(5, 0xABCD00EF);
+	AMIQ_RM_CHECK(top.write(0x0, 0x5) == OKAY);
+	AMIQ_RM_CHECK(data.get_index() == 5);
+	AMIQ_RM_CHECK(top.read(0x4) == make_pair((amiq_rm_reg_data_t) 0xABCD00EF, OKAY));
+	AMIQ_RM_CHECK(top.write(0x4, 0x00000077) == OKAY);
+	AMIQ_RM_CHECK(table.get(5) == 0x00000077);
+	AMIQ_RM_CHECK(table.get(2) == 0x12340056);
+	AMIQ_RM_CHECK(top.read(0x114).first == 0x77);
+
+	//and after a set(); the other fields of the index register do not move the index
+	index_reg.set(0x71);
+	AMIQ_RM_CHECK(data.get_index() == 1);
+	AMIQ_RM_CHECK(top.write(0x0, 0xF1) == OKAY);
+	AMIQ_RM_CHECK(data.get_index() == 1);
+	AMIQ_RM_CHECK(top.write(0x4, 0x11) == OKAY);
+	AMIQ_RM_CHECK(table.get(1) == 0x11);
+
+	//the side effects of the layout are applied to the element: W1C clears the written bits of status only
+	table.set(3, 0x0000FF00);
+	AMIQ_RM_CHECK(top.write(0x0, 0x3) == OKAY);
+	AMIQ_RM_CHECK(top.write(0x4, 0x00000F00) == OKAY);
+	AMIQ_RM_CHECK(table.get(3) == 0x0000F000);
+	AMIQ_RM_CHECK(data.get() == 0x0000F000);
+
+	//an index outside the array returns ERROR and does not change any element
+	vector<amiq_rm_reg_data_t> values = table.values;
+	AMIQ_RM_CHECK(top.write(0x0, 0x8) == OKAY);
+	AMIQ_RM_CHECK(data.get_index() == 8);
+	AMIQ_RM_CHECK(top.read(0x4).second == ERROR);
+	AMIQ_RM_CHECK(top.write(0x4, 0xFFFFFFFF) == ERROR);
+	AMIQ_RM_CHECK(top.write(0x0, 0xF) == OKAY);
+	AMIQ_RM_CHECK(top.read(0x4).second == ERROR);
+	AMIQ_RM_CHECK(table.values == values);
+	AMIQ_RM_CHECK(top.write(0x0, 0x7) == OKAY);
+	AMIQ_RM_CHECK(top.read(0x4) == make_pair((amiq_rm_reg_data_t) 0x0, OKAY));
+
+	//sub-word accesses are forwarded with their lanes: only the enabled bytes of the element are read or written
+	table.set(6, 0x44332211);
+	AMIQ_RM_CHECK(top.write(0x0, 0x6) == OKAY);
+	AMIQ_RM_CHECK(data.read(0x2) == make_pair((amiq_rm_reg_data_t) 0x00002200, OKAY));
+	AMIQ_RM_CHECK(data.read(0xC) == make_pair((amiq_rm_reg_data_t) 0x44330000, OKAY));
+	AMIQ_RM_CHECK(top.read(0x6, 2, 0x3) == make_pair((amiq_rm_reg_data_t) 0x4433, OKAY));
+	AMIQ_RM_CHECK(data.write(0xAABBCCDD, 0x1) == OKAY);
+	AMIQ_RM_CHECK(table.get(6) == 0x443322DD);
+	AMIQ_RM_CHECK(top.write(0x6, 0xEEFF, 2, 0x2) == OKAY);
+	AMIQ_RM_CHECK(table.get(6) == 0xEE3322DD);
+
+	//a W1C field is cleared only by the enabled lanes
+	table.set(6, 0x0000FF00);
+	AMIQ_RM_CHECK(data.write(0xFFFFFFFF, 0xD) == OKAY);
+	AMIQ_RM_CHECK(table.get(6) == 0xFFFFFFFF);
+	AMIQ_RM_CHECK(data.write(0xFFFFFFFF, 0x2) == OKAY);
+	AMIQ_RM_CHECK(table.get(6) == 0xFFFF00FF);
+
+	return amiq_rm_test_result("test_indirect_reg");
+}
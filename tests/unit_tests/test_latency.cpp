@@ -0,0 +1,84 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        test_latency.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+
+#include "amiq_rm.h"
+#include "amiq_rm_test.hpp"
+
+using namespace std;
+using namespace amiq_rm;
+
+int main() {
+	//instances of 0x10 bytes with two registers of different latencies, mapped at 0x1000, and a register at 0x0
+	amiq_rm_address_map instance("instance");
+	amiq_rm_reg status("status");
+	amiq_rm_reg ctrl("ctrl");
+	status.add_field(new amiq_rm_field("value", 0x5, 32, "RW"));
+	ctrl.add_field(new amiq_rm_field("value", 0x7, 32, "RW"));
+	status.set_latency(5, 7);
+	ctrl.set_latency(100, 200);
+	instance.add_reg(status, 0x0);
+	instance.add_reg(ctrl, 0x4);
+	amiq_rm_map_array channels("channels", instance, 2, 0x10);
+
+	amiq_rm_reg single("single");
+	single.add_field(new amiq_rm_field("value", 0x0, 32, "RW"));
+	single.set_latency(1000, 2000);
+
+	amiq_rm_physical_address_map top("top");
+	top.add_reg(single, 0x0);
+	top.add_map_array(channels, 0x1000);
+	top.build();
+	top.reset();
+	top.set_latency(10, 20, 0);
+
+	amiq_rm_quantum_keeper keeper(1000000);
+
+	//the elements of a map array have the latency of their register in the prototype
+	AMIQ_RM_CHECK(top.read(0x1014, keeper).first == 0x7);
+	AMIQ_RM_CHECK(keeper.get_local_time() == 110);
+	AMIQ_RM_CHECK(top.write(0x1010, 0x15, keeper) == OKAY);
+	AMIQ_RM_CHECK(keeper.get_local_time() == 110 + 27);
+	AMIQ_RM_CHECK(top.read(0x0, keeper).second == OKAY);
+	AMIQ_RM_CHECK(keeper.get_local_time() == 137 + 1010);
+	AMIQ_RM_CHECK(top.read(0x2000, keeper).second == HOLE);
+	AMIQ_RM_CHECK(keeper.get_local_time() == 1147 + 10);
+
+	//a sized access has the latency of the element of its first enabled byte
+	uint64_t start = keeper.get_local_time();
+	AMIQ_RM_CHECK(top.read(0x1010, 4, 0xF, keeper).first == 0x15);
+	AMIQ_RM_CHECK(keeper.get_local_time() == start + 15);
+	AMIQ_RM_CHECK(top.read(0x1012, 4, 0xC, keeper).first == (0x7 << 16));
+	AMIQ_RM_CHECK(keeper.get_local_time() == start + 15 + 110);
+	AMIQ_RM_CHECK(top.write(0x1002, 0xFFFFFFFF, 4, 0xF, keeper) == OKAY);
+	AMIQ_RM_CHECK(keeper.get_local_time() == start + 125 + 27);
+	AMIQ_RM_CHECK(top.read(0x1002, 4, 0x0, keeper).second == OKAY);
+	AMIQ_RM_CHECK(keeper.get_local_time() == start + 152 + 10);
+
+	//a compiled sequence has the same latencies as the accesses
+	amiq_rm_sequence sequence("sequence");
+	sequence.add_read("0x1014");
+	sequence.add_write("0x1000", 0x1);
+	AMIQ_RM_CHECK(sequence.compile(top));
+	start = keeper.get_local_time();
+	AMIQ_RM_CHECK(sequence.run(keeper));
+	AMIQ_RM_CHECK(keeper.get_local_time() == start + 110 + 27);
+
+	return amiq_rm_test_result("test_latency");
+}
@@ -0,0 +1,92 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        test_map_array.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#include "amiq_rm.h"
+#include "amiq_rm_test.hpp"
+
+using namespace std;
+using namespace amiq_rm;
+
+int main() {
+	//instances of 0x10 bytes with two registers, mapped at 0x1000
+	amiq_rm_address_map instance("instance");
+	amiq_rm_reg status("status");
+	amiq_rm_reg ctrl("ctrl");
+	status.add_field(new amiq_rm_field("value", 0x5, 32, "RW"));
+	ctrl.add_field(new amiq_rm_field("value", 0x7, 32, "RW"));
+	instance.add_reg(status, 0x0);
+	instance.add_reg(ctrl, 0x4);
+
+	amiq_rm_map_array channels("channels", instance, 2, 0x10);
+	channels.set_nof_banks(2);
+	channels.set_capacity(4);
+
+	amiq_rm_physical_address_map top("top");
+	top.add_map_array(channels, 0x1000);
+	top.build();
+	top.reset();
+
+	AMIQ_RM_CHECK(top.read(0x1014).first == 0x7);
+	AMIQ_RM_CHECK(top.write(0x1014, 0x11) == OKAY);
+	channels.get_bank_values(1)[0] = 0x22;
+
+	//a new build keeps the values of all banks
+	top.build();
+	AMIQ_RM_CHECK(top.read(0x1014).first == 0x11);
+	AMIQ_RM_CHECK(channels.get_bank_values(1)[0] == 0x22);
+	AMIQ_RM_CHECK(channels.get_bank_values(1).size() == 2 * channels.get_nof_slots());
+
+	//the reserved range is decoded, the instances which do not exist yet are holes
+	AMIQ_RM_CHECK(top.read(0x1020).second == HOLE);
+	AMIQ_RM_CHECK(top.get_size() == 0x1040);
+
+	//an instance added inside the capacity is decoded without building the map again
+	AMIQ_RM_CHECK(channels.add_instance() == 2);
+	AMIQ_RM_CHECK(top.read(0x1024).first == 0x7);
+	AMIQ_RM_CHECK(top.write(0x1020, 0x33) == OKAY);
+	AMIQ_RM_CHECK(channels.get(channels.get_index(2, status)) == 0x33);
+	AMIQ_RM_CHECK(channels.get_bank_values(1).size() == 3 * channels.get_nof_slots());
+
+	//beyond the capacity, the map must be built again, the values are kept
+	AMIQ_RM_CHECK(channels.add_instance() == 3);
+	AMIQ_RM_CHECK(channels.add_instance() == 4);
+	AMIQ_RM_CHECK(top.read(0x1040).second == HOLE);
+	top.build();
+	AMIQ_RM_CHECK(top.read(0x1040).first == 0x5);
+	AMIQ_RM_CHECK(top.read(0x1020).first == 0x33);
+	AMIQ_RM_CHECK(top.read(0x1014).first == 0x11);
+
+	//reset still sets all instances of all banks to the reset values
+	top.reset();
+	AMIQ_RM_CHECK(top.read(0x1014).first == 0x7);
+	AMIQ_RM_CHECK(channels.get_bank_values(1)[0] == 0x5);
+
+	//the bank is selected by wide fields, the bits above the field are ignored
+	amiq_rm_reg context("context");
+	context.add_field(new amiq_rm_field("value", 0x0, 31, "RW"));
+	context.add_field(new amiq_rm_field("lock", 0x0, 1, "RW"));
+	context.build();
+	channels.set_bank_selector(context, "value");
+	AMIQ_RM_CHECK(context.write(0x80000001) == OKAY);
+	AMIQ_RM_CHECK(channels.get_bank() == 1);
+	AMIQ_RM_CHECK(context.write(0x80000000) == OKAY);
+	AMIQ_RM_CHECK(channels.get_bank() == 0);
+
+	return amiq_rm_test_result("test_map_array");
+}
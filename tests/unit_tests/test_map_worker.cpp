@@ -0,0 +1,139 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        test_map_worker.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+
+#include "amiq_rm.h"
+#include "amiq_rm_test.hpp"
+#include <thread>
+
+using namespace std;
+using namespace amiq_rm;
+
+/** A 32-bit read-write register. */
+class test_reg: public amiq_rm_reg {
+public:
+	test_reg(string my_name) :
+			amiq_rm_reg(my_name) {
+		add_field(new amiq_rm_field("value", 0, 32, "RW"));
+	}
+};
+
+/** The number of registers of each shard. */
+static const int unsigned NOF_REGS = 16;
+
+/** The number of accesses of each producer. */
+static const int unsigned NOF_ACCESSES = 2000;
+
+/** A physical map with its own registers. */
+class test_shard {
+public:
+	amiq_rm_physical_address_map top;
+	amiq_rm_address_map sub;
+	test_reg *regs[NOF_REGS];
+
+	test_shard() :
+			top("top"), sub("sub") {
+		for (int unsigned i = 0; i < NOF_REGS; i++) {
+			regs[i] = new test_reg("reg");
+			sub.add_reg(*regs[i], 4 * i);
+		}
+		top.add_map(sub, 0x100);
+		top.build();
+		top.reset();
+	}
+
+	~test_shard() {
+		for (int unsigned i = 0; i < NOF_REGS; i++)
+			delete regs[i];
+	}
+};
+
+/** A producer which writes its own register and reads it back through the worker. */
+static void produce(amiq_rm_map_worker *worker, int unsigned reg_index, int unsigned *nof_errors) {
+	amiq_rm_reg_address_t address = 0x100 + 4 * reg_index;
+	for (int unsigned i = 0; i < NOF_ACCESSES; i++) {
+		pair<amiq_rm_reg_data_t, amiq_rm_status_t> data_with_status;
+		if (worker->write(address, i) != OKAY)
+			(*nof_errors)++;
+		data_with_status = worker->read(address);
+		if ((data_with_status.second != OKAY) || (data_with_status.first != i))
+			(*nof_errors)++;
+	}
+}
+
+/** Two workers drive two disjoint maps in parallel, each one with several producers. */
+static void check_parallel_shards() {
+	test_shard shards[2];
+	amiq_rm_map_worker worker0(shards[0].top);
+	amiq_rm_map_worker worker1(shards[1].top);
+	amiq_rm_map_worker *workers[2] = { &worker0, &worker1 };
+	AMIQ_RM_CHECK(worker0.is_disjoint() && worker1.is_disjoint());
+	worker0.start(amiq_rm_map_worker::AMIQ_RM_NO_CPU);
+	worker1.start(amiq_rm_map_worker::AMIQ_RM_NO_CPU);
+
+	vector<thread*> producers;
+	int unsigned nof_errors[8] = { 0 };
+	for (int unsigned i = 0; i < 8; i++)
+		producers.push_back(new thread(produce, workers[i % 2], i / 2, &nof_errors[i]));
+	for (int unsigned i = 0; i < producers.size(); i++) {
+		producers[i]->join();
+		AMIQ_RM_CHECK(nof_errors[i] == 0);
+		delete producers[i];
+	}
+	worker0.stop();
+	worker1.stop();
+	AMIQ_RM_CHECK(worker0.get_nof_requests() == 4 * 2 * NOF_ACCESSES);
+	AMIQ_RM_CHECK(shards[1].regs[3]->value == NOF_ACCESSES - 1);
+}
+
+/** The requests are rejected while the worker is stopped. */
+static void check_stopped() {
+	test_shard shard;
+	amiq_rm_map_worker worker(shard.top);
+	amiq_rm_access_request request(WRITE, 0x100, 1);
+	AMIQ_RM_CHECK(!worker.submit(&request));
+	AMIQ_RM_CHECK(worker.read(0x100).second == ERROR);
+
+	worker.start(amiq_rm_map_worker::AMIQ_RM_NO_CPU);
+	AMIQ_RM_CHECK(worker.submit(&request));
+	request.wait();
+	AMIQ_RM_CHECK((request.status == OKAY) && (worker.read(0x100).first == 1));
+	worker.stop();
+
+	AMIQ_RM_CHECK(!worker.submit(&request));
+	AMIQ_RM_CHECK(worker.write(0x100, 2) == ERROR);
+	AMIQ_RM_CHECK(shard.regs[0]->value == 1);
+}
+
+/** A sub-map shared by two physical maps is reported. */
+static void check_shared_map() {
+	test_shard shard;
+	amiq_rm_physical_address_map other("other");
+	other.add_map(shard.sub, 0x0);
+	other.build();
+	amiq_rm_map_worker worker(shard.top);
+	AMIQ_RM_CHECK(!worker.is_disjoint());
+}
+
+int main() {
+	check_parallel_shards();
+	check_stopped();
+	check_shared_map();
+	return amiq_rm_test_result("test_map_worker");
+}
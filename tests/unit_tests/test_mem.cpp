@@ -0,0 +1,66 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        test_mem.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#include "amiq_rm.h"
+#include "amiq_rm_test.hpp"
+#include <cstring>
+
+using namespace std;
+using namespace amiq_rm;
+
+int main() {
+	amiq_rm_mem mem("mem", 3 * amiq_rm_mem::AMIQ_RM_MEM_PAGE_SIZE);
+	AMIQ_RM_CHECK(mem.get_nof_allocated_pages() == 0);
+	AMIQ_RM_CHECK(mem.read(0x10).first == 0);
+
+	//word accesses are little-endian and allocate only the touched page
+	AMIQ_RM_CHECK(mem.write(0x10, 0x11223344) == OKAY);
+	AMIQ_RM_CHECK(mem.get(0x10) == 0x11223344);
+	AMIQ_RM_CHECK(mem.get(0x11) == 0x00112233);
+	AMIQ_RM_CHECK(mem.get_nof_allocated_pages() == 1);
+
+	//a word which crosses a page boundary
+	amiq_rm_reg_address_t boundary = amiq_rm_mem::AMIQ_RM_MEM_PAGE_SIZE - 2;
+	mem.set(boundary, 0xAABBCCDD);
+	AMIQ_RM_CHECK(mem.get(boundary) == 0xAABBCCDD);
+	AMIQ_RM_CHECK(mem.get_nof_allocated_pages() == 2);
+
+	//byte enables
+	AMIQ_RM_CHECK(mem.write(0x10, 0xFFFFFFFF, 0x2) == OKAY);
+	AMIQ_RM_CHECK(mem.read(0x10, 0xF).first == 0x1122FF44);
+
+	//accesses outside of the memory
+	AMIQ_RM_CHECK(mem.read(mem.size - 2).second == ERROR);
+	AMIQ_RM_CHECK(mem.write(mem.size, 0) == ERROR);
+
+	//bulk accesses
+	unsigned char buffer[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+	unsigned char result[8];
+	mem.load(0x100, buffer, sizeof(buffer));
+	mem.dump(0x100, result, sizeof(result));
+	AMIQ_RM_CHECK(memcmp(buffer, result, sizeof(buffer)) == 0);
+	mem.fill(0x100, 0, sizeof(buffer));
+	AMIQ_RM_CHECK(mem.get(0x104) == 0);
+
+	mem.clear();
+	AMIQ_RM_CHECK(mem.get_nof_allocated_pages() == 0);
+	AMIQ_RM_CHECK(mem.get(0x10) == 0);
+
+	return amiq_rm_test_result("test_mem");
+}
@@ -0,0 +1,112 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        test_pack.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#include "amiq_rm.h"
+#include "amiq_rm_test.hpp"
+
+using namespace std;
+using namespace amiq_rm;
+
+/** The number of elements of the register arrays. */
+static const int unsigned NOF_ELEMENTS = 16;
+
+/** @returns a register with a 4-bit, a 12-bit and a 16-bit field. */
+static amiq_rm_reg* new_split_reg(string name) {
+	amiq_rm_reg *reg = new amiq_rm_reg(name);
+	reg->add_field(new amiq_rm_field("low", 0, 4, "RW"));
+	reg->add_field(new amiq_rm_field("mid", 0, 12, "RW"));
+	reg->add_field(new amiq_rm_field("high", 0, 16, "RW"));
+	reg->build();
+	return reg;
+}
+
+/** @returns a register with one 32-bit field. */
+static amiq_rm_reg* new_wide_reg(string name) {
+	amiq_rm_reg *reg = new amiq_rm_reg(name);
+	reg->add_field(new amiq_rm_field("value", 0, 32, "RW"));
+	reg->build();
+	return reg;
+}
+
+/** @returns the word of element @b i of the register arrays. */
+static amiq_rm_reg_data_t element_word(int unsigned i) {
+	return 0x9E3779B9 * (i + 1);
+}
+
+/** pack() and unpack() agree with each other and with the field accessors. */
+static void check_reg() {
+	amiq_rm_reg *reg = new_split_reg("reg");
+	amiq_rm_reg_data_t values[3] = { 0x5, 0xABC, 0x1234 };
+	AMIQ_RM_CHECK(reg->pack(values) == 0x1234ABC5);
+
+	//the bits which do not fit in a field are ignored
+	amiq_rm_reg_data_t wide_values[3] = { 0xF5, 0xFABC, 0xFFFF1234 };
+	AMIQ_RM_CHECK(reg->pack(wide_values) == 0x1234ABC5);
+
+	amiq_rm_reg_data_t unpacked[3];
+	reg->unpack(0x1234ABC5, unpacked);
+	AMIQ_RM_CHECK((unpacked[0] == 0x5) && (unpacked[1] == 0xABC) && (unpacked[2] == 0x1234));
+
+	reg->set(0xCAFE0123);
+	reg->unpack(reg->get(), unpacked);
+	AMIQ_RM_CHECK(unpacked[0] == reg->get_field_value("low"));
+	AMIQ_RM_CHECK(unpacked[1] == reg->get_field_value("mid"));
+	AMIQ_RM_CHECK(unpacked[2] == reg->get_field_value("high"));
+	AMIQ_RM_CHECK(reg->pack(unpacked) == 0xCAFE0123);
+	delete reg;
+
+	amiq_rm_reg *wide = new_wide_reg("wide");
+	amiq_rm_reg_data_t wide_value = 0xFFFFFFFF;
+	AMIQ_RM_CHECK(wide->pack(&wide_value) == 0xFFFFFFFF);
+	wide->unpack(0x89ABCDEF, &wide_value);
+	AMIQ_RM_CHECK(wide_value == 0x89ABCDEF);
+	AMIQ_RM_CHECK(wide->pack(&wide_value) == 0x89ABCDEF);
+	delete wide;
+}
+
+/** unpack_columns() of an array gives the values of get_field_value() and the columns pack back to the element words. */
+static void check_reg_array(amiq_rm_reg *layout) {
+	amiq_rm_reg_array array("array", layout, NOF_ELEMENTS, 4);
+	array.build();
+	for (int unsigned i = 0; i < NOF_ELEMENTS; i++)
+		array.set(i, element_word(i));
+
+	int unsigned nof_fields = layout->fields.size();
+	vector<vector<amiq_rm_reg_data_t> > columns(nof_fields, vector<amiq_rm_reg_data_t>(NOF_ELEMENTS, 0));
+	vector<amiq_rm_reg_data_t*> column_pointers(nof_fields);
+	for (int unsigned f = 0; f < nof_fields; f++)
+		column_pointers[f] = &columns[f][0];
+	array.unpack_columns(&column_pointers[0]);
+
+	for (int unsigned i = 0; i < NOF_ELEMENTS; i++) {
+		vector<amiq_rm_reg_data_t> values(nof_fields);
+		for (int unsigned f = 0; f < nof_fields; f++) {
+			AMIQ_RM_CHECK(columns[f][i] == array.get_field_value(i, layout->fields[f]->name));
+			values[f] = columns[f][i];
+		}
+		AMIQ_RM_CHECK(layout->pack(&values[0]) == element_word(i));
+	}
+}
+
+int main() {
+	check_reg();
+	check_reg_array(new_split_reg("layout"));
+	check_reg_array(new_wide_reg("layout"));
+	return amiq_rm_test_result("test_pack");
+}
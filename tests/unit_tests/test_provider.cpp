@@ -0,0 +1,119 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        test_provider.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+
+#include "amiq_rm.h"
+#include "amiq_rm_test.hpp"
+
+using namespace std;
+using namespace amiq_rm;
+
+/** Provider which returns a value set by the test and counts the calls. */
+class counting_provider: public amiq_rm_value_provider {
+public:
+	/** The value returned by get_value(). */
+	amiq_rm_reg_data_t value;
+
+	/** The number of calls of get_value(). */
+	int unsigned nof_calls;
+
+	/** @param my_value is the first value returned */
+	counting_provider(amiq_rm_reg_data_t my_value) {
+		value = my_value;
+		nof_calls = 0;
+	}
+
+	/** @returns the value set by the test */
+	virtual amiq_rm_reg_data_t get_value(amiq_rm_reg &reg) {
+		nof_calls++;
+		return value;
+	}
+};
+
+int main() {
+	//counter: value[31:0] RO, pulled from a register provider
+	amiq_rm_reg counter("counter");
+	counter.add_field(new amiq_rm_field("value", 0x0, 32, "RO"));
+	counting_provider counter_provider(0x5);
+	counter.set_provider(&counter_provider);
+
+	//status: level[7:0] RO pulled from a field provider, ctrl[15:8] RW, busy[16] RO pulled from another field provider
+	amiq_rm_reg status("status");
+	status.add_field(new amiq_rm_field("level", 0x0, 8, "RO"));
+	status.add_field(new amiq_rm_field("ctrl", 0x0, 8, "RW"));
+	status.add_field(new amiq_rm_field("busy", 0x0, 1, "RO"));
+	counting_provider level_provider(0x1FF);
+	counting_provider busy_provider(0x1);
+	status.get_field_my_name("level")->provider = &level_provider;
+	status.get_field_my_name("busy")->provider = &busy_provider;
+
+	amiq_rm_physical_address_map top("top");
+	top.add_reg(counter, 0x0);
+	top.add_reg(status, 0x4);
+	top.build();
+	AMIQ_RM_CHECK(counter.has_providers() && status.has_providers());
+
+	//the first access pulls the value, the other accesses of the same epoch use it
+	amiq_rm_value_provider::advance_epoch();
+	AMIQ_RM_CHECK(counter.get() == 0x5);
+	AMIQ_RM_CHECK(counter_provider.nof_calls == 1);
+	counter_provider.value = 0x6;
+	AMIQ_RM_CHECK(top.read(0x0).first == 0x5);
+	AMIQ_RM_CHECK(counter.get_field_value("value") == 0x5);
+	AMIQ_RM_CHECK(counter_provider.nof_calls == 1);
+
+	//a new epoch pulls the value again, once
+	amiq_rm_value_provider::advance_epoch();
+	AMIQ_RM_CHECK(top.read(0x0).first == 0x6);
+	AMIQ_RM_CHECK(counter.get() == 0x6);
+	AMIQ_RM_CHECK(counter_provider.nof_calls == 2);
+
+	//a register which is not accessed is not pulled
+	amiq_rm_value_provider::advance_epoch();
+	amiq_rm_value_provider::advance_epoch();
+	AMIQ_RM_CHECK(counter_provider.nof_calls == 2);
+
+	//the field providers supply their bits only, the value is truncated to the field; the other fields keep the model value
+	AMIQ_RM_CHECK(top.write(0x4, 0xFFFFFFFF) == OKAY);
+	AMIQ_RM_CHECK((level_provider.nof_calls == 1) && (busy_provider.nof_calls == 1));
+	AMIQ_RM_CHECK(status.get() == 0x1FFFF);
+	level_provider.value = 0x12;
+	busy_provider.value = 0x0;
+	AMIQ_RM_CHECK(top.read(0x4).first == 0x1FFFF);
+	amiq_rm_value_provider::advance_epoch();
+	AMIQ_RM_CHECK(top.read(0x4).first == 0xFF12);
+	AMIQ_RM_CHECK(status.get_field_value("level") == 0x12);
+	AMIQ_RM_CHECK((level_provider.nof_calls == 2) && (busy_provider.nof_calls == 2));
+
+	//the field providers override the bits supplied by the register provider
+	counting_provider status_provider(0xFFFFFFFF);
+	status.set_provider(&status_provider);
+	amiq_rm_value_provider::advance_epoch();
+	AMIQ_RM_CHECK(status.get() == 0xFFFEFF12);
+	AMIQ_RM_CHECK((status_provider.nof_calls == 1) && (level_provider.nof_calls == 3));
+
+	//without providers the value is the one of the model
+	counter.set_provider(NULL);
+	AMIQ_RM_CHECK(!counter.has_providers());
+	amiq_rm_value_provider::advance_epoch();
+	AMIQ_RM_CHECK(counter.get() == 0x6);
+	AMIQ_RM_CHECK(counter_provider.nof_calls == 2);
+
+	return amiq_rm_test_result("test_provider");
+}
@@ -0,0 +1,180 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        test_randomize.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+
+#include "amiq_rm.h"
+#include "amiq_rm_test.hpp"
+
+using namespace std;
+using namespace amiq_rm;
+
+/** Number of seeds checked for the masks and the constraints. */
+static const int unsigned NOF_SEEDS = 256;
+
+/** @returns true for the registers named "mixed" */
+static bool is_mixed(amiq_rm_reg &reg) {
+	return (reg.name == "mixed");
+}
+
+/** @returns the values of all registers of the hierarchy of the test, in a fixed order */
+static vector<amiq_rm_reg_data_t> get_values(amiq_rm_reg &mixed, amiq_rm_reg &status, amiq_rm_reg &wide, amiq_rm_reg_array &elements,
+		amiq_rm_map_array &channels) {
+	vector<amiq_rm_reg_data_t> values;
+	values.push_back(mixed.get());
+	values.push_back(status.get());
+	values.push_back(wide.get());
+	values.insert(values.end(), elements.values.begin(), elements.values.end());
+	for (int unsigned i = 0; i < channels.get_nof_banks(); i++)
+		values.insert(values.end(), channels.get_bank_values(i).begin(), channels.get_bank_values(i).end());
+	return values;
+}
+
+int main() {
+	//mixed: free[7:0] RW, ro[15:8] RO, range[19:16] RW in [3, 9], choice[23:20] RW in {1, 4, 12}, flags[27:24] W1C, bits [31:28] reserved
+	amiq_rm_reg mixed("mixed");
+	mixed.add_field(new amiq_rm_field("free", 0x0, 8, "RW"));
+	mixed.add_field(new amiq_rm_field("ro", 0xA5, 8, "RO"));
+	mixed.add_field(new amiq_rm_field("range", 0x3, 4, "RW"));
+	mixed.add_field(new amiq_rm_field("choice", 0x1, 4, "RW"));
+	mixed.add_field(new amiq_rm_field("flags", 0xF, 4, "W1C"));
+	mixed.get_field_my_name("range")->set_rand_range(3, 9);
+	vector<amiq_rm_reg_data_t> choices;
+	choices.push_back(1);
+	choices.push_back(4);
+	choices.push_back(12);
+	mixed.get_field_my_name("choice")->set_rand_values(choices);
+
+	amiq_rm_reg status("status");
+	status.add_field(new amiq_rm_field("value", 0x1234, 32, "RO"));
+
+	//register array elements: low[15:0] RW, mode[19:16] RW in {2, 5}, id[31:20] RO
+	amiq_rm_reg *layout = new amiq_rm_reg("element");
+	layout->add_field(new amiq_rm_field("low", 0x0, 16, "RW"));
+	layout->add_field(new amiq_rm_field("mode", 0x2, 4, "RW"));
+	layout->add_field(new amiq_rm_field("id", 0x7, 12, "RO"));
+	vector<amiq_rm_reg_data_t> modes;
+	modes.push_back(2);
+	modes.push_back(5);
+	layout->get_field_my_name("mode")->set_rand_values(modes);
+	amiq_rm_reg_array elements("elements", layout, 8, 4);
+
+	//map array with two banks of four instances: cfg has value[15:0] RW, version[31:16] RO
+	amiq_rm_address_map instance("instance");
+	amiq_rm_reg cfg("cfg");
+	cfg.add_field(new amiq_rm_field("value", 0x0, 16, "RW"));
+	cfg.add_field(new amiq_rm_field("version", 0xBEEF, 16, "RO"));
+	instance.add_reg(cfg, 0x0);
+	amiq_rm_map_array channels("channels", instance, 4, 0x10);
+	channels.set_nof_banks(2);
+
+	amiq_rm_address_map sub("sub");
+	amiq_rm_reg wide("wide");
+	wide.add_field(new amiq_rm_field("value", 0x0, 32, "RW"));
+	sub.add_reg(wide, 0x0);
+
+	amiq_rm_physical_address_map top("top");
+	top.add_reg(mixed, 0x0);
+	top.add_reg(status, 0x4);
+	top.add_reg_array(elements, 0x100);
+	top.add_map_array(channels, 0x200);
+	top.add_map(sub, 0x1000);
+	top.build();
+	top.reset();
+
+	//every register, array element and map array value of the selected bank is randomized
+	AMIQ_RM_CHECK(top.randomize(1) == 3 + 8 + 4);
+
+	//the same seed gives the same values, another seed gives other values
+	top.reset();
+	AMIQ_RM_CHECK(top.randomize(42) == 15);
+	vector<amiq_rm_reg_data_t> first = get_values(mixed, status, wide, elements, channels);
+	top.reset();
+	top.randomize(42);
+	AMIQ_RM_CHECK(get_values(mixed, status, wide, elements, channels) == first);
+	top.reset();
+	top.randomize(43);
+	AMIQ_RM_CHECK(get_values(mixed, status, wide, elements, channels) != first);
+
+	//the write masks, the read-only and reserved bits and the constraints are honoured for many seeds, the free bits take many values
+	amiq_rm_reg_data_t free_seen = 0;
+	amiq_rm_reg_data_t wide_ones = 0;
+	amiq_rm_reg_data_t wide_zeros = 0;
+	vector<bool> range_seen(16, false);
+	vector<bool> choice_seen(16, false);
+	vector<bool> mode_seen(16, false);
+	for (int unsigned seed = 0; seed < NOF_SEEDS; seed++) {
+		top.reset();
+		top.randomize(seed);
+
+		AMIQ_RM_CHECK(mixed.get_field_value("ro") == 0xA5);
+		AMIQ_RM_CHECK(mixed.get_field_value("flags") == 0xF);
+		AMIQ_RM_CHECK((mixed.get() >> 28) == 0);
+		AMIQ_RM_CHECK((mixed.get_field_value("range") >= 3) && (mixed.get_field_value("range") <= 9));
+		AMIQ_RM_CHECK((mixed.get_field_value("choice") == 1) || (mixed.get_field_value("choice") == 4) || (mixed.get_field_value("choice") == 12));
+		free_seen |= mixed.get_field_value("free");
+		range_seen[mixed.get_field_value("range")] = true;
+		choice_seen[mixed.get_field_value("choice")] = true;
+
+		AMIQ_RM_CHECK(status.get() == 0x1234);
+		wide_ones |= wide.get();
+		wide_zeros |= ~wide.get();
+
+		for (int unsigned i = 0; i < elements.count; i++) {
+			AMIQ_RM_CHECK(elements.get_field_value(i, "id") == 0x7);
+			AMIQ_RM_CHECK((elements.get_field_value(i, "mode") == 2) || (elements.get_field_value(i, "mode") == 5));
+			mode_seen[elements.get_field_value(i, "mode")] = true;
+		}
+
+		for (int unsigned i = 0; i < 4; i++)
+			AMIQ_RM_CHECK(channels.get_field_value(channels.get_index(i, cfg), "version") == 0xBEEF);
+	}
+	AMIQ_RM_CHECK(free_seen == 0xFF);
+	AMIQ_RM_CHECK((wide_ones == 0xFFFFFFFF) && (wide_zeros == 0xFFFFFFFF));
+	for (int unsigned i = 0; i < 16; i++) {
+		AMIQ_RM_CHECK(range_seen[i] == ((i >= 3) && (i <= 9)));
+		AMIQ_RM_CHECK(choice_seen[i] == ((i == 1) || (i == 4) || (i == 12)));
+		AMIQ_RM_CHECK(mode_seen[i] == ((i == 2) || (i == 5)));
+	}
+
+	//a filter does not change the positions in the random sequence: the selected register gets the value of the full randomization
+	top.reset();
+	top.randomize(7);
+	amiq_rm_reg_data_t mixed_value = mixed.get();
+	top.reset();
+	AMIQ_RM_CHECK(top.randomize(7, is_mixed) == 1);
+	AMIQ_RM_CHECK(mixed.get() == mixed_value);
+	AMIQ_RM_CHECK(wide.get() == 0x0);
+	AMIQ_RM_CHECK(elements.get(0) == layout->get_reset_value());
+
+	//the map array randomizes the values of the selected bank only, from its own position in the sequence
+	top.reset();
+	channels.select_bank(1);
+	AMIQ_RM_CHECK(channels.randomize(7, 100, NULL) == 4);
+	for (int unsigned i = 0; i < 4; i++) {
+		int unsigned index = channels.get_index(i, cfg);
+		AMIQ_RM_CHECK(channels.get(index) == cfg.get_random_value(cfg.get_reset_value(), amiq_rm_random(7, 100 + index)));
+		AMIQ_RM_CHECK(channels.get_bank_values(0)[index] == cfg.get_reset_value());
+	}
+	AMIQ_RM_CHECK(channels.randomize(7, 100, is_mixed) == 0);
+
+	//the same values are seen through the decoder
+	AMIQ_RM_CHECK(top.read(0x200).first == channels.get(channels.get_index(0, cfg)));
+
+	return amiq_rm_test_result("test_randomize");
+}
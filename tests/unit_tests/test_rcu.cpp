@@ -0,0 +1,208 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        test_rcu.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+
+#include "amiq_rm.h"
+#include "amiq_rm_test.hpp"
+#include <atomic>
+#include <thread>
+
+using namespace std;
+using namespace amiq_rm;
+
+/** A 32-bit read-write register. */
+class test_reg: public amiq_rm_reg {
+public:
+	test_reg(string my_name, amiq_rm_reg_data_t reset_value) :
+			amiq_rm_reg(my_name) {
+		add_field(new amiq_rm_field("value", reset_value, 32, "RW"));
+	}
+};
+
+/** The number of registers of the block. */
+static const int unsigned NOF_REGS = 64;
+
+/** The number of topology updates done while the map is read. */
+static const int unsigned NOF_UPDATES = 200;
+
+/** A map with two blocks of registers, each register holds its index: @b block is moved by the tests, @b other stays in place. */
+class test_topology {
+public:
+	amiq_rm_physical_address_map top;
+	amiq_rm_address_map block;
+	amiq_rm_address_map other;
+	test_reg *regs[2 * NOF_REGS];
+
+	test_topology() :
+			top("top"), block("block"), other("other") {
+		for (int unsigned i = 0; i < 2 * NOF_REGS; i++) {
+			regs[i] = new test_reg("reg" + to_string(i % NOF_REGS), i % NOF_REGS);
+			((i < NOF_REGS) ? block : other).add_reg(*regs[i], 4 * (i % NOF_REGS));
+		}
+		top.add_map(block, 0x1000);
+		top.add_map(other, 0x8000);
+		top.build();
+		top.reset();
+		top.enable_rcu();
+	}
+
+	~test_topology() {
+		for (int unsigned i = 0; i < 2 * NOF_REGS; i++)
+			delete regs[i];
+	}
+};
+
+/** A reader which reads the block until it is stopped and counts the wrong results. */
+static void read_loop(amiq_rm_physical_address_map *top, amiq_rm_reg_address_t base, atomic<bool> *stopped, int unsigned *nof_errors) {
+	for (int unsigned i = 0; !*stopped; i++) {
+		pair<amiq_rm_reg_data_t, amiq_rm_status_t> data_with_status = top->read(base + 4 * (i % NOF_REGS));
+		if ((data_with_status.second != OKAY) || (data_with_status.first != i % NOF_REGS))
+			(*nof_errors)++;
+	}
+}
+
+/** build() and publish() replace the decoder while other threads read the map. */
+static void check_build_and_publish() {
+	test_topology topology;
+	atomic<bool> stopped(false);
+	int unsigned nof_errors = 0;
+	thread reader(read_loop, &topology.top, 0x1000, &stopped, &nof_errors);
+	for (int unsigned i = 0; i < NOF_UPDATES; i++) {
+		if (i % 2 == 0)
+			topology.top.publish();
+		else
+			topology.top.build();
+	}
+	stopped = true;
+	reader.join();
+	AMIQ_RM_CHECK(nof_errors == 0);
+
+	//without readers, all the replaced decoders are deleted
+	amiq_rm_rcu::get().reclaim();
+	AMIQ_RM_CHECK(amiq_rm_rcu::get().get_nof_retired() == 0);
+	//the last build() published a new decoder instead of building the member in place
+	AMIQ_RM_CHECK(&topology.top.get_decoder() != &topology.top.decoder);
+}
+
+/** A thread which walks the table of targets of the map until it is stopped and counts the inconsistent tables. */
+static void walk_loop(amiq_rm_physical_address_map *top, atomic<bool> *stopped, int unsigned *nof_errors) {
+	while (!*stopped) {
+		amiq_rm_rcu_read_guard guard(true);
+		amiq_rm_target_table *table = top->get_decoder().get_table();
+		vector<int unsigned> positions;
+		table->find_targets(0, ~((amiq_rm_reg_address_t) 0), positions);
+		if (positions.size() != 2 * NOF_REGS)
+			(*nof_errors)++;
+		for (int unsigned i = 1; i < positions.size(); i++) {
+			if (table->targets[positions[i - 1]]->base >= table->targets[positions[i]]->base)
+				(*nof_errors)++;
+		}
+	}
+}
+
+/** A sub-map is moved back and forth while other threads read the map and walk its targets. */
+static void check_relocate_while_reading() {
+	test_topology topology;
+	amiq_rm_physical_address_map &top = topology.top;
+	amiq_rm_radix_decoder *decoder = &top.get_decoder();
+	atomic<bool> stopped(false);
+	int unsigned nof_read_errors = 0;
+	int unsigned nof_walk_errors = 0;
+	thread reader(read_loop, &top, 0x8000, &stopped, &nof_read_errors);
+	thread walker(walk_loop, &top, &stopped, &nof_walk_errors);
+	for (int unsigned i = 0; i < NOF_UPDATES; i++) {
+		amiq_rm_reg_address_t offset = (i % 2 == 0) ? 0x4000 : 0x1000;
+		AMIQ_RM_CHECK(top.relocate_map(topology.block, offset));
+		AMIQ_RM_CHECK(top.read(offset + 4 * 7).first == 7);
+	}
+	stopped = true;
+	reader.join();
+	walker.join();
+	AMIQ_RM_CHECK((nof_read_errors == 0) && (nof_walk_errors == 0));
+
+	//the disjoint moves were done in place, the replaced nodes, targets and tables are reclaimed
+	AMIQ_RM_CHECK(&top.get_decoder() == decoder);
+	amiq_rm_rcu::get().reclaim();
+	AMIQ_RM_CHECK(amiq_rm_rcu::get().get_nof_retired() == 0);
+}
+
+/** A move to an overlapping range publishes a new decoder instead of moving the sub-map in place. */
+static void check_overlapping_relocation() {
+	test_topology topology;
+	amiq_rm_physical_address_map &top = topology.top;
+	amiq_rm_radix_decoder *decoder = &top.get_decoder();
+	AMIQ_RM_CHECK(top.relocate_map(topology.block, 0x1080));
+	AMIQ_RM_CHECK(&top.get_decoder() != decoder);
+	AMIQ_RM_CHECK(top.read(0x1080 + 4 * 5).first == 5);
+	AMIQ_RM_CHECK(top.read(0x1000).second == HOLE);
+	amiq_rm_rcu::get().reclaim();
+}
+
+/** A compiled sequence still runs after the sub-map of its registers was moved. */
+static void check_sequence_after_relocation() {
+	test_topology topology;
+	amiq_rm_physical_address_map &top = topology.top;
+	amiq_rm_sequence sequence("sequence");
+	sequence.add_write("block.reg3", 0x33);
+	sequence.add_check("block.reg3", 0x33, ~0U);
+	AMIQ_RM_CHECK(sequence.compile(top));
+
+	AMIQ_RM_CHECK(top.relocate_map(topology.block, 0x4000));
+	amiq_rm_rcu::get().reclaim();
+	AMIQ_RM_CHECK(sequence.run());
+	AMIQ_RM_CHECK((topology.regs[3]->value == 0x33) && (top.read(0x4000 + 4 * 3).first == 0x33));
+}
+
+/** A sub-map is told apart from a sibling with the same name: the sibling is neither ignored when the new range is checked nor
+ * moved, while the sub-maps of the moved sub-map are moved with it. */
+static void check_same_name_siblings() {
+	amiq_rm_physical_address_map top("top");
+	amiq_rm_address_map a("bar");
+	amiq_rm_address_map b("bar");
+	amiq_rm_address_map inner("inner");
+	test_reg reg_a("reg", 0xA), reg_b("reg", 0xB), reg_inner("reg", 0xC);
+	a.add_reg(reg_a, 0x0);
+	inner.add_reg(reg_inner, 0x0);
+	a.add_map(inner, 0x10);
+	b.add_reg(reg_b, 0x80);
+	top.add_map(a, 0x1000);
+	top.add_map(b, 0x2000);
+	top.build();
+	top.reset();
+	top.enable_rcu();
+
+	AMIQ_RM_CHECK(!top.relocate_map(a, 0x2080));
+	AMIQ_RM_CHECK((top.read(0x1000).first == 0xA) && (top.read(0x2080).first == 0xB));
+
+	AMIQ_RM_CHECK(top.relocate_map(a, 0x3000));
+	AMIQ_RM_CHECK(top.read(0x3000).first == 0xA);
+	AMIQ_RM_CHECK(top.read(0x3010).first == 0xC);
+	AMIQ_RM_CHECK(top.read(0x2080).first == 0xB);
+	AMIQ_RM_CHECK(top.read(0x1000).second == HOLE);
+	amiq_rm_rcu::get().reclaim();
+}
+
+int main() {
+	check_build_and_publish();
+	check_relocate_while_reading();
+	check_overlapping_relocation();
+	check_sequence_after_relocation();
+	check_same_name_siblings();
+	return amiq_rm_test_result("test_rcu");
+}
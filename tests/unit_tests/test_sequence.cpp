@@ -0,0 +1,273 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        test_sequence.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+
+#include "amiq_rm.h"
+#include "amiq_rm_test.hpp"
+#include <fstream>
+#include <stdio.h>
+
+using namespace std;
+using namespace amiq_rm;
+
+/** File used by the test. */
+static const char *FILE_NAME = "/tmp/amiq_rm_test_sequence.txt";
+
+/** Register whose "ready" bit is set by the read with a given number, for the polls. */
+class ready_reg: public amiq_rm_reg {
+public:
+	/** The number of reads of the register. */
+	int unsigned nof_reads;
+
+	/** The number of the read which sets "ready". */
+	int unsigned ready_after;
+
+	/** @param my_name is set as name */
+	ready_reg(string my_name) :
+			amiq_rm_reg(my_name) {
+		nof_reads = 0;
+		ready_after = 0;
+		add_field(new amiq_rm_field("ready", 0x0, 1, "RO"));
+		add_field(new amiq_rm_field("state", 0x0, 7, "RO"));
+	}
+
+	/** Count the reads and set "ready" on the selected one. */
+	virtual amiq_rm_status_t pre_access(amiq_rm_direction_t direction, amiq_rm_reg_data_t access_data) {
+		if ((direction == READ) && (++nof_reads == ready_after))
+			value |= 0x1;
+		return amiq_rm_reg::pre_access(direction, access_data);
+	}
+};
+
+/** The function writes the file used by the test.
+ * @param content is the content of the file */
+static void write_file(string content) {
+	ofstream file(FILE_NAME);
+	file << content;
+}
+
+/** The registers of the test:
+ * @li ctrl at 0x0: enable[0] RW, mode[3:1] RW, data[31:4] RW
+ * @li status at 0x4: ready[0] RO, state[7:1] RO
+ * @li cmd at 0x8: value[31:0] WO
+ * @li sub.cfg at 0x100: value[31:0] RW, reset value 0x10
+ * @li chan[0..3] at 0x200: level[7:0] RW, gain[15:8] RW
+ * @li mem at 0x1000 */
+struct test_map {
+	amiq_rm_physical_address_map top;
+	amiq_rm_address_map sub;
+	amiq_rm_reg ctrl;
+	ready_reg status;
+	amiq_rm_reg cmd;
+	amiq_rm_reg cfg;
+	amiq_rm_reg_array chan;
+	amiq_rm_mem mem;
+
+	test_map() :
+			top("top"), sub("sub"), ctrl("ctrl"), status("status"), cmd("cmd"), cfg("cfg"), chan("chan", new amiq_rm_reg("chan"), 4, 4), mem(
+					"mem", 0x100) {
+		ctrl.add_field(new amiq_rm_field("enable", 0x0, 1, "RW"));
+		ctrl.add_field(new amiq_rm_field("mode", 0x0, 3, "RW"));
+		ctrl.add_field(new amiq_rm_field("data", 0x0, 28, "RW"));
+		cmd.add_field(new amiq_rm_field("value", 0x0, 32, "WO"));
+		cfg.add_field(new amiq_rm_field("value", 0x10, 32, "RW"));
+		chan.layout->add_field(new amiq_rm_field("level", 0x0, 8, "RW"));
+		chan.layout->add_field(new amiq_rm_field("gain", 0x0, 8, "RW"));
+		top.add_reg(ctrl, 0x0);
+		top.add_reg(status, 0x4);
+		top.add_reg(cmd, 0x8);
+		sub.add_reg(cfg, 0x0);
+		top.add_map(sub, 0x100);
+		top.add_reg_array(chan, 0x200);
+		top.add_mem(mem, 0x1000);
+		top.build();
+		top.reset();
+	}
+};
+
+/** The text format: all kinds of steps, comments, registers by path and by address, numbers in hexadecimal and decimal. */
+static void check_text_format() {
+	write_file("# initialization\n"
+			"\n"
+			"write ctrl 0x1       # enable\n"
+			"write_field ctrl mode 5\n"
+			"  read sub.cfg\n"
+			"read 0x100 16\n"
+			"read chan[2] 0x30 0xF0\n"
+			"poll status 0x1 0x1 8\n"
+			"check 0x4 0x1\n"
+			"check ctrl 0xB 0xF\n");
+	amiq_rm_sequence sequence("init");
+	AMIQ_RM_CHECK(sequence.load(FILE_NAME));
+	AMIQ_RM_CHECK(sequence.get_nof_steps() == 8);
+	string text = "write ctrl 0x1\n"
+			"write_field ctrl mode 0x5\n"
+			"read sub.cfg\n"
+			"read 0x100 0x10 0xffffffff\n"
+			"read chan[2] 0x30 0xf0\n"
+			"poll status 0x1 0x1 8\n"
+			"check 0x4 0x1 0xffffffff\n"
+			"check ctrl 0xb 0xf\n";
+	AMIQ_RM_CHECK(sequence.to_string() == text);
+
+	//the output of to_string() is loaded back to the same steps
+	write_file(text);
+	amiq_rm_sequence copy("copy");
+	AMIQ_RM_CHECK(copy.load(FILE_NAME));
+	AMIQ_RM_CHECK(copy.to_string() == text);
+
+	//the sequence runs on the map
+	test_map map;
+	map.status.ready_after = 3;
+	map.chan.set(2, 0x3F);
+	AMIQ_RM_CHECK(sequence.compile(map.top));
+	AMIQ_RM_CHECK(sequence.run());
+	AMIQ_RM_CHECK(sequence.get_failed_step() == amiq_rm_sequence::AMIQ_RM_NO_STEP);
+	AMIQ_RM_CHECK(map.ctrl.get() == 0xB);
+	AMIQ_RM_CHECK(map.status.nof_reads == 3);
+
+	//a file is appended to the steps which were already added
+	AMIQ_RM_CHECK(sequence.load(FILE_NAME));
+	AMIQ_RM_CHECK(sequence.get_nof_steps() == 16);
+}
+
+/** A file with a line which is not valid adds no step. */
+static void check_invalid_lines() {
+	const char *lines[] = { "write ctrl", "write ctrl 0x1 0x2", "write ctrl one", "write ctrl 0xZZ", "read", "read ctrl 1 2 3",
+			"write_field ctrl mode", "poll status 0x1 0x1", "poll status 0x1 0x1 0", "check ctrl", "check ctrl 1 2 3", "erase ctrl" };
+	for (int unsigned i = 0; i < sizeof(lines) / sizeof(lines[0]); i++) {
+		write_file(string("write ctrl 0x1\nread ctrl\n") + lines[i] + "\nread ctrl\n");
+		amiq_rm_sequence sequence("invalid");
+		sequence.add_write("ctrl", 0x2);
+		AMIQ_RM_CHECK(!sequence.load(FILE_NAME));
+		AMIQ_RM_CHECK(sequence.get_nof_steps() == 1);
+		AMIQ_RM_CHECK(sequence.to_string() == "write ctrl 0x2\n");
+	}
+
+	amiq_rm_sequence sequence("missing");
+	AMIQ_RM_CHECK(!sequence.load("/tmp/amiq_rm_test_sequence_missing.txt"));
+	AMIQ_RM_CHECK(sequence.get_nof_steps() == 0);
+}
+
+/** compile() fails for registers, addresses and fields which do not exist. */
+static void check_compile_errors() {
+	test_map map;
+	amiq_rm_sequence no_path("no_path");
+	no_path.add_write("ctrl", 0x1);
+	no_path.add_write("sub.missing", 0x1);
+	AMIQ_RM_CHECK(!no_path.compile(map.top));
+
+	amiq_rm_sequence no_address("no_address");
+	no_address.add_read("0xC");
+	AMIQ_RM_CHECK(!no_address.compile(map.top));
+
+	amiq_rm_sequence no_field("no_field");
+	no_field.add_write_field("ctrl", "speed", 0x1);
+	AMIQ_RM_CHECK(!no_field.compile(map.top));
+
+	//a memory word has no fields
+	amiq_rm_sequence mem_field("mem_field");
+	mem_field.add_write_field("0x1010", "value", 0x1);
+	AMIQ_RM_CHECK(!mem_field.compile(map.top));
+
+	//the elements of arrays, the words of memories and the registers of sub-maps are resolved
+	amiq_rm_sequence all_kinds("all_kinds");
+	all_kinds.add_write_field("chan[3]", "gain", 0x7);
+	all_kinds.add_write("0x1010", 0xAB);
+	all_kinds.add_check("sub.cfg", 0x10, ~0U);
+	AMIQ_RM_CHECK(all_kinds.compile(map.top));
+	AMIQ_RM_CHECK(all_kinds.run());
+	AMIQ_RM_CHECK(map.chan.get(3) == 0x700);
+	AMIQ_RM_CHECK(map.top.read(0x1010).first == 0xAB);
+
+	//a step added after compile() needs a new compile()
+	all_kinds.add_read("ctrl");
+	AMIQ_RM_CHECK(all_kinds.compile(map.top));
+	AMIQ_RM_CHECK(all_kinds.get_nof_steps() == 4);
+}
+
+/** run() stops at the first failed step and reports it. */
+static void check_failures() {
+	test_map map;
+
+	//a read with other data: the status is OKAY, the data is the one read, the next steps are not executed
+	amiq_rm_sequence read_mismatch("read_mismatch");
+	read_mismatch.add_write("ctrl", 0x5);
+	read_mismatch.add_read("ctrl", 0x4, 0xF);
+	read_mismatch.add_write("sub.cfg", 0x99);
+	AMIQ_RM_CHECK(read_mismatch.compile(map.top));
+	AMIQ_RM_CHECK(!read_mismatch.run());
+	AMIQ_RM_CHECK(read_mismatch.get_failed_step() == 1);
+	AMIQ_RM_CHECK(read_mismatch.get_failed_status() == OKAY);
+	AMIQ_RM_CHECK(read_mismatch.get_failed_data() == 0x5);
+	AMIQ_RM_CHECK(map.cfg.get() == 0x10);
+
+	//a poll which does not see the data in MAX_READS reads
+	amiq_rm_sequence poll_timeout("poll_timeout");
+	poll_timeout.add_poll("status", 0x1, 0x1, 2);
+	AMIQ_RM_CHECK(poll_timeout.compile(map.top));
+	map.status.ready_after = 10;
+	AMIQ_RM_CHECK(!poll_timeout.run());
+	AMIQ_RM_CHECK(poll_timeout.get_failed_step() == 0);
+	AMIQ_RM_CHECK(poll_timeout.get_failed_status() == OKAY);
+	AMIQ_RM_CHECK(poll_timeout.get_failed_data() == 0x0);
+	AMIQ_RM_CHECK(map.status.nof_reads == 2);
+
+	//the next run polls again and sees the data
+	map.status.ready_after = 3;
+	AMIQ_RM_CHECK(poll_timeout.run());
+	AMIQ_RM_CHECK(poll_timeout.get_failed_step() == amiq_rm_sequence::AMIQ_RM_NO_STEP);
+	AMIQ_RM_CHECK(map.status.nof_reads == 3);
+
+	//an access which fails: the status of the access is reported
+	amiq_rm_sequence access_error("access_error");
+	access_error.add_write("cmd", 0x1);
+	access_error.add_read("cmd");
+	AMIQ_RM_CHECK(access_error.compile(map.top));
+	AMIQ_RM_CHECK(!access_error.run());
+	AMIQ_RM_CHECK(access_error.get_failed_step() == 1);
+	AMIQ_RM_CHECK(access_error.get_failed_status() == ERROR);
+
+	//a read-modify-write whose read fails does not write
+	amiq_rm_sequence field_error("field_error");
+	field_error.add_write_field("cmd", "value", 0x2);
+	AMIQ_RM_CHECK(field_error.compile(map.top));
+	AMIQ_RM_CHECK(!field_error.run());
+	AMIQ_RM_CHECK(field_error.get_failed_status() == ERROR);
+	AMIQ_RM_CHECK(map.cmd.get() == 0x1);
+
+	//a check of the model value, which is done without an access
+	amiq_rm_sequence check_mismatch("check_mismatch");
+	check_mismatch.add_check("status", 0x0, 0xFF);
+	AMIQ_RM_CHECK(check_mismatch.compile(map.top));
+	int unsigned nof_reads = map.status.nof_reads;
+	AMIQ_RM_CHECK(!check_mismatch.run());
+	AMIQ_RM_CHECK(check_mismatch.get_failed_step() == 0);
+	AMIQ_RM_CHECK(check_mismatch.get_failed_data() == 0x1);
+	AMIQ_RM_CHECK(map.status.nof_reads == nof_reads);
+}
+
+int main() {
+	check_text_format();
+	check_invalid_lines();
+	check_compile_errors();
+	check_failures();
+	remove(FILE_NAME);
+	return amiq_rm_test_result("test_sequence");
+}
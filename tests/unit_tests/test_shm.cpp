@@ -0,0 +1,212 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        test_shm.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#include "amiq_rm.h"
+#include "amiq_rm_test.hpp"
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <chrono>
+#include <thread>
+
+using namespace std;
+using namespace amiq_rm;
+
+/** Socket of the server used by the test. */
+static const char *SOCKET_PATH = "/tmp/amiq_rm_test_shm.sock";
+
+/** Socket of a server which attaches a client but never executes its requests. */
+static const char *STALLED_SOCKET_PATH = "/tmp/amiq_rm_test_shm_stalled.sock";
+
+/** Shared memory object of the client of the stalled server. */
+static const char *STALLED_SHM_NAME = "/amiq_rm_test_shm_stalled";
+
+/** @returns a socket connected to the control channel of the server, -1 in case of error */
+static int connect_control() {
+	struct sockaddr_un socket_address;
+	memset(&socket_address, 0, sizeof(socket_address));
+	socket_address.sun_family = AF_UNIX;
+	strncpy(socket_address.sun_path, SOCKET_PATH, sizeof(socket_address.sun_path) - 1);
+
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if ((fd >= 0) && (connect(fd, (struct sockaddr*) &socket_address, sizeof(socket_address)) != 0)) {
+		close(fd);
+		fd = -1;
+	}
+	return fd;
+}
+
+/** The function waits until the server has a given number of clients.
+ * @returns true if the number was reached within one second */
+static bool wait_for_clients(amiq_rm_shm_server &server, int unsigned nof_clients) {
+	for (int unsigned i = 0; i < 1000; i++) {
+		if (server.get_nof_clients() == nof_clients)
+			return true;
+		this_thread::sleep_for(chrono::milliseconds(1));
+	}
+	return false;
+}
+
+/** The function plays a server which attaches one client and then does not execute its requests until the client detaches.
+ * @param listen_fd is the listening socket */
+static void stalled_server(int listen_fd) {
+	int fd = accept(listen_fd, NULL, NULL);
+	if (fd < 0)
+		return;
+
+	amiq_rm_shm_control_t message;
+	int shm_fd = shm_open(STALLED_SHM_NAME, O_CREAT | O_RDWR, 0600);
+	if ((recv(fd, &message, sizeof(message), MSG_WAITALL) == sizeof(message)) && (shm_fd >= 0)
+			&& (ftruncate(shm_fd, sizeof(amiq_rm_shm_region_t)) == 0)) {
+		amiq_rm_shm_region_t *region = (amiq_rm_shm_region_t*) mmap(NULL, sizeof(amiq_rm_shm_region_t), PROT_READ | PROT_WRITE, MAP_SHARED,
+				shm_fd, 0);
+		if (region != MAP_FAILED) {
+			region->magic = AMIQ_RM_SHM_MAGIC;
+			region->nof_entries = AMIQ_RM_SHM_NOF_ENTRIES;
+			munmap(region, sizeof(amiq_rm_shm_region_t));
+			memset(&message, 0, sizeof(message));
+			strncpy(message.name, STALLED_SHM_NAME, AMIQ_RM_SHM_NAME_SIZE - 1);
+			if (send(fd, &message, sizeof(message), 0) == sizeof(message))
+				recv(fd, &message, sizeof(message), MSG_WAITALL);
+		}
+	}
+	if (shm_fd >= 0)
+		close(shm_fd);
+	close(fd);
+}
+
+/** The function checks that a client of a server which does not execute the requests gives up after its timeout. */
+static void check_stalled_server() {
+	struct sockaddr_un socket_address;
+	memset(&socket_address, 0, sizeof(socket_address));
+	socket_address.sun_family = AF_UNIX;
+	strncpy(socket_address.sun_path, STALLED_SOCKET_PATH, sizeof(socket_address.sun_path) - 1);
+	unlink(STALLED_SOCKET_PATH);
+	int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	AMIQ_RM_CHECK((listen_fd >= 0) && (bind(listen_fd, (struct sockaddr*) &socket_address, sizeof(socket_address)) == 0)
+			&& (listen(listen_fd, 1) == 0));
+	thread server(stalled_server, listen_fd);
+
+	amiq_rm_shm_client_t *client = amiq_rm_shm_attach(STALLED_SOCKET_PATH);
+	AMIQ_RM_CHECK(client != NULL);
+	if (client != NULL) {
+		amiq_rm_shm_set_timeout(client, 50);
+		uint32_t data = 0;
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		AMIQ_RM_CHECK(amiq_rm_shm_read(client, 0x10, &data) == AMIQ_RM_SHM_ERROR);
+		chrono::steady_clock::duration elapsed = chrono::steady_clock::now() - start;
+		AMIQ_RM_CHECK((elapsed >= chrono::milliseconds(49)) && (elapsed < chrono::seconds(2)));
+
+		//the ring can no longer be used, the next accesses fail at once
+		amiq_rm_shm_entry_t entries[2];
+		memset(entries, 0, sizeof(entries));
+		AMIQ_RM_CHECK(amiq_rm_shm_execute(client, entries, 2) == -1);
+		AMIQ_RM_CHECK((entries[0].status == AMIQ_RM_SHM_ERROR) && (entries[1].status == AMIQ_RM_SHM_ERROR));
+		amiq_rm_shm_detach(client);
+	}
+	server.join();
+	close(listen_fd);
+	unlink(STALLED_SOCKET_PATH);
+	shm_unlink(STALLED_SHM_NAME);
+}
+
+int main() {
+	amiq_rm_physical_address_map map("map");
+	amiq_rm_reg reg("reg");
+	reg.add_field(new amiq_rm_field("value", 0x5A, 32, "RW"));
+	map.add_reg(reg, 0x10);
+	map.build();
+	map.reset();
+
+	amiq_rm_shm_server server(map, SOCKET_PATH);
+	AMIQ_RM_CHECK(server.start());
+
+	//a client which sent only part of a message does not stop the server from attaching other clients
+	int stalled_fd = connect_control();
+	AMIQ_RM_CHECK(stalled_fd >= 0);
+	amiq_rm_shm_control_t message;
+	memset(&message, 0, sizeof(message));
+	message.op = AMIQ_RM_SHM_ATTACH;
+	AMIQ_RM_CHECK(send(stalled_fd, &message, sizeof(message) / 2, 0) == sizeof(message) / 2);
+
+	amiq_rm_shm_client_t *client = amiq_rm_shm_attach(SOCKET_PATH);
+	AMIQ_RM_CHECK(client != NULL);
+	if (client != NULL) {
+		uint32_t data = 0;
+		AMIQ_RM_CHECK(amiq_rm_shm_read(client, 0x10, &data) == OKAY);
+		AMIQ_RM_CHECK(data == 0x5A);
+		AMIQ_RM_CHECK(amiq_rm_shm_write(client, 0x10, 0x1234) == OKAY);
+		AMIQ_RM_CHECK(reg.get() == 0x1234);
+		AMIQ_RM_CHECK(amiq_rm_shm_read(client, 0x20, &data) == HOLE);
+	}
+
+	//the rest of the message completes the attach of the stalled client
+	AMIQ_RM_CHECK(send(stalled_fd, ((char* ) &message) + sizeof(message) / 2, sizeof(message) - sizeof(message) / 2, 0)
+			== sizeof(message) - sizeof(message) / 2);
+	AMIQ_RM_CHECK(recv(stalled_fd, &message, sizeof(message), MSG_WAITALL) == sizeof(message));
+	AMIQ_RM_CHECK(message.op == 0);
+	AMIQ_RM_CHECK(wait_for_clients(server, 2));
+
+	//a client which publishes more requests than the ring holds is dropped, the other clients are still served
+	message.name[AMIQ_RM_SHM_NAME_SIZE - 1] = 0;
+	int shm_fd = shm_open(message.name, O_RDWR, 0);
+	AMIQ_RM_CHECK(shm_fd >= 0);
+	if (shm_fd >= 0) {
+		amiq_rm_shm_region_t *region = (amiq_rm_shm_region_t*) mmap(NULL, sizeof(amiq_rm_shm_region_t), PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd,
+				0);
+		close(shm_fd);
+		AMIQ_RM_CHECK(region != MAP_FAILED);
+		if (region != MAP_FAILED) {
+			__atomic_store_n(&region->head, (uint64_t) AMIQ_RM_SHM_NOF_ENTRIES + 1, __ATOMIC_RELEASE);
+			AMIQ_RM_CHECK(wait_for_clients(server, 1));
+			AMIQ_RM_CHECK(recv(stalled_fd, &message, sizeof(message), 0) == 0);
+			AMIQ_RM_CHECK(region->done == 0);
+			munmap(region, sizeof(amiq_rm_shm_region_t));
+		}
+	}
+	close(stalled_fd);
+
+	if (client != NULL) {
+		uint32_t data = 0;
+		AMIQ_RM_CHECK(amiq_rm_shm_read(client, 0x10, &data) == OKAY);
+		AMIQ_RM_CHECK(data == 0x1234);
+		amiq_rm_shm_detach(client);
+	}
+	AMIQ_RM_CHECK(wait_for_clients(server, 0));
+
+	//a client of a server which stopped gets an error as soon as it sees the connection closed, without waiting for its timeout
+	client = amiq_rm_shm_attach(SOCKET_PATH);
+	AMIQ_RM_CHECK(client != NULL);
+	server.stop();
+	if (client != NULL) {
+		uint32_t data = 0;
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		AMIQ_RM_CHECK(amiq_rm_shm_write(client, 0x10, 0x1) == AMIQ_RM_SHM_ERROR);
+		AMIQ_RM_CHECK(amiq_rm_shm_read(client, 0x10, &data) == AMIQ_RM_SHM_ERROR);
+		AMIQ_RM_CHECK(chrono::steady_clock::now() - start < chrono::seconds(1));
+		amiq_rm_shm_detach(client);
+	}
+
+	check_stalled_server();
+
+	return amiq_rm_test_result("test_shm");
+}
@@ -0,0 +1,155 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        test_signal.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+
+#include "amiq_rm.h"
+#include "amiq_rm_test.hpp"
+
+using namespace std;
+using namespace amiq_rm;
+
+/** @returns a vector with one offset */
+static vector<amiq_rm_reg_address_t> offsets(amiq_rm_reg_address_t offset) {
+	return vector<amiq_rm_reg_address_t>(1, offset);
+}
+
+/** @returns a new register with one field which contributes to a signal */
+static amiq_rm_reg* new_signal_reg(string name, int unsigned size, string attrib, string signal_name) {
+	amiq_rm_reg *reg = new amiq_rm_reg(name);
+	reg->add_field(new amiq_rm_field("event", 0x0, size, attrib));
+	reg->get_field_my_name("event")->add_signal(signal_name);
+	return reg;
+}
+
+int main() {
+	int unsigned irq = amiq_rm_signal::get_id("irq");
+	int unsigned error = amiq_rm_signal::get_id("error");
+	AMIQ_RM_CHECK(irq != error);
+	AMIQ_RM_CHECK(amiq_rm_signal::get_id("irq") == irq);
+	AMIQ_RM_CHECK(amiq_rm_signal::get_name(error) == "error");
+
+	//isr: done[0] W1C -> irq, fault[1] W1C -> error
+	amiq_rm_reg isr("isr");
+	isr.add_field(new amiq_rm_field("done", 0x0, 1, "W1C"));
+	isr.add_field(new amiq_rm_field("fault", 0x0, 1, "W1C"));
+	isr.get_field_my_name("done")->add_signal("irq");
+	isr.get_field_my_name("fault")->add_signal("error");
+	amiq_rm_reg *status = new_signal_reg("status", 4, "RC", "irq");
+
+	//top.blk.core.core_isr at 0x1100
+	amiq_rm_address_map blk("blk");
+	amiq_rm_address_map core("core");
+	amiq_rm_reg *core_isr = new_signal_reg("core_isr", 1, "RW", "irq");
+	core.add_reg(*core_isr, 0x0);
+	blk.add_map(core, 0x100);
+
+	amiq_rm_reg_array pending("pending", new_signal_reg("pending", 1, "W1C", "irq"), 4, 4);
+
+	amiq_rm_address_map instance("instance");
+	amiq_rm_reg *channel_isr = new_signal_reg("channel_isr", 1, "W1C", "irq");
+	instance.add_reg(*channel_isr, 0x0);
+	amiq_rm_map_array channels("channels", instance, 2, 0x10);
+	channels.set_nof_banks(2);
+
+	amiq_rm_physical_address_map top("top");
+	top.add_reg(isr, 0x0);
+	top.add_reg(*status, 0x4);
+	top.add_reg_array(pending, 0x200);
+	top.add_map_array(channels, 0x400);
+	top.add_map(blk, 0x1000);
+	top.build();
+	top.reset();
+
+	AMIQ_RM_CHECK(isr.get_signal_mask() == (amiq_rm_signal::get_mask(irq) | amiq_rm_signal::get_mask(error)));
+	AMIQ_RM_CHECK(top.get_pending_signals() == 0);
+	AMIQ_RM_CHECK(top.get_signal_sources(irq).empty());
+
+	//W1C: the signal is pending until the bit is written with 1, writing 0 keeps it
+	isr.set(0x1);
+	AMIQ_RM_CHECK(top.is_signal_pending(irq) && !top.is_signal_pending(error));
+	AMIQ_RM_CHECK(top.get_signal_sources(irq) == offsets(0x0));
+	AMIQ_RM_CHECK(top.get_signal_sources(error).empty());
+	AMIQ_RM_CHECK(top.write(0x0, 0x0) == OKAY);
+	AMIQ_RM_CHECK(top.is_signal_pending(irq));
+	AMIQ_RM_CHECK(top.write(0x0, 0x1) == OKAY);
+	AMIQ_RM_CHECK(!top.is_signal_pending(irq));
+
+	//the signals of the fields of a register are independent
+	isr.set(0x2);
+	AMIQ_RM_CHECK(top.get_pending_signals() == amiq_rm_signal::get_mask(error));
+	AMIQ_RM_CHECK(top.get_signal_sources(error) == offsets(0x0));
+	AMIQ_RM_CHECK(top.write(0x0, 0x2) == OKAY);
+	AMIQ_RM_CHECK(top.get_pending_signals() == 0);
+
+	//RC: the read which returns the value clears the signal
+	status->set(0x3);
+	AMIQ_RM_CHECK(top.get_signal_sources(irq) == offsets(0x4));
+	AMIQ_RM_CHECK(top.read(0x4).first == 0x3);
+	AMIQ_RM_CHECK(!top.is_signal_pending(irq));
+
+	//nested maps: the signal is pending in every map on the path, the sources are relative to the map which is asked
+	core_isr->set(0x1);
+	AMIQ_RM_CHECK(core.is_signal_pending(irq) && blk.is_signal_pending(irq) && top.is_signal_pending(irq));
+	AMIQ_RM_CHECK(top.get_signal_sources(irq) == offsets(0x1100));
+	AMIQ_RM_CHECK(blk.get_signal_sources(irq) == offsets(0x100));
+
+	//the signal stays pending while at least one source has it active
+	isr.set(0x1);
+	vector<amiq_rm_reg_address_t> both_sources;
+	both_sources.push_back(0x0);
+	both_sources.push_back(0x1100);
+	AMIQ_RM_CHECK(top.get_signal_sources(irq) == both_sources);
+	AMIQ_RM_CHECK(top.write(0x1100, 0x0) == OKAY);
+	AMIQ_RM_CHECK(!blk.is_signal_pending(irq) && top.is_signal_pending(irq));
+	AMIQ_RM_CHECK(top.write(0x0, 0x1) == OKAY);
+	AMIQ_RM_CHECK(!top.is_signal_pending(irq));
+
+	//register arrays: each element is a source
+	pending.set(2, 0x1);
+	AMIQ_RM_CHECK(pending.signal_node.get_count(irq) == 1);
+	AMIQ_RM_CHECK(top.get_signal_sources(irq) == offsets(0x208));
+	AMIQ_RM_CHECK(top.write(0x208, 0x1) == OKAY);
+	AMIQ_RM_CHECK(!top.is_signal_pending(irq));
+
+	//map arrays: only the selected bank is a source, a bank switch updates the parents
+	channels.set(channels.get_index(1, *channel_isr), 0x1);
+	AMIQ_RM_CHECK(top.get_signal_sources(irq) == offsets(0x410));
+	channels.select_bank(1);
+	AMIQ_RM_CHECK(!top.is_signal_pending(irq));
+	AMIQ_RM_CHECK(top.write(0x400, 0x0) == OKAY);
+	channels.set(channels.get_index(0, *channel_isr), 0x1);
+	AMIQ_RM_CHECK(top.get_signal_sources(irq) == offsets(0x400));
+	channels.select_bank(0);
+	AMIQ_RM_CHECK(top.get_signal_sources(irq) == offsets(0x410));
+	AMIQ_RM_CHECK(top.write(0x410, 0x1) == OKAY);
+	AMIQ_RM_CHECK(!top.is_signal_pending(irq));
+	channels.select_bank(1);
+	AMIQ_RM_CHECK(top.get_signal_sources(irq) == offsets(0x400));
+
+	//reset clears all signals
+	top.reset();
+	AMIQ_RM_CHECK(top.get_pending_signals() == 0);
+	channels.select_bank(0);
+	AMIQ_RM_CHECK(top.get_pending_signals() == 0);
+
+	delete status;
+	delete core_isr;
+	delete channel_isr;
+	return amiq_rm_test_result("test_signal");
+}
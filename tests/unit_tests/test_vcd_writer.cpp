@@ -0,0 +1,225 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        test_vcd_writer.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+
+#include "amiq_rm.h"
+#include "amiq_rm_test.hpp"
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace std;
+using namespace amiq_rm;
+
+/** File used by the test. */
+static const char *FILE_NAME = "/tmp/amiq_rm_test_vcd_writer.vcd";
+
+/** A value change of the dump. */
+struct vcd_change {
+	/** The time of the change, the dumped values have the time of $dumpvars. */
+	uint64_t time;
+
+	/** The hierarchical name of the variable (e.g. "top.ctrl.mode"). */
+	string path;
+
+	/** The bits of the value. */
+	string bits;
+};
+
+/** The content of a dump, as parsed by parse(). */
+struct vcd_dump {
+	/** The argument of $timescale. */
+	string timescale;
+
+	/** The width of each variable, by hierarchical name. */
+	map<string, int unsigned> widths;
+
+	/** The values of $dumpvars, by hierarchical name. */
+	map<string, string> initial_values;
+
+	/** The changes which follow $dumpvars, in the order of the file. */
+	vector<vcd_change> changes;
+
+	/** The timestamps which follow $dumpvars, in the order of the file. */
+	vector<uint64_t> times;
+};
+
+/** The function parses the output file of the writer.
+ * @param dump is filled with the content of the file
+ * @returns false if the file is not a well-formed dump */
+static bool parse(vcd_dump &dump) {
+	ifstream file(FILE_NAME);
+	vector<string> scopes;
+	map<string, string> paths;
+	string token;
+	uint64_t time = 0;
+	bool in_definitions = true;
+	bool in_dumpvars = false;
+	bool dumpvars_seen = false;
+
+	while (file >> token) {
+		if (token == "$timescale") {
+			file >> dump.timescale >> token;
+			if (!in_definitions || (token != "$end"))
+				return false;
+		} else if (token == "$scope") {
+			string kind, name;
+			file >> kind >> name >> token;
+			if (!in_definitions || (kind != "module") || (token != "$end"))
+				return false;
+			scopes.push_back(name);
+		} else if (token == "$upscope") {
+			file >> token;
+			if (!in_definitions || scopes.empty() || (token != "$end"))
+				return false;
+			scopes.pop_back();
+		} else if (token == "$var") {
+			string type, code, name;
+			int unsigned width;
+			file >> type >> width >> code >> name >> token;
+			if (!in_definitions || (type != "wire") || (token != "$end") || (paths.count(code) != 0))
+				return false;
+			string path;
+			for (int unsigned i = 0; i < scopes.size(); i++)
+				path += scopes[i] + ".";
+			paths[code] = path + name;
+			dump.widths[path + name] = width;
+		} else if (token == "$enddefinitions") {
+			file >> token;
+			if (!in_definitions || !scopes.empty() || (token != "$end"))
+				return false;
+			in_definitions = false;
+		} else if (token == "$dumpvars") {
+			if (in_definitions || dumpvars_seen)
+				return false;
+			in_dumpvars = true;
+			dumpvars_seen = true;
+		} else if (token == "$end") {
+			if (!in_dumpvars)
+				return false;
+			in_dumpvars = false;
+		} else if (token[0] == '#') {
+			uint64_t new_time = strtoull(token.c_str() + 1, NULL, 10);
+			if (in_definitions || in_dumpvars || (new_time < time))
+				return false;
+			time = new_time;
+			if (dumpvars_seen)
+				dump.times.push_back(time);
+		} else if (token[0] == 'b') {
+			string code;
+			file >> code;
+			if (in_definitions || !dumpvars_seen || (paths.count(code) == 0) || (token.size() - 1 > dump.widths[paths[code]]))
+				return false;
+			if (in_dumpvars) {
+				dump.initial_values[paths[code]] = token.substr(1);
+			} else {
+				vcd_change change = { time, paths[code], token.substr(1) };
+				dump.changes.push_back(change);
+			}
+		} else {
+			return false;
+		}
+	}
+	return !in_definitions && dumpvars_seen && !in_dumpvars;
+}
+
+int main() {
+	//traced.ctrl: enable[0] RW, mode[3:1] RW, count[11:4] RW; traced.sub.data: level[15:0] RW; top.untraced is outside the traced tree
+	amiq_rm_reg ctrl("ctrl");
+	ctrl.add_field(new amiq_rm_field("enable", 0x1, 1, "RW"));
+	ctrl.add_field(new amiq_rm_field("mode", 0x2, 3, "RW"));
+	ctrl.add_field(new amiq_rm_field("count", 0x0, 8, "RW"));
+	amiq_rm_reg data("data");
+	data.add_field(new amiq_rm_field("level", 0xA, 16, "RW"));
+	amiq_rm_reg untraced("untraced");
+	untraced.add_field(new amiq_rm_field("value", 0x0, 32, "RW"));
+
+	amiq_rm_address_map sub("sub");
+	sub.add_reg(data, 0x0);
+	amiq_rm_address_map traced("traced");
+	traced.add_reg(ctrl, 0x0);
+	traced.add_map(sub, 0x100);
+	amiq_rm_physical_address_map top("top");
+	top.add_map(traced, 0x0);
+	top.add_reg(untraced, 0x1000);
+	top.build();
+	top.reset();
+
+	amiq_rm_vcd_writer writer(64);
+	writer.add_map(traced);
+	AMIQ_RM_CHECK(writer.open(FILE_NAME));
+
+	//#10: only mode changes
+	writer.set_time(10);
+	AMIQ_RM_CHECK(top.write(0x0, 0x7) == OKAY);
+	//#10 again, no new timestamp: count changes; the same value does not produce a change
+	writer.set_time(10);
+	AMIQ_RM_CHECK(top.write(0x0, 0x37) == OKAY);
+	AMIQ_RM_CHECK(top.write(0x0, 0x37) == OKAY);
+	//#20 without changes is not written, #30 changes data; the untraced register is not recorded
+	writer.set_time(20);
+	AMIQ_RM_CHECK(top.write(0x1000, 0x1) == OKAY);
+	writer.set_time(30);
+	AMIQ_RM_CHECK(top.write(0x100, 0xFFFF) == OKAY);
+	AMIQ_RM_CHECK(writer.get_nof_changes() == 3);
+	AMIQ_RM_CHECK(writer.close());
+
+	//the writer is detached when it is closed
+	AMIQ_RM_CHECK(top.write(0x100, 0x0) == OKAY);
+
+	vcd_dump dump;
+	AMIQ_RM_CHECK(parse(dump));
+	AMIQ_RM_CHECK(dump.timescale == "1ns");
+
+	//the header has the scopes of the maps and of the registers, a "value" variable and one variable per field
+	AMIQ_RM_CHECK(dump.widths.size() == 6);
+	AMIQ_RM_CHECK(dump.widths["traced.ctrl.value"] == 12);
+	AMIQ_RM_CHECK(dump.widths["traced.ctrl.enable"] == 1);
+	AMIQ_RM_CHECK(dump.widths["traced.ctrl.mode"] == 3);
+	AMIQ_RM_CHECK(dump.widths["traced.ctrl.count"] == 8);
+	AMIQ_RM_CHECK(dump.widths["traced.sub.data.value"] == 16);
+	AMIQ_RM_CHECK(dump.widths["traced.sub.data.level"] == 16);
+	AMIQ_RM_CHECK(dump.widths.count("top.untraced.value") == 0);
+
+	//$dumpvars has the values at the time the output was opened, without the leading zeros
+	AMIQ_RM_CHECK(dump.initial_values.size() == 6);
+	AMIQ_RM_CHECK(dump.initial_values["traced.ctrl.value"] == "101");
+	AMIQ_RM_CHECK(dump.initial_values["traced.ctrl.enable"] == "1");
+	AMIQ_RM_CHECK(dump.initial_values["traced.ctrl.mode"] == "10");
+	AMIQ_RM_CHECK(dump.initial_values["traced.ctrl.count"] == "0");
+	AMIQ_RM_CHECK(dump.initial_values["traced.sub.data.value"] == "1010");
+	AMIQ_RM_CHECK(dump.initial_values["traced.sub.data.level"] == "1010");
+
+	//one timestamp per time with changes, then the value of the register and the fields which changed
+	AMIQ_RM_CHECK((dump.times.size() == 2) && (dump.times[0] == 10) && (dump.times[1] == 30));
+	AMIQ_RM_CHECK(dump.changes.size() == 6);
+	if (dump.changes.size() == 6) {
+		AMIQ_RM_CHECK((dump.changes[0].time == 10) && (dump.changes[0].path == "traced.ctrl.value") && (dump.changes[0].bits == "111"));
+		AMIQ_RM_CHECK((dump.changes[1].time == 10) && (dump.changes[1].path == "traced.ctrl.mode") && (dump.changes[1].bits == "11"));
+		AMIQ_RM_CHECK((dump.changes[2].time == 10) && (dump.changes[2].path == "traced.ctrl.value") && (dump.changes[2].bits == "110111"));
+		AMIQ_RM_CHECK((dump.changes[3].time == 10) && (dump.changes[3].path == "traced.ctrl.count") && (dump.changes[3].bits == "11"));
+		AMIQ_RM_CHECK((dump.changes[4].time == 30) && (dump.changes[4].path == "traced.sub.data.value") && (dump.changes[4].bits == "1111111111111111"));
+		AMIQ_RM_CHECK((dump.changes[5].time == 30) && (dump.changes[5].path == "traced.sub.data.level") && (dump.changes[5].bits == "1111111111111111"));
+	}
+
+	remove(FILE_NAME);
+	return amiq_rm_test_result("test_vcd_writer");
+}
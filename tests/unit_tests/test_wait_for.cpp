@@ -0,0 +1,104 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        test_wait_for.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+
+#include "amiq_rm.h"
+#include "amiq_rm_test.hpp"
+#include <thread>
+
+using namespace std;
+using namespace amiq_rm;
+
+/** A register with a 32-bit read-write field. */
+class test_reg: public amiq_rm_reg {
+public:
+	test_reg(string my_name) :
+			amiq_rm_reg(my_name) {
+		add_field(new amiq_rm_field("value", 0, 32, "RW"));
+		build();
+		reset();
+	}
+};
+
+/** The number of round trips of check_round_trips(). */
+static const int unsigned NOF_ROUND_TRIPS = 5000;
+
+/** A wait which cannot be satisfied returns false at the timeout. */
+static void check_timeout() {
+	test_reg reg("reg");
+	AMIQ_RM_CHECK(!reg.wait_for("value", 1, chrono::milliseconds(10)));
+	AMIQ_RM_CHECK(reg.wait_for("value", 0, chrono::milliseconds(10)));
+}
+
+/** The thread which answers each value of @b ping with the same value on @b pong. */
+static void answer(test_reg *ping, test_reg *pong, int unsigned *nof_missed) {
+	for (int unsigned i = 1; i <= NOF_ROUND_TRIPS; i++) {
+		if (!ping->wait_for("value", i, chrono::seconds(10)))
+			(*nof_missed)++;
+		pong->set(i);
+	}
+}
+
+/** Two threads wait for each other's changes: a lost notification would block a round trip until the timeout. */
+static void check_round_trips() {
+	test_reg ping("ping");
+	test_reg pong("pong");
+	int unsigned nof_missed = 0;
+	thread answerer(answer, &ping, &pong, &nof_missed);
+	for (int unsigned i = 1; i <= NOF_ROUND_TRIPS; i++) {
+		ping.set(i);
+		if (!pong.wait_for("value", i, chrono::seconds(10)))
+			nof_missed++;
+	}
+	answerer.join();
+	AMIQ_RM_CHECK(nof_missed == 0);
+}
+
+/** The thread which waits on a register for the value 1. */
+static void wait_one(test_reg *reg, bool *satisfied) {
+	*satisfied = reg->wait_for("value", 1, chrono::seconds(10));
+}
+
+/** Many registers, more than the wait slots, are waited on at the same time and each one wakes up its waiter. */
+static void check_many_registers() {
+	static const int unsigned NOF_REGS = 100;
+	vector<test_reg*> regs;
+	vector<thread*> waiters;
+	bool satisfied[NOF_REGS];
+	for (int unsigned i = 0; i < NOF_REGS; i++) {
+		regs.push_back(new test_reg("reg"));
+		satisfied[i] = false;
+		waiters.push_back(new thread(wait_one, regs[i], &satisfied[i]));
+	}
+	for (int unsigned i = 0; i < NOF_REGS; i++)
+		regs[i]->set(1);
+	for (int unsigned i = 0; i < NOF_REGS; i++) {
+		waiters[i]->join();
+		AMIQ_RM_CHECK(satisfied[i]);
+		delete waiters[i];
+		delete regs[i];
+	}
+}
+
+int main() {
+	check_timeout();
+	check_round_trips();
+	check_many_registers();
+	return amiq_rm_test_result("test_wait_for");
+}
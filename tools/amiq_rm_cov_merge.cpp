@@ -0,0 +1,48 @@
+/* ****************************************************************************
+ * (C) Copyright 2014 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * NAME:        amiq_rm_cov_merge.cpp
+ * PROJECT:     amiq_rm
+ *******************************************************************************/
+
+#include "amiq_rm_coverage.hpp"
+#include <iostream>
+
+using namespace std;
+using namespace amiq_rm;
+
+//merges the binary coverage files given as inputs into one output file and prints the merged coverage
+int main(int argc, char *argv[]) {
+	if (argc < 3) {
+		cerr << "Usage: " << argv[0] << " <output file> <input file> [<input file> ...]" << endl;
+		return 1;
+	}
+
+	amiq_rm_coverage merged;
+	for (int i = 2; i < argc; i++) {
+		if (!merged.load(argv[i])) {
+			cerr << "Could not merge coverage file " << argv[i] << endl;
+			return 1;
+		}
+	}
+
+	if (!merged.save(argv[1])) {
+		cerr << "Could not write coverage file " << argv[1] << endl;
+		return 1;
+	}
+
+	cout << merged.to_string();
+	return 0;
+}